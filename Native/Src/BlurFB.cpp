@@ -1,4 +1,7 @@
 #include "API.h"
+#include "Utils.h"
+#include "FrameCapture.h"
+#include "BlurFB.h"
 
 #include <GL/glew.h>
 #include <cstdint>
@@ -78,6 +81,14 @@ public:
 		usingDefaultFB = false;
 	}
 	
+	//Only the single sampled buffers can be read back.
+	bool Capture(uint32_t index, const char* path, CaptureFormat format)
+	{
+		if (index != BUF_Inter1 && index != BUF_Inter2)
+			return false;
+		return CaptureFramebuffer(m_framebuffers[index], m_width, m_height, path, format);
+	}
+	
 	void BindTexture(uint32_t index)
 	{
 		glActiveTexture(GL_TEXTURE0);
@@ -112,6 +123,11 @@ CS_VISIBLE void BlurFB_Resolve(BlurFB* blurFB, bool toDefault)
 	blurFB->Resolve(toDefault);
 }
 
+CS_VISIBLE bool BlurFB_Capture(BlurFB* blurFB, uint32_t index, const char* path, CaptureFormat format)
+{
+	return blurFB->Capture(index, path, format);
+}
+
 CS_VISIBLE void BlurFB_BindTexture(BlurFB* blurFB, uint32_t index)
 {
 	blurFB->BindTexture(index);
@@ -120,4 +136,5 @@ CS_VISIBLE void BlurFB_BindTexture(BlurFB* blurFB, uint32_t index)
 CS_VISIBLE void Blur_DrawFST()
 {
 	glDrawArrays(GL_TRIANGLES, 0, 3);
+	DrawCallCount++;
 }
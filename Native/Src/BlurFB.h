@@ -0,0 +1,16 @@
+#pragma once
+
+#include "API.h"
+#include "FrameCapture.h"
+
+#include <cstdint>
+
+class BlurFB;
+
+CS_VISIBLE BlurFB* BlurFB_Create(uint32_t width, uint32_t height);
+CS_VISIBLE void BlurFB_Destroy(BlurFB* blurFB);
+CS_VISIBLE void BlurFB_BindFramebuffer(BlurFB* blurFB, uint32_t index);
+CS_VISIBLE void BlurFB_Resolve(BlurFB* blurFB, bool toDefault);
+CS_VISIBLE bool BlurFB_Capture(BlurFB* blurFB, uint32_t index, const char* path, CaptureFormat format);
+CS_VISIBLE void BlurFB_BindTexture(BlurFB* blurFB, uint32_t index);
+CS_VISIBLE void Blur_DrawFST();
@@ -0,0 +1,161 @@
+#include "API.h"
+#include "Utils.h"
+#include "Mesh.h"
+#include "ChipCuller.h"
+
+#include <GL/glew.h>
+
+//Binding points used by ChipCull.cs.glsl. The visible chips of the pass being drawn are bound to
+// CULLED_CHIPS_UNIT, which is where Chip.vs.glsl and ChipShadow.vs.glsl read them from.
+static const GLuint CULLED_CHIPS_UNIT = 1;
+static const GLuint SHADOW_CULLED_CHIPS_UNIT = 2;
+static const GLuint COMMANDS_UNIT = 3;
+
+static const uint32_t CULL_GROUP_SIZE = 64;
+
+//Size of the CulledChip struct in std430 layout.
+static const size_t CULLED_CHIP_SIZE = sizeof(float) * 8;
+
+class ChipCuller
+{
+public:
+	using Pass = ChipCullPass;
+	
+	static constexpr uint32_t NUM_PASSES = 2;
+	static constexpr uint32_t MAX_MESHES = 4;
+	
+	//The chip meshes are consecutive index ranges of one mesh, so each pass is drawn with a single multi draw.
+	ChipCuller(Mesh& mesh, const uint32_t* partFirstIndices, const uint32_t* partNumIndices, uint32_t numParts)
+		: m_mesh(mesh), m_numParts(numParts)
+	{
+		if (numParts > MAX_MESHES)
+			Panic("Too many meshes for chip culling.");
+		
+		//Each pass has one command per part. The compute shader counts visible chips into instanceCount. The base
+		// instance only selects the draw id, since the culled chips are indexed by gl_InstanceID.
+		for (uint32_t pass = 0; pass < NUM_PASSES; pass++)
+		{
+			for (uint32_t i = 0; i < numParts; i++)
+			{
+				DrawElementsIndirectCommand& command = m_clearedCommands[pass * MAX_MESHES + i];
+				command.count = partNumIndices[i];
+				command.firstIndex = partFirstIndices[i];
+				command.baseInstance = i;
+			}
+		}
+		
+		glGenBuffers(1, &m_commandBuffer);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+		glBufferStorage(GL_DRAW_INDIRECT_BUFFER, sizeof(m_clearedCommands), m_clearedCommands, GL_DYNAMIC_STORAGE_BIT);
+		
+		const uint32_t drawIds[MAX_MESHES] = { 0, 1, 2, 3 };
+		glGenBuffers(1, &m_drawIdBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, m_drawIdBuffer);
+		glBufferStorage(GL_ARRAY_BUFFER, sizeof(drawIds), drawIds, 0);
+	}
+	
+	~ChipCuller()
+	{
+		glDeleteBuffers(1, &m_commandBuffer);
+		glDeleteBuffers(1, &m_drawIdBuffer);
+		if (m_capacity != 0)
+			glDeleteBuffers(1, &m_chipsBuffer);
+	}
+	
+	//Expects the cull shader to be bound and the chip stacks to be bound to unit 0.
+	void Cull(uint32_t numChips)
+	{
+		m_numChips = numChips;
+		
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(m_clearedCommands), m_clearedCommands);
+		
+		if (numChips == 0)
+			return;
+		
+		if (numChips > m_capacity)
+			Reserve(numChips);
+		
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, CULLED_CHIPS_UNIT, m_chipsBuffer, 0, m_passStride);
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, SHADOW_CULLED_CHIPS_UNIT, m_chipsBuffer, m_passStride, m_passStride);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMANDS_UNIT, m_commandBuffer);
+		
+		glDispatchCompute((numChips + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+		
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+	}
+	
+	//Draws every part. Shaders tell the parts apart by the draw id attribute.
+	void Draw(Pass pass)
+	{
+		if (m_numChips == 0)
+			return;
+		
+		const uint32_t passIndex = static_cast<uint32_t>(pass);
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, CULLED_CHIPS_UNIT, m_chipsBuffer, m_passStride * passIndex,
+		                  m_passStride);
+		
+		m_mesh.Bind();
+		
+		glBindBuffer(GL_ARRAY_BUFFER, m_drawIdBuffer);
+		glEnableVertexAttribArray(DRAW_ID_ATTRIB);
+		glVertexAttribIPointer(DRAW_ID_ATTRIB, 1, GL_UNSIGNED_INT, sizeof(uint32_t), nullptr);
+		glVertexAttribDivisor(DRAW_ID_ATTRIB, UINT32_MAX);
+		
+		const size_t commandOffset = sizeof(DrawElementsIndirectCommand) * passIndex * MAX_MESHES;
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, m_mesh.GetIndexType(), reinterpret_cast<void*>(commandOffset),
+		                            m_numParts, 0);
+		DrawCallCount++;
+		
+		glVertexAttribDivisor(DRAW_ID_ATTRIB, 0);
+		glDisableVertexAttribArray(DRAW_ID_ATTRIB);
+	}
+	
+private:
+	void Reserve(uint32_t numChips)
+	{
+		if (m_capacity != 0)
+			glDeleteBuffers(1, &m_chipsBuffer);
+		
+		//Grows in large steps since the number of chips on the table changes a little at a time.
+		m_capacity = RoundToNextMultiple<uint32_t>(numChips, 1024);
+		m_passStride = RoundToNextMultiple<size_t>(m_capacity * CULLED_CHIP_SIZE, SSBOOffsetAlignment);
+		
+		glGenBuffers(1, &m_chipsBuffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_chipsBuffer);
+		glBufferStorage(GL_SHADER_STORAGE_BUFFER, m_passStride * NUM_PASSES, nullptr, 0);
+	}
+	
+	Mesh& m_mesh;
+	uint32_t m_numParts;
+	
+	DrawElementsIndirectCommand m_clearedCommands[NUM_PASSES * MAX_MESHES] = { };
+	
+	uint32_t m_numChips = 0;
+	uint32_t m_capacity = 0;
+	size_t m_passStride = 0;
+	
+	GLuint m_commandBuffer;
+	GLuint m_drawIdBuffer;
+	GLuint m_chipsBuffer;
+};
+
+// C# Bindings
+CS_VISIBLE ChipCuller* CC_Create(Mesh* mesh, const uint32_t* partFirstIndices, const uint32_t* partNumIndices,
+                                 uint32_t numParts)
+{
+	return new ChipCuller(*mesh, partFirstIndices, partNumIndices, numParts);
+}
+
+CS_VISIBLE void CC_Destroy(ChipCuller* culler) { delete culler; }
+
+CS_VISIBLE void CC_Cull(ChipCuller* culler, uint32_t numChips)
+{
+	culler->Cull(numChips);
+}
+
+CS_VISIBLE void CC_Draw(ChipCuller* culler, ChipCullPass pass)
+{
+	culler->Draw(pass);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "API.h"
+#include "Mesh.h"
+
+#include <cstdint>
+
+enum class ChipCullPass : uint32_t
+{
+	Main = 0,
+	Shadow = 1
+};
+
+class ChipCuller;
+
+CS_VISIBLE ChipCuller* CC_Create(Mesh* mesh, const uint32_t* partFirstIndices, const uint32_t* partNumIndices,
+                                 uint32_t numParts);
+CS_VISIBLE void CC_Destroy(ChipCuller* culler);
+CS_VISIBLE void CC_Cull(ChipCuller* culler, uint32_t numChips);
+CS_VISIBLE void CC_Draw(ChipCuller* culler, ChipCullPass pass);
@@ -1,25 +1,19 @@
 #include <GL/glew.h>
 #include <cstring>
+#include <vector>
+#include <algorithm>
 
 #include "API.h"
 #include "Utils.h"
-
-#pragma pack(push, 1)
-struct Chip
-{
-	float x;
-	float y;
-	float z;
-	float rotation;
-};
-#pragma pack(pop)
+#include "ChipsBuffer.h"
 
 class ChipsBuffer
 {
 public:
-	inline ChipsBuffer(size_t maxChips)
+	inline ChipsBuffer(size_t maxElements, size_t elementSize)
+		: m_elementSize(elementSize)
 	{
-		m_pageSize = RoundToNextMultiple<size_t>(maxChips * sizeof(float) * 4, SSBOOffsetAlignment);
+		m_pageSize = RoundToNextMultiple<size_t>(maxElements * elementSize, SSBOOffsetAlignment);
 		size_t bufferSize = m_pageSize * MAX_QUEUED_FRAMES;
 		
 		glGenBuffers(1, &m_buffer);
@@ -36,18 +30,43 @@ public:
 		glDeleteBuffers(1, &m_buffer);
 	}
 	
-	inline void Upload(void* chips, uint64_t count)
+	inline void Upload(const void* elements, uint64_t count)
 	{
 		if (count == 0)
 			return;
 		
+		if (m_deltaUploads)
+		{
+			UploadDelta(static_cast<const char*>(elements), count);
+			return;
+		}
+		
 		const size_t bufferOffset = m_pageSize * FrameQueueIndex;
-		const size_t uploadSize = count * sizeof(float) * 4;
+		const size_t uploadSize = count * m_elementSize;
 		
-		std::memcpy(m_bufferMapping + bufferOffset, chips, uploadSize);
+		std::memcpy(m_bufferMapping + bufferOffset, elements, uploadSize);
 		
 		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_buffer);
 		glFlushMappedBufferRange(GL_SHADER_STORAGE_BUFFER, bufferOffset, uploadSize);
+		
+		m_stats.bytesUploaded += uploadSize;
+	}
+	
+	inline void SetDeltaUploads(bool enabled)
+	{
+		m_deltaUploads = enabled;
+		
+		//The mapping is write only, so delta mode keeps a copy of what each page contains to compare against.
+		for (uint32_t i = 0; i < MAX_QUEUED_FRAMES; i++)
+		{
+			m_pageContents[i].resize(enabled ? m_pageSize : 0);
+			m_pageValidBytes[i] = 0;
+		}
+	}
+	
+	inline const ChipsBufferStats& GetStats() const
+	{
+		return m_stats;
 	}
 	
 	inline void Bind(uint32_t unit)
@@ -56,6 +75,71 @@ public:
 	}
 	
 private:
+	void UploadDelta(const char* elements, uint64_t count)
+	{
+		//Unchanged elements separated by less than this many bytes are uploaded as part of the same range.
+		const size_t MERGE_GAP = 256;
+		
+		const size_t bufferOffset = m_pageSize * FrameQueueIndex;
+		const size_t uploadSize = count * m_elementSize;
+		char* pageContents = m_pageContents[FrameQueueIndex].data();
+		const size_t validBytes = m_pageValidBytes[FrameQueueIndex];
+		
+		size_t rangeBegin = 0;
+		size_t rangeEnd = 0;
+		bool hasRange = false;
+		uint64_t bytesUploaded = 0;
+		
+		auto flushRange = [&]
+		{
+			std::memcpy(m_bufferMapping + bufferOffset + rangeBegin, elements + rangeBegin, rangeEnd - rangeBegin);
+			std::memcpy(pageContents + rangeBegin, elements + rangeBegin, rangeEnd - rangeBegin);
+			
+			if (bytesUploaded == 0)
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_buffer);
+			glFlushMappedBufferRange(GL_SHADER_STORAGE_BUFFER, bufferOffset + rangeBegin, rangeEnd - rangeBegin);
+			bytesUploaded += rangeEnd - rangeBegin;
+		};
+		
+		for (size_t offset = 0; offset < uploadSize; offset += m_elementSize)
+		{
+			if (offset + m_elementSize <= validBytes &&
+			    std::memcmp(pageContents + offset, elements + offset, m_elementSize) == 0)
+			{
+				continue;
+			}
+			
+			if (hasRange && offset - rangeEnd < MERGE_GAP)
+			{
+				rangeEnd = offset + m_elementSize;
+				continue;
+			}
+			
+			if (hasRange)
+				flushRange();
+			rangeBegin = offset;
+			rangeEnd = offset + m_elementSize;
+			hasRange = true;
+		}
+		
+		if (hasRange)
+			flushRange();
+		
+		m_pageValidBytes[FrameQueueIndex] = std::max(validBytes, uploadSize);
+		
+		m_stats.bytesUploaded += bytesUploaded;
+		m_stats.bytesSkipped += uploadSize - bytesUploaded;
+		if (bytesUploaded == 0)
+			m_stats.idleUploads++;
+	}
+	
+	bool m_deltaUploads = false;
+	std::vector<char> m_pageContents[MAX_QUEUED_FRAMES];
+	size_t m_pageValidBytes[MAX_QUEUED_FRAMES] = { };
+	
+	ChipsBufferStats m_stats = { };
+	
+	size_t m_elementSize;
 	size_t m_pageSize;
 	GLuint m_buffer;
 	char* m_bufferMapping;
@@ -63,7 +147,12 @@ private:
 
 CS_VISIBLE ChipsBuffer* CB_Create(uint64_t maxChips)
 {
-	return new ChipsBuffer(maxChips);
+	return new ChipsBuffer(maxChips, sizeof(Chip));
+}
+
+CS_VISIBLE ChipsBuffer* CB_CreateStacks(uint64_t maxStacks)
+{
+	return new ChipsBuffer(maxStacks, sizeof(ChipStack));
 }
 
 CS_VISIBLE void CB_Destroy(ChipsBuffer* buffer)
@@ -76,7 +165,22 @@ CS_VISIBLE void CB_Upload(ChipsBuffer* buffer, void* chips, uint64_t count)
 	buffer->Upload(chips, count);
 }
 
+CS_VISIBLE void CB_UploadStacks(ChipsBuffer* buffer, ChipStack* stacks, uint64_t count)
+{
+	buffer->Upload(stacks, count);
+}
+
 CS_VISIBLE void CB_Bind(ChipsBuffer* buffer, uint32_t unit)
 {
 	buffer->Bind(unit);
+}
+
+CS_VISIBLE void CB_SetDeltaUploads(ChipsBuffer* buffer, bool enabled)
+{
+	buffer->SetDeltaUploads(enabled);
+}
+
+CS_VISIBLE ChipsBufferStats CB_GetStats(ChipsBuffer* buffer)
+{
+	return buffer->GetStats();
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "API.h"
+
+#include <cstdint>
+
+#pragma pack(push, 1)
+struct Chip
+{
+	float x;
+	float y;
+	float z;
+	float rotation;
+};
+
+//A stack of chips which is expanded to individual chip instances in the vertex shader.
+struct ChipStack
+{
+	float x;
+	float y;
+	float z;
+	float rotation;
+	uint32_t firstChip;
+	uint32_t count;
+	uint32_t seed;
+	uint32_t color;
+};
+
+struct ChipsBufferStats
+{
+	uint64_t bytesUploaded;
+	uint64_t bytesSkipped;
+	uint64_t idleUploads;
+};
+#pragma pack(pop)
+
+class ChipsBuffer;
+
+CS_VISIBLE ChipsBuffer* CB_Create(uint64_t maxChips);
+CS_VISIBLE ChipsBuffer* CB_CreateStacks(uint64_t maxStacks);
+CS_VISIBLE void CB_Destroy(ChipsBuffer* buffer);
+CS_VISIBLE void CB_Upload(ChipsBuffer* buffer, void* chips, uint64_t count);
+CS_VISIBLE void CB_UploadStacks(ChipsBuffer* buffer, ChipStack* stacks, uint64_t count);
+CS_VISIBLE void CB_Bind(ChipsBuffer* buffer, uint32_t unit);
+CS_VISIBLE void CB_SetDeltaUploads(ChipsBuffer* buffer, bool enabled);
+CS_VISIBLE ChipsBufferStats CB_GetStats(ChipsBuffer* buffer);
@@ -0,0 +1,263 @@
+#include "API.h"
+#include "Utils.h"
+#include "Montgomery.h"
+#include "ThreadPool.h"
+#include "DeckCrypto.h"
+
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+//Cards of the deck are encrypted SRA style, as card^key mod prime, with commuting keys from every player.
+static const uint32_t DECK_SIZE = 52;
+
+//Cards are raised in groups, so that the independent multiplications of different cards overlap in the pipeline.
+static const uint32_t INTERLEAVED_CARDS = 4;
+
+//Cards are split into groups of this many, which the calling thread and pool workers take one at a time.
+static const uint32_t NUM_CARD_GROUPS = DECK_SIZE / INTERLEAVED_CARDS;
+
+//Raises a group of cards to their keys. keys holds either a single key for all cards, or one key per card.
+static void ExpModGroup(const Montgomery& montgomery, uint64_t* cards, const uint64_t* keys, uint32_t numKeys)
+{
+	const uint64_t one = montgomery.ToMontgomery(1);
+	
+	uint64_t bases[INTERLEAVED_CARDS];
+	uint64_t exponents[INTERLEAVED_CARDS];
+	uint64_t results[INTERLEAVED_CARDS];
+	for (uint32_t i = 0; i < INTERLEAVED_CARDS; i++)
+	{
+		bases[i] = montgomery.ToMontgomery(cards[i]);
+		exponents[i] = keys[numKeys == 1 ? 0 : i];
+		results[i] = one;
+	}
+	
+	for (int bit = 63; bit >= 0; bit--)
+	{
+		for (uint32_t i = 0; i < INTERLEAVED_CARDS; i++)
+		{
+			results[i] = montgomery.Multiply(results[i], results[i]);
+			const uint64_t multiplied = montgomery.Multiply(results[i], bases[i]);
+			const uint64_t mask = 0 - ((exponents[i] >> bit) & 1);
+			results[i] = (multiplied & mask) | (results[i] & ~mask);
+		}
+	}
+	
+	for (uint32_t i = 0; i < INTERLEAVED_CARDS; i++)
+		cards[i] = montgomery.FromMontgomery(results[i]);
+}
+
+struct DeckJob
+{
+	DeckJob(uint64_t prime, uint64_t* _cards, const uint64_t* _keys, uint32_t _numKeys)
+		: montgomery(prime), cards(_cards), keys(_keys), numKeys(_numKeys) { }
+	
+	Montgomery montgomery;
+	uint64_t* cards;
+	const uint64_t* keys;
+	uint32_t numKeys;
+	
+	std::atomic<uint32_t> nextGroup { 0 };
+	
+	std::mutex doneMutex;
+	std::condition_variable doneCondition;
+	uint32_t groupsDone = 0;
+	
+	//Runs groups until none are left.
+	void RunGroups()
+	{
+		uint32_t numDone = 0;
+		for (uint32_t group; (group = nextGroup.fetch_add(1, std::memory_order_relaxed)) < NUM_CARD_GROUPS; numDone++)
+		{
+			const uint32_t first = group * INTERLEAVED_CARDS;
+			ExpModGroup(montgomery, cards + first, numKeys == 1 ? keys : keys + first, numKeys);
+		}
+		
+		if (numDone != 0)
+		{
+			std::lock_guard<std::mutex> lock(doneMutex);
+			groupsDone += numDone;
+			if (groupsDone == NUM_CARD_GROUPS)
+				doneCondition.notify_one();
+		}
+	}
+};
+
+//Raises every card to its key, spreading the groups over the shared thread pool. The calling thread works on groups
+// as well, so the deck is finished even when the workers are busy with other jobs. Workers that start late find
+// nothing left to do, which is why they hold on to the job state rather than referring to the caller's stack.
+static void ExpModDeck(uint64_t prime, uint64_t* cards, const uint64_t* keys, uint32_t numKeys)
+{
+	std::shared_ptr<DeckJob> job = std::make_shared<DeckJob>(prime, cards, keys, numKeys);
+	
+	ThreadPool& pool = ThreadPool::GetShared();
+	const uint32_t numHelpers = std::min(pool.GetNumWorkers(), NUM_CARD_GROUPS - 1);
+	for (uint32_t i = 0; i < numHelpers; i++)
+		pool.Submit([job] (uint32_t) { job->RunGroups(); });
+	
+	job->RunGroups();
+	
+	std::unique_lock<std::mutex> lock(job->doneMutex);
+	job->doneCondition.wait(lock, [&] { return job->groupsDone == NUM_CARD_GROUPS; });
+}
+
+static_assert(DECK_SIZE % INTERLEAVED_CARDS == 0, "The deck must split evenly into interleaved groups.");
+
+static uint64_t AddMod(uint64_t a, uint64_t b, uint64_t modulus)
+{
+	return a >= modulus - b ? a - (modulus - b) : a + b;
+}
+
+//Double and add, since the even moduli used for keys can not be put in Montgomery form.
+static uint64_t MultiplyMod(uint64_t a, uint64_t b, uint64_t modulus)
+{
+	a %= modulus;
+	uint64_t result = 0;
+	for (; b != 0; b >>= 1)
+	{
+		if (b & 1)
+			result = AddMod(result, a, modulus);
+		a = AddMod(a, a, modulus);
+	}
+	return result;
+}
+
+static inline uint32_t CountTrailingZeros64(uint64_t value)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return index;
+#elif defined(__GNUC__)
+	return __builtin_ctzll(value);
+#else
+	uint32_t count = 0;
+	for (; (value & 1) == 0; value >>= 1)
+		count++;
+	return count;
+#endif
+}
+
+//Binary GCD. Only shifts and subtractions, which is cheaper than division for testing random key candidates.
+static uint64_t GCD(uint64_t a, uint64_t b)
+{
+	if (a == 0 || b == 0)
+		return a | b;
+	
+	const uint32_t commonTwos = CountTrailingZeros64(a | b);
+	a >>= CountTrailingZeros64(a);
+	do
+	{
+		b >>= CountTrailingZeros64(b);
+		if (a > b)
+			std::swap(a, b);
+		b -= a;
+	} while (b != 0);
+	
+	return a << commonTwos;
+}
+
+//Returns the inverse of value modulo modulus, or 0 if there is none. The coefficients of the extended Euclidean
+// algorithm alternate in sign, so only their magnitudes are kept, which never exceed the modulus.
+static uint64_t InverseMod(uint64_t value, uint64_t modulus)
+{
+	uint64_t remainder = modulus, nextRemainder = value % modulus;
+	uint64_t coefficient = 0, nextCoefficient = 1;
+	bool negative = false, nextNegative = false;
+	
+	while (nextRemainder != 0)
+	{
+		const uint64_t quotient = remainder / nextRemainder;
+		
+		const uint64_t newRemainder = remainder - quotient * nextRemainder;
+		remainder = nextRemainder;
+		nextRemainder = newRemainder;
+		
+		const uint64_t newCoefficient = coefficient + quotient * nextCoefficient;
+		coefficient = nextCoefficient;
+		nextCoefficient = newCoefficient;
+		negative = nextNegative;
+		nextNegative = !nextNegative;
+	}
+	
+	if (remainder != 1)
+		return 0;
+	return negative ? modulus - coefficient : coefficient;
+}
+
+//Picks a key from each random word. Keys must be invertible modulo prime - 1 so that encryption can be undone, and 1
+// is skipped since it would leave the cards unchanged.
+static void GenerateKeys(const uint64_t* randomWords, uint32_t numKeys, uint64_t prime, uint64_t* keys,
+                         uint64_t* inverseKeys)
+{
+	const uint64_t order = prime - 1;
+	for (uint32_t i = 0; i < numKeys; i++)
+	{
+		uint64_t key = 2 + randomWords[i] % (order - 2);
+		while (GCD(key, order) != 1)
+			key = key + 1 == order ? 2 : key + 1;
+		
+		keys[i] = key;
+		inverseKeys[i] = InverseMod(key, order);
+	}
+}
+
+// C# Bindings
+CS_VISIBLE uint64_t DC_ExpMod(uint64_t value, uint64_t exponent, uint64_t prime)
+{
+	if (prime % 2 == 0)
+		Panic("Deck encryption needs an odd prime.");
+	return Montgomery(prime).Pow(value, exponent);
+}
+
+CS_VISIBLE void DC_ExpMod52(uint64_t* cards, const uint64_t* keys, uint32_t numKeys, uint64_t prime)
+{
+	if (prime % 2 == 0)
+		Panic("Deck encryption needs an odd prime.");
+	if (numKeys != 1 && numKeys != DECK_SIZE)
+		Panic("Deck encryption needs one key or a key per card.");
+	ExpModDeck(prime, cards, keys, numKeys);
+}
+
+//Removes the global key and applies the individual keys in one pass. Exponents compose by multiplication modulo
+// prime - 1, so each card is raised only once, to globalInverseKey * individualKeys[i].
+CS_VISIBLE void DC_ReplaceGlobalKey(uint64_t* cards, uint64_t globalInverseKey, const uint64_t* individualKeys,
+                                    uint64_t prime)
+{
+	if (prime % 2 == 0)
+		Panic("Deck encryption needs an odd prime.");
+	
+	uint64_t keys[DECK_SIZE];
+	for (uint32_t i = 0; i < DECK_SIZE; i++)
+		keys[i] = MultiplyMod(globalInverseKey, individualKeys[i], prime - 1);
+	ExpModDeck(prime, cards, keys, DECK_SIZE);
+}
+
+//Applies the keys one after another to a single card.
+CS_VISIBLE uint64_t DC_DecryptCard(uint64_t card, const uint64_t* keys, uint32_t numKeys, uint64_t prime)
+{
+	if (prime % 2 == 0)
+		Panic("Deck encryption needs an odd prime.");
+	
+	const Montgomery montgomery(prime);
+	for (uint32_t i = 0; i < numKeys; i++)
+		card = montgomery.Pow(card, keys[i]);
+	return card;
+}
+
+CS_VISIBLE uint64_t DC_InverseMod(uint64_t value, uint64_t modulus)
+{
+	return InverseMod(value, modulus);
+}
+
+//Writes a key and its inverse for each of the numKeys random words.
+CS_VISIBLE void DC_GenerateKeys(const uint64_t* randomWords, uint32_t numKeys, uint64_t prime, uint64_t* keys,
+                                uint64_t* inverseKeys)
+{
+	if (prime % 2 == 0 || prime < 5)
+		Panic("Deck encryption needs an odd prime of at least 5.");
+	GenerateKeys(randomWords, numKeys, prime, keys, inverseKeys);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "API.h"
+
+#include <cstdint>
+
+//Modular exponentiation for the commutative deck encryption. Cards are encrypted by raising them to a key modulo an
+// odd prime, and decrypted with the key's inverse modulo prime - 1.
+
+CS_VISIBLE uint64_t DC_ExpMod(uint64_t value, uint64_t exponent, uint64_t prime);
+
+//Raises all 52 cards to keys[0] if numKeys is 1, or each card to its own key if numKeys is 52.
+CS_VISIBLE void DC_ExpMod52(uint64_t* cards, const uint64_t* keys, uint32_t numKeys, uint64_t prime);
+
+CS_VISIBLE void DC_ReplaceGlobalKey(uint64_t* cards, uint64_t globalInverseKey, const uint64_t* individualKeys,
+                                    uint64_t prime);
+CS_VISIBLE uint64_t DC_DecryptCard(uint64_t card, const uint64_t* keys, uint32_t numKeys, uint64_t prime);
+CS_VISIBLE uint64_t DC_InverseMod(uint64_t value, uint64_t modulus);
+CS_VISIBLE void DC_GenerateKeys(const uint64_t* randomWords, uint32_t numKeys, uint64_t prime, uint64_t* keys,
+                                uint64_t* inverseKeys);
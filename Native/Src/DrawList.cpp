@@ -0,0 +1,270 @@
+#include "API.h"
+#include "Utils.h"
+#include "Mesh.h"
+#include "DrawList.h"
+
+#include <GL/glew.h>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+class DrawList
+{
+public:
+	static constexpr uint32_t INVALID_HANDLE = UINT32_MAX;
+	
+	DrawList(Mesh& mesh, uint32_t maxDraws, uint32_t paramsStride)
+		: m_mesh(mesh), m_maxDraws(maxDraws), m_paramsStride(paramsStride)
+	{
+		m_commands.resize(maxDraws);
+		m_params.resize(static_cast<size_t>(maxDraws) * paramsStride);
+		m_slotToHandle.resize(maxDraws);
+		
+		m_commandsPageSize = RoundToNextMultiple<size_t>(maxDraws * sizeof(DrawElementsIndirectCommand), 16);
+		m_paramsPageSize = RoundToNextMultiple<size_t>(static_cast<size_t>(maxDraws) * paramsStride, SSBOOffsetAlignment);
+		
+		GLuint buffers[3];
+		glGenBuffers(3, buffers);
+		m_commandBuffer = buffers[0];
+		m_paramsBuffer = buffers[1];
+		m_drawIdBuffer = buffers[2];
+		
+		const GLbitfield storageFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT;
+		const GLbitfield mapFlags = storageFlags | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+		
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+		glBufferStorage(GL_DRAW_INDIRECT_BUFFER, m_commandsPageSize * MAX_QUEUED_FRAMES, nullptr, storageFlags);
+		m_commandsMapping = static_cast<char*>(glMapBufferRange(GL_DRAW_INDIRECT_BUFFER, 0,
+				m_commandsPageSize * MAX_QUEUED_FRAMES, mapFlags));
+		
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_paramsBuffer);
+		glBufferStorage(GL_SHADER_STORAGE_BUFFER, m_paramsPageSize * MAX_QUEUED_FRAMES, nullptr, storageFlags);
+		m_paramsMapping = static_cast<char*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0,
+				m_paramsPageSize * MAX_QUEUED_FRAMES, mapFlags));
+		
+		//Shaders index their parameter SSBO with the draw id attribute, which is read from this identity buffer.
+		std::vector<uint32_t> drawIds(maxDraws);
+		for (uint32_t i = 0; i < maxDraws; i++)
+			drawIds[i] = i;
+		glBindBuffer(GL_ARRAY_BUFFER, m_drawIdBuffer);
+		glBufferStorage(GL_ARRAY_BUFFER, sizeof(uint32_t) * maxDraws, drawIds.data(), 0);
+	}
+	
+	~DrawList()
+	{
+		const GLuint buffers[] = { m_commandBuffer, m_paramsBuffer, m_drawIdBuffer };
+		glDeleteBuffers(3, buffers);
+	}
+	
+	uint32_t Add(const DrawDesc& desc, const void* params)
+	{
+		if (m_numDraws == m_maxDraws)
+			Panic("DrawList capacity exceeded.");
+		
+		uint32_t handle;
+		if (!m_freeHandles.empty())
+		{
+			handle = m_freeHandles.back();
+			m_freeHandles.pop_back();
+		}
+		else
+		{
+			handle = static_cast<uint32_t>(m_handleToSlot.size());
+			m_handleToSlot.push_back(INVALID_HANDLE);
+		}
+		
+		const uint32_t slot = m_numDraws++;
+		m_handleToSlot[handle] = slot;
+		m_slotToHandle[slot] = handle;
+		
+		WriteSlot(slot, &desc, params);
+		return handle;
+	}
+	
+	void Remove(uint32_t handle)
+	{
+		const uint32_t slot = m_handleToSlot[handle];
+		if (slot == INVALID_HANDLE)
+			return;
+		
+		//Keeps the command array compact by moving the last draw into the freed slot.
+		const uint32_t lastSlot = --m_numDraws;
+		if (slot != lastSlot)
+		{
+			m_commands[slot] = m_commands[lastSlot];
+			m_commands[slot].baseInstance = slot;
+			std::memcpy(&m_params[static_cast<size_t>(slot) * m_paramsStride],
+			            &m_params[static_cast<size_t>(lastSlot) * m_paramsStride], m_paramsStride);
+			
+			const uint32_t movedHandle = m_slotToHandle[lastSlot];
+			m_slotToHandle[slot] = movedHandle;
+			m_handleToSlot[movedHandle] = slot;
+			MarkDirty(slot);
+		}
+		
+		m_handleToSlot[handle] = INVALID_HANDLE;
+		m_freeHandles.push_back(handle);
+	}
+	
+	void Update(uint32_t handle, const DrawDesc* desc, const void* params)
+	{
+		const uint32_t slot = m_handleToSlot[handle];
+		if (slot != INVALID_HANDLE)
+			WriteSlot(slot, desc, params);
+	}
+	
+	//Removes all draws, for lists which are rebuilt every frame in draw order.
+	void Clear()
+	{
+		m_numDraws = 0;
+		m_handleToSlot.clear();
+		m_freeHandles.clear();
+	}
+	
+	uint32_t GetCount() const
+	{
+		return m_numDraws;
+	}
+	
+	void Submit(uint32_t paramsUnit)
+	{
+		if (m_numDraws == 0)
+			return;
+		
+		const size_t commandsOffset = m_commandsPageSize * FrameQueueIndex;
+		const size_t paramsOffset = m_paramsPageSize * FrameQueueIndex;
+		
+		//Each frame page only receives the draws which changed since that page was last written.
+		DirtyRange& dirty = m_dirtyRanges[FrameQueueIndex];
+		const uint32_t dirtyEnd = std::min(dirty.end, m_numDraws);
+		if (dirty.begin < dirtyEnd)
+		{
+			const size_t commandsBegin = dirty.begin * sizeof(DrawElementsIndirectCommand);
+			const size_t commandsBytes = (dirtyEnd - dirty.begin) * sizeof(DrawElementsIndirectCommand);
+			std::memcpy(m_commandsMapping + commandsOffset + commandsBegin, &m_commands[dirty.begin], commandsBytes);
+			
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+			glFlushMappedBufferRange(GL_DRAW_INDIRECT_BUFFER, commandsOffset + commandsBegin, commandsBytes);
+			
+			if (m_paramsStride != 0)
+			{
+				const size_t paramsBegin = static_cast<size_t>(dirty.begin) * m_paramsStride;
+				const size_t paramsBytes = static_cast<size_t>(dirtyEnd - dirty.begin) * m_paramsStride;
+				std::memcpy(m_paramsMapping + paramsOffset + paramsBegin, &m_params[paramsBegin], paramsBytes);
+				
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_paramsBuffer);
+				glFlushMappedBufferRange(GL_SHADER_STORAGE_BUFFER, paramsOffset + paramsBegin, paramsBytes);
+			}
+		}
+		dirty = { };
+		
+		m_mesh.Bind();
+		
+		glBindBuffer(GL_ARRAY_BUFFER, m_drawIdBuffer);
+		glEnableVertexAttribArray(DRAW_ID_ATTRIB);
+		glVertexAttribIPointer(DRAW_ID_ATTRIB, 1, GL_UNSIGNED_INT, sizeof(uint32_t), nullptr);
+		glVertexAttribDivisor(DRAW_ID_ATTRIB, UINT32_MAX);
+		
+		if (m_paramsStride != 0)
+			glBindBufferRange(GL_SHADER_STORAGE_BUFFER, paramsUnit, m_paramsBuffer, paramsOffset, m_paramsPageSize);
+		
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, m_mesh.GetIndexType(), reinterpret_cast<void*>(commandsOffset),
+		                            m_numDraws, 0);
+		DrawCallCount++;
+		
+		//The mesh VAO is shared with regular draws, which must not see the draw id array.
+		glVertexAttribDivisor(DRAW_ID_ATTRIB, 0);
+		glDisableVertexAttribArray(DRAW_ID_ATTRIB);
+	}
+	
+private:
+	void WriteSlot(uint32_t slot, const DrawDesc* desc, const void* params)
+	{
+		if (desc != nullptr)
+		{
+			DrawElementsIndirectCommand& command = m_commands[slot];
+			command.count = desc->numIndices;
+			command.instanceCount = desc->numInstances;
+			command.firstIndex = desc->firstIndex;
+			command.baseVertex = desc->baseVertex;
+			command.baseInstance = slot;
+		}
+		
+		if (params != nullptr && m_paramsStride != 0)
+			std::memcpy(&m_params[static_cast<size_t>(slot) * m_paramsStride], params, m_paramsStride);
+		
+		MarkDirty(slot);
+	}
+	
+	void MarkDirty(uint32_t slot)
+	{
+		for (DirtyRange& range : m_dirtyRanges)
+		{
+			range.begin = std::min(range.begin, slot);
+			range.end = std::max(range.end, slot + 1);
+		}
+	}
+	
+	struct DirtyRange
+	{
+		uint32_t begin = UINT32_MAX;
+		uint32_t end = 0;
+	};
+	
+	Mesh& m_mesh;
+	uint32_t m_maxDraws;
+	uint32_t m_paramsStride;
+	uint32_t m_numDraws = 0;
+	
+	std::vector<DrawElementsIndirectCommand> m_commands;
+	std::vector<char> m_params;
+	
+	std::vector<uint32_t> m_handleToSlot;
+	std::vector<uint32_t> m_slotToHandle;
+	std::vector<uint32_t> m_freeHandles;
+	
+	DirtyRange m_dirtyRanges[MAX_QUEUED_FRAMES];
+	
+	size_t m_commandsPageSize;
+	size_t m_paramsPageSize;
+	
+	GLuint m_commandBuffer;
+	GLuint m_paramsBuffer;
+	GLuint m_drawIdBuffer;
+	
+	char* m_commandsMapping;
+	char* m_paramsMapping;
+};
+
+// C# Bindings
+CS_VISIBLE DrawList* DL_Create(Mesh* mesh, uint32_t maxDraws, uint32_t paramsStride)
+{
+	return new DrawList(*mesh, maxDraws, paramsStride);
+}
+
+CS_VISIBLE void DL_Destroy(DrawList* drawList) { delete drawList; }
+
+CS_VISIBLE uint32_t DL_Add(DrawList* drawList, const DrawDesc* desc, const void* params)
+{
+	return drawList->Add(*desc, params);
+}
+
+CS_VISIBLE void DL_Remove(DrawList* drawList, uint32_t handle)
+{
+	drawList->Remove(handle);
+}
+
+CS_VISIBLE void DL_Update(DrawList* drawList, uint32_t handle, const DrawDesc* desc, const void* params)
+{
+	drawList->Update(handle, desc, params);
+}
+
+CS_VISIBLE void DL_Clear(DrawList* drawList) { drawList->Clear(); }
+
+CS_VISIBLE uint32_t DL_GetCount(DrawList* drawList) { return drawList->GetCount(); }
+
+CS_VISIBLE void DL_Submit(DrawList* drawList, uint32_t paramsUnit)
+{
+	drawList->Submit(paramsUnit);
+}
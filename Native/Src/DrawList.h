@@ -0,0 +1,27 @@
+#pragma once
+
+#include "API.h"
+#include "Mesh.h"
+
+#include <cstdint>
+
+#pragma pack(push, 1)
+struct DrawDesc
+{
+	uint32_t firstIndex;
+	uint32_t numIndices;
+	int32_t baseVertex;
+	uint32_t numInstances;
+};
+#pragma pack(pop)
+
+class DrawList;
+
+CS_VISIBLE DrawList* DL_Create(Mesh* mesh, uint32_t maxDraws, uint32_t paramsStride);
+CS_VISIBLE void DL_Destroy(DrawList* drawList);
+CS_VISIBLE uint32_t DL_Add(DrawList* drawList, const DrawDesc* desc, const void* params);
+CS_VISIBLE void DL_Remove(DrawList* drawList, uint32_t handle);
+CS_VISIBLE void DL_Update(DrawList* drawList, uint32_t handle, const DrawDesc* desc, const void* params);
+CS_VISIBLE void DL_Clear(DrawList* drawList);
+CS_VISIBLE uint32_t DL_GetCount(DrawList* drawList);
+CS_VISIBLE void DL_Submit(DrawList* drawList, uint32_t paramsUnit);
@@ -0,0 +1,692 @@
+#include "Equity.h"
+#include "RangeEquity.h"
+#include "ThreadPool.h"
+#include "Random.h"
+#include "API.h"
+#include "Utils.h"
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <climits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EQUITY_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#define ALIGN16 __declspec(align(16))
+#else
+#define ALIGN16 __attribute__((aligned(16)))
+#endif
+
+//Monte Carlo deals are run in batches of this size, which is also how often partial results are published.
+static const uint32_t DEALS_PER_TASK = 4096;
+
+//Exhaustive enumeration compares players on this many boards at a time, one board per 16 bit SIMD lane.
+static const uint32_t RIVER_BLOCK_SIZE = 8;
+
+static inline uint32_t PopCount16(uint32_t mask)
+{
+	mask = mask - ((mask >> 1) & 0x5555);
+	mask = (mask & 0x3333) + ((mask >> 2) & 0x3333);
+	mask = (mask + (mask >> 4)) & 0x0F0F;
+	return (mask + (mask >> 8)) & 0x1F;
+}
+
+void EquityTally::Add(const EquityTally& other)
+{
+	deals += other.deals;
+	for (uint32_t p = 0; p < MAX_EQUITY_PLAYERS; p++)
+	{
+		wins[p] += other.wins[p];
+		ties[p] += other.ties[p];
+		shares[p] += other.shares[p];
+	}
+}
+
+EquitySpot MakeEquitySpot(const uint8_t* holeCards, uint32_t numPlayers, const uint8_t* board, uint32_t numBoardCards,
+                          const uint8_t* deadCards, uint32_t numDeadCards)
+{
+	if (numPlayers < 2 || numPlayers > MAX_EQUITY_PLAYERS)
+		Panic("Equity calculations need between 2 and 8 players.");
+	if (numBoardCards > 5)
+		Panic("Too many board cards for equity calculation.");
+	
+	uint64_t usedCards = 0;
+	auto UseCard = [&] (uint8_t card)
+	{
+		if (card >= 52 || (usedCards & (1ull << card)))
+			Panic("Invalid or repeated card in equity calculation.");
+		usedCards |= 1ull << card;
+	};
+	
+	EquitySpot spot;
+	spot.numPlayers = numPlayers;
+	uint32_t numUnknownHands = 0;
+	for (uint32_t p = 0; p < numPlayers; p++)
+	{
+		spot.holeCards[p * 2] = holeCards[p * 2];
+		spot.holeCards[p * 2 + 1] = holeCards[p * 2 + 1];
+		if (holeCards[p * 2] == NO_CARD)
+		{
+			numUnknownHands++;
+			continue;
+		}
+		UseCard(holeCards[p * 2]);
+		UseCard(holeCards[p * 2 + 1]);
+	}
+	
+	spot.numBoardCards = numBoardCards;
+	for (uint32_t i = 0; i < numBoardCards; i++)
+	{
+		spot.board[i] = board[i];
+		UseCard(board[i]);
+	}
+	
+	for (uint32_t i = 0; i < numDeadCards; i++)
+		UseCard(deadCards[i]);
+	
+	spot.deckSize = 0;
+	for (uint8_t card = 0; card < 52; card++)
+	{
+		if (!(usedCards & (1ull << card)))
+			spot.deck[spot.deckSize++] = card;
+	}
+	
+	if (spot.deckSize < (5 - numBoardCards) + numUnknownHands * 2)
+		Panic("Not enough cards left to deal in equity calculation.");
+	
+	return spot;
+}
+
+void TallyDeal(uint8_t hands[][7], uint32_t numPlayers, EquityTally& tally)
+{
+	uint16_t strengths[MAX_EQUITY_PLAYERS];
+	uint16_t best = 0;
+	for (uint32_t p = 0; p < numPlayers; p++)
+	{
+		strengths[p] = EvaluateHand(hands[p], 7);
+		best = std::max(best, strengths[p]);
+	}
+	
+	uint32_t numWinners = 0;
+	for (uint32_t p = 0; p < numPlayers; p++)
+		numWinners += strengths[p] == best;
+	
+	const uint64_t share = EQUITY_SHARE_UNIT / numWinners;
+	for (uint32_t p = 0; p < numPlayers; p++)
+	{
+		if (strengths[p] != best)
+			continue;
+		
+		if (numWinners == 1)
+			tally.wins[p]++;
+		else
+			tally.ties[p]++;
+		tally.shares[p] += share;
+	}
+	tally.deals++;
+}
+
+static void SampleDeals(const EquitySpot& spot, uint32_t numDeals, Xoshiro256& random, EquityTally& tally)
+{
+	uint8_t deck[52];
+	std::copy(spot.deck, spot.deck + spot.deckSize, deck);
+	
+	uint8_t hands[MAX_EQUITY_PLAYERS][7];
+	uint32_t numUnknownHands = 0;
+	for (uint32_t p = 0; p < spot.numPlayers; p++)
+	{
+		hands[p][0] = spot.holeCards[p * 2];
+		hands[p][1] = spot.holeCards[p * 2 + 1];
+		std::copy(spot.board, spot.board + spot.numBoardCards, hands[p] + 2);
+		numUnknownHands += hands[p][0] == NO_CARD;
+	}
+	
+	const uint32_t numMissingBoard = 5 - spot.numBoardCards;
+	const uint32_t numToDeal = numMissingBoard + numUnknownHands * 2;
+	
+	for (uint32_t deal = 0; deal < numDeals; deal++)
+	{
+		//Partial Fisher-Yates shuffle of the front of the deck. The deck is not restored between deals, since a
+		// shuffle of any permutation is as good as a shuffle of the sorted deck.
+		for (uint32_t i = 0; i < numToDeal; i++)
+			std::swap(deck[i], deck[i + random.NextBelow(spot.deckSize - i)]);
+		
+		const uint8_t* dealt = deck + numMissingBoard;
+		for (uint32_t p = 0; p < spot.numPlayers; p++)
+		{
+			std::copy(deck, deck + numMissingBoard, hands[p] + 2 + spot.numBoardCards);
+			if (spot.holeCards[p * 2] == NO_CARD)
+			{
+				hands[p][0] = *(dealt++);
+				hands[p][1] = *(dealt++);
+			}
+		}
+		
+		TallyDeal(hands, spot.numPlayers, tally);
+	}
+}
+
+//Scores every river from deck[firstRiver] onwards, given the first four board cards. The rivers of each player are
+// evaluated together from the six known cards, and then compared across players for eight boards at a time.
+static void TallyRivers(const EquitySpot& spot, const uint8_t* board, uint32_t firstRiver, EquityTally& tally)
+{
+	const uint32_t numRivers = spot.deckSize - firstRiver;
+	if (numRivers == 0)
+		return;
+	const uint32_t numBlocks = (numRivers + RIVER_BLOCK_SIZE - 1) / RIVER_BLOCK_SIZE;
+	
+	ALIGN16 uint16_t strengths[MAX_EQUITY_PLAYERS][RoundToNextMultiple<uint32_t>(52, RIVER_BLOCK_SIZE)];
+	for (uint32_t p = 0; p < spot.numPlayers; p++)
+	{
+		const uint8_t cards[6] = { spot.holeCards[p * 2], spot.holeCards[p * 2 + 1],
+		                           board[0], board[1], board[2], board[3] };
+		uint16_t cardStrengths[52];
+		EvaluateRivers(cards, cardStrengths);
+		
+		for (uint32_t i = 0; i < numRivers; i++)
+			strengths[p][i] = cardStrengths[spot.deck[firstRiver + i]];
+		std::fill(strengths[p] + numRivers, strengths[p] + numBlocks * RIVER_BLOCK_SIZE, 0);
+	}
+	
+	//Number of boards each player wins, indexed by the number of players sharing the pot.
+	uint32_t potsWon[MAX_EQUITY_PLAYERS][MAX_EQUITY_PLAYERS + 1] = { };
+	
+	for (uint32_t block = 0; block < numBlocks; block++)
+	{
+		const uint32_t offset = block * RIVER_BLOCK_SIZE;
+		const uint32_t numValid = std::min(RIVER_BLOCK_SIZE, numRivers - offset);
+		
+#ifdef EQUITY_SSE2
+		//Strengths are compared as signed values, so the top bit is flipped to keep straight flushes on top.
+		const __m128i signFlip = _mm_set1_epi16(static_cast<short>(0x8000));
+		__m128i playerStrengths[MAX_EQUITY_PLAYERS];
+		__m128i best = _mm_set1_epi16(SHRT_MIN);
+		for (uint32_t p = 0; p < spot.numPlayers; p++)
+		{
+			const __m128i loaded = _mm_load_si128(reinterpret_cast<const __m128i*>(strengths[p] + offset));
+			playerStrengths[p] = _mm_xor_si128(loaded, signFlip);
+			best = _mm_max_epi16(best, playerStrengths[p]);
+		}
+		
+		__m128i winnerCounts = _mm_setzero_si128();
+		for (uint32_t p = 0; p < spot.numPlayers; p++)
+		{
+			playerStrengths[p] = _mm_cmpeq_epi16(playerStrengths[p], best);
+			winnerCounts = _mm_sub_epi16(winnerCounts, playerStrengths[p]);
+		}
+		
+		//Byte masks have two bits per board.
+		const uint32_t validMask = (1u << (numValid * 2)) - 1;
+		for (uint32_t numWinners = 1; numWinners <= spot.numPlayers; numWinners++)
+		{
+			const __m128i hasNumWinners = _mm_cmpeq_epi16(winnerCounts, _mm_set1_epi16(static_cast<short>(numWinners)));
+			if ((_mm_movemask_epi8(hasNumWinners) & validMask) == 0)
+				continue;
+			
+			for (uint32_t p = 0; p < spot.numPlayers; p++)
+			{
+				const uint32_t mask = _mm_movemask_epi8(_mm_and_si128(hasNumWinners, playerStrengths[p])) & validMask;
+				potsWon[p][numWinners] += PopCount16(mask) / 2;
+			}
+		}
+#else
+		for (uint32_t i = offset; i < offset + numValid; i++)
+		{
+			uint16_t best = 0;
+			for (uint32_t p = 0; p < spot.numPlayers; p++)
+				best = std::max(best, strengths[p][i]);
+			
+			uint32_t numWinners = 0;
+			for (uint32_t p = 0; p < spot.numPlayers; p++)
+				numWinners += strengths[p][i] == best;
+			
+			for (uint32_t p = 0; p < spot.numPlayers; p++)
+				potsWon[p][numWinners] += strengths[p][i] == best;
+		}
+#endif
+	}
+	
+	for (uint32_t p = 0; p < spot.numPlayers; p++)
+	{
+		tally.wins[p] += potsWon[p][1];
+		for (uint32_t numWinners = 1; numWinners <= spot.numPlayers; numWinners++)
+		{
+			if (numWinners > 1)
+				tally.ties[p] += potsWon[p][numWinners];
+			tally.shares[p] += potsWon[p][numWinners] * (EQUITY_SHARE_UNIT / numWinners);
+		}
+	}
+	tally.deals += numRivers;
+}
+
+//Fills in the board from board[numFilled] using cards from deck[nextIndex] onwards, in increasing deck order so
+// that every board is dealt once.
+static void EnumerateBoards(const EquitySpot& spot, uint8_t* board, uint32_t numFilled, uint32_t nextIndex,
+                            EquityTally& tally)
+{
+	if (numFilled == 4)
+	{
+		TallyRivers(spot, board, nextIndex, tally);
+		return;
+	}
+	
+	for (uint32_t i = nextIndex; i < spot.deckSize; i++)
+	{
+		board[numFilled] = spot.deck[i];
+		EnumerateBoards(spot, board, numFilled + 1, i + 1, tally);
+	}
+}
+
+//Returns the same key for spots that only differ by a permutation of suits, which have the same equities.
+static std::string GetCanonicalKey(const EquitySpot& spot)
+{
+	std::string bestKey;
+	uint8_t suits[4] = { 0, 1, 2, 3 };
+	do
+	{
+		auto MapCard = [&] (uint8_t card) { return static_cast<uint8_t>((card & ~3) | suits[card & 3]); };
+		
+		std::string key;
+		key.push_back(static_cast<char>(spot.numPlayers));
+		for (uint32_t p = 0; p < spot.numPlayers; p++)
+		{
+			const uint8_t first = MapCard(spot.holeCards[p * 2]);
+			const uint8_t second = MapCard(spot.holeCards[p * 2 + 1]);
+			key.push_back(static_cast<char>(std::max(first, second)));
+			key.push_back(static_cast<char>(std::min(first, second)));
+		}
+		
+		uint8_t board[5];
+		std::transform(spot.board, spot.board + spot.numBoardCards, board, MapCard);
+		std::sort(board, board + spot.numBoardCards);
+		key.push_back(static_cast<char>(spot.numBoardCards));
+		key.append(reinterpret_cast<const char*>(board), spot.numBoardCards);
+		
+		//The deck tells apart spots with different dead cards.
+		uint64_t deckMask = 0;
+		for (uint32_t i = 0; i < spot.deckSize; i++)
+			deckMask |= 1ull << MapCard(spot.deck[i]);
+		key.append(reinterpret_cast<const char*>(&deckMask), sizeof(deckMask));
+		
+		if (bestKey.empty() || key < bestKey)
+			bestKey = std::move(key);
+	}
+	while (std::next_permutation(suits, suits + 4));
+	
+	return bestKey;
+}
+
+//Results of finished enumerations and fixed size range samplings, by canonical spot. Cleared when full, since spots at a
+// live table are rarely repeated much later.
+static const size_t MAX_CACHED_SPOTS = 4096;
+static std::mutex cacheMutex;
+static std::unordered_map<std::string, EquityTally> resultCache;
+
+void ClearEquityCache()
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	resultCache.clear();
+}
+
+//Computes equities on the shared thread pool while the caller keeps running. Partial results can be read at any time.
+class EquityJob
+{
+public:
+	EquityJob()
+		: m_pool(ThreadPool::GetShared()) { }
+	
+	~EquityJob()
+	{
+		m_cancelled = true;
+		Wait();
+	}
+	
+	//Runs a fixed number of deals, or as many as fit in the time budget when no number is given.
+	void StartMonteCarlo(const EquitySpot& spot, uint64_t numDeals, uint32_t timeBudgetMS, uint64_t seed)
+	{
+		m_spot = spot;
+		m_sampler = [this] (Xoshiro256& random, uint32_t count, EquityTally& tally)
+		{
+			SampleDeals(m_spot, count, random, tally);
+			return true;
+		};
+		StartSampling(numDeals, timeBudgetMS, seed);
+	}
+	
+	//Samples deals from the players' ranges, like StartMonteCarlo. Results of a fixed number of deals are cached.
+	void StartRangeSampling(RangeSpot&& spot, uint64_t numDeals, uint32_t timeBudgetMS, uint64_t seed)
+	{
+		m_rangeSpot.reset(new RangeSpot(std::move(spot)));
+		m_sampler = [this] (Xoshiro256& random, uint32_t count, EquityTally& tally)
+		{
+			return SampleRangeDeals(*m_rangeSpot, count, random, tally);
+		};
+		
+		if (numDeals != 0)
+		{
+			m_cacheKey = m_rangeSpot->canonicalKey;
+			m_cacheKey.append(reinterpret_cast<const char*>(&numDeals), sizeof(numDeals));
+			if (TryGetCached())
+				return;
+		}
+		
+		StartSampling(numDeals, timeBudgetMS, seed);
+	}
+	
+	//Deals every possible board. All hole cards must be known.
+	void StartEnumeration(const EquitySpot& spot)
+	{
+		m_spot = spot;
+		for (uint32_t p = 0; p < m_spot.numPlayers; p++)
+		{
+			if (m_spot.holeCards[p * 2] == NO_CARD)
+				Panic("Equity enumeration needs all hole cards to be known.");
+		}
+		
+		m_cacheKey = GetCanonicalKey(m_spot);
+		if (TryGetCached())
+			return;
+		
+		const uint32_t numMissing = 5 - m_spot.numBoardCards;
+		if (numMissing >= 2)
+		{
+			//Splits the work by the first missing board card. Tasks for the low cards have many more boards to deal,
+			// which is evened out by idle workers stealing the rest.
+			for (uint32_t i = 0; i < m_spot.deckSize; i++)
+			{
+				Submit([this, i] (uint32_t)
+				{
+					uint8_t board[5];
+					std::copy(m_spot.board, m_spot.board + m_spot.numBoardCards, board);
+					board[m_spot.numBoardCards] = m_spot.deck[i];
+					
+					EquityTally tally;
+					EnumerateBoards(m_spot, board, m_spot.numBoardCards + 1, i + 1, tally);
+					AddResult(tally);
+				});
+			}
+		}
+		else
+		{
+			Submit([this, numMissing] (uint32_t)
+			{
+				EquityTally tally;
+				if (numMissing == 1)
+				{
+					TallyRivers(m_spot, m_spot.board, 0, tally);
+				}
+				else
+				{
+					uint8_t hands[MAX_EQUITY_PLAYERS][7];
+					for (uint32_t p = 0; p < m_spot.numPlayers; p++)
+					{
+						hands[p][0] = m_spot.holeCards[p * 2];
+						hands[p][1] = m_spot.holeCards[p * 2 + 1];
+						std::copy(m_spot.board, m_spot.board + 5, hands[p] + 2);
+					}
+					TallyDeal(hands, m_spot.numPlayers, tally);
+				}
+				AddResult(tally);
+			});
+		}
+		
+		FinishTask();
+	}
+	
+	//Returns true once the job has finished.
+	bool GetResult(EquityTally& tally)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		tally = m_result;
+		return m_pendingTasks == 0;
+	}
+	
+	//Must not be called from a thread pool task.
+	void Wait()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_tasksDone.wait(lock, [&] { return m_pendingTasks == 0; });
+	}
+	
+	//Cancels the job without waiting for it. The job deletes itself once its running tasks have returned.
+	void Release()
+	{
+		m_cancelled = true;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_pendingTasks != 0)
+			{
+				m_released = true;
+				return;
+			}
+		}
+		delete this;
+	}
+	
+private:
+	void StartSampling(uint64_t numDeals, uint32_t timeBudgetMS, uint64_t seed)
+	{
+		m_hasDeadline = timeBudgetMS != 0;
+		m_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeBudgetMS);
+		
+		//Each worker draws from its own stream, so tasks never share generator state.
+		Xoshiro256 random(seed);
+		for (uint32_t i = 0; i < m_pool.GetNumWorkers(); i++)
+		{
+			m_workerStates.emplace_back(random);
+			random.Jump();
+		}
+		
+		if (numDeals != 0)
+		{
+			for (uint64_t dealt = 0; dealt < numDeals; dealt += DEALS_PER_TASK)
+			{
+				const uint32_t taskDeals = static_cast<uint32_t>(std::min<uint64_t>(DEALS_PER_TASK, numDeals - dealt));
+				Submit([this, taskDeals] (uint32_t workerIndex) { SampleBatches(workerIndex, taskDeals, 1); });
+			}
+		}
+		else
+		{
+			//In time budget mode every worker keeps dealing batches until the deadline.
+			for (uint32_t i = 0; i < m_pool.GetNumWorkers(); i++)
+				Submit([this] (uint32_t workerIndex) { SampleBatches(workerIndex, DEALS_PER_TASK, UINT32_MAX); });
+		}
+		
+		FinishTask();
+	}
+	
+	void Submit(std::function<void(uint32_t)> task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pendingTasks++;
+		}
+		
+		m_pool.Submit([this, task] (uint32_t workerIndex)
+		{
+			if (!m_cancelled)
+				task(workerIndex);
+			FinishTask();
+		});
+	}
+	
+	//Finishes the job straight away if the result is cached.
+	bool TryGetCached()
+	{
+		{
+			std::lock_guard<std::mutex> lock(cacheMutex);
+			auto entry = resultCache.find(m_cacheKey);
+			if (entry == resultCache.end())
+				return false;
+			m_result = entry->second;
+		}
+		
+		m_cacheKey.clear();
+		FinishTask();
+		return true;
+	}
+	
+	//Start functions hold one pending task themselves while submitting, so the job can not finish before all of its
+	// tasks have been submitted.
+	void FinishTask()
+	{
+		bool released;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (--m_pendingTasks != 0)
+				return;
+			
+			if (!m_cacheKey.empty() && !m_cancelled)
+			{
+				std::lock_guard<std::mutex> cacheLock(cacheMutex);
+				if (resultCache.size() >= MAX_CACHED_SPOTS)
+					resultCache.clear();
+				resultCache.emplace(m_cacheKey, m_result);
+			}
+			m_tasksDone.notify_all();
+			released = m_released;
+		}
+		
+		//Nothing touches the job after its last task, so it can be deleted from the worker.
+		if (released)
+			delete this;
+	}
+	
+	void AddResult(const EquityTally& tally)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_result.Add(tally);
+	}
+	
+	void SampleBatches(uint32_t workerIndex, uint32_t dealsPerBatch, uint32_t maxBatches)
+	{
+		for (uint32_t batch = 0; batch < maxBatches && !m_cancelled; batch++)
+		{
+			if (m_hasDeadline && std::chrono::steady_clock::now() >= m_deadline)
+				break;
+			
+			EquityTally tally;
+			const bool dealt = m_sampler(m_workerStates[workerIndex].random, dealsPerBatch, tally);
+			AddResult(tally);
+			if (!dealt)
+				break;
+		}
+	}
+	
+	//Padded so that the generators of different workers never share a cache line.
+	struct WorkerState
+	{
+		explicit WorkerState(const Xoshiro256& _random) : random(_random) { }
+		
+		char padding[64];
+		Xoshiro256 random;
+	};
+	
+	EquitySpot m_spot;
+	std::unique_ptr<RangeSpot> m_rangeSpot;
+	std::function<bool(Xoshiro256&, uint32_t, EquityTally&)> m_sampler;
+	
+	ThreadPool& m_pool;
+	std::vector<WorkerState> m_workerStates;
+	
+	std::chrono::steady_clock::time_point m_deadline;
+	bool m_hasDeadline = false;
+	std::atomic<bool> m_cancelled { false };
+	
+	//Set while a job whose result will be cached is running.
+	std::string m_cacheKey;
+	
+	std::mutex m_mutex;
+	std::condition_variable m_tasksDone;
+	uint32_t m_pendingTasks = 1;
+	bool m_released = false;
+	EquityTally m_result;
+};
+
+EquityTally SampleEquity(const EquitySpot& spot, uint64_t numDeals, uint64_t seed)
+{
+	EquityJob job;
+	job.StartMonteCarlo(spot, numDeals, 0, seed);
+	job.Wait();
+	
+	EquityTally tally;
+	job.GetResult(tally);
+	return tally;
+}
+
+EquityTally EnumerateEquity(const EquitySpot& spot)
+{
+	EquityJob job;
+	job.StartEnumeration(spot);
+	job.Wait();
+	
+	EquityTally tally;
+	job.GetResult(tally);
+	return tally;
+}
+
+// C# Bindings
+CS_VISIBLE EquityJob* EQ_StartMonteCarlo(const uint8_t* holeCards, uint32_t numPlayers, const uint8_t* board,
+                                         uint32_t numBoardCards, const uint8_t* deadCards, uint32_t numDeadCards,
+                                         uint64_t numDeals, uint32_t timeBudgetMS, uint64_t seed)
+{
+	EquityJob* job = new EquityJob();
+	job->StartMonteCarlo(MakeEquitySpot(holeCards, numPlayers, board, numBoardCards, deadCards, numDeadCards),
+	                     numDeals, timeBudgetMS, seed);
+	return job;
+}
+
+CS_VISIBLE EquityJob* EQ_StartEnumeration(const uint8_t* holeCards, uint32_t numPlayers, const uint8_t* board,
+                                          uint32_t numBoardCards, const uint8_t* deadCards, uint32_t numDeadCards)
+{
+	EquityJob* job = new EquityJob();
+	job->StartEnumeration(MakeEquitySpot(holeCards, numPlayers, board, numBoardCards, deadCards, numDeadCards));
+	return job;
+}
+
+//weights holds 1326 combo weights for each player, see GetComboIndex. Returns null if a player's range is empty
+// once the board and dead cards are removed.
+CS_VISIBLE EquityJob* EQ_StartRangeSampling(const float* weights, uint32_t numPlayers, const uint8_t* board,
+                                            uint32_t numBoardCards, const uint8_t* deadCards, uint32_t numDeadCards,
+                                            uint64_t numDeals, uint32_t timeBudgetMS, uint64_t seed)
+{
+	RangeSpot spot;
+	if (!MakeRangeSpot(weights, numPlayers, board, numBoardCards, deadCards, numDeadCards, spot))
+		return nullptr;
+	
+	EquityJob* job = new EquityJob();
+	job->StartRangeSampling(std::move(spot), numDeals, timeBudgetMS, seed);
+	return job;
+}
+
+//Returns at once, a running job is cancelled and freed on the thread pool.
+CS_VISIBLE void EQ_Destroy(EquityJob* job) { job->Release(); }
+
+//Writes the fraction of deals each player wins outright, ties, and the player's share of the pot. Returns true once
+// the job has finished.
+CS_VISIBLE bool EQ_GetResult(EquityJob* job, uint64_t* deals, double* win, double* tie, double* equity)
+{
+	EquityTally tally;
+	const bool finished = job->GetResult(tally);
+	
+	*deals = tally.deals;
+	const double scale = tally.deals == 0 ? 0.0 : 1.0 / tally.deals;
+	for (uint32_t p = 0; p < MAX_EQUITY_PLAYERS; p++)
+	{
+		win[p] = tally.wins[p] * scale;
+		tie[p] = tally.ties[p] * scale;
+		equity[p] = tally.shares[p] * scale / EQUITY_SHARE_UNIT;
+	}
+	return finished;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "HandEvaluator.h"
+
+#include <cstdint>
+
+static const uint32_t MAX_EQUITY_PLAYERS = 8;
+
+//Split pots are counted in units that divide evenly among any number of winners.
+static const uint64_t EQUITY_SHARE_UNIT = 840;
+
+struct EquityTally
+{
+	uint64_t deals = 0;
+	uint64_t wins[MAX_EQUITY_PLAYERS] = { };
+	uint64_t ties[MAX_EQUITY_PLAYERS] = { };
+	uint64_t shares[MAX_EQUITY_PLAYERS] = { };
+	
+	void Add(const EquityTally& other);
+};
+
+//A spot to compute equities for. Players with NO_CARD hole cards hold unknown hands, which are dealt from the deck
+// along with the rest of the board. The deck holds every card that is not known or dead.
+struct EquitySpot
+{
+	uint32_t numPlayers;
+	uint8_t holeCards[MAX_EQUITY_PLAYERS * 2];
+	uint32_t numBoardCards;
+	uint8_t board[5];
+	uint32_t deckSize;
+	uint8_t deck[52];
+};
+
+//Panics if there are too many players or cards, or if a card is given twice.
+EquitySpot MakeEquitySpot(const uint8_t* holeCards, uint32_t numPlayers, const uint8_t* board, uint32_t numBoardCards,
+                          const uint8_t* deadCards, uint32_t numDeadCards);
+
+//Scores one complete deal. Each hand holds the player's hole cards followed by the board.
+void TallyDeal(uint8_t hands[][7], uint32_t numPlayers, EquityTally& tally);
+
+//Blocking versions of the native equity jobs, which run on the shared thread pool. Must not be called from a pool task.
+EquityTally SampleEquity(const EquitySpot& spot, uint64_t numDeals, uint64_t seed);
+
+//Deals every possible board and returns exact results. Results are cached by the spot with its suits put in a
+// canonical order, so spots that only differ by suits are only enumerated once.
+EquityTally EnumerateEquity(const EquitySpot& spot);
+
+void ClearEquityCache();
@@ -0,0 +1,377 @@
+#include "FrameCapture.h"
+#include "API.h"
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+//Read back buffers in flight. Captures are dropped rather than stalling when all of them are in use.
+static const uint32_t CAPTURE_SLOTS = 4;
+
+struct CaptureSlot
+{
+	GLuint buffer = 0;
+	const uint8_t* mapping = nullptr;
+	size_t capacity = 0;
+	
+	GLsync fence = nullptr;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t skippedFrames = 0;
+	uint32_t droppedFrames = 0;
+	CaptureFormat format = CaptureFormat::PNG;
+	std::string path;
+	
+	//Set while the GPU or the worker thread uses the slot.
+	std::atomic<bool> busy { false };
+};
+
+static CaptureSlot slots[CAPTURE_SLOTS];
+
+//Slots whose fence has not been seen signaled yet, in submission order.
+static std::deque<uint32_t> pendingSlots;
+
+static std::thread workerThread;
+static std::mutex workerMutex;
+static std::condition_variable workerCondition;
+static std::deque<uint32_t> workerQueue;
+static bool stopWorker = false;
+
+//Raw stream being written, only used by the worker thread. It stays open until the path changes or capturing shuts
+// down, rather than being reopened for every frame.
+static std::ofstream rawStream;
+static std::string rawStreamPath;
+
+static std::atomic<uint32_t> capturesWritten { 0 };
+static uint32_t capturesDropped = 0;
+
+//Frames missing since the last capture, written into the next raw frame header.
+static uint32_t framesSkippedSinceCapture = 0;
+static uint32_t capturesDroppedSinceCapture = 0;
+
+static uint32_t crcTable[256];
+
+static bool InitCRCTable()
+{
+	for (uint32_t n = 0; n < 256; n++)
+	{
+		uint32_t c = n;
+		for (int k = 0; k < 8; k++)
+			c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+		crcTable[n] = c;
+	}
+	return true;
+}
+
+static uint32_t UpdateCRC(uint32_t crc, const uint8_t* data, size_t length)
+{
+	for (size_t i = 0; i < length; i++)
+		crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return crc;
+}
+
+static void WriteBE32(std::vector<uint8_t>& out, uint32_t value)
+{
+	out.push_back(static_cast<uint8_t>(value >> 24));
+	out.push_back(static_cast<uint8_t>(value >> 16));
+	out.push_back(static_cast<uint8_t>(value >> 8));
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+static void WriteChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+{
+	WriteBE32(out, static_cast<uint32_t>(data.size()));
+	const size_t typeBegin = out.size();
+	out.insert(out.end(), type, type + 4);
+	out.insert(out.end(), data.begin(), data.end());
+	WriteBE32(out, UpdateCRC(0xFFFFFFFFu, out.data() + typeBegin, out.size() - typeBegin) ^ 0xFFFFFFFFu);
+}
+
+std::vector<uint8_t> EncodePNG(const uint8_t* pixels, uint32_t width, uint32_t height)
+{
+	static const bool crcTableInitialized = InitCRCTable();
+	(void)crcTableInitialized;
+	
+	//Each row is prefixed with filter type 0.
+	const size_t rowSize = static_cast<size_t>(width) * 3 + 1;
+	std::vector<uint8_t> image(rowSize * height);
+	for (uint32_t y = 0; y < height; y++)
+	{
+		const uint8_t* src = pixels + static_cast<size_t>(height - 1 - y) * width * 4;
+		uint8_t* dst = image.data() + rowSize * y;
+		*(dst++) = 0;
+		for (uint32_t x = 0; x < width; x++)
+		{
+			*(dst++) = src[x * 4 + 0];
+			*(dst++) = src[x * 4 + 1];
+			*(dst++) = src[x * 4 + 2];
+		}
+	}
+	
+	const size_t MAX_BLOCK_SIZE = 65535;
+	std::vector<uint8_t> zlib;
+	zlib.reserve(image.size() + (image.size() / MAX_BLOCK_SIZE + 1) * 5 + 6);
+	zlib.push_back(0x78);
+	zlib.push_back(0x01);
+	
+	uint32_t adlerA = 1, adlerB = 0;
+	for (size_t offset = 0; ; offset += MAX_BLOCK_SIZE)
+	{
+		const size_t blockSize = std::min(MAX_BLOCK_SIZE, image.size() - offset);
+		const bool lastBlock = offset + blockSize == image.size();
+		zlib.push_back(lastBlock ? 1 : 0);
+		zlib.push_back(static_cast<uint8_t>(blockSize));
+		zlib.push_back(static_cast<uint8_t>(blockSize >> 8));
+		zlib.push_back(static_cast<uint8_t>(~blockSize));
+		zlib.push_back(static_cast<uint8_t>(~blockSize >> 8));
+		zlib.insert(zlib.end(), image.begin() + offset, image.begin() + offset + blockSize);
+		
+		for (size_t i = offset; i < offset + blockSize; i++)
+		{
+			adlerA = (adlerA + image[i]) % 65521;
+			adlerB = (adlerB + adlerA) % 65521;
+		}
+		
+		if (lastBlock)
+			break;
+	}
+	WriteBE32(zlib, (adlerB << 16) | adlerA);
+	
+	std::vector<uint8_t> header;
+	WriteBE32(header, width);
+	WriteBE32(header, height);
+	const uint8_t headerTail[] = { 8, 2, 0, 0, 0 };
+	header.insert(header.end(), headerTail, headerTail + sizeof(headerTail));
+	
+	const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	std::vector<uint8_t> png(signature, signature + sizeof(signature));
+	png.reserve(zlib.size() + 64);
+	WriteChunk(png, "IHDR", header);
+	WriteChunk(png, "IDAT", zlib);
+	WriteChunk(png, "IEND", { });
+	return png;
+}
+
+static void WriteCapture(const CaptureSlot& slot)
+{
+	if (slot.format == CaptureFormat::Raw)
+	{
+		if (rawStreamPath != slot.path)
+		{
+			rawStream.close();
+			rawStream.clear();
+			rawStream.open(slot.path, std::ios::binary | std::ios::trunc);
+			rawStreamPath = slot.path;
+		}
+		
+		//Every frame carries its own size, since the window may be resized while capturing.
+		RawFrameHeader header;
+		header.width = slot.width;
+		header.height = slot.height;
+		header.skippedFrames = slot.skippedFrames;
+		header.droppedFrames = slot.droppedFrames;
+		rawStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		
+		const size_t rowBytes = static_cast<size_t>(slot.width) * 4;
+		for (uint32_t y = slot.height; y > 0; y--)
+			rawStream.write(reinterpret_cast<const char*>(slot.mapping + rowBytes * (y - 1)), rowBytes);
+		
+		if (!rawStream)
+		{
+			std::cerr << "Error writing frame capture to '" << slot.path << "'." << std::endl;
+			rawStream.clear();
+		}
+		return;
+	}
+	
+	const std::vector<uint8_t> png = EncodePNG(slot.mapping, slot.width, slot.height);
+	std::ofstream stream(slot.path, std::ios::binary);
+	stream.write(reinterpret_cast<const char*>(png.data()), png.size());
+	
+	if (!stream)
+		std::cerr << "Error writing frame capture to '" << slot.path << "'." << std::endl;
+}
+
+static void RunCaptureWorker()
+{
+	while (true)
+	{
+		uint32_t slotIndex;
+		{
+			std::unique_lock<std::mutex> lock(workerMutex);
+			workerCondition.wait(lock, [] { return stopWorker || !workerQueue.empty(); });
+			if (workerQueue.empty())
+				return;
+			slotIndex = workerQueue.front();
+			workerQueue.pop_front();
+		}
+		
+		WriteCapture(slots[slotIndex]);
+		capturesWritten++;
+		slots[slotIndex].busy.store(false, std::memory_order_release);
+	}
+}
+
+static void QueueForWorker(uint32_t slotIndex)
+{
+	{
+		std::lock_guard<std::mutex> lock(workerMutex);
+		workerQueue.push_back(slotIndex);
+	}
+	workerCondition.notify_one();
+}
+
+bool CaptureFramebuffer(GLuint framebuffer, uint32_t width, uint32_t height, const char* path, CaptureFormat format)
+{
+	uint32_t slotIndex = 0;
+	while (slotIndex < CAPTURE_SLOTS && slots[slotIndex].busy.load(std::memory_order_acquire))
+		slotIndex++;
+	
+	if (slotIndex == CAPTURE_SLOTS)
+	{
+		capturesDropped++;
+		capturesDroppedSinceCapture++;
+		return false;
+	}
+	
+	if (!workerThread.joinable())
+	{
+		stopWorker = false;
+		workerThread = std::thread(RunCaptureWorker);
+	}
+	
+	CaptureSlot& slot = slots[slotIndex];
+	
+	const size_t size = static_cast<size_t>(width) * height * 4;
+	if (size > slot.capacity)
+	{
+		if (slot.buffer != 0)
+			glDeleteBuffers(1, &slot.buffer);
+		
+		//The worker thread reads the pixels straight from the persistent mapping.
+		const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glGenBuffers(1, &slot.buffer);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+		glBufferStorage(GL_PIXEL_PACK_BUFFER, size, nullptr, flags);
+		slot.mapping = static_cast<const uint8_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, flags));
+		slot.capacity = size;
+	}
+	
+	GLint previousReadFramebuffer;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+	
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, previousReadFramebuffer);
+	
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.width = width;
+	slot.height = height;
+	slot.skippedFrames = framesSkippedSinceCapture;
+	slot.droppedFrames = capturesDroppedSinceCapture;
+	slot.format = format;
+	slot.path = path;
+	slot.busy.store(true, std::memory_order_relaxed);
+	
+	framesSkippedSinceCapture = 0;
+	capturesDroppedSinceCapture = 0;
+	
+	pendingSlots.push_back(slotIndex);
+	return true;
+}
+
+void UpdateFrameCapture()
+{
+	//Fences signal in submission order, so polling stops at the first one that has not.
+	while (!pendingSlots.empty())
+	{
+		CaptureSlot& slot = slots[pendingSlots.front()];
+		const GLenum status = glClientWaitSync(slot.fence, 0, 0);
+		if (status == GL_TIMEOUT_EXPIRED)
+			break;
+		
+		glDeleteSync(slot.fence);
+		slot.fence = nullptr;
+		QueueForWorker(pendingSlots.front());
+		pendingSlots.pop_front();
+	}
+}
+
+void FrameCaptureSkipped()
+{
+	framesSkippedSinceCapture++;
+}
+
+void ShutdownFrameCapture()
+{
+	const GLuint64 WAIT_TIMEOUT = 1000000000;
+	for (uint32_t slotIndex : pendingSlots)
+	{
+		glClientWaitSync(slots[slotIndex].fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT);
+		glDeleteSync(slots[slotIndex].fence);
+		slots[slotIndex].fence = nullptr;
+		QueueForWorker(slotIndex);
+	}
+	pendingSlots.clear();
+	
+	if (workerThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(workerMutex);
+			stopWorker = true;
+		}
+		workerCondition.notify_one();
+		workerThread.join();
+	}
+	
+	rawStream.close();
+	rawStreamPath.clear();
+	
+	for (CaptureSlot& slot : slots)
+	{
+		if (slot.buffer != 0)
+			glDeleteBuffers(1, &slot.buffer);
+		slot.buffer = 0;
+		slot.mapping = nullptr;
+		slot.capacity = 0;
+	}
+}
+
+#pragma pack(push, 1)
+struct FrameCaptureStats
+{
+	uint32_t written;
+	uint32_t dropped;
+	uint32_t inFlight;
+};
+#pragma pack(pop)
+
+// C# Bindings
+CS_VISIBLE bool CaptureFrame(uint32_t width, uint32_t height, const char* path, CaptureFormat format)
+{
+	return CaptureFramebuffer(0, width, height, path, format);
+}
+
+CS_VISIBLE FrameCaptureStats GetFrameCaptureStats()
+{
+	FrameCaptureStats stats;
+	stats.written = capturesWritten;
+	stats.dropped = capturesDropped;
+	stats.inFlight = 0;
+	for (const CaptureSlot& slot : slots)
+	{
+		if (slot.busy.load(std::memory_order_relaxed))
+			stats.inFlight++;
+	}
+	return stats;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+
+enum class CaptureFormat : uint32_t
+{
+	//One PNG file per capture.
+	PNG = 0,
+	
+	//A RawFrameHeader and top down RGBA8 rows appended to the file for every capture, so that a sequence of captures
+	// forms a raw video stream. The file is truncated by the first capture to it and kept open until the path changes
+	// or ShutdownFrameCapture.
+	Raw = 1
+};
+
+#pragma pack(push, 1)
+struct RawFrameHeader
+{
+	uint32_t width;
+	uint32_t height;
+	
+	//Frames since the previous capture which are missing from the stream, because they skipped presenting or because
+	// all read back buffers were in use.
+	uint32_t skippedFrames;
+	uint32_t droppedFrames;
+};
+#pragma pack(pop)
+
+//Starts reading back the color buffer of the given framebuffer, 0 being the back buffer. The pixels are copied into a pixel pack
+// buffer and written to path by a worker thread once the GPU has finished. Returns false if the capture was
+// dropped because all read back buffers are in use.
+bool CaptureFramebuffer(GLuint framebuffer, uint32_t width, uint32_t height, const char* path, CaptureFormat format);
+
+//Encodes an RGB PNG from bottom up RGBA rows. The image data is stored in uncompressed deflate blocks, which keeps
+// encoding cheap enough to never fall behind the capture rate at the cost of larger files.
+std::vector<uint8_t> EncodePNG(const uint8_t* pixels, uint32_t width, uint32_t height);
+
+//Called once per frame after presentation. Hands captures which the GPU has finished to the worker thread.
+void UpdateFrameCapture();
+
+//Called instead of UpdateFrameCapture for frames which skipped presenting, so that raw streams can record the gap.
+void FrameCaptureSkipped();
+
+//Waits for all captures to be written, must be called while the context is still current.
+void ShutdownFrameCapture();
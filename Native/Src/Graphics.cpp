@@ -112,4 +112,9 @@ CS_VISIBLE void FB_DiscardColor()
 {
 	GLenum attachment = GL_COLOR_ATTACHMENT0;
 	glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, &attachment);
+}
+
+CS_VISIBLE uint32_t GetDrawCallCount()
+{
+	return DrawCallCount;
 }
\ No newline at end of file
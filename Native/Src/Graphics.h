@@ -17,3 +17,4 @@ extern uint32_t DisplayWidth;
 extern uint32_t DisplayHeight;
 
 CS_VISIBLE void SetFixedFunctionState(uint8_t state);
+CS_VISIBLE void FB_ClearDepth();
@@ -0,0 +1,500 @@
+#include "HandEvaluator.h"
+#include "API.h"
+#include "Utils.h"
+
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+enum HandCategory : uint32_t
+{
+	HC_HighCard      = 0,
+	HC_Pair          = 1,
+	HC_TwoPair       = 2,
+	HC_ThreeOfAKind  = 3,
+	HC_Straight      = 4,
+	HC_Flush         = 5,
+	HC_FullHouse     = 6,
+	HC_FourOfAKind   = 7,
+	HC_StraightFlush = 8
+};
+
+static const uint32_t NUM_RANKS = 13;
+static const uint32_t MIN_CARDS = 5;
+static const uint32_t MAX_CARDS = 7;
+
+//Returns the top rank of the highest straight in a mask of ranks, or -1. A5432 counts as a five high straight.
+static int FindStraight(uint32_t rankMask)
+{
+	for (int top = 12; top >= 4; top--)
+	{
+		const uint32_t straightMask = 0x1Fu << (top - 4);
+		if ((rankMask & straightMask) == straightMask)
+			return top;
+	}
+	
+	const uint32_t WHEEL_MASK = (1u << 12) | 0xF;
+	return (rankMask & WHEEL_MASK) == WHEEL_MASK ? 3 : -1;
+}
+
+//Appends the highest ranks in the mask, up to count of them.
+static void TakeHighest(uint32_t rankMask, uint32_t count, std::vector<int>& ranks)
+{
+	for (int rank = 12; rank >= 0 && count > 0; rank--)
+	{
+		if (rankMask & (1u << rank))
+		{
+			ranks.push_back(rank);
+			count--;
+		}
+	}
+}
+
+//Scores are only used while building the tables. They order hands by category followed by up to five
+// deciding ranks, four bits each.
+static uint32_t MakeScore(uint32_t category, const std::vector<int>& ranks)
+{
+	uint32_t score = category << 20;
+	for (size_t i = 0; i < ranks.size(); i++)
+		score |= static_cast<uint32_t>(ranks[i]) << (16 - 4 * i);
+	return score;
+}
+
+//Scores the best five card hand from a multiset of ranks, ignoring flushes.
+static uint32_t ScoreRanks(const uint8_t counts[NUM_RANKS])
+{
+	uint32_t present = 0;
+	int quads = -1, trips = -1, secondTrips = -1, pairHigh = -1, pairLow = -1;
+	for (int rank = 12; rank >= 0; rank--)
+	{
+		if (counts[rank] == 0)
+			continue;
+		present |= 1u << rank;
+		
+		if (counts[rank] == 4)
+		{
+			quads = rank;
+		}
+		else if (counts[rank] == 3)
+		{
+			if (trips == -1)
+				trips = rank;
+			else if (secondTrips == -1)
+				secondTrips = rank;
+		}
+		else if (counts[rank] == 2)
+		{
+			if (pairHigh == -1)
+				pairHigh = rank;
+			else if (pairLow == -1)
+				pairLow = rank;
+		}
+	}
+	
+	std::vector<int> ranks;
+	if (quads != -1)
+	{
+		ranks.push_back(quads);
+		TakeHighest(present & ~(1u << quads), 1, ranks);
+		return MakeScore(HC_FourOfAKind, ranks);
+	}
+	
+	//With two sets of three, the lower one provides the pair of a full house.
+	const int fullHousePair = std::max(secondTrips, pairHigh);
+	if (trips != -1 && fullHousePair != -1)
+		return MakeScore(HC_FullHouse, { trips, fullHousePair });
+	
+	const int straight = FindStraight(present);
+	if (straight != -1)
+		return MakeScore(HC_Straight, { straight });
+	
+	if (trips != -1)
+	{
+		ranks.push_back(trips);
+		TakeHighest(present & ~(1u << trips), 2, ranks);
+		return MakeScore(HC_ThreeOfAKind, ranks);
+	}
+	
+	if (pairLow != -1)
+	{
+		ranks.push_back(pairHigh);
+		ranks.push_back(pairLow);
+		TakeHighest(present & ~(1u << pairHigh) & ~(1u << pairLow), 1, ranks);
+		return MakeScore(HC_TwoPair, ranks);
+	}
+	
+	if (pairHigh != -1)
+	{
+		ranks.push_back(pairHigh);
+		TakeHighest(present & ~(1u << pairHigh), 3, ranks);
+		return MakeScore(HC_Pair, ranks);
+	}
+	
+	TakeHighest(present, 5, ranks);
+	return MakeScore(HC_HighCard, ranks);
+}
+
+static uint32_t ScoreFlush(uint32_t suitMask)
+{
+	const int straight = FindStraight(suitMask);
+	if (straight != -1)
+		return MakeScore(HC_StraightFlush, { straight });
+	
+	std::vector<int> ranks;
+	TakeHighest(suitMask, 5, ranks);
+	return MakeScore(HC_Flush, ranks);
+}
+
+//Lookup tables built when the library is loaded. Flushes are looked up by the ranks of the flush suit. All other
+// hands are looked up by their multiset of ranks, through a minimal perfect hash which ranks the multiset among
+// all multisets with the same number of cards.
+struct EvaluatorTables
+{
+	uint16_t flushStrengths[1 << NUM_RANKS];
+	
+	//Hash contribution of count cards of a rank, when remaining cards are left for this and the higher ranks.
+	uint32_t rankHash[NUM_RANKS][MAX_CARDS + 1][5];
+	
+	uint32_t rankStrengthsOffset[MAX_CARDS + 1];
+	std::vector<uint16_t> rankStrengths;
+	
+	EvaluatorTables()
+	{
+		BuildHash();
+		
+		//Enumerates every scorable hand to find the strength order within each category.
+		std::vector<uint32_t> scores;
+		ForEachRankMultiset(MIN_CARDS, [&] (const uint8_t* counts) { scores.push_back(ScoreRanks(counts)); });
+		for (uint32_t mask = 0; mask < (1u << NUM_RANKS); mask++)
+		{
+			if (PopCount(mask) == MIN_CARDS)
+				scores.push_back(ScoreFlush(mask));
+		}
+		
+		std::sort(scores.begin(), scores.end());
+		scores.erase(std::unique(scores.begin(), scores.end()), scores.end());
+		
+		std::map<uint32_t, uint16_t> strengthOfScore;
+		uint32_t category = UINT32_MAX;
+		uint32_t index = 0;
+		for (uint32_t score : scores)
+		{
+			if (score >> 20 != category)
+			{
+				category = score >> 20;
+				index = 0;
+			}
+			strengthOfScore[score] = static_cast<uint16_t>((category << 12) | index++);
+		}
+		
+		for (uint32_t mask = 0; mask < (1u << NUM_RANKS); mask++)
+			flushStrengths[mask] = PopCount(mask) >= MIN_CARDS ? strengthOfScore[ScoreFlush(mask)] : 0;
+		
+		for (uint32_t numCards = MIN_CARDS; numCards <= MAX_CARDS; numCards++)
+		{
+			rankStrengthsOffset[numCards] = static_cast<uint32_t>(rankStrengths.size());
+			rankStrengths.resize(rankStrengths.size() + multisets[0][numCards]);
+			ForEachRankMultiset(numCards, [&] (const uint8_t* counts)
+			{
+				uint64_t packedCounts = 0;
+				for (uint32_t rank = 0; rank < NUM_RANKS; rank++)
+					packedCounts |= static_cast<uint64_t>(counts[rank]) << (rank * 4);
+				rankStrengths[rankStrengthsOffset[numCards] + Hash(packedCounts, numCards)] = strengthOfScore[ScoreRanks(counts)];
+			});
+		}
+	}
+	
+	//Counts are stored in four bits per rank, starting with the lowest rank.
+	uint32_t Hash(uint64_t counts, uint32_t numCards) const
+	{
+		uint32_t hash = 0;
+		for (uint32_t rank = 0; rank < NUM_RANKS; rank++)
+		{
+			const uint32_t count = static_cast<uint32_t>(counts >> (rank * 4)) & 0xF;
+			hash += rankHash[rank][numCards][count];
+			numCards -= count;
+		}
+		return hash;
+	}
+	
+private:
+	//Number of multisets of ranks from rank and up, with the given number of cards and at most four of each rank.
+	uint32_t multisets[NUM_RANKS + 1][MAX_CARDS + 1];
+	
+	void BuildHash()
+	{
+		for (uint32_t cards = 0; cards <= MAX_CARDS; cards++)
+			multisets[NUM_RANKS][cards] = cards == 0 ? 1 : 0;
+		
+		for (int rank = NUM_RANKS - 1; rank >= 0; rank--)
+		{
+			for (uint32_t cards = 0; cards <= MAX_CARDS; cards++)
+			{
+				multisets[rank][cards] = 0;
+				for (uint32_t count = 0; count <= std::min(cards, 4u); count++)
+					multisets[rank][cards] += multisets[rank + 1][cards - count];
+			}
+		}
+		
+		//Multisets with fewer of this rank come first, so count cards of this rank skip past all multisets
+		// which have fewer of it.
+		for (uint32_t rank = 0; rank < NUM_RANKS; rank++)
+		{
+			for (uint32_t cards = 0; cards <= MAX_CARDS; cards++)
+			{
+				uint32_t skipped = 0;
+				for (uint32_t count = 0; count <= 4; count++)
+				{
+					rankHash[rank][cards][count] = skipped;
+					if (count <= cards)
+						skipped += multisets[rank + 1][cards - count];
+				}
+			}
+		}
+	}
+	
+	template <typename CallbackTp>
+	static void ForEachRankMultiset(uint32_t numCards, CallbackTp callback)
+	{
+		uint8_t counts[NUM_RANKS] = { };
+		ForEachRankMultiset(counts, 0, numCards, callback);
+	}
+	
+	template <typename CallbackTp>
+	static void ForEachRankMultiset(uint8_t* counts, uint32_t rank, uint32_t remaining, CallbackTp& callback)
+	{
+		if (rank == NUM_RANKS)
+		{
+			if (remaining == 0)
+				callback(counts);
+			return;
+		}
+		
+		for (uint32_t count = 0; count <= std::min(remaining, 4u); count++)
+		{
+			counts[rank] = static_cast<uint8_t>(count);
+			ForEachRankMultiset(counts, rank + 1, remaining - count, callback);
+		}
+		counts[rank] = 0;
+	}
+	
+	static uint32_t PopCount(uint32_t mask)
+	{
+		uint32_t count = 0;
+		for (; mask != 0; mask &= mask - 1)
+			count++;
+		return count;
+	}
+};
+
+static const EvaluatorTables tables;
+
+static inline uint32_t CountTrailingZeros(uint32_t value)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return index;
+#else
+	return __builtin_ctz(value);
+#endif
+}
+
+uint16_t EvaluateHand(const uint8_t* cards, uint32_t numCards)
+{
+	//Rank counts and suit counts are kept in four bit fields, so that each card is a single add.
+	uint64_t rankCounts = 0;
+	uint32_t suitCounts = 0;
+	uint32_t suitMasks[4] = { };
+	
+	for (uint32_t i = 0; i < numCards; i++)
+	{
+		const uint32_t rank = cards[i] >> 2;
+		const uint32_t suit = cards[i] & 3;
+		rankCounts += 1ull << (rank * 4);
+		suitCounts += 1u << (suit * 4);
+		suitMasks[suit] |= 1u << rank;
+	}
+	
+	//Adding three sets the top bit of every suit count of five or more. With at most seven cards only one suit can
+	// make a flush, and a flush beats anything the other cards make.
+	const uint32_t flushBits = (suitCounts + 0x3333) & 0x8888;
+	if (flushBits != 0)
+		return tables.flushStrengths[suitMasks[CountTrailingZeros(flushBits) / 4]];
+	
+	return tables.rankStrengths[tables.rankStrengthsOffset[numCards] + tables.Hash(rankCounts, numCards)];
+}
+
+void EvaluateRivers(const uint8_t* cards, uint16_t* strengths)
+{
+	uint32_t rankCounts[NUM_RANKS] = { };
+	uint32_t suitCounts[4] = { };
+	uint32_t suitMasks[4] = { };
+	for (uint32_t i = 0; i < 6; i++)
+	{
+		rankCounts[cards[i] >> 2]++;
+		suitCounts[cards[i] & 3]++;
+		suitMasks[cards[i] & 3] |= 1u << (cards[i] >> 2);
+	}
+	
+	//The hash of seven cards walks the ranks upwards, with the number of cards left decreasing. The river card
+	// adds one card left for all ranks up to its own, so the hash splits into a sum over the ranks below the river,
+	// the river's rank and the ranks above it, which are all precomputed here.
+	uint32_t below[NUM_RANKS + 1];
+	uint32_t above[NUM_RANKS + 1];
+	uint32_t cardsBelow[NUM_RANKS];
+	below[0] = 0;
+	for (uint32_t rank = 0, seen = 0; rank < NUM_RANKS; rank++)
+	{
+		cardsBelow[rank] = seen;
+		below[rank + 1] = below[rank] + tables.rankHash[rank][MAX_CARDS - seen][rankCounts[rank]];
+		seen += rankCounts[rank];
+	}
+	above[NUM_RANKS] = 0;
+	for (int rank = NUM_RANKS - 1; rank >= 0; rank--)
+		above[rank] = above[rank + 1] + tables.rankHash[rank][MAX_CARDS - 1 - cardsBelow[rank]][rankCounts[rank]];
+	
+	uint16_t rankStrengths[NUM_RANKS];
+	for (uint32_t rank = 0; rank < NUM_RANKS; rank++)
+	{
+		if (rankCounts[rank] == 4)
+			continue;
+		const uint32_t hash = below[rank] + tables.rankHash[rank][MAX_CARDS - cardsBelow[rank]][rankCounts[rank] + 1] +
+			above[rank + 1];
+		rankStrengths[rank] = tables.rankStrengths[tables.rankStrengthsOffset[MAX_CARDS] + hash];
+	}
+	
+	//At most one suit can have four or more of six cards.
+	int flushSuit = -1;
+	for (uint32_t suit = 0; suit < 4; suit++)
+	{
+		if (suitCounts[suit] >= 4)
+			flushSuit = suit;
+	}
+	
+	for (uint32_t card = 0; card < 52; card++)
+	{
+		const uint32_t rank = card >> 2;
+		const uint32_t suit = card & 3;
+		if (rankCounts[rank] == 4)
+		{
+			strengths[card] = 0;
+		}
+		else if (flushSuit != -1 && (suitCounts[flushSuit] >= 5 || static_cast<int>(suit) == flushSuit))
+		{
+			const uint32_t addedRank = static_cast<int>(suit) == flushSuit ? 1u << rank : 0;
+			strengths[card] = tables.flushStrengths[suitMasks[flushSuit] | addedRank];
+		}
+		else
+		{
+			strengths[card] = rankStrengths[rank];
+		}
+	}
+}
+
+//Matches Protocol.MAX_CLIENTS in managed code.
+static const uint32_t MAX_SHOWDOWN_PLAYERS = 8;
+
+void EvaluateShowdown(const uint8_t* board, const uint8_t* holeCards, uint32_t numPlayers, const int32_t* contributions,
+                      uint32_t numPots, uint16_t* strengths, int32_t* potAwards)
+{
+	if (numPlayers > MAX_SHOWDOWN_PLAYERS)
+		Panic("Too many players for showdown evaluation.");
+	
+	bool inShowdown[MAX_SHOWDOWN_PLAYERS];
+	uint8_t cards[MAX_CARDS];
+	std::copy(board, board + 5, cards);
+	
+	for (uint32_t p = 0; p < numPlayers; p++)
+	{
+		inShowdown[p] = holeCards[p * 2] != NO_CARD;
+		potAwards[p] = 0;
+		
+		if (inShowdown[p])
+		{
+			cards[5] = holeCards[p * 2];
+			cards[6] = holeCards[p * 2 + 1];
+			strengths[p] = EvaluateHand(cards, MAX_CARDS);
+		}
+		else
+		{
+			strengths[p] = 0;
+		}
+	}
+	
+	for (uint32_t pot = 0; pot < numPots; pot++)
+	{
+		const int32_t* potContributions = contributions + static_cast<size_t>(pot) * numPlayers;
+		
+		int32_t size = 0;
+		int bestStrength = -1;
+		uint32_t numWinners = 0;
+		for (uint32_t p = 0; p < numPlayers; p++)
+		{
+			size += potContributions[p];
+			if (potContributions[p] <= 0 || !inShowdown[p])
+				continue;
+			
+			if (strengths[p] > bestStrength)
+			{
+				bestStrength = strengths[p];
+				numWinners = 1;
+			}
+			else if (strengths[p] == bestStrength)
+			{
+				numWinners++;
+			}
+		}
+		
+		if (size == 0)
+			continue;
+		
+		//Nobody who paid into this pot is left in the hand, so the chips go back to whoever paid them.
+		if (numWinners == 0)
+		{
+			for (uint32_t p = 0; p < numPlayers; p++)
+				potAwards[p] += potContributions[p];
+			continue;
+		}
+		
+		//Odd chips go one each to the first winners by seat.
+		const int32_t share = size / static_cast<int32_t>(numWinners);
+		int32_t remainder = size % static_cast<int32_t>(numWinners);
+		for (uint32_t p = 0; p < numPlayers; p++)
+		{
+			if (potContributions[p] <= 0 || !inShowdown[p] || strengths[p] != bestStrength)
+				continue;
+			
+			potAwards[p] += share;
+			if (remainder > 0)
+			{
+				potAwards[p]++;
+				remainder--;
+			}
+		}
+	}
+}
+
+// C# Bindings
+CS_VISIBLE uint16_t HE_Evaluate(const uint8_t* cards, uint32_t numCards)
+{
+	return EvaluateHand(cards, numCards);
+}
+
+//Evaluates numHands hands of cardsPerHand cards each, stored one after another.
+CS_VISIBLE void HE_EvaluateBatch(const uint8_t* cards, uint32_t cardsPerHand, uint32_t numHands, uint16_t* strengths)
+{
+	for (uint32_t i = 0; i < numHands; i++)
+		strengths[i] = EvaluateHand(cards + static_cast<size_t>(i) * cardsPerHand, cardsPerHand);
+}
+
+CS_VISIBLE void HE_EvaluateShowdown(const uint8_t* board, const uint8_t* holeCards, uint32_t numPlayers,
+                                    const int32_t* contributions, uint32_t numPots, uint16_t* strengths,
+                                    int32_t* potAwards)
+{
+	EvaluateShowdown(board, holeCards, numPlayers, contributions, numPots, strengths, potAwards);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+//Cards are packed as in managed code, suit + rank * 4, with ranks from 0 (two) to 12 (ace).
+
+//Stands in for the hole cards of players who did not reach the showdown.
+static const uint8_t NO_CARD = 0xFF;
+
+//Returns the strength of the best five card hand among 5 to 7 cards. Stronger hands have higher values, equal
+// values tie. The hand category (0 for high card up to 8 for straight flush) is stored in the top four bits.
+uint16_t EvaluateHand(const uint8_t* cards, uint32_t numCards);
+
+//Evaluates the seven card hands made by adding each card to six known cards, much faster than evaluating them one
+// by one. strengths has an entry for every card, those of cards that can not be added are undefined.
+void EvaluateRivers(const uint8_t* cards, uint16_t* strengths);
+
+inline uint32_t GetHandCategory(uint16_t strength)
+{
+	return strength >> 12;
+}
+
+//Scores every player's best hand with the five board cards and splits each pot among the strongest hands of the
+// players who contributed to it. holeCards holds two cards per player, NO_CARD for players who folded.
+// contributions holds numPlayers chip amounts per pot, pot after pot, as in Player.ContributionAmounts.
+// Strengths of players without cards are zero. potAwards receives each player's total winnings.
+void EvaluateShowdown(const uint8_t* board, const uint8_t* holeCards, uint32_t numPlayers, const int32_t* contributions,
+                      uint32_t numPots, uint16_t* strengths, int32_t* potAwards);
@@ -1,6 +1,11 @@
 #include "API.h"
+#include "Latency.h"
+#include "InputLog.h"
 
 #include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
 #include <SDL2/SDL.h>
 
 int32_t MouseWheelX = 0;
@@ -20,7 +25,11 @@ CS_VISIBLE MouseState GetMouseState()
 {
 	MouseState mouseState;
 	
-	uint32_t buttonState = SDL_GetMouseState(&mouseState.CursorX, &mouseState.CursorY);
+	uint32_t buttonState;
+	if (IsReplayingInput())
+		buttonState = GetReplayMouseState(&mouseState.CursorX, &mouseState.CursorY);
+	else
+		buttonState = SDL_GetMouseState(&mouseState.CursorX, &mouseState.CursorY);
 	mouseState.LeftButtonPressed = (buttonState & SDL_BUTTON_LMASK) ? 1 : 0;
 	mouseState.RightButtonPressed = (buttonState & SDL_BUTTON_RMASK) ? 1 : 0;
 	mouseState.ScrollX = MouseWheelX;
@@ -40,6 +49,124 @@ struct KeyboardState
 CS_VISIBLE void GetKeyboardState(KeyboardState* keyboardState)
 {
 	int numKeys;
-	keyboardState->KeyStates = SDL_GetKeyboardState(&numKeys);
+	if (IsReplayingInput())
+		keyboardState->KeyStates = GetReplayKeyboardState(&numKeys);
+	else
+		keyboardState->KeyStates = SDL_GetKeyboardState(&numKeys);
 	keyboardState->NumKeys = numKeys;
 }
+
+enum class InputEventType : uint32_t
+{
+	TextInput = 0,
+	KeyDown = 1,
+	KeyUp = 2,
+	MouseButtonDown = 3,
+	MouseButtonUp = 4,
+	MouseWheel = 5
+};
+
+#pragma pack(push, 1)
+//x and y hold the scancode for key events, the button and cursor position for mouse buttons and the scroll
+// amount for wheel events. arrivalTime is GetInputClock's value when the main loop received the event.
+struct InputEvent
+{
+	InputEventType type;
+	uint32_t sdlTimestamp;
+	uint64_t arrivalTime;
+	int32_t x;
+	int32_t y;
+	int32_t button;
+	uint32_t textLength;
+	char text[32];
+};
+#pragma pack(pop)
+
+static const uint32_t INPUT_RING_CAPACITY = 1024;
+
+static InputEvent inputRing[INPUT_RING_CAPACITY];
+static uint32_t inputRingBegin = 0;
+static uint32_t inputRingCount = 0;
+static uint64_t inputEventsDropped = 0;
+
+CS_VISIBLE uint64_t GetInputClock()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void PushInputEvent(const InputEvent& inputEvent)
+{
+	//When managed code falls behind, the oldest events are dropped.
+	if (inputRingCount == INPUT_RING_CAPACITY)
+	{
+		inputRingBegin = (inputRingBegin + 1) % INPUT_RING_CAPACITY;
+		inputRingCount--;
+		inputEventsDropped++;
+	}
+	
+	inputRing[(inputRingBegin + inputRingCount) % INPUT_RING_CAPACITY] = inputEvent;
+	inputRingCount++;
+}
+
+//Called by the main loop for every SDL event. Events which are not input are ignored.
+void RecordInputEvent(const SDL_Event& event)
+{
+	InputEvent inputEvent = { };
+	inputEvent.sdlTimestamp = event.common.timestamp;
+	inputEvent.arrivalTime = GetInputClock();
+	
+	switch (event.type)
+	{
+	case SDL_TEXTINPUT:
+		inputEvent.type = InputEventType::TextInput;
+		inputEvent.textLength = std::strlen(event.text.text);
+		std::memcpy(inputEvent.text, event.text.text, inputEvent.textLength);
+		break;
+	case SDL_KEYDOWN:
+	case SDL_KEYUP:
+		inputEvent.type = event.type == SDL_KEYDOWN ? InputEventType::KeyDown : InputEventType::KeyUp;
+		inputEvent.x = event.key.keysym.scancode;
+		inputEvent.y = event.key.repeat;
+		break;
+	case SDL_MOUSEBUTTONDOWN:
+	case SDL_MOUSEBUTTONUP:
+		inputEvent.type = event.type == SDL_MOUSEBUTTONDOWN ? InputEventType::MouseButtonDown
+		                                                    : InputEventType::MouseButtonUp;
+		inputEvent.x = event.button.x;
+		inputEvent.y = event.button.y;
+		inputEvent.button = event.button.button;
+		break;
+	case SDL_MOUSEWHEEL:
+		inputEvent.type = InputEventType::MouseWheel;
+		inputEvent.x = event.wheel.x;
+		inputEvent.y = event.wheel.y;
+		break;
+	default:
+		return;
+	}
+	
+	PushInputEvent(inputEvent);
+}
+
+//Copies up to maxEvents of the oldest queued events to events and removes them from the queue.
+CS_VISIBLE uint32_t DrainInputEvents(InputEvent* events, uint32_t maxEvents)
+{
+	const uint32_t count = std::min(maxEvents, inputRingCount);
+	for (uint32_t i = 0; i < count; i++)
+		events[i] = inputRing[(inputRingBegin + i) % INPUT_RING_CAPACITY];
+	
+	inputRingBegin = (inputRingBegin + count) % INPUT_RING_CAPACITY;
+	inputRingCount -= count;
+	
+	//Events are drained in arrival order, so the first one is the oldest the frame reacts to.
+	if (count != 0)
+		LatencyInputReceived(events[0].arrivalTime);
+	
+	return count;
+}
+
+CS_VISIBLE uint64_t GetDroppedInputEvents()
+{
+	return inputEventsDropped;
+}
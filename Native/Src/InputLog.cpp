@@ -0,0 +1,267 @@
+#include "InputLog.h"
+#include "API.h"
+#include "Utils.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <iterator>
+
+//Log layout: a LogHeader, then for every frame a FrameHeader followed by numEvents raw SDL_Events.
+static const uint32_t LOG_MAGIC = 0x504B524C;
+static const uint32_t LOG_VERSION = 1;
+
+#pragma pack(push, 1)
+struct LogHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t eventSize;
+	int32_t windowWidth;
+	int32_t windowHeight;
+	int32_t mouseX;
+	int32_t mouseY;
+};
+
+struct FrameHeader
+{
+	float dt;
+	uint32_t numEvents;
+};
+#pragma pack(pop)
+
+enum class InputLogMode
+{
+	None,
+	Record,
+	Replay
+};
+
+static InputLogMode logMode = InputLogMode::None;
+static std::string logPath;
+static float replayFixedDT = 0;
+
+static std::ofstream recordStream;
+static std::ifstream replayStream;
+
+//Events of the current frame which are written to the log, copied so that the frame's own events keep their order.
+static std::vector<SDL_Event> recordedEvents;
+
+//Replayed resizes are applied to this window, since the game reacts to them as if the user had resized it.
+static SDL_Window* replayWindow = nullptr;
+
+static uint64_t loggedFrames = 0;
+static uint64_t presentedFrames = 0;
+static std::chrono::steady_clock::time_point replayStartTime;
+
+static int32_t replayMouseX = 0;
+static int32_t replayMouseY = 0;
+static uint32_t replayMouseButtons = 0;
+static uint8_t replayKeyStates[SDL_NUM_SCANCODES] = { };
+
+CS_VISIBLE void StartInputRecording(const char* path)
+{
+	logMode = InputLogMode::Record;
+	logPath = path;
+}
+
+//If fixedDT is greater than zero it is used for every frame instead of the recorded frame times.
+CS_VISIBLE void StartInputReplay(const char* path, float fixedDT)
+{
+	logMode = InputLogMode::Replay;
+	logPath = path;
+	replayFixedDT = fixedDT;
+}
+
+bool IsReplayingInput()
+{
+	return logMode == InputLogMode::Replay;
+}
+
+//Only input and resizes are logged. Focus and visibility changes depend on the machine, and would throttle replays.
+static bool ShouldLogEvent(const SDL_Event& event)
+{
+	switch (event.type)
+	{
+	case SDL_KEYDOWN:
+	case SDL_KEYUP:
+	case SDL_TEXTINPUT:
+	case SDL_MOUSEMOTION:
+	case SDL_MOUSEBUTTONDOWN:
+	case SDL_MOUSEBUTTONUP:
+	case SDL_MOUSEWHEEL:
+		return true;
+	case SDL_WINDOWEVENT:
+		return event.window.event == SDL_WINDOWEVENT_RESIZED;
+	default:
+		return false;
+	}
+}
+
+void BeginInputLog(SDL_Window* window)
+{
+	if (logMode == InputLogMode::Record)
+	{
+		recordStream.open(logPath, std::ios::binary);
+		if (!recordStream)
+			Panic("Could not open the input recording for writing.");
+		
+		LogHeader header;
+		header.magic = LOG_MAGIC;
+		header.version = LOG_VERSION;
+		header.eventSize = sizeof(SDL_Event);
+		SDL_GetWindowSize(window, &header.windowWidth, &header.windowHeight);
+		SDL_GetMouseState(&header.mouseX, &header.mouseY);
+		recordStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+	else if (logMode == InputLogMode::Replay)
+	{
+		replayStream.open(logPath, std::ios::binary);
+		if (!replayStream)
+			Panic("Could not open the input recording for reading.");
+		
+		LogHeader header;
+		replayStream.read(reinterpret_cast<char*>(&header), sizeof(header));
+		if (!replayStream || header.magic != LOG_MAGIC || header.version != LOG_VERSION ||
+		    header.eventSize != sizeof(SDL_Event))
+		{
+			Panic("Invalid or incompatible input recording.");
+		}
+		
+		//The window is resized to the recorded size, the resize event reaches the game through the first frame.
+		SDL_SetWindowSize(window, header.windowWidth, header.windowHeight);
+		replayWindow = window;
+		replayMouseX = header.mouseX;
+		replayMouseY = header.mouseY;
+		
+		replayStartTime = std::chrono::steady_clock::now();
+	}
+	
+	loggedFrames = 0;
+	presentedFrames = 0;
+}
+
+void EndInputLog()
+{
+	if (logMode == InputLogMode::Record)
+	{
+		recordStream.close();
+		std::cout << "Recorded " << loggedFrames << " frames to " << logPath << std::endl;
+	}
+	else if (logMode == InputLogMode::Replay)
+	{
+		replayStream.close();
+		replayWindow = nullptr;
+		
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - replayStartTime).count();
+		std::cout << "Replayed " << loggedFrames << " frames in " << seconds << " s, "
+		          << (loggedFrames == 0 ? 0.0 : seconds * 1000.0 / loggedFrames) << " ms per frame" << std::endl;
+		
+		//Frames which skipped drawing would make the replay look faster than the recording was.
+		if (presentedFrames != loggedFrames)
+		{
+			std::cerr << "Replay drew " << presentedFrames << " of " << loggedFrames << " replayed frames, "
+			          << "timings are not comparable" << std::endl;
+		}
+	}
+	
+	logMode = InputLogMode::None;
+}
+
+static void UpdateReplayInputState(const SDL_Event& event)
+{
+	switch (event.type)
+	{
+	case SDL_KEYDOWN:
+	case SDL_KEYUP:
+		if (event.key.keysym.scancode < SDL_NUM_SCANCODES)
+			replayKeyStates[event.key.keysym.scancode] = event.type == SDL_KEYDOWN ? 1 : 0;
+		break;
+	case SDL_MOUSEMOTION:
+		replayMouseX = event.motion.x;
+		replayMouseY = event.motion.y;
+		break;
+	case SDL_MOUSEBUTTONDOWN:
+		replayMouseButtons |= SDL_BUTTON(event.button.button);
+		replayMouseX = event.button.x;
+		replayMouseY = event.button.y;
+		break;
+	case SDL_MOUSEBUTTONUP:
+		replayMouseButtons &= ~SDL_BUTTON(event.button.button);
+		replayMouseX = event.button.x;
+		replayMouseY = event.button.y;
+		break;
+	}
+}
+
+void InputFramePresented()
+{
+	presentedFrames++;
+}
+
+bool ProcessFrameInput(float& dt, std::vector<SDL_Event>& events)
+{
+	if (logMode == InputLogMode::Record)
+	{
+		recordedEvents.clear();
+		std::copy_if(events.begin(), events.end(), std::back_inserter(recordedEvents), ShouldLogEvent);
+		
+		FrameHeader frameHeader;
+		frameHeader.dt = dt;
+		frameHeader.numEvents = static_cast<uint32_t>(recordedEvents.size());
+		recordStream.write(reinterpret_cast<const char*>(&frameHeader), sizeof(frameHeader));
+		recordStream.write(reinterpret_cast<const char*>(recordedEvents.data()), sizeof(SDL_Event) * frameHeader.numEvents);
+		
+		loggedFrames++;
+		return true;
+	}
+	
+	if (logMode != InputLogMode::Replay)
+		return true;
+	
+	FrameHeader frameHeader;
+	replayStream.read(reinterpret_cast<char*>(&frameHeader), sizeof(frameHeader));
+	if (!replayStream)
+		return false;
+	
+	//Live input is ignored during replays, only requests to quit are kept.
+	events.erase(std::remove_if(events.begin(), events.end(), [] (const SDL_Event& event)
+	{
+		return event.type != SDL_QUIT;
+	}), events.end());
+	
+	const size_t firstReplayed = events.size();
+	events.resize(firstReplayed + frameHeader.numEvents);
+	replayStream.read(reinterpret_cast<char*>(events.data() + firstReplayed), sizeof(SDL_Event) * frameHeader.numEvents);
+	if (!replayStream)
+		return false;
+	
+	for (size_t i = firstReplayed; i < events.size(); i++)
+	{
+		UpdateReplayInputState(events[i]);
+		
+		//The window follows the recorded size, so that the viewport matches what the game was told. The live resize
+		// event which this causes is dropped with the rest of the live input.
+		if (events[i].type == SDL_WINDOWEVENT && events[i].window.event == SDL_WINDOWEVENT_RESIZED)
+			SDL_SetWindowSize(replayWindow, events[i].window.data1, events[i].window.data2);
+	}
+	
+	dt = replayFixedDT > 0 ? replayFixedDT : frameHeader.dt;
+	loggedFrames++;
+	return true;
+}
+
+uint32_t GetReplayMouseState(int32_t* x, int32_t* y)
+{
+	*x = replayMouseX;
+	*y = replayMouseY;
+	return replayMouseButtons;
+}
+
+const uint8_t* GetReplayKeyboardState(int* numKeys)
+{
+	*numKeys = SDL_NUM_SCANCODES;
+	return replayKeyStates;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include <cstdint>
+
+//Recording and replay of the event stream and frame times, for repeatable whole game benchmarks.
+// Started through StartInputRecording or StartInputReplay before RunGame.
+
+bool IsReplayingInput();
+
+//Called once per frame with the events polled from SDL. While recording, the frame's dt and input events are
+// appended to the log. While replaying, input events are replaced by the recorded ones and dt by the recorded
+// or fixed frame time. Returns false once the replay has run out of frames.
+bool ProcessFrameInput(float& dt, std::vector<SDL_Event>& events);
+
+//Called once per presented frame. A replay which presents fewer frames than it replayed is reported when it ends.
+void InputFramePresented();
+
+void BeginInputLog(SDL_Window* window);
+void EndInputLog();
+
+//Input state reconstructed from replayed events, used instead of SDL's state while replaying.
+uint32_t GetReplayMouseState(int32_t* x, int32_t* y);
+const uint8_t* GetReplayKeyboardState(int* numKeys);
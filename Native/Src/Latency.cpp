@@ -0,0 +1,153 @@
+#include "Latency.h"
+
+#include <GL/glew.h>
+#include <vector>
+#include <algorithm>
+
+static bool latencyTrackingEnabled = false;
+
+//Arrival time of the oldest input the current frame reacts to, zero if the frame received no input.
+static uint64_t frameInputArrival = 0;
+
+//Frames which received input and are still in flight on the GPU.
+struct PendingFrame
+{
+	GLuint query;
+	uint64_t inputArrival;
+};
+
+static const uint32_t MAX_PENDING_FRAMES = 8;
+static PendingFrame pendingFrames[MAX_PENDING_FRAMES];
+static uint32_t numPendingFrames = 0;
+static GLuint queryPool[MAX_PENDING_FRAMES];
+static uint32_t numPooledQueries = 0;
+
+//The most recent latency samples in milliseconds, overwritten in a ring.
+static const uint32_t MAX_SAMPLES = 1024;
+static float samples[MAX_SAMPLES];
+static uint32_t numSamples = 0;
+static uint32_t nextSample = 0;
+
+#pragma pack(push, 1)
+struct LatencyStats
+{
+	uint32_t samples;
+	float p50;
+	float p95;
+	float p99;
+	float max;
+};
+#pragma pack(pop)
+
+//When enabled, every frame which reacts to input records the time from the input's arrival until the GPU
+// has finished the frame.
+CS_VISIBLE void SetLatencyTracking(bool enabled)
+{
+	latencyTrackingEnabled = enabled;
+}
+
+CS_VISIBLE void ResetLatencyStats()
+{
+	numSamples = 0;
+	nextSample = 0;
+}
+
+CS_VISIBLE LatencyStats GetLatencyStats()
+{
+	LatencyStats stats = { };
+	stats.samples = numSamples;
+	if (numSamples == 0)
+		return stats;
+	
+	std::vector<float> sorted(samples, samples + numSamples);
+	std::sort(sorted.begin(), sorted.end());
+	
+	auto percentile = [&] (float p)
+	{
+		return sorted[std::min(static_cast<uint32_t>(p * numSamples), numSamples - 1)];
+	};
+	
+	stats.p50 = percentile(0.50f);
+	stats.p95 = percentile(0.95f);
+	stats.p99 = percentile(0.99f);
+	stats.max = sorted.back();
+	return stats;
+}
+
+void LatencyInputReceived(uint64_t arrivalTime)
+{
+	if (frameInputArrival == 0 || arrivalTime < frameInputArrival)
+		frameInputArrival = arrivalTime;
+}
+
+void LatencyFrameSkipped()
+{
+	frameInputArrival = 0;
+}
+
+static void AddSample(float latencyMS)
+{
+	samples[nextSample] = latencyMS;
+	nextSample = (nextSample + 1) % MAX_SAMPLES;
+	numSamples = std::min(numSamples + 1, MAX_SAMPLES);
+}
+
+void LatencyFrameSubmitted()
+{
+	const uint64_t inputArrival = frameInputArrival;
+	frameInputArrival = 0;
+	
+	if (!latencyTrackingEnabled && numPendingFrames == 0)
+		return;
+	
+	//GPU timestamps are mapped to the input clock through an offset which is measured every frame.
+	GLint64 gpuNow;
+	glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+	const int64_t gpuToInputClock = static_cast<int64_t>(GetInputClock()) - gpuNow;
+	
+	//Collects the frames which the GPU has finished, without waiting for any.
+	uint32_t numStillPending = 0;
+	for (uint32_t i = 0; i < numPendingFrames; i++)
+	{
+		PendingFrame& frame = pendingFrames[i];
+		
+		GLint available;
+		glGetQueryObjectiv(frame.query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+		{
+			pendingFrames[numStillPending++] = frame;
+			continue;
+		}
+		
+		GLuint64 gpuTime;
+		glGetQueryObjectui64v(frame.query, GL_QUERY_RESULT, &gpuTime);
+		const int64_t finishTime = static_cast<int64_t>(gpuTime) + gpuToInputClock;
+		AddSample((finishTime - static_cast<int64_t>(frame.inputArrival)) * 1E-6f);
+		
+		queryPool[numPooledQueries++] = frame.query;
+	}
+	numPendingFrames = numStillPending;
+	
+	if (!latencyTrackingEnabled || inputArrival == 0 || numPendingFrames == MAX_PENDING_FRAMES)
+		return;
+	
+	//The timestamp is written when the GPU reaches this point, which is where the frame's fence is inserted.
+	GLuint query;
+	if (numPooledQueries != 0)
+		query = queryPool[--numPooledQueries];
+	else
+		glGenQueries(1, &query);
+	glQueryCounter(query, GL_TIMESTAMP);
+	
+	pendingFrames[numPendingFrames++] = { query, inputArrival };
+}
+
+void ShutdownLatencyTracking()
+{
+	for (uint32_t i = 0; i < numPendingFrames; i++)
+		glDeleteQueries(1, &pendingFrames[i].query);
+	glDeleteQueries(numPooledQueries, queryPool);
+	
+	numPendingFrames = 0;
+	numPooledQueries = 0;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "API.h"
+
+#include <cstdint>
+
+//Nanoseconds on a monotonic clock, shared by all input and latency timestamps.
+CS_VISIBLE uint64_t GetInputClock();
+
+//Input to photon latency tracking. Enabled through SetLatencyTracking.
+
+//Called when a frame receives input events, with the arrival time of the oldest one.
+void LatencyInputReceived(uint64_t arrivalTime);
+
+//Called right after the frame is submitted for presentation.
+void LatencyFrameSubmitted();
+
+//Called instead of LatencyFrameSubmitted when a frame is not presented. Its input did not change the screen, so it is
+// not attributed to a later frame.
+void LatencyFrameSkipped();
+
+//Deletes the timestamp queries. Called while the GL context is still current.
+void ShutdownLatencyTracking();
@@ -1,14 +1,140 @@
 #include "Mesh.h"
+#include "MeshOptimizer.h"
 #include "API.h"
+#include "Utils.h"
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+#pragma pack(push, 1)
+struct PackedVertex
+{
+	int16_t position[4];
+	int16_t normal[2];
+	int16_t tangent[2];
+	uint16_t texCoord[2];
+};
+#pragma pack(pop)
 
 const uint32_t VERTEX_SIZES[] =
 {
-	/* Standard */ sizeof(float) * (3 + 3 + 3 + 2),
-	/* Card     */ sizeof(float) * 2,
-	/* Text     */ sizeof(float) * (3 + 2) + sizeof(uint32_t),
+	/* Standard       */ sizeof(float) * (3 + 3 + 3 + 2),
+	/* Card           */ sizeof(float) * 2,
+	/* Text           */ sizeof(float) * (3 + 2) + sizeof(uint32_t),
+	/* StandardPacked */ sizeof(PackedVertex),
 };
 
-Mesh::Mesh(VertexType vertexType, uint32_t numVertices, void* vertices, uint32_t numIndices, uint32_t* indices)
+//Constant attributes which receive the position dequantization parameters of packed meshes.
+const GLuint POSITION_SCALE_ATTRIB = 4;
+const GLuint POSITION_BIAS_ATTRIB = 5;
+
+inline int16_t PackSNorm16(float value)
+{
+	return static_cast<int16_t>(std::round(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f));
+}
+
+//Octahedral encoding of a unit vector into two signed normalized components.
+inline void PackOctahedral(const float* v, int16_t* out)
+{
+	const float l1Norm = std::abs(v[0]) + std::abs(v[1]) + std::abs(v[2]);
+	if (l1Norm == 0)
+	{
+		out[0] = out[1] = 0;
+		return;
+	}
+	
+	float x = v[0] / l1Norm;
+	float y = v[1] / l1Norm;
+	if (v[2] < 0)
+	{
+		const float oldX = x;
+		x = (1.0f - std::abs(y)) * (oldX >= 0 ? 1.0f : -1.0f);
+		y = (1.0f - std::abs(oldX)) * (y >= 0 ? 1.0f : -1.0f);
+	}
+	
+	out[0] = PackSNorm16(x);
+	out[1] = PackSNorm16(y);
+}
+
+inline uint16_t PackHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	
+	const uint32_t sign = (bits >> 16) & 0x8000;
+	const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+	uint32_t mantissa = bits & 0x7FFFFF;
+	
+	if (((bits >> 23) & 0xFF) == 0xFF)
+		return static_cast<uint16_t>(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+	if (exponent >= 31)
+		return static_cast<uint16_t>(sign | 0x7C00);
+	
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+			return static_cast<uint16_t>(sign);
+		
+		mantissa |= 0x800000;
+		const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+		uint32_t half = mantissa >> shift;
+		if ((mantissa >> (shift - 1)) & 1)
+			half++;
+		return static_cast<uint16_t>(sign | half);
+	}
+	
+	//Rounding may carry into the exponent, which still produces the correctly rounded value.
+	uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+	if (mantissa & 0x1000)
+		half++;
+	return static_cast<uint16_t>(half);
+}
+
+static std::vector<PackedVertex> PackVertices(const StandardVertex* vertices, uint32_t numVertices,
+                                              float* positionScale, float* positionBias)
+{
+	float minPos[3] = { INFINITY, INFINITY, INFINITY };
+	float maxPos[3] = { -INFINITY, -INFINITY, -INFINITY };
+	for (uint32_t v = 0; v < numVertices; v++)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			minPos[i] = std::min(minPos[i], vertices[v].position[i]);
+			maxPos[i] = std::max(maxPos[i], vertices[v].position[i]);
+		}
+	}
+	
+	for (int i = 0; i < 3; i++)
+	{
+		positionBias[i] = numVertices == 0 ? 0.0f : (minPos[i] + maxPos[i]) * 0.5f;
+		positionScale[i] = numVertices == 0 ? 1.0f : (maxPos[i] - minPos[i]) * 0.5f;
+		if (positionScale[i] <= 0)
+			positionScale[i] = 1.0f;
+	}
+	
+	std::vector<PackedVertex> packedVertices(numVertices);
+	for (uint32_t v = 0; v < numVertices; v++)
+	{
+		PackedVertex& packed = packedVertices[v];
+		for (int i = 0; i < 3; i++)
+			packed.position[i] = PackSNorm16((vertices[v].position[i] - positionBias[i]) / positionScale[i]);
+		packed.position[3] = 0;
+		
+		PackOctahedral(vertices[v].normal, packed.normal);
+		PackOctahedral(vertices[v].tangent, packed.tangent);
+		
+		packed.texCoord[0] = PackHalf(vertices[v].texCoord[0]);
+		packed.texCoord[1] = PackHalf(vertices[v].texCoord[1]);
+	}
+	
+	return packedVertices;
+}
+
+Mesh::Mesh(VertexType vertexType, uint32_t numVertices, void* vertices, uint32_t numIndices, uint32_t* indices,
+           bool optimize, MeshOptimizeStats* optimizeStats, uint32_t numParts, const uint32_t* partNumIndices)
 	: m_numIndices(numIndices)
 {
 	glGenBuffers(2, m_buffers);
@@ -18,11 +144,74 @@ Mesh::Mesh(VertexType vertexType, uint32_t numVertices, void* vertices, uint32_t
 	
 	const uint32_t vertexSize = VERTEX_SIZES[static_cast<int>(vertexType)];
 	
+	//Optimization works on copies, since the input arrays belong to the caller.
+	std::vector<char> optimizedVertices;
+	std::vector<uint32_t> optimizedIndices;
+	std::vector<uint16_t> narrowIndices;
+	if (optimize)
+	{
+		const uint32_t inputVertexSize = vertexType == VertexType::StandardPacked ? sizeof(StandardVertex) : vertexSize;
+		
+		optimizedVertices.assign(static_cast<char*>(vertices),
+		                         static_cast<char*>(vertices) + static_cast<size_t>(inputVertexSize) * numVertices);
+		optimizedIndices.assign(indices, indices + numIndices);
+		
+		const float acmrBefore = CalculateACMR(indices, numIndices, numVertices);
+		
+		if (numParts == 0)
+		{
+			OptimizeVertexCache(optimizedIndices.data(), numIndices, numVertices);
+		}
+		else
+		{
+			uint32_t firstIndex = 0;
+			for (uint32_t i = 0; i < numParts; i++)
+			{
+				if (firstIndex + partNumIndices[i] > numIndices)
+					Panic("Mesh parts exceed the number of indices.");
+				OptimizeVertexCache(optimizedIndices.data() + firstIndex, partNumIndices[i], numVertices);
+				firstIndex += partNumIndices[i];
+			}
+		}
+		
+		//Fetch optimization only renumbers vertices, so the triangles stay in their parts.
+		OptimizeVertexFetch(optimizedVertices.data(), inputVertexSize, numVertices, optimizedIndices.data(), numIndices);
+		
+		vertices = optimizedVertices.data();
+		indices = optimizedIndices.data();
+		
+		if (numVertices < 65536)
+		{
+			narrowIndices.assign(optimizedIndices.begin(), optimizedIndices.end());
+			m_indexType = GL_UNSIGNED_SHORT;
+		}
+		
+		if (optimizeStats != nullptr)
+		{
+			optimizeStats->acmrBefore = acmrBefore;
+			optimizeStats->acmrAfter = CalculateACMR(indices, numIndices, numVertices);
+			optimizeStats->indexSize = m_indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+		}
+	}
+	
+	//Packed meshes take standard vertices as input and quantize them before upload.
+	std::vector<PackedVertex> packedVertices;
+	if (vertexType == VertexType::StandardPacked)
+	{
+		packedVertices = PackVertices(static_cast<const StandardVertex*>(vertices), numVertices,
+		                              m_positionScale, m_positionBias);
+		vertices = packedVertices.data();
+		m_packed = true;
+	}
+	
 	glBindBuffer(GL_ARRAY_BUFFER, GetVB());
 	glBufferStorage(GL_ARRAY_BUFFER, vertexSize * numVertices, vertices, 0);
 	
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, GetIB());
-	glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * numIndices, indices, 0);
+	if (m_indexType == GL_UNSIGNED_SHORT)
+		glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * numIndices, narrowIndices.data(), 0);
+	else
+		glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * numIndices, indices, 0);
 	
 	switch (vertexType)
 	{
@@ -55,6 +244,22 @@ Mesh::Mesh(VertexType vertexType, uint32_t numVertices, void* vertices, uint32_t
 		glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, vertexSize, reinterpret_cast<void*>(sizeof(float) * 5));
 		break;
 	}
+	case VertexType::StandardPacked:
+	{
+		const uint32_t NUM_ATTRIB_ARRAYS = 4;
+		
+		glBindVertexBuffer(0, GetVB(), 0, vertexSize);
+		for (uint32_t i = 0; i < NUM_ATTRIB_ARRAYS; i++)
+		{
+			glEnableVertexAttribArray(i);
+			glVertexAttribBinding(i, 0);
+		}
+		glVertexAttribFormat(0, 3, GL_SHORT, GL_TRUE, offsetof(PackedVertex, position));
+		glVertexAttribFormat(1, 2, GL_SHORT, GL_TRUE, offsetof(PackedVertex, normal));
+		glVertexAttribFormat(2, 2, GL_SHORT, GL_TRUE, offsetof(PackedVertex, tangent));
+		glVertexAttribFormat(3, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(PackedVertex, texCoord));
+		break;
+	}
 	}
 }
 
@@ -64,16 +269,91 @@ Mesh::~Mesh()
 	glDeleteVertexArrays(1, &m_vao);
 }
 
-void Mesh::Draw()
+void Mesh::Bind() const
 {
 	glBindVertexArray(m_vao);
-	glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, nullptr);
+	
+	//Dequantization parameters are passed as constant attribute values, so shaders need no per mesh uniforms.
+	if (m_packed)
+	{
+		glVertexAttrib3fv(POSITION_SCALE_ATTRIB, m_positionScale);
+		glVertexAttrib3fv(POSITION_BIAS_ATTRIB, m_positionBias);
+	}
+}
+
+void Mesh::Draw()
+{
+	Bind();
+	glDrawElements(GL_TRIANGLES, m_numIndices, m_indexType, nullptr);
+	DrawCallCount++;
 }
 
 void Mesh::DrawInstanced(uint32_t numInstances)
 {
-	glBindVertexArray(m_vao);
-	glDrawElementsInstanced(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, nullptr, numInstances);
+	Bind();
+	glDrawElementsInstanced(GL_TRIANGLES, m_numIndices, m_indexType, nullptr, numInstances);
+	DrawCallCount++;
+}
+
+CS_VISIBLE void Mesh_GenerateTangents(StandardVertex* vertices, uint32_t numVertices, const uint32_t* indices,
+                                      uint32_t numIndices)
+{
+	std::vector<float> tangents1(numVertices * 3, 0.0f);
+	std::vector<float> tangents2(numVertices * 3, 0.0f);
+	for (uint32_t i = 0; i + 2 < numIndices; i += 3)
+	{
+		const StandardVertex& v0 = vertices[indices[i]];
+		const StandardVertex& v1 = vertices[indices[i + 1]];
+		const StandardVertex& v2 = vertices[indices[i + 2]];
+		
+		float dp0[3], dp1[3];
+		for (int c = 0; c < 3; c++)
+		{
+			dp0[c] = v1.position[c] - v0.position[c];
+			dp1[c] = v2.position[c] - v0.position[c];
+		}
+		const float dtc0[] = { v1.texCoord[0] - v0.texCoord[0], v1.texCoord[1] - v0.texCoord[1] };
+		const float dtc1[] = { v2.texCoord[0] - v0.texCoord[0], v2.texCoord[1] - v0.texCoord[1] };
+		
+		const float div = dtc0[0] * dtc1[1] - dtc1[0] * dtc0[1];
+		if (std::abs(div) < 1E-6f)
+			continue;
+		const float r = 1.0f / div;
+		
+		const float d1[] = { (dtc0[1] * dp0[0] - dtc0[1] * dp1[0]) * r, (dtc1[1] * dp0[1] - dtc0[1] * dp1[1]) * r,
+		                     (dtc1[1] * dp0[2] - dtc0[1] * dp1[2]) * r };
+		const float d2[] = { (dtc0[0] * dp1[0] - dtc1[0] * dp0[0]) * r, (dtc0[0] * dp1[1] - dtc1[0] * dp0[1]) * r,
+		                     (dtc0[0] * dp1[2] - dtc1[0] * dp0[2]) * r };
+		
+		for (int j = 0; j < 3; j++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				tangents1[indices[i + j] * 3 + c] += d1[c];
+				tangents2[indices[i + j] * 3 + c] += d2[c];
+			}
+		}
+	}
+	
+	for (uint32_t v = 0; v < numVertices; v++)
+	{
+		const float* t1 = &tangents1[v * 3];
+		const float* t2 = &tangents2[v * 3];
+		if (t1[0] * t1[0] + t1[1] * t1[1] + t1[2] * t1[2] < 1E-6f)
+			continue;
+		
+		const float* n = vertices[v].normal;
+		const float nDotT = n[0] * t1[0] + n[1] * t1[1] + n[2] * t1[2];
+		const float tangent[] = { t1[0] - n[0] * nDotT, t1[1] - n[1] * nDotT, t1[2] - n[2] * nDotT };
+		const float length = std::sqrt(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
+		
+		//The tangent is flipped if it is mirrored relative to the texture's bitangent direction.
+		const float bitangent[] = { n[1] * tangent[2] - n[2] * tangent[1], n[2] * tangent[0] - n[0] * tangent[2],
+		                            n[0] * tangent[1] - n[1] * tangent[0] };
+		const float sign = bitangent[0] * t2[0] + bitangent[1] * t2[1] + bitangent[2] * t2[2] < 0 ? -1.0f : 1.0f;
+		for (int c = 0; c < 3; c++)
+			vertices[v].tangent[c] = sign * tangent[c] / length;
+	}
 }
 
 CS_VISIBLE Mesh* Mesh_Create(VertexType vertexType, uint32_t numVertices, void* vertices, uint32_t numIndices, uint32_t* indices)
@@ -81,6 +361,14 @@ CS_VISIBLE Mesh* Mesh_Create(VertexType vertexType, uint32_t numVertices, void*
 	return new Mesh(vertexType, numVertices, vertices, numIndices, indices);
 }
 
+//numParts may be 0 to optimize all indices as one part.
+CS_VISIBLE Mesh* Mesh_CreateOptimized(VertexType vertexType, uint32_t numVertices, void* vertices, uint32_t numIndices,
+                                      uint32_t* indices, MeshOptimizeStats* stats, uint32_t numParts,
+                                      const uint32_t* partNumIndices)
+{
+	return new Mesh(vertexType, numVertices, vertices, numIndices, indices, true, stats, numParts, partNumIndices);
+}
+
 CS_VISIBLE void Mesh_Destroy(Mesh* mesh) { delete mesh; }
 
 CS_VISIBLE void Mesh_Draw(Mesh* mesh) { mesh->Draw(); }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "API.h"
+
 #include <GL/glew.h>
 #include <cstdint>
 
@@ -7,18 +9,67 @@ enum class VertexType : int32_t
 {
 	Standard = 0,
 	Card = 1,
-	Text = 2
+	Text = 2,
+	StandardPacked = 3
+};
+
+#pragma pack(push, 1)
+struct StandardVertex
+{
+	float position[3];
+	float normal[3];
+	float tangent[3];
+	float texCoord[2];
 };
 
+struct MeshOptimizeStats
+{
+	float acmrBefore;
+	float acmrAfter;
+	uint32_t indexSize;
+};
+
+//Layout of the commands read by glDrawElementsIndirect and glMultiDrawElementsIndirect.
+struct DrawElementsIndirectCommand
+{
+	uint32_t count;
+	uint32_t instanceCount;
+	uint32_t firstIndex;
+	int32_t baseVertex;
+	uint32_t baseInstance;
+};
+#pragma pack(pop)
+
+//Attribute location which receives the index of the draw within a multi draw. Shaders declare
+// "layout(location=7) in uint drawId_in;", which is fed from an identity buffer with a divisor larger than any
+// instance count, so every instance of a draw fetches element baseInstance.
+static const GLuint DRAW_ID_ATTRIB = 7;
+
+//Derives per vertex tangents from the texture coordinates of the triangles using each vertex. Vertices whose
+// triangles have degenerate texture coordinates keep their tangent. Used by GLTFImporter.
+CS_VISIBLE void Mesh_GenerateTangents(StandardVertex* vertices, uint32_t numVertices, const uint32_t* indices,
+                                      uint32_t numIndices);
+
 class Mesh
 {
 public:
-	Mesh(VertexType vertexType, uint32_t numVertices, void* vertices, uint32_t numIndices, uint32_t* indices);
+	//The indices may be split into consecutive parts which are drawn separately. Optimization then keeps the
+	// triangles of each part within its range.
+	Mesh(VertexType vertexType, uint32_t numVertices, void* vertices, uint32_t numIndices, uint32_t* indices,
+	     bool optimize = false, MeshOptimizeStats* optimizeStats = nullptr, uint32_t numParts = 0,
+	     const uint32_t* partNumIndices = nullptr);
 	~Mesh();
 	
 	void Draw();
 	void DrawInstanced(uint32_t numInstances);
 	
+	void Bind() const;
+	
+	inline GLenum GetIndexType() const
+	{ return m_indexType; }
+	inline uint32_t GetNumIndices() const
+	{ return m_numIndices; }
+	
 private:
 	inline GLuint GetVB() const
 	{ return m_buffers[0]; }
@@ -26,6 +77,11 @@ private:
 	{ return m_buffers[1]; }
 	
 	uint32_t m_numIndices;
+	GLenum m_indexType = GL_UNSIGNED_INT;
+	
+	bool m_packed = false;
+	float m_positionScale[3];
+	float m_positionBias[3];
 	
 	GLuint m_buffers[2];
 	GLuint m_vao;
@@ -0,0 +1,197 @@
+#include "MeshOptimizer.h"
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+static const uint32_t INVALID_INDEX = UINT32_MAX;
+
+static const int FORSYTH_CACHE_SIZE = 32;
+
+static float ForsythVertexScore(int cachePosition, uint32_t remainingValence)
+{
+	if (remainingValence == 0)
+		return -1.0f;
+	
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		//Vertices used by the last triangle get a fixed score, so that the next triangle does not simply reuse them.
+		if (cachePosition < 3)
+			score = 0.75f;
+		else
+			score = std::pow(1.0f - (cachePosition - 3) / static_cast<float>(FORSYTH_CACHE_SIZE - 3), 1.5f);
+	}
+	
+	//Boosts vertices with few remaining triangles, to get rid of lone triangles early.
+	return score + 2.0f / std::sqrt(static_cast<float>(remainingValence));
+}
+
+void OptimizeVertexCache(uint32_t* indices, uint32_t numIndices, uint32_t numVertices)
+{
+	const uint32_t numTriangles = numIndices / 3;
+	if (numTriangles == 0)
+		return;
+	
+	//Builds per vertex lists of triangles which are not yet emitted.
+	std::vector<uint32_t> remainingValence(numVertices, 0);
+	for (uint32_t i = 0; i < numTriangles * 3; i++)
+		remainingValence[indices[i]]++;
+	
+	std::vector<uint32_t> vertexTrianglesOffset(numVertices + 1, 0);
+	for (uint32_t v = 0; v < numVertices; v++)
+		vertexTrianglesOffset[v + 1] = vertexTrianglesOffset[v] + remainingValence[v];
+	
+	std::vector<uint32_t> vertexTriangles(numTriangles * 3);
+	{
+		std::vector<uint32_t> fill(vertexTrianglesOffset.begin(), vertexTrianglesOffset.end() - 1);
+		for (uint32_t i = 0; i < numTriangles * 3; i++)
+			vertexTriangles[fill[indices[i]]++] = i / 3;
+	}
+	
+	std::vector<int> cachePosition(numVertices, -1);
+	std::vector<float> vertexScore(numVertices);
+	for (uint32_t v = 0; v < numVertices; v++)
+		vertexScore[v] = ForsythVertexScore(-1, remainingValence[v]);
+	
+	std::vector<float> triangleScore(numTriangles);
+	std::vector<bool> triangleEmitted(numTriangles, false);
+	for (uint32_t t = 0; t < numTriangles; t++)
+	{
+		triangleScore[t] = vertexScore[indices[t * 3 + 0]] + vertexScore[indices[t * 3 + 1]] +
+		                   vertexScore[indices[t * 3 + 2]];
+	}
+	
+	std::vector<uint32_t> outIndices;
+	outIndices.reserve(numTriangles * 3);
+	
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> newCache;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+	
+	uint32_t bestTriangle = static_cast<uint32_t>(std::max_element(triangleScore.begin(), triangleScore.end()) -
+	                                              triangleScore.begin());
+	uint32_t scanPosition = 0;
+	
+	for (uint32_t emitted = 0; emitted < numTriangles; emitted++)
+	{
+		//When no cached vertex has triangles left, continues with the first triangle which is not emitted yet.
+		if (bestTriangle == INVALID_INDEX)
+		{
+			while (triangleEmitted[scanPosition])
+				scanPosition++;
+			bestTriangle = scanPosition;
+		}
+		
+		const uint32_t* triangle = indices + bestTriangle * 3;
+		triangleEmitted[bestTriangle] = true;
+		
+		newCache.clear();
+		for (int i = 0; i < 3; i++)
+		{
+			const uint32_t v = triangle[i];
+			outIndices.push_back(v);
+			newCache.push_back(v);
+			
+			uint32_t* trianglesBegin = vertexTriangles.data() + vertexTrianglesOffset[v];
+			uint32_t* trianglesEnd = trianglesBegin + remainingValence[v];
+			std::swap(*std::find(trianglesBegin, trianglesEnd, bestTriangle), *(trianglesEnd - 1));
+			remainingValence[v]--;
+		}
+		
+		for (uint32_t v : cache)
+		{
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+				newCache.push_back(v);
+		}
+		
+		for (size_t i = 0; i < newCache.size(); i++)
+			cachePosition[newCache[i]] = i < static_cast<size_t>(FORSYTH_CACHE_SIZE) ? static_cast<int>(i) : -1;
+		
+		//Updates the scores of every vertex whose cache position changed, including evicted ones.
+		for (uint32_t v : newCache)
+		{
+			const float newScore = ForsythVertexScore(cachePosition[v], remainingValence[v]);
+			const float scoreDelta = newScore - vertexScore[v];
+			vertexScore[v] = newScore;
+			
+			const uint32_t* trianglesBegin = vertexTriangles.data() + vertexTrianglesOffset[v];
+			for (uint32_t t = 0; t < remainingValence[v]; t++)
+				triangleScore[trianglesBegin[t]] += scoreDelta;
+		}
+		
+		if (newCache.size() > static_cast<size_t>(FORSYTH_CACHE_SIZE))
+			newCache.resize(FORSYTH_CACHE_SIZE);
+		cache.swap(newCache);
+		
+		bestTriangle = INVALID_INDEX;
+		float bestScore = -1.0f;
+		for (uint32_t v : cache)
+		{
+			const uint32_t* trianglesBegin = vertexTriangles.data() + vertexTrianglesOffset[v];
+			for (uint32_t t = 0; t < remainingValence[v]; t++)
+			{
+				if (triangleScore[trianglesBegin[t]] > bestScore)
+				{
+					bestScore = triangleScore[trianglesBegin[t]];
+					bestTriangle = trianglesBegin[t];
+				}
+			}
+		}
+	}
+	
+	std::copy(outIndices.begin(), outIndices.end(), indices);
+}
+
+void OptimizeVertexFetch(void* vertices, uint32_t vertexSize, uint32_t numVertices, uint32_t* indices, uint32_t numIndices)
+{
+	std::vector<uint32_t> remap(numVertices, INVALID_INDEX);
+	uint32_t nextVertex = 0;
+	
+	for (uint32_t i = 0; i < numIndices; i++)
+	{
+		uint32_t& newIndex = remap[indices[i]];
+		if (newIndex == INVALID_INDEX)
+			newIndex = nextVertex++;
+		indices[i] = newIndex;
+	}
+	
+	for (uint32_t v = 0; v < numVertices; v++)
+	{
+		if (remap[v] == INVALID_INDEX)
+			remap[v] = nextVertex++;
+	}
+	
+	char* vertexBytes = static_cast<char*>(vertices);
+	std::vector<char> oldVertices(vertexBytes, vertexBytes + static_cast<size_t>(vertexSize) * numVertices);
+	for (uint32_t v = 0; v < numVertices; v++)
+	{
+		std::memcpy(vertexBytes + static_cast<size_t>(remap[v]) * vertexSize,
+		            oldVertices.data() + static_cast<size_t>(v) * vertexSize, vertexSize);
+	}
+}
+
+float CalculateACMR(const uint32_t* indices, uint32_t numIndices, uint32_t numVertices, uint32_t cacheSize)
+{
+	const uint32_t numTriangles = numIndices / 3;
+	if (numTriangles == 0)
+		return 0.0f;
+	
+	//Stores the value of the miss counter at the time each vertex was last transformed.
+	std::vector<uint32_t> cacheTimestamps(numVertices, 0);
+	uint32_t misses = 0;
+	
+	for (uint32_t i = 0; i < numTriangles * 3; i++)
+	{
+		const uint32_t v = indices[i];
+		if (cacheTimestamps[v] == 0 || misses - cacheTimestamps[v] >= cacheSize)
+		{
+			misses++;
+			cacheTimestamps[v] = misses;
+		}
+	}
+	
+	return misses / static_cast<float>(numTriangles);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+//Reorders triangles for the post transform vertex cache using Tom Forsyth's linear speed algorithm.
+void OptimizeVertexCache(uint32_t* indices, uint32_t numIndices, uint32_t numVertices);
+
+//Reorders vertices in order of first use and remaps indices accordingly. Unreferenced vertices are moved to the end.
+void OptimizeVertexFetch(void* vertices, uint32_t vertexSize, uint32_t numVertices, uint32_t* indices, uint32_t numIndices);
+
+//Average cache miss ratio (transformed vertices per triangle) for a FIFO cache of the given size.
+float CalculateACMR(const uint32_t* indices, uint32_t numIndices, uint32_t numVertices, uint32_t cacheSize = 16);
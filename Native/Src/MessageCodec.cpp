@@ -0,0 +1,236 @@
+#include "MessageCodec.h"
+#include "API.h"
+#include "Utils.h"
+
+#include <cstring>
+#include <algorithm>
+
+static const uint32_t MAX_PACKETS = UINT16_MAX;
+
+uint32_t GetNumPackets(uint32_t dataSize)
+{
+	if (dataSize == 0)
+		return 0;
+	if (dataSize <= MAX_DATA_INITIAL_PACKET)
+		return 1;
+	
+	const uint64_t numPackets = 1 + (static_cast<uint64_t>(dataSize) - MAX_DATA_INITIAL_PACKET +
+		MAX_DATA_CONTINUATION_PACKET - 1) / MAX_DATA_CONTINUATION_PACKET;
+	return numPackets > MAX_PACKETS ? 0 : static_cast<uint32_t>(numPackets);
+}
+
+static void WriteU16(uint8_t* destination, uint32_t value)
+{
+	destination[0] = static_cast<uint8_t>(value);
+	destination[1] = static_cast<uint8_t>(value >> 8);
+}
+
+uint32_t EncodeFrames(uint16_t id, uint32_t dataSize, uint8_t* headers, FrameSlice* slices)
+{
+	const uint32_t numPackets = GetNumPackets(dataSize);
+	if (numPackets == 0)
+		return 0;
+	
+	const uint32_t lastPacketSize = numPackets == 1 ? dataSize :
+		dataSize - MAX_DATA_INITIAL_PACKET - (numPackets - 2) * MAX_DATA_CONTINUATION_PACKET;
+	
+	WriteU16(headers, PROTOCOL_MAGIC);
+	WriteU16(headers + 2, id);
+	WriteU16(headers + 4, numPackets);
+	WriteU16(headers + 6, lastPacketSize);
+	slices[0] = { FS_Headers, 0, INITIAL_HEADER_SIZE };
+	slices[1] = { FS_Data, 0, numPackets == 1 ? dataSize : MAX_DATA_INITIAL_PACKET };
+	
+	uint32_t headerOffset = INITIAL_HEADER_SIZE;
+	uint32_t dataOffset = slices[1].size;
+	for (uint32_t packet = 1; packet < numPackets; packet++)
+	{
+		WriteU16(headers + headerOffset, PROTOCOL_MAGIC);
+		WriteU16(headers + headerOffset + 2, CONTINUATION_ID);
+		
+		const uint32_t packetDataSize = packet == numPackets - 1 ? lastPacketSize : MAX_DATA_CONTINUATION_PACKET;
+		slices[packet * 2] = { FS_Headers, headerOffset, CONTINUATION_HEADER_SIZE };
+		slices[packet * 2 + 1] = { FS_Data, dataOffset, packetDataSize };
+		
+		headerOffset += CONTINUATION_HEADER_SIZE;
+		dataOffset += packetDataSize;
+	}
+	
+	return numPackets * 2;
+}
+
+FrameDecoder::FrameDecoder(uint8_t* ring, uint32_t capacity)
+	: m_ring(ring), m_capacity(capacity), m_mask(capacity - 1)
+{
+	if (capacity < PACKET_SIZE || (capacity & (capacity - 1)) != 0)
+		Panic("The frame decoder ring must be a power of two of at least one packet.");
+	
+	//A message has one view per packet, plus one where it wraps around the end of the ring.
+	m_views.reserve(capacity / PACKET_SIZE + 3);
+}
+
+uint8_t* FrameDecoder::GetReceiveSpace(uint32_t& size) const
+{
+	const uint32_t writeIndex = m_writePosition & m_mask;
+	const uint32_t free = m_capacity - (m_writePosition - m_readPosition);
+	size = std::min(free, m_capacity - writeIndex);
+	return m_ring + writeIndex;
+}
+
+void FrameDecoder::CommitReceived(uint32_t size)
+{
+	m_writePosition += size;
+}
+
+void FrameDecoder::AddView(uint32_t position, uint32_t size)
+{
+	const uint32_t index = position & m_mask;
+	const uint32_t firstSize = std::min(size, m_capacity - index);
+	m_views.push_back({ m_ring + index, firstSize });
+	if (firstSize != size)
+		m_views.push_back({ m_ring, size - firstSize });
+}
+
+DecodeResult FrameDecoder::Next(DecodedMessage& message)
+{
+	while (true)
+	{
+		const uint32_t available = m_writePosition - m_readPosition;
+		if (available < INITIAL_HEADER_SIZE)
+			return DecodeResult::NeedMore;
+		
+		const uint16_t magic = ReadU16(m_readPosition);
+		const uint16_t id = ReadU16(m_readPosition + 2);
+		const uint32_t numPackets = ReadU16(m_readPosition + 4);
+		const uint32_t lastPacketSize = ReadU16(m_readPosition + 6);
+		
+		const uint32_t maxLastPacketSize = numPackets == 1 ? MAX_DATA_INITIAL_PACKET : MAX_DATA_CONTINUATION_PACKET;
+		if (magic != PROTOCOL_MAGIC || id == CONTINUATION_ID || numPackets == 0 || lastPacketSize == 0 ||
+		    lastPacketSize > maxLastPacketSize)
+		{
+			SkipByte();
+			continue;
+		}
+		
+		const uint64_t dataSize = numPackets == 1 ? lastPacketSize : MAX_DATA_INITIAL_PACKET +
+			static_cast<uint64_t>(numPackets - 2) * MAX_DATA_CONTINUATION_PACKET + lastPacketSize;
+		const uint64_t wireSize = dataSize + GetFrameHeadersSize(numPackets);
+		
+		//Continuation headers are checked as soon as they arrive, so that a bogus initial header does not hold up the
+		// stream until its supposed size has been received.
+		m_views.clear();
+		AddView(m_readPosition + INITIAL_HEADER_SIZE, numPackets == 1 ? lastPacketSize : MAX_DATA_INITIAL_PACKET);
+		
+		uint32_t offset = PACKET_SIZE;
+		bool valid = true;
+		for (uint32_t packet = 1; packet < numPackets && offset + CONTINUATION_HEADER_SIZE <= available; packet++)
+		{
+			const uint32_t position = m_readPosition + offset;
+			if (ReadU16(position) != PROTOCOL_MAGIC || ReadU16(position + 2) != CONTINUATION_ID)
+			{
+				valid = false;
+				break;
+			}
+			
+			const uint32_t packetDataSize = packet == numPackets - 1 ? lastPacketSize : MAX_DATA_CONTINUATION_PACKET;
+			AddView(position + CONTINUATION_HEADER_SIZE, packetDataSize);
+			offset += CONTINUATION_HEADER_SIZE + packetDataSize;
+		}
+		
+		if (!valid)
+		{
+			SkipByte();
+			continue;
+		}
+		
+		//A message too large for the ring could never be received whole. It is only reported once its first
+		// continuation header has been checked, so that stray bytes which happen to look like a header do not end the
+		// connection.
+		if (wireSize > m_capacity)
+			return available < PACKET_SIZE + CONTINUATION_HEADER_SIZE ? DecodeResult::NeedMore : DecodeResult::TooLarge;
+		if (wireSize > available)
+			return DecodeResult::NeedMore;
+		
+		m_pendingWireSize = static_cast<uint32_t>(wireSize);
+		message.id = id;
+		message.size = static_cast<uint32_t>(dataSize);
+		message.views = m_views.data();
+		message.numViews = static_cast<uint32_t>(m_views.size());
+		return DecodeResult::Message;
+	}
+}
+
+void FrameDecoder::Release()
+{
+	m_readPosition += m_pendingWireSize;
+	m_pendingWireSize = 0;
+}
+
+// C# Bindings
+CS_VISIBLE uint32_t MC_GetNumPackets(uint32_t dataSize)
+{
+	return GetNumPackets(dataSize);
+}
+
+CS_VISIBLE uint32_t MC_GetFrameHeadersSize(uint32_t numPackets)
+{
+	return GetFrameHeadersSize(numPackets);
+}
+
+CS_VISIBLE uint32_t MC_GetReceiveRingSize()
+{
+	return RECEIVE_RING_SIZE;
+}
+
+//headers must hold MC_GetFrameHeadersSize bytes and slices two per packet.
+CS_VISIBLE uint32_t MC_EncodeFrames(uint16_t id, uint32_t dataSize, uint8_t* headers, FrameSlice* slices)
+{
+	return EncodeFrames(id, dataSize, headers, slices);
+}
+
+//The ring is owned by the caller and must stay pinned for the lifetime of the decoder.
+CS_VISIBLE FrameDecoder* MC_CreateDecoder(uint8_t* ring, uint32_t capacity)
+{
+	return new FrameDecoder(ring, capacity);
+}
+
+CS_VISIBLE void MC_DestroyDecoder(FrameDecoder* decoder) { delete decoder; }
+
+CS_VISIBLE uint32_t MC_GetReceiveSpace(FrameDecoder* decoder, uint32_t* offset)
+{
+	uint32_t size;
+	*offset = decoder->GetRingOffset(decoder->GetReceiveSpace(size));
+	return size;
+}
+
+CS_VISIBLE void MC_CommitReceived(FrameDecoder* decoder, uint32_t size)
+{
+	decoder->CommitReceived(size);
+}
+
+CS_VISIBLE DecodeResult MC_NextMessage(FrameDecoder* decoder, uint16_t* id, uint32_t* size)
+{
+	DecodedMessage message;
+	const DecodeResult result = decoder->Next(message);
+	if (result == DecodeResult::Message)
+	{
+		*id = message.id;
+		*size = message.size;
+	}
+	return result;
+}
+
+//Copies the data of the message returned by MC_NextMessage and releases it.
+CS_VISIBLE void MC_TakeMessage(FrameDecoder* decoder, uint8_t* data)
+{
+	DecodedMessage message;
+	if (decoder->Next(message) != DecodeResult::Message)
+		Panic("No decoded message to take.");
+	
+	for (uint32_t i = 0; i < message.numViews; i++)
+	{
+		std::memcpy(data, message.views[i].data, message.views[i].size);
+		data += message.views[i].size;
+	}
+	decoder->Release();
+}
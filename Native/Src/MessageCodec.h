@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//Framing of Protocol.cs. A message is an initial packet with the header MAGIC, id, packet count and the data size of
+// the last packet, followed by continuation packets with the header MAGIC, 0. All fields are little endian.
+static const uint16_t PROTOCOL_MAGIC = 0x5045;
+static const uint16_t CONTINUATION_ID = 0;
+
+static const uint32_t PACKET_SIZE = 1024;
+static const uint32_t INITIAL_HEADER_SIZE = 8;
+static const uint32_t CONTINUATION_HEADER_SIZE = 4;
+static const uint32_t MAX_DATA_INITIAL_PACKET = PACKET_SIZE - INITIAL_HEADER_SIZE;
+static const uint32_t MAX_DATA_CONTINUATION_PACKET = PACKET_SIZE - CONTINUATION_HEADER_SIZE;
+
+//Ring size of every receiver, the managed one and the native server's, so both reject the same messages as too large.
+static const uint32_t RECEIVE_RING_SIZE = 64 * 1024;
+
+enum FrameSource : uint32_t
+{
+	FS_Headers = 0,
+	FS_Data = 1
+};
+
+//A range of either the header buffer or the message data. The packets of a message are the slices in order.
+#pragma pack(push, 1)
+struct FrameSlice
+{
+	FrameSource source;
+	uint32_t offset;
+	uint32_t size;
+};
+#pragma pack(pop)
+
+//Returns 0 if the data is empty or too large for the 16 bit packet count.
+uint32_t GetNumPackets(uint32_t dataSize);
+
+inline uint32_t GetFrameHeadersSize(uint32_t numPackets)
+{
+	return INITIAL_HEADER_SIZE + (numPackets - 1) * CONTINUATION_HEADER_SIZE;
+}
+
+//Writes the packet headers of a message to headers and two slices per packet, which interleave the headers with
+// the message data so it is sent as is. Returns the number of slices.
+uint32_t EncodeFrames(uint16_t id, uint32_t dataSize, uint8_t* headers, FrameSlice* slices);
+
+struct FrameView
+{
+	const uint8_t* data;
+	uint32_t size;
+};
+
+struct DecodedMessage
+{
+	uint16_t id;
+	uint32_t size;
+	
+	//Data of the message in order, pointing into the ring buffer. Valid until the message is released.
+	const FrameView* views;
+	uint32_t numViews;
+};
+
+enum class DecodeResult : uint32_t
+{
+	NeedMore = 0,
+	Message = 1,
+	
+	//The stream announces a message larger than the ring, after which the connection should be closed.
+	TooLarge = 2
+};
+
+//Reassembles messages from a byte stream in a ring buffer. Bytes are received straight into the ring and messages
+// are read where they lie, so nothing is copied or allocated per message. Bytes that do not form a valid packet are
+// skipped until the stream is back in sync.
+class FrameDecoder
+{
+public:
+	//The capacity must be a power of two, and bounds the size of messages on the wire.
+	FrameDecoder(uint8_t* ring, uint32_t capacity);
+	
+	//Contiguous free space to receive into.
+	uint8_t* GetReceiveSpace(uint32_t& size) const;
+	void CommitReceived(uint32_t size);
+	
+	//Returns the same message until it is released.
+	DecodeResult Next(DecodedMessage& message);
+	void Release();
+	
+	uint32_t GetRingOffset(const uint8_t* pointer) const
+	{
+		return static_cast<uint32_t>(pointer - m_ring);
+	}
+	
+	uint64_t GetBytesSkipped() const
+	{
+		return m_bytesSkipped;
+	}
+	
+private:
+	uint8_t At(uint32_t position) const
+	{
+		return m_ring[position & m_mask];
+	}
+	
+	uint16_t ReadU16(uint32_t position) const
+	{
+		return static_cast<uint16_t>(At(position) | (At(position + 1) << 8));
+	}
+	
+	void SkipByte()
+	{
+		m_readPosition++;
+		m_bytesSkipped++;
+	}
+	
+	void AddView(uint32_t position, uint32_t size);
+	
+	uint8_t* m_ring;
+	uint32_t m_capacity;
+	uint32_t m_mask;
+	
+	//Stream positions, which wrap around at 2^32 and are masked to index the ring.
+	uint32_t m_readPosition = 0;
+	uint32_t m_writePosition = 0;
+	
+	//Bytes on the wire of the message returned by Next, or 0.
+	uint32_t m_pendingWireSize = 0;
+	
+	std::vector<FrameView> m_views;
+	uint64_t m_bytesSkipped = 0;
+};
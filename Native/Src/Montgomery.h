@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+//Returns the low half of the 128 bit product of a and b, and writes the high half to high.
+inline uint64_t MultiplyWide(uint64_t a, uint64_t b, uint64_t& high)
+{
+#if defined(__SIZEOF_INT128__)
+	const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+	high = static_cast<uint64_t>(product >> 64);
+	return static_cast<uint64_t>(product);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	return _umul128(a, b, &high);
+#else
+	const uint64_t aLow = a & 0xFFFFFFFF, aHigh = a >> 32;
+	const uint64_t bLow = b & 0xFFFFFFFF, bHigh = b >> 32;
+	const uint64_t lowLow = aLow * bLow;
+	const uint64_t highLow = aHigh * bLow;
+	const uint64_t lowHigh = aLow * bHigh;
+	const uint64_t middle = (lowLow >> 32) + (highLow & 0xFFFFFFFF) + (lowHigh & 0xFFFFFFFF);
+	high = aHigh * bHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+	return (middle << 32) | (lowLow & 0xFFFFFFFF);
+#endif
+}
+
+//Arithmetic modulo an odd 64 bit modulus in Montgomery form, where x is stored as x * 2^64 mod n. Multiplications
+// then need no division, and intermediate products never overflow however large the modulus is.
+class Montgomery
+{
+public:
+	//The modulus must be odd.
+	explicit Montgomery(uint64_t modulus)
+		: m_modulus(modulus)
+	{
+		//Newton's iteration doubles the number of correct low bits of the inverse each step, starting from 3 bits.
+		uint64_t inverse = modulus;
+		for (int i = 0; i < 5; i++)
+			inverse *= 2 - modulus * inverse;
+		m_negInverse = 0 - inverse;
+		
+		//2^64 mod n, then doubled 64 times to get 2^128 mod n.
+		m_one = (0 - modulus) % modulus;
+		m_rSquared = m_one;
+		for (int i = 0; i < 64; i++)
+			m_rSquared = AddMod(m_rSquared, m_rSquared);
+	}
+	
+	uint64_t GetModulus() const { return m_modulus; }
+	
+	uint64_t ToMontgomery(uint64_t x) const
+	{
+		return Multiply(x % m_modulus, m_rSquared);
+	}
+	
+	uint64_t FromMontgomery(uint64_t x) const
+	{
+		return Reduce(x, 0);
+	}
+	
+	//Both operands and the result are in Montgomery form.
+	uint64_t Multiply(uint64_t a, uint64_t b) const
+	{
+		uint64_t high;
+		const uint64_t low = MultiplyWide(a, b, high);
+		return Reduce(low, high);
+	}
+	
+	//Takes and returns normal values. Runs the same operations for every exponent, so the time taken does not
+	// depend on the key.
+	uint64_t Pow(uint64_t base, uint64_t exponent) const
+	{
+		const uint64_t montBase = ToMontgomery(base);
+		uint64_t result = m_one;
+		for (int bit = 63; bit >= 0; bit--)
+		{
+			result = Multiply(result, result);
+			const uint64_t multiplied = Multiply(result, montBase);
+			const uint64_t mask = 0 - ((exponent >> bit) & 1);
+			result = (multiplied & mask) | (result & ~mask);
+		}
+		return FromMontgomery(result);
+	}
+	
+private:
+	uint64_t AddMod(uint64_t a, uint64_t b) const
+	{
+		const uint64_t sum = a + b;
+		return (sum < a || sum >= m_modulus) ? sum - m_modulus : sum;
+	}
+	
+	//Returns (high * 2^64 + low) / 2^64 mod n, for values below n * 2^64.
+	uint64_t Reduce(uint64_t low, uint64_t high) const
+	{
+		//Adding m * n clears the low half. It carries into the high half unless the low half was already zero.
+		const uint64_t m = low * m_negInverse;
+		uint64_t mnHigh;
+		MultiplyWide(m, m_modulus, mnHigh);
+		
+		const uint64_t carry = low != 0;
+		uint64_t result = high + mnHigh;
+		bool overflow = result < high;
+		result += carry;
+		overflow |= result < carry;
+		
+		//The sum is below 2n, so one subtraction is enough.
+		if (overflow || result >= m_modulus)
+			result -= m_modulus;
+		return result;
+	}
+	
+	uint64_t m_modulus;
+	uint64_t m_negInverse;
+	uint64_t m_one;
+	uint64_t m_rSquared;
+};
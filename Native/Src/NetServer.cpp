@@ -0,0 +1,690 @@
+#include "API.h"
+#include "Utils.h"
+#include "MessageCodec.h"
+
+#include <cstdint>
+#include <vector>
+
+enum class NetEventType : uint32_t
+{
+	Connected = 0,
+	Message = 1,
+	Disconnected = 2
+};
+
+#pragma pack(push, 1)
+struct NetEventInfo
+{
+	NetEventType type;
+	uint32_t connection;
+	uint32_t messageId;
+	uint32_t size;
+};
+#pragma pack(pop)
+
+#ifdef __linux__
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+struct NetEvent
+{
+	NetEventType type;
+	uint32_t connection;
+	uint16_t messageId;
+	std::vector<uint8_t> data;
+};
+
+//Bounded multi producer queue of events, after Dmitry Vyukov's. Each cell's sequence number says whether it is
+// free to write for a given lap of the ring, or holds an event ready to be read.
+class EventQueue
+{
+public:
+	explicit EventQueue(uint32_t capacity)
+		: m_cells(capacity), m_mask(capacity - 1)
+	{
+		for (uint32_t i = 0; i < capacity; i++)
+			m_cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	
+	//Moves from the event only if there was room for it.
+	bool TryPush(NetEvent& event)
+	{
+		uint64_t position = m_pushPosition.load(std::memory_order_relaxed);
+		while (true)
+		{
+			Cell& cell = m_cells[position & m_mask];
+			const int64_t difference = static_cast<int64_t>(cell.sequence.load(std::memory_order_acquire) - position);
+			if (difference == 0)
+			{
+				if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					cell.event = std::move(event);
+					cell.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0)
+				return false;
+			else
+				position = m_pushPosition.load(std::memory_order_relaxed);
+		}
+	}
+	
+	//Only the popping thread may check.
+	bool HasEvent() const
+	{
+		return m_cells[m_popPosition & m_mask].sequence.load(std::memory_order_acquire) == m_popPosition + 1;
+	}
+	
+	//Only one thread may pop.
+	bool TryPop(NetEvent& event)
+	{
+		Cell& cell = m_cells[m_popPosition & m_mask];
+		if (cell.sequence.load(std::memory_order_acquire) != m_popPosition + 1)
+			return false;
+		
+		event = std::move(cell.event);
+		cell.sequence.store(m_popPosition + m_mask + 1, std::memory_order_release);
+		m_popPosition++;
+		return true;
+	}
+	
+private:
+	struct Cell
+	{
+		std::atomic<uint64_t> sequence;
+		NetEvent event;
+	};
+	
+	std::vector<Cell> m_cells;
+	uint64_t m_mask;
+	
+	//The producers' and the consumer's positions are kept on separate cache lines.
+	char m_padding1[64];
+	std::atomic<uint64_t> m_pushPosition { 0 };
+	char m_padding2[64];
+	uint64_t m_popPosition = 0;
+};
+
+struct Connection
+{
+	Connection(uint32_t _id, int _socket)
+		: id(_id), socket(_socket), ring(RECEIVE_RING_SIZE), decoder(ring.data(), RECEIVE_RING_SIZE) { }
+	
+	uint32_t id;
+	int socket;
+	
+	//Only touched by the worker the connection belongs to.
+	std::vector<uint8_t> ring;
+	FrameDecoder decoder;
+	
+	//Bytes which could not be sent right away, waiting for the socket to become writable.
+	std::mutex sendMutex;
+	std::vector<uint8_t> outbox;
+	size_t outboxOffset = 0;
+	bool closed = false;
+};
+
+//Accepts connections and moves messages between sockets and managed code. Each worker thread waits on its own
+// edge triggered epoll instance, and connections are spread over the workers round robin. Decoded messages are
+// handed to a single managed consumer through a lock free queue, while any thread may send.
+class NetServer
+{
+public:
+	static constexpr uint32_t EVENT_QUEUE_CAPACITY = 64 * 1024;
+	
+	//Bytes which may wait in a connection's outbox. A client which stops reading would otherwise make it grow without
+	// bound, so its connection is shut down instead.
+	static constexpr size_t MAX_OUTBOX_SIZE = 16 * 1024 * 1024;
+	
+	NetServer()
+		: m_events(EVENT_QUEUE_CAPACITY) { }
+	
+	~NetServer()
+	{
+		m_stopping.store(true, std::memory_order_relaxed);
+		for (Worker& worker : m_workers)
+		{
+			const uint64_t wake = 1;
+			if (write(worker.wakeEvent, &wake, sizeof(wake)) < 0)
+				Panic("Error waking network worker.");
+		}
+		
+		for (Worker& worker : m_workers)
+		{
+			worker.thread.join();
+			close(worker.wakeEvent);
+			close(worker.epoll);
+		}
+		
+		for (auto& entry : m_connections)
+			close(entry.second->socket);
+		if (m_listenSocket != -1)
+			close(m_listenSocket);
+		if (m_spareDescriptor != -1)
+			close(m_spareDescriptor);
+	}
+	
+	bool Start(uint16_t port, uint32_t numWorkers)
+	{
+		m_listenSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (m_listenSocket == -1)
+			return false;
+		m_spareDescriptor = OpenSpareDescriptor();
+		
+		const int reuse = 1;
+		setsockopt(m_listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+		
+		sockaddr_in address = { };
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_ANY);
+		address.sin_port = htons(port);
+		if (bind(m_listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+		    listen(m_listenSocket, SOMAXCONN) != 0)
+		{
+			return false;
+		}
+		
+		m_workers = std::vector<Worker>(std::max(numWorkers, 1u));
+		for (Worker& worker : m_workers)
+		{
+			worker.epoll = epoll_create1(EPOLL_CLOEXEC);
+			worker.wakeEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			if (worker.epoll == -1 || worker.wakeEvent == -1)
+				Panic("Error creating network worker.");
+			
+			//Wake ups are the only events without a pointer.
+			epoll_event event = { };
+			event.events = EPOLLIN;
+			event.data.ptr = nullptr;
+			epoll_ctl(worker.epoll, EPOLL_CTL_ADD, worker.wakeEvent, &event);
+		}
+		
+		//The first worker also accepts connections, which are marked by a pointer to the server.
+		epoll_event listenEvent = GetListenEvent();
+		epoll_ctl(m_workers[0].epoll, EPOLL_CTL_ADD, m_listenSocket, &listenEvent);
+		
+		for (uint32_t i = 0; i < m_workers.size(); i++)
+			m_workers[i].thread = std::thread(&NetServer::RunWorker, this, i);
+		return true;
+	}
+	
+	//Sends straight from the message data when the socket has room, and copies only what does not fit. Returns false
+	// if the message would overflow the outbox, after which the connection is reported as disconnected.
+	bool Send(uint32_t connectionId, uint16_t messageId, const uint8_t* data, uint32_t size)
+	{
+		const std::shared_ptr<Connection> connection = FindConnection(connectionId);
+		if (connection == nullptr)
+			return false;
+		
+		const uint32_t numPackets = GetNumPackets(size);
+		if (numPackets == 0)
+			return false;
+		
+		thread_local std::vector<uint8_t> headers;
+		thread_local std::vector<FrameSlice> slices;
+		thread_local std::vector<iovec> vectors;
+		headers.resize(GetFrameHeadersSize(numPackets));
+		slices.resize(numPackets * 2);
+		vectors.resize(numPackets * 2);
+		
+		const uint32_t numSlices = EncodeFrames(messageId, size, headers.data(), slices.data());
+		for (uint32_t i = 0; i < numSlices; i++)
+		{
+			const uint8_t* source = slices[i].source == FS_Headers ? headers.data() : data;
+			vectors[i].iov_base = const_cast<uint8_t*>(source + slices[i].offset);
+			vectors[i].iov_len = slices[i].size;
+		}
+		
+		std::lock_guard<std::mutex> lock(connection->sendMutex);
+		if (connection->closed)
+			return false;
+		
+		uint32_t firstUnsent = 0;
+		if (connection->outbox.size() == connection->outboxOffset)
+		{
+			firstUnsent = SendVectors(connection->socket, vectors.data(), numSlices);
+			if (firstUnsent == UINT32_MAX)
+				return false;
+		}
+		
+		size_t unsentSize = connection->outbox.size() - connection->outboxOffset;
+		for (uint32_t i = firstUnsent; i < numSlices; i++)
+			unsentSize += vectors[i].iov_len;
+		if (unsentSize > MAX_OUTBOX_SIZE)
+		{
+			shutdown(connection->socket, SHUT_RDWR);
+			std::vector<uint8_t>().swap(connection->outbox);
+			connection->outboxOffset = 0;
+			return false;
+		}
+		
+		for (uint32_t i = firstUnsent; i < numSlices; i++)
+		{
+			const uint8_t* begin = static_cast<const uint8_t*>(vectors[i].iov_base);
+			connection->outbox.insert(connection->outbox.end(), begin, begin + vectors[i].iov_len);
+		}
+		return true;
+	}
+	
+	//The connection is shut down here and closed by its worker, which then reports it as disconnected.
+	void Close(uint32_t connectionId)
+	{
+		const std::shared_ptr<Connection> connection = FindConnection(connectionId);
+		if (connection == nullptr)
+			return;
+		
+		std::lock_guard<std::mutex> lock(connection->sendMutex);
+		if (!connection->closed)
+			shutdown(connection->socket, SHUT_RDWR);
+	}
+	
+	//Blocks the polling thread until an event can be polled or the timeout passes. Returns false on timeout.
+	bool WaitForEvent(uint32_t timeoutMS)
+	{
+		std::unique_lock<std::mutex> lock(m_waitMutex);
+		m_consumerWaiting.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		
+		const bool ready = m_eventPushed.wait_for(lock, std::chrono::milliseconds(timeoutMS),
+		                                          [&] { return m_events.HasEvent(); });
+		m_consumerWaiting.store(false, std::memory_order_relaxed);
+		return ready;
+	}
+	
+	//Only one thread may poll. The data of a message stays available until the next poll.
+	bool Poll(NetEventInfo& info)
+	{
+		if (!m_events.TryPop(m_currentEvent))
+			return false;
+		
+		info.type = m_currentEvent.type;
+		info.connection = m_currentEvent.connection;
+		info.messageId = m_currentEvent.messageId;
+		info.size = static_cast<uint32_t>(m_currentEvent.data.size());
+		return true;
+	}
+	
+	const std::vector<uint8_t>& GetCurrentData() const
+	{
+		return m_currentEvent.data;
+	}
+	
+	uint32_t GetNumConnections()
+	{
+		std::lock_guard<std::mutex> lock(m_connectionsMutex);
+		return static_cast<uint32_t>(m_connections.size());
+	}
+	
+private:
+	static constexpr uint32_t MAX_EPOLL_EVENTS = 256;
+	
+	struct Worker
+	{
+		int epoll = -1;
+		int wakeEvent = -1;
+		std::thread thread;
+	};
+	
+	//Sends as much as the socket takes without blocking. Returns the index of the first vector that was not sent
+	// completely, which is adjusted to start at the unsent part, or UINT32_MAX if the connection failed.
+	static uint32_t SendVectors(int socket, iovec* vectors, uint32_t numVectors)
+	{
+		uint32_t first = 0;
+		while (first < numVectors)
+		{
+			msghdr header = { };
+			header.msg_iov = vectors + first;
+			header.msg_iovlen = std::min<uint32_t>(numVectors - first, IOV_MAX);
+			
+			ssize_t sent = sendmsg(socket, &header, MSG_NOSIGNAL);
+			if (sent < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				return errno == EAGAIN || errno == EWOULDBLOCK ? first : UINT32_MAX;
+			}
+			
+			for (; first < numVectors && static_cast<size_t>(sent) >= vectors[first].iov_len; first++)
+				sent -= vectors[first].iov_len;
+			if (first < numVectors)
+			{
+				vectors[first].iov_base = static_cast<uint8_t*>(vectors[first].iov_base) + sent;
+				vectors[first].iov_len -= sent;
+			}
+		}
+		return numVectors;
+	}
+	
+	std::shared_ptr<Connection> FindConnection(uint32_t connectionId)
+	{
+		std::lock_guard<std::mutex> lock(m_connectionsMutex);
+		auto it = m_connections.find(connectionId);
+		return it == m_connections.end() ? nullptr : it->second;
+	}
+	
+	//Waits for room in the queue rather than dropping events, unless the server is being destroyed.
+	void PushEvent(NetEvent& event)
+	{
+		while (!m_events.TryPush(event))
+		{
+			if (m_stopping.load(std::memory_order_relaxed))
+				return;
+			std::this_thread::yield();
+		}
+		
+		//Pairs with the fence in WaitForEvent, so either the consumer sees the event or this sees it waiting.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (m_consumerWaiting.load(std::memory_order_relaxed))
+		{
+			std::lock_guard<std::mutex> lock(m_waitMutex);
+			m_eventPushed.notify_one();
+		}
+	}
+	
+	void PushEvent(NetEventType type, uint32_t connectionId)
+	{
+		NetEvent event;
+		event.type = type;
+		event.connection = connectionId;
+		event.messageId = 0;
+		PushEvent(event);
+	}
+	
+	epoll_event GetListenEvent()
+	{
+		epoll_event event = { };
+		event.events = EPOLLIN | EPOLLET;
+		event.data.ptr = this;
+		return event;
+	}
+	
+	static int OpenSpareDescriptor()
+	{
+		return open("/dev/null", O_RDONLY | O_CLOEXEC);
+	}
+	
+	void AcceptConnections()
+	{
+		while (true)
+		{
+			const int socket = accept4(m_listenSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (socket == -1)
+			{
+				if (errno == EINTR || errno == ECONNABORTED)
+					continue;
+				if ((errno == EMFILE || errno == ENFILE) && RejectConnection())
+					continue;
+				return;
+			}
+			
+			//Messages are small and latency sensitive.
+			const int noDelay = 1;
+			setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+			
+			const uint32_t id = m_nextConnectionId++;
+			std::shared_ptr<Connection> connection = std::make_shared<Connection>(id, socket);
+			{
+				std::lock_guard<std::mutex> lock(m_connectionsMutex);
+				m_connections.emplace(id, connection);
+			}
+			PushEvent(NetEventType::Connected, id);
+			
+			epoll_event event = { };
+			event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+			event.data.ptr = connection.get();
+			const Worker& worker = m_workers[m_nextWorker++ % m_workers.size()];
+			epoll_ctl(worker.epoll, EPOLL_CTL_ADD, socket, &event);
+		}
+	}
+	
+	//Out of file descriptors, the edge triggered listener would not report the pending connections again and accepting
+	// would stop for good. The spare descriptor is given up to accept and close the oldest pending connection instead.
+	// Returns false if that is not possible either, which pauses accepting until a connection closes. The pause is set
+	// first, so a connection closing meanwhile either frees a descriptor for this attempt or resumes accepting.
+	bool RejectConnection()
+	{
+		m_acceptPaused.store(true);
+		if (m_spareDescriptor == -1)
+			m_spareDescriptor = OpenSpareDescriptor();
+		if (m_spareDescriptor == -1)
+			return false;
+		
+		close(m_spareDescriptor);
+		const int socket = accept4(m_listenSocket, nullptr, nullptr, SOCK_CLOEXEC);
+		const bool outOfDescriptors = socket == -1 && (errno == EMFILE || errno == ENFILE);
+		if (socket != -1)
+			close(socket);
+		m_spareDescriptor = OpenSpareDescriptor();
+		
+		if (outOfDescriptors)
+			return false;
+		m_acceptPaused.store(false);
+		return true;
+	}
+	
+	//Reads until the socket would block, as edge triggering requires. Returns false if the connection is done.
+	bool ReceiveMessages(Connection& connection)
+	{
+		while (true)
+		{
+			uint32_t space;
+			uint8_t* destination = connection.decoder.GetReceiveSpace(space);
+			
+			const ssize_t received = recv(connection.socket, destination, space, 0);
+			if (received == 0)
+				return false;
+			if (received < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				return errno == EAGAIN || errno == EWOULDBLOCK;
+			}
+			connection.decoder.CommitReceived(static_cast<uint32_t>(received));
+			
+			DecodedMessage message;
+			DecodeResult result;
+			while ((result = connection.decoder.Next(message)) == DecodeResult::Message)
+			{
+				NetEvent event;
+				event.type = NetEventType::Message;
+				event.connection = connection.id;
+				event.messageId = message.id;
+				event.data.reserve(message.size);
+				for (uint32_t i = 0; i < message.numViews; i++)
+					event.data.insert(event.data.end(), message.views[i].data, message.views[i].data + message.views[i].size);
+				connection.decoder.Release();
+				
+				PushEvent(event);
+			}
+			
+			if (result == DecodeResult::TooLarge)
+				return false;
+		}
+	}
+	
+	bool FlushOutbox(Connection& connection)
+	{
+		std::lock_guard<std::mutex> lock(connection.sendMutex);
+		if (connection.outbox.size() == connection.outboxOffset)
+			return true;
+		
+		iovec vector;
+		vector.iov_base = connection.outbox.data() + connection.outboxOffset;
+		vector.iov_len = connection.outbox.size() - connection.outboxOffset;
+		const size_t pending = vector.iov_len;
+		const uint32_t firstUnsent = SendVectors(connection.socket, &vector, 1);
+		if (firstUnsent == UINT32_MAX)
+			return false;
+		
+		connection.outboxOffset += firstUnsent == 1 ? pending : pending - vector.iov_len;
+		if (connection.outboxOffset == connection.outbox.size())
+		{
+			connection.outbox.clear();
+			connection.outboxOffset = 0;
+		}
+		return true;
+	}
+	
+	void CloseConnection(Connection& connection)
+	{
+		const uint32_t id = connection.id;
+		{
+			std::lock_guard<std::mutex> lock(connection.sendMutex);
+			connection.closed = true;
+			close(connection.socket);
+		}
+		
+		//Senders may still hold the connection, which is freed when the last of them lets go.
+		{
+			std::lock_guard<std::mutex> lock(m_connectionsMutex);
+			m_connections.erase(id);
+		}
+		PushEvent(NetEventType::Disconnected, id);
+		
+		//Modifying the listener makes epoll check it again and report the connections still waiting to be accepted.
+		if (m_acceptPaused.exchange(false))
+		{
+			epoll_event listenEvent = GetListenEvent();
+			epoll_ctl(m_workers[0].epoll, EPOLL_CTL_MOD, m_listenSocket, &listenEvent);
+		}
+	}
+	
+	void RunWorker(uint32_t workerIndex)
+	{
+		const Worker& worker = m_workers[workerIndex];
+		epoll_event events[MAX_EPOLL_EVENTS];
+		
+		while (!m_stopping.load(std::memory_order_relaxed))
+		{
+			const int numEvents = epoll_wait(worker.epoll, events, MAX_EPOLL_EVENTS, -1);
+			for (int i = 0; i < numEvents; i++)
+			{
+				if (events[i].data.ptr == nullptr)
+					continue;
+				if (events[i].data.ptr == this)
+				{
+					AcceptConnections();
+					continue;
+				}
+				
+				Connection& connection = *static_cast<Connection*>(events[i].data.ptr);
+				bool open = (events[i].events & EPOLLERR) == 0;
+				if (open && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)))
+					open = ReceiveMessages(connection);
+				if (open && (events[i].events & EPOLLOUT))
+					open = FlushOutbox(connection);
+				
+				if (!open)
+					CloseConnection(connection);
+			}
+		}
+	}
+	
+	int m_listenSocket = -1;
+	
+	//Kept open to be given up when file descriptors run out. Only used by the first worker.
+	int m_spareDescriptor = -1;
+	std::atomic<bool> m_acceptPaused { false };
+	
+	std::vector<Worker> m_workers;
+	std::atomic<uint32_t> m_nextWorker { 0 };
+	std::atomic<bool> m_stopping { false };
+	
+	std::mutex m_connectionsMutex;
+	std::unordered_map<uint32_t, std::shared_ptr<Connection>> m_connections;
+	std::atomic<uint32_t> m_nextConnectionId { 1 };
+	
+	EventQueue m_events;
+	NetEvent m_currentEvent;
+	
+	std::mutex m_waitMutex;
+	std::condition_variable m_eventPushed;
+	std::atomic<bool> m_consumerWaiting { false };
+};
+
+#else
+
+//Only Linux has epoll, so creating a server fails elsewhere.
+class NetServer
+{
+public:
+	bool Start(uint16_t, uint32_t) { return false; }
+	bool Send(uint32_t, uint16_t, const uint8_t*, uint32_t) { return false; }
+	void Close(uint32_t) { }
+	bool WaitForEvent(uint32_t) { return false; }
+	bool Poll(NetEventInfo&) { return false; }
+	const std::vector<uint8_t>& GetCurrentData() const { return m_noData; }
+	uint32_t GetNumConnections() { return 0; }
+	
+private:
+	std::vector<uint8_t> m_noData;
+};
+
+#endif
+
+// C# Bindings
+//Returns null if the port could not be listened on, or if the platform has no epoll.
+CS_VISIBLE NetServer* NS_Create(uint16_t port, uint32_t numWorkers)
+{
+	NetServer* server = new NetServer;
+	if (!server->Start(port, numWorkers))
+	{
+		delete server;
+		return nullptr;
+	}
+	return server;
+}
+
+CS_VISIBLE void NS_Destroy(NetServer* server) { delete server; }
+
+CS_VISIBLE bool NS_Send(NetServer* server, uint32_t connection, uint16_t messageId, const uint8_t* data, uint32_t size)
+{
+	return server->Send(connection, messageId, data, size);
+}
+
+CS_VISIBLE void NS_Close(NetServer* server, uint32_t connection)
+{
+	server->Close(connection);
+}
+
+CS_VISIBLE bool NS_WaitForEvent(NetServer* server, uint32_t timeoutMS)
+{
+	return server->WaitForEvent(timeoutMS);
+}
+
+CS_VISIBLE bool NS_Poll(NetServer* server, NetEventInfo* info)
+{
+	return server->Poll(*info);
+}
+
+//Copies the data of the message returned by the last poll.
+CS_VISIBLE void NS_GetEventData(NetServer* server, uint8_t* data)
+{
+	const std::vector<uint8_t>& eventData = server->GetCurrentData();
+	std::copy(eventData.begin(), eventData.end(), data);
+}
+
+CS_VISIBLE uint32_t NS_GetNumConnections(NetServer* server)
+{
+	return server->GetNumConnections();
+}
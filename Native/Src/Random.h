@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+//xoshiro256** by David Blackman and Sebastiano Vigna. Fast and small enough to give every thread its own generator.
+class Xoshiro256
+{
+public:
+	explicit Xoshiro256(uint64_t seed)
+	{
+		//Expands the seed with splitmix64, which can not produce the all zero state.
+		for (uint64_t& word : m_state)
+		{
+			seed += 0x9E3779B97F4A7C15ull;
+			uint64_t z = seed;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			word = z ^ (z >> 31);
+		}
+	}
+	
+	uint64_t Next()
+	{
+		const uint64_t result = RotateLeft(m_state[1] * 5, 7) * 9;
+		const uint64_t t = m_state[1] << 17;
+		
+		m_state[2] ^= m_state[0];
+		m_state[3] ^= m_state[1];
+		m_state[1] ^= m_state[2];
+		m_state[0] ^= m_state[3];
+		m_state[2] ^= t;
+		m_state[3] = RotateLeft(m_state[3], 45);
+		
+		return result;
+	}
+	
+	//Returns a value below bound using a multiply and shift. The bias is negligible for the small bounds used here.
+	uint32_t NextBelow(uint32_t bound)
+	{
+		return static_cast<uint32_t>(((Next() >> 32) * bound) >> 32);
+	}
+	
+	//Advances the generator by 2^128 steps. Generators made by jumping one another produce streams that never overlap.
+	void Jump()
+	{
+		static const uint64_t JUMP[] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+		                                 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+		
+		uint64_t jumped[4] = { };
+		for (uint64_t jumpWord : JUMP)
+		{
+			for (int bit = 0; bit < 64; bit++)
+			{
+				if (jumpWord & (1ull << bit))
+				{
+					for (int i = 0; i < 4; i++)
+						jumped[i] ^= m_state[i];
+				}
+				Next();
+			}
+		}
+		
+		for (int i = 0; i < 4; i++)
+			m_state[i] = jumped[i];
+	}
+	
+private:
+	static uint64_t RotateLeft(uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+	
+	uint64_t m_state[4];
+};
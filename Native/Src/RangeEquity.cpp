@@ -0,0 +1,311 @@
+#include "RangeEquity.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <cstring>
+
+//Attempts at drawing combos that do not share cards before a deal is given up.
+static const uint32_t MAX_DEAL_ATTEMPTS = 1000;
+
+static void BuildAliasTable(const std::vector<float>& weights, RangeSpot::Range& range)
+{
+	const uint32_t count = static_cast<uint32_t>(weights.size());
+	double totalWeight = 0;
+	for (float weight : weights)
+		totalWeight += weight;
+	
+	//Vose's method. Entries are split into those below and above the average weight, and each small entry is
+	// topped up by a large one.
+	std::vector<double> scaled(count);
+	std::vector<uint32_t> small, large;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		scaled[i] = weights[i] * count / totalWeight;
+		(scaled[i] < 1.0 ? small : large).push_back(i);
+	}
+	
+	range.probabilities.assign(count, 1.0f);
+	range.aliases.resize(count);
+	for (uint32_t i = 0; i < count; i++)
+		range.aliases[i] = i;
+	
+	while (!small.empty() && !large.empty())
+	{
+		const uint32_t less = small.back();
+		const uint32_t more = large.back();
+		small.pop_back();
+		
+		range.probabilities[less] = static_cast<float>(scaled[less]);
+		range.aliases[less] = more;
+		
+		scaled[more] -= 1.0 - scaled[less];
+		if (scaled[more] < 1.0)
+		{
+			large.pop_back();
+			small.push_back(more);
+		}
+	}
+}
+
+//FNV-1a over 64 bit words, with a shift after each multiply so that high bits reach the low bits too. Ranges take
+// kilobytes per player, which makes hashing them a byte at a time show up.
+struct SpotHash
+{
+	uint64_t value = 0xCBF29CE484222325ull;
+	
+	void Add(const void* data, size_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i += sizeof(uint64_t))
+		{
+			uint64_t word = 0;
+			std::memcpy(&word, bytes + i, std::min(sizeof(uint64_t), size - i));
+			value = (value ^ word) * 0x100000001B3ull;
+			value ^= value >> 31;
+		}
+	}
+};
+
+//Hashes the ranges, board and known cards with suits permuted, in a form where equal spots have equal hashes.
+static uint64_t HashRangeSpot(const float* weights, const RangeSpot& spot, const uint8_t* suits,
+                              std::vector<float>& permutedWeights)
+{
+	auto MapCard = [&] (uint8_t card) { return static_cast<uint8_t>((card & ~3) | suits[card & 3]); };
+	
+	SpotHash hash;
+	hash.Add(&spot.numPlayers, sizeof(spot.numPlayers));
+	
+	//Combos are indexed in order of their high card, then their low card.
+	uint16_t permutedCombos[NUM_COMBOS];
+	uint32_t combo = 0;
+	for (uint8_t high = 1; high < 52; high++)
+	{
+		for (uint8_t low = 0; low < high; low++)
+			permutedCombos[combo++] = static_cast<uint16_t>(GetComboIndex(MapCard(high), MapCard(low)));
+	}
+	
+	permutedWeights.resize(NUM_COMBOS);
+	for (uint32_t p = 0; p < spot.numPlayers; p++)
+	{
+		for (combo = 0; combo < NUM_COMBOS; combo++)
+			permutedWeights[permutedCombos[combo]] = weights[p * NUM_COMBOS + combo];
+		hash.Add(permutedWeights.data(), NUM_COMBOS * sizeof(float));
+	}
+	
+	uint8_t board[5];
+	std::transform(spot.board, spot.board + spot.numBoardCards, board, MapCard);
+	std::sort(board, board + spot.numBoardCards);
+	hash.Add(&spot.numBoardCards, sizeof(spot.numBoardCards));
+	hash.Add(board, spot.numBoardCards);
+	
+	uint64_t knownCards = 0;
+	for (uint8_t card = 0; card < 52; card++)
+	{
+		if (spot.knownCards & (1ull << card))
+			knownCards |= 1ull << MapCard(card);
+	}
+	hash.Add(&knownCards, sizeof(knownCards));
+	
+	return hash.value;
+}
+
+//Hashes everything about one suit which does not depend on how the other suits are numbered: the weights of the
+// suited combos, the weights of the offsuit combos sorted over the other suits, and the suit's board and known
+// cards. Suits are only permuted among those with equal signatures.
+static uint64_t GetSuitSignature(const float* weights, const RangeSpot& spot, uint8_t suit)
+{
+	SpotHash hash;
+	for (uint32_t p = 0; p < spot.numPlayers; p++)
+	{
+		const float* playerWeights = weights + p * NUM_COMBOS;
+		for (uint8_t highRank = 1; highRank < 13; highRank++)
+		{
+			for (uint8_t lowRank = 0; lowRank < highRank; lowRank++)
+			{
+				const float weight = playerWeights[GetComboIndex(highRank * 4 + suit, lowRank * 4 + suit)];
+				hash.Add(&weight, sizeof(weight));
+			}
+		}
+		
+		for (uint8_t rank = 0; rank < 13; rank++)
+		{
+			for (uint8_t otherRank = 0; otherRank < 13; otherRank++)
+			{
+				float offsuitWeights[3];
+				uint32_t numOffsuit = 0;
+				for (uint8_t otherSuit = 0; otherSuit < 4; otherSuit++)
+				{
+					if (otherSuit != suit)
+						offsuitWeights[numOffsuit++] = playerWeights[GetComboIndex(rank * 4 + suit, otherRank * 4 + otherSuit)];
+				}
+				std::sort(offsuitWeights, offsuitWeights + 3);
+				hash.Add(offsuitWeights, sizeof(offsuitWeights));
+			}
+		}
+	}
+	
+	uint16_t boardRanks = 0;
+	for (uint32_t i = 0; i < spot.numBoardCards; i++)
+	{
+		if ((spot.board[i] & 3) == suit)
+			boardRanks |= 1 << (spot.board[i] / 4);
+	}
+	
+	uint16_t knownRanks = 0;
+	for (uint8_t rank = 0; rank < 13; rank++)
+	{
+		if (spot.knownCards & (1ull << (rank * 4 + suit)))
+			knownRanks |= 1 << rank;
+	}
+	
+	hash.Add(&boardRanks, sizeof(boardRanks));
+	hash.Add(&knownRanks, sizeof(knownRanks));
+	return hash.value;
+}
+
+bool MakeRangeSpot(const float* weights, uint32_t numPlayers, const uint8_t* board, uint32_t numBoardCards,
+                   const uint8_t* deadCards, uint32_t numDeadCards, RangeSpot& spot)
+{
+	if (numPlayers < 2 || numPlayers > MAX_EQUITY_PLAYERS)
+		Panic("Equity calculations need between 2 and 8 players.");
+	if (numBoardCards > 5)
+		Panic("Too many board cards for equity calculation.");
+	
+	spot.numPlayers = numPlayers;
+	spot.numBoardCards = numBoardCards;
+	spot.knownCards = 0;
+	
+	auto UseCard = [&] (uint8_t card)
+	{
+		if (card >= 52 || (spot.knownCards & (1ull << card)))
+			Panic("Invalid or repeated card in equity calculation.");
+		spot.knownCards |= 1ull << card;
+	};
+	
+	for (uint32_t i = 0; i < numBoardCards; i++)
+	{
+		spot.board[i] = board[i];
+		UseCard(board[i]);
+	}
+	for (uint32_t i = 0; i < numDeadCards; i++)
+		UseCard(deadCards[i]);
+	
+	for (uint32_t p = 0; p < numPlayers; p++)
+	{
+		std::vector<float> comboWeights;
+		for (uint8_t high = 1; high < 52; high++)
+		{
+			for (uint8_t low = 0; low < high; low++)
+			{
+				const float weight = weights[p * NUM_COMBOS + GetComboIndex(high, low)];
+				const uint64_t comboMask = (1ull << high) | (1ull << low);
+				if (weight <= 0 || (spot.knownCards & comboMask))
+					continue;
+				
+				spot.ranges[p].combos.push_back(high);
+				spot.ranges[p].combos.push_back(low);
+				comboWeights.push_back(weight);
+			}
+		}
+		
+		if (comboWeights.empty())
+			return false;
+		BuildAliasTable(comboWeights, spot.ranges[p]);
+	}
+	
+	//Suits are numbered in order of their signatures, which leaves only the order of suits with equal signatures
+	// to choose. Of those orders the one with the lowest hash is taken, so that the key is the same however the spot's
+	// suits were numbered. Hashing each order costs as much as serializing the ranges, so spots without symmetric
+	// suits only hash one.
+	uint64_t signatures[4];
+	uint8_t bySignature[4] = { 0, 1, 2, 3 };
+	for (uint8_t suit = 0; suit < 4; suit++)
+		signatures[suit] = GetSuitSignature(weights, spot, suit);
+	std::sort(bySignature, bySignature + 4, [&] (uint8_t a, uint8_t b) { return signatures[a] < signatures[b]; });
+	
+	std::vector<float> permutedWeights;
+	uint64_t hash = UINT64_MAX;
+	uint8_t order[4] = { 0, 1, 2, 3 };
+	do
+	{
+		bool sorted = true;
+		for (uint32_t i = 0; i + 1 < 4; i++)
+			sorted &= signatures[bySignature[order[i]]] <= signatures[bySignature[order[i + 1]]];
+		if (!sorted)
+			continue;
+		
+		uint8_t suits[4];
+		for (uint8_t i = 0; i < 4; i++)
+			suits[bySignature[order[i]]] = i;
+		hash = std::min(hash, HashRangeSpot(weights, spot, suits, permutedWeights));
+	}
+	while (std::next_permutation(order, order + 4));
+	
+	spot.canonicalKey = "R";
+	spot.canonicalKey.append(reinterpret_cast<const char*>(&hash), sizeof(hash));
+	
+	return true;
+}
+
+bool SampleRangeDeals(const RangeSpot& spot, uint32_t numDeals, Xoshiro256& random, EquityTally& tally)
+{
+	uint8_t hands[MAX_EQUITY_PLAYERS][7];
+	for (uint32_t p = 0; p < spot.numPlayers; p++)
+		std::copy(spot.board, spot.board + spot.numBoardCards, hands[p] + 2);
+	
+	const uint32_t numMissingBoard = 5 - spot.numBoardCards;
+	
+	for (uint32_t deal = 0; deal < numDeals; deal++)
+	{
+		uint64_t usedCards;
+		uint32_t attempt = 0;
+		for (; attempt < MAX_DEAL_ATTEMPTS; attempt++)
+		{
+			usedCards = spot.knownCards;
+			uint32_t p = 0;
+			for (; p < spot.numPlayers; p++)
+			{
+				const RangeSpot::Range& range = spot.ranges[p];
+				const uint32_t numCombos = static_cast<uint32_t>(range.aliases.size());
+				
+				const uint32_t slot = random.NextBelow(numCombos);
+				const float coin = (random.Next() >> 40) * (1.0f / (1 << 24));
+				const uint32_t combo = coin < range.probabilities[slot] ? slot : range.aliases[slot];
+				
+				const uint64_t comboMask = (1ull << range.combos[combo * 2]) | (1ull << range.combos[combo * 2 + 1]);
+				if (usedCards & comboMask)
+					break;
+				
+				usedCards |= comboMask;
+				hands[p][0] = range.combos[combo * 2];
+				hands[p][1] = range.combos[combo * 2 + 1];
+			}
+			
+			if (p == spot.numPlayers)
+				break;
+		}
+		
+		if (attempt == MAX_DEAL_ATTEMPTS)
+			return false;
+		
+		//Completes the board by partially shuffling the cards nobody holds.
+		uint8_t deck[52];
+		uint32_t deckSize = 0;
+		for (uint8_t card = 0; card < 52; card++)
+		{
+			if (!(usedCards & (1ull << card)))
+				deck[deckSize++] = card;
+		}
+		
+		for (uint32_t i = 0; i < numMissingBoard; i++)
+		{
+			std::swap(deck[i], deck[i + random.NextBelow(deckSize - i)]);
+			for (uint32_t p = 0; p < spot.numPlayers; p++)
+				hands[p][2 + spot.numBoardCards + i] = deck[i];
+		}
+		
+		TallyDeal(hands, spot.numPlayers, tally);
+	}
+	
+	return true;
+}
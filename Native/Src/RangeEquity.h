@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Equity.h"
+#include "Random.h"
+
+#include <cstdint>
+#include <vector>
+#include <string>
+
+//Number of distinct pairs of hole cards.
+static const uint32_t NUM_COMBOS = 1326;
+
+//Ranges are given as one weight per combo, in the order of this index.
+inline uint32_t GetComboIndex(uint8_t card1, uint8_t card2)
+{
+	const uint32_t high = card1 > card2 ? card1 : card2;
+	const uint32_t low = card1 > card2 ? card2 : card1;
+	return high * (high - 1) / 2 + low;
+}
+
+//A spot where every player holds a weighted range of hands. Combos which clash with the board or dead cards are
+// left out of the ranges.
+struct RangeSpot
+{
+	uint32_t numPlayers;
+	uint32_t numBoardCards;
+	uint8_t board[5];
+	uint64_t knownCards;
+	
+	//Combos of each player with alias tables, which draw a combo in proportion to its weight in constant time.
+	struct Range
+	{
+		std::vector<uint8_t> combos;
+		std::vector<float> probabilities;
+		std::vector<uint32_t> aliases;
+	};
+	Range ranges[MAX_EQUITY_PLAYERS];
+	
+	//Identical for spots that only differ by a permutation of suits.
+	std::string canonicalKey;
+};
+
+//weights holds NUM_COMBOS weights for each player. Returns false if a player's range is empty, which happens when
+// the board and dead cards remove all of its combos.
+bool MakeRangeSpot(const float* weights, uint32_t numPlayers, const uint8_t* board, uint32_t numBoardCards,
+                   const uint8_t* deadCards, uint32_t numDeadCards, RangeSpot& spot);
+
+//Deals combos from the players' ranges and completes the board. Deals in which players' combos share a card are
+// redrawn as a whole, so each deal is as likely as the product of its combos' weights. Returns false if the ranges
+// clash so much that no deal could be found.
+bool SampleRangeDeals(const RangeSpot& spot, uint32_t numDeals, Xoshiro256& random, EquityTally& tally);
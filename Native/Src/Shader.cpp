@@ -14,7 +14,13 @@ Shader::~Shader()
 
 void Shader::AttachStage(StageType stageType, const char* code)
 {
-	GLenum glType = stageType == StageType::Vertex ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER;
+	GLenum glType = GL_VERTEX_SHADER;
+	switch (stageType)
+	{
+	case StageType::Vertex: glType = GL_VERTEX_SHADER; break;
+	case StageType::Fragment: glType = GL_FRAGMENT_SHADER; break;
+	case StageType::Compute: glType = GL_COMPUTE_SHADER; break;
+	}
 	
 	AttachShader(m_program, glType, code);
 }
@@ -9,7 +9,8 @@ public:
 	enum class StageType : int32_t
 	{
 		Vertex = 0,
-		Fragment = 1
+		Fragment = 1,
+		Compute = 2
 	};
 	
 	Shader();
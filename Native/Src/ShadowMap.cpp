@@ -1,4 +1,5 @@
 #include "API.h"
+#include "ShadowMap.h"
 
 #include <GL/glew.h>
 #include <cstdint>
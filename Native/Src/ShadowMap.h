@@ -0,0 +1,12 @@
+#pragma once
+
+#include "API.h"
+
+#include <cstdint>
+
+class ShadowMap;
+
+CS_VISIBLE ShadowMap* SM_Create(uint32_t resolution);
+CS_VISIBLE void SM_Destroy(ShadowMap* shadowMap);
+CS_VISIBLE void SM_BindFramebuffer(ShadowMap* shadowMap);
+CS_VISIBLE void SM_BindTexture(ShadowMap* shadowMap, uint32_t unit);
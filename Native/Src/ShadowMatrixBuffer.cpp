@@ -1,4 +1,5 @@
 #include "API.h"
+#include "ShadowMatrixBuffer.h"
 
 #include <GL/glew.h>
 #include <cstdint>
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "API.h"
+
+#include <cstdint>
+
+class ShadowMatrixBuffer;
+
+CS_VISIBLE ShadowMatrixBuffer* SMB_Create(float* matrixPtr);
+CS_VISIBLE void SMB_Destroy(ShadowMatrixBuffer* buffer);
+CS_VISIBLE void SMB_Bind(ShadowMatrixBuffer* buffer, uint32_t unit);
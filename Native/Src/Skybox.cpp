@@ -69,4 +69,5 @@ CS_VISIBLE void SKY_Draw(Shader* shader)
 	glBindVertexArray(g_skyboxVAO);
 	
 	glDrawArrays(GL_TRIANGLES, 0, 3);
+	DrawCallCount++;
 }
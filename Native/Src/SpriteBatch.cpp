@@ -2,6 +2,7 @@
 #include "Utils.h"
 #include "Texture2D.h"
 #include "Graphics.h"
+#include "SpriteBatch.h"
 
 #include <GL/glew.h>
 #include <vector>
@@ -53,19 +54,6 @@ struct Vertex
 	float v;
 	uint8_t color[4];
 };
-
-struct Sprite
-{
-	float x;
-	float y;
-	float width;
-	float height;
-	float srcX;
-	float srcY;
-	float srcWidth;
-	float srcHeight;
-	uint8_t color[4];
-};
 #pragma pack(pop)
 
 class SpriteBatch
@@ -245,6 +233,7 @@ public:
 			const uint32_t firstIndex = textureEntry.m_firstIndex + frame.m_indexPos;
 			glDrawElementsBaseVertex(GL_TRIANGLES, textureEntry.m_numIndices, GL_UNSIGNED_INT,
 			                         reinterpret_cast<void*>(sizeof(uint32_t) * firstIndex), frame.m_vertexPos);
+			DrawCallCount++;
 		}
 		
 		frame.m_vertexPos = newVertexPos;
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "API.h"
+#include "Texture2D.h"
+
+#include <cstdint>
+
+#pragma pack(push, 1)
+struct Sprite
+{
+	float x;
+	float y;
+	float width;
+	float height;
+	float srcX;
+	float srcY;
+	float srcWidth;
+	float srcHeight;
+	uint8_t color[4];
+};
+#pragma pack(pop)
+
+class SpriteBatch;
+
+CS_VISIBLE SpriteBatch* SB_Create();
+CS_VISIBLE void SB_Destroy(SpriteBatch* spriteBatch);
+CS_VISIBLE void SB_SetDisplaySize(SpriteBatch* spriteBatch, float displayWidth, float displayHeight);
+CS_VISIBLE void SB_Begin(SpriteBatch* spriteBatch);
+CS_VISIBLE void SB_End(SpriteBatch* spriteBatch);
+CS_VISIBLE void SB_Draw(SpriteBatch* spriteBatch, const Texture2D* texture, const Sprite* sprite);
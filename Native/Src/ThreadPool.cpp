@@ -0,0 +1,103 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+//The pool and worker index of the current thread, if it is a pool worker.
+static thread_local ThreadPool* currentPool = nullptr;
+static thread_local uint32_t currentWorkerIndex = 0;
+
+ThreadPool::ThreadPool(uint32_t numWorkers)
+{
+	numWorkers = std::max(numWorkers, 1u);
+	for (uint32_t i = 0; i < numWorkers; i++)
+		m_workers.emplace_back(new Worker);
+	
+	//Threads are started once all queues exist, since workers steal from each other straight away.
+	for (uint32_t i = 0; i < numWorkers; i++)
+		m_workers[i]->thread = std::thread(&ThreadPool::RunWorker, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_stop = true;
+	}
+	m_wakeCondition.notify_all();
+	
+	for (std::unique_ptr<Worker>& worker : m_workers)
+		worker->thread.join();
+}
+
+ThreadPool& ThreadPool::GetShared()
+{
+	static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+	return pool;
+}
+
+void ThreadPool::Submit(Task task)
+{
+	//Tasks from outside the pool are spread over the workers round robin.
+	const uint32_t queueIndex = currentPool == this ? currentWorkerIndex :
+		m_nextExternalQueue.fetch_add(1, std::memory_order_relaxed) % GetNumWorkers();
+	
+	//Counted before it is queued, so that the count never drops below zero when a worker takes it right away.
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_numQueued++;
+	}
+	
+	{
+		std::lock_guard<std::mutex> lock(m_workers[queueIndex]->mutex);
+		m_workers[queueIndex]->tasks.push_back(std::move(task));
+	}
+	m_wakeCondition.notify_one();
+}
+
+bool ThreadPool::TryTake(uint32_t workerIndex, Task& task)
+{
+	for (uint32_t i = 0; i < GetNumWorkers(); i++)
+	{
+		Worker& worker = *m_workers[(workerIndex + i) % GetNumWorkers()];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (worker.tasks.empty())
+			continue;
+		
+		if (i == 0)
+		{
+			task = std::move(worker.tasks.back());
+			worker.tasks.pop_back();
+		}
+		else
+		{
+			task = std::move(worker.tasks.front());
+			worker.tasks.pop_front();
+		}
+		
+		std::lock_guard<std::mutex> sleepLock(m_sleepMutex);
+		m_numQueued--;
+		return true;
+	}
+	return false;
+}
+
+void ThreadPool::RunWorker(uint32_t workerIndex)
+{
+	currentPool = this;
+	currentWorkerIndex = workerIndex;
+	
+	while (true)
+	{
+		Task task;
+		if (TryTake(workerIndex, task))
+		{
+			task(workerIndex);
+			continue;
+		}
+		
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_wakeCondition.wait(lock, [&] { return m_stop || m_numQueued != 0; });
+		if (m_stop && m_numQueued == 0)
+			return;
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <atomic>
+
+//Runs tasks on a fixed set of worker threads. Each worker has its own queue. Tasks submitted from a worker go to the
+// back of its own queue, which it runs newest first, and workers that run out of tasks steal the oldest tasks
+// from the others.
+class ThreadPool
+{
+public:
+	//Tasks receive the index of the worker running them, so they can use per worker state without locking.
+	using Task = std::function<void(uint32_t workerIndex)>;
+	
+	explicit ThreadPool(uint32_t numWorkers);
+	
+	//Runs the remaining queued tasks before returning.
+	~ThreadPool();
+	
+	void Submit(Task task);
+	
+	uint32_t GetNumWorkers() const
+	{
+		return static_cast<uint32_t>(m_workers.size());
+	}
+	
+	//Pool for background computations, which leaves one core for the render thread.
+	static ThreadPool& GetShared();
+	
+private:
+	struct Worker
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+		std::thread thread;
+	};
+	
+	bool TryTake(uint32_t workerIndex, Task& task);
+	void RunWorker(uint32_t workerIndex);
+	
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	
+	//Queued tasks across all workers. Only changed while holding m_sleepMutex, so workers can not miss a wake up.
+	std::atomic<uint32_t> m_numQueued { 0 };
+	std::mutex m_sleepMutex;
+	std::condition_variable m_wakeCondition;
+	bool m_stop = false;
+	
+	std::atomic<uint32_t> m_nextExternalQueue { 0 };
+};
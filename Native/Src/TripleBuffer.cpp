@@ -0,0 +1,87 @@
+#include "API.h"
+#include "Utils.h"
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+//Passes snapshots of a fixed size from one writer thread to one reader thread without locking. The writer always
+// has a slot to write to and the reader always gets the most recently published snapshot, so neither waits on the other.
+class TripleBuffer
+{
+public:
+	explicit TripleBuffer(size_t snapshotSize)
+		: m_slotSize(RoundToNextMultiple<size_t>(snapshotSize, CACHE_LINE_SIZE)),
+		  m_storage(m_slotSize * 3 + CACHE_LINE_SIZE)
+	{
+		//Aligns the slots to cache lines so that the writer and reader do not false share.
+		const uintptr_t storageAddress = reinterpret_cast<uintptr_t>(m_storage.data());
+		m_slots = m_storage.data() + (RoundToNextMultiple<uintptr_t>(storageAddress, CACHE_LINE_SIZE) - storageAddress);
+	}
+	
+	void* GetWriteSlot()
+	{
+		return m_slots + m_slotSize * m_writeIndex;
+	}
+	
+	void Publish()
+	{
+		const uint32_t previous = m_middle.exchange(m_writeIndex | FRESH_BIT, std::memory_order_acq_rel);
+		m_writeIndex = previous & INDEX_MASK;
+	}
+	
+	//Returns the latest published snapshot. The pointer stays valid until the next call.
+	const void* AcquireLatest()
+	{
+		if (m_middle.load(std::memory_order_relaxed) & FRESH_BIT)
+		{
+			const uint32_t previous = m_middle.exchange(m_readIndex, std::memory_order_acq_rel);
+			m_readIndex = previous & INDEX_MASK;
+			m_hasSnapshot = true;
+		}
+		
+		return m_hasSnapshot ? m_slots + m_slotSize * m_readIndex : nullptr;
+	}
+	
+private:
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+	static constexpr uint32_t INDEX_MASK = 3;
+	static constexpr uint32_t FRESH_BIT = 4;
+	
+	size_t m_slotSize;
+	std::vector<char> m_storage;
+	char* m_slots;
+	
+	//The slot which is neither being written nor read, and whether it holds a snapshot the reader has not seen.
+	std::atomic<uint32_t> m_middle { 1 };
+	
+	//Writer and reader indices are padded apart, so each thread only touches its own cache line.
+	char m_padding1[CACHE_LINE_SIZE];
+	uint32_t m_writeIndex = 0;
+	char m_padding2[CACHE_LINE_SIZE];
+	uint32_t m_readIndex = 2;
+	bool m_hasSnapshot = false;
+};
+
+// C# Bindings
+CS_VISIBLE TripleBuffer* TB_Create(uint64_t snapshotSize)
+{
+	return new TripleBuffer(snapshotSize);
+}
+
+CS_VISIBLE void TB_Destroy(TripleBuffer* buffer) { delete buffer; }
+
+CS_VISIBLE void* TB_GetWriteSlot(TripleBuffer* buffer)
+{
+	return buffer->GetWriteSlot();
+}
+
+CS_VISIBLE void TB_Publish(TripleBuffer* buffer)
+{
+	buffer->Publish();
+}
+
+CS_VISIBLE const void* TB_AcquireLatest(TripleBuffer* buffer)
+{
+	return buffer->AcquireLatest();
+}
@@ -3,6 +3,7 @@
 
 #include "API.h"
 #include "Utils.h"
+#include "UniformBuffer.h"
 
 struct UniformBuffer
 {
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "API.h"
+
+#include <cstdint>
+
+struct UniformBuffer;
+
+CS_VISIBLE UniformBuffer* UB_Create(uint64_t size);
+CS_VISIBLE void UB_Destroy(UniformBuffer* uniformBuffer);
+CS_VISIBLE void* UB_GetMapping(UniformBuffer* uniformBuffer);
+CS_VISIBLE void UB_Flush(UniformBuffer* uniformBuffer);
+CS_VISIBLE void UB_Bind(UniformBuffer* uniformBuffer, uint32_t unit);
@@ -1,8 +1,10 @@
 #include "Utils.h"
 #include <iostream>
 
+uint32_t QueuedFrames = 3;
 uint32_t FrameQueueIndex = 0;
 uint32_t FrameIndex = 0;
+uint32_t DrawCallCount = 0;
 
 GLint UniformBufferOffsetAlignment = 0;
 GLint SSBOOffsetAlignment = 0;
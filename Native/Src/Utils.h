@@ -4,11 +4,16 @@
 #include <cmath>
 #include <algorithm>
 
-constexpr uint32_t MAX_QUEUED_FRAMES = 3;
+//Per frame resources are allocated for this many frames, of which the first QueuedFrames are used.
+constexpr uint32_t MAX_QUEUED_FRAMES = 4;
 
+extern uint32_t QueuedFrames;
 extern uint32_t FrameQueueIndex;
 extern uint32_t FrameIndex;
 
+//Number of draw commands submitted since startup. Multi draws count once.
+extern uint32_t DrawCallCount;
+
 extern GLint UniformBufferOffsetAlignment;
 extern GLint SSBOOffsetAlignment;
 
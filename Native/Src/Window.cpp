@@ -1,11 +1,17 @@
 #include "API.h"
 #include "Utils.h"
 #include "Graphics.h"
+#include "Latency.h"
+#include "InputLog.h"
+#include "FrameCapture.h"
 #include "stb_image.h"
 
 #include <iostream>
 #include <chrono>
-#include <cstring>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
 #include <SDL2/SDL.h>
 #include <GL/glew.h>
 
@@ -30,12 +36,13 @@ void GLAPIENTRY OpenGLMessageCallback(GLenum, GLenum type, GLuint id, GLenum sev
 extern int32_t MouseWheelX;
 extern int32_t MouseWheelY;
 
+void RecordInputEvent(const SDL_Event& event);
+
 using InitCallback = void(*)();
 using CloseCallback = void(*)();
 using FrameCallback = void(*)(float dt);
 using ResizeCallback = void(*)(int width, int height);
-using TextInputCallback = void(*)(char* utf8String, int32_t byteLength);
-using KeyPressCallback = void(*)(int32_t key);
+using SimulationCallback = void(*)(float dt);
 
 static bool shouldExit = false;
 
@@ -44,9 +51,183 @@ CS_VISIBLE void ExitGame()
 	shouldExit = true;
 }
 
+static SimulationCallback simulationCallback = nullptr;
+static float simulationRate = 60;
+
+//Runs callback on its own thread at a fixed rate while the game is running. Must be called before RunGame.
+// The simulation hands its results to the frame callback through a TripleBuffer, so neither thread waits on the other.
+CS_VISIBLE void SetSimulationThread(SimulationCallback callback, float rate)
+{
+	simulationCallback = callback;
+	simulationRate = rate;
+}
+
+static void RunSimulation(SimulationCallback callback, float rate, const std::atomic<bool>& stop)
+{
+	using Clock = std::chrono::steady_clock;
+	const Clock::duration step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+	
+	//After a long stall the simulation drops the missed steps instead of trying to catch up with all of them.
+	const int MAX_CATCH_UP_STEPS = 5;
+	
+	Clock::time_point nextStepTime = Clock::now();
+	while (!stop.load(std::memory_order_relaxed))
+	{
+		callback(1.0f / rate);
+		
+		nextStepTime += step;
+		const Clock::time_point now = Clock::now();
+		if (now - nextStepTime > step * MAX_CATCH_UP_STEPS)
+			nextStepTime = now;
+		
+		std::this_thread::sleep_until(nextStepTime);
+	}
+}
+
+enum class FramePacing : int32_t
+{
+	Uncapped = 0,
+	VSync = 1,
+	AdaptiveVSync = 2,
+	FrameCap = 3,
+	JustInTime = 4
+};
+
+static FramePacing framePacing = FramePacing::Uncapped;
+static float framePacingTargetFPS = 60;
+static bool framePacingChanged = false;
+
+//Selects how the main loop paces frames. targetFPS is only used by FrameCap. AdaptiveVSync tears instead of
+// waiting a whole refresh when a frame is late, and falls back to regular vsync where it is not supported.
+// JustInTime uses vsync and delays input sampling until just before the predicted start of the next frame.
+CS_VISIBLE void SetFramePacing(FramePacing pacing, float targetFPS)
+{
+	framePacing = pacing;
+	framePacingTargetFPS = targetFPS;
+	framePacingChanged = true;
+}
+
+static bool windowOccluded = false;
+static bool windowFocused = true;
+static bool redrawRequired = true;
+static bool presentSkipped = false;
+
+//True while the window is minimized or hidden. The frame callback should skip drawing and call SkipPresent.
+// Never true during replays, which draw every frame so that their timings are comparable between runs.
+CS_VISIBLE bool IsWindowOccluded()
+{
+	return windowOccluded && !IsReplayingInput();
+}
+
+//True if any event arrived since the last presented frame, which may have changed what should be on screen.
+CS_VISIBLE bool IsRedrawRequired()
+{
+	return redrawRequired || IsReplayingInput();
+}
+
+//Called from the frame callback when nothing was drawn. The previous frame stays on screen and the main loop sleeps
+// until the next event or the idle timeout, instead of spinning.
+CS_VISIBLE void SkipPresent()
+{
+	presentSkipped = true;
+}
+
+using PacingClock = std::chrono::steady_clock;
+
+#pragma pack(push, 1)
+struct FrameQueueStats
+{
+	uint64_t frames;
+	uint64_t blockedFrames;
+	float totalWaitMS;
+	float maxWaitMS;
+	uint32_t queueDepth;
+};
+#pragma pack(pop)
+
+static FrameQueueStats frameQueueStats = { };
+static uint32_t requestedQueuedFrames = 0;
+
+//Sets how many frames the CPU may run ahead of the GPU, from 1 (lowest latency) to MAX_QUEUED_FRAMES (highest
+// throughput). Takes effect at the start of the next frame.
+CS_VISIBLE void SetFrameQueueDepth(uint32_t depth)
+{
+	requestedQueuedFrames = std::min(std::max(depth, 1u), MAX_QUEUED_FRAMES);
+}
+
+//blockedFrames counts the frames where the CPU had to wait for the GPU before it could reuse a frame's resources.
+CS_VISIBLE FrameQueueStats GetFrameQueueStats()
+{
+	FrameQueueStats stats = frameQueueStats;
+	stats.queueDepth = QueuedFrames;
+	return stats;
+}
+
+CS_VISIBLE void ResetFrameQueueStats()
+{
+	frameQueueStats = { };
+}
+
+//Waits recorded in the frame queue stats are those of frames which found their resources still in use by the GPU.
+static void WaitForFence(GLsync& fence, bool recordWait)
+{
+	if (fence == nullptr)
+		return;
+	
+	if (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED)
+	{
+		const PacingClock::time_point waitStartTime = PacingClock::now();
+		glClientWaitSync(fence, 0, UINT64_MAX);
+		const float waitMS = std::chrono::duration<float, std::milli>(PacingClock::now() - waitStartTime).count();
+		
+		if (recordWait)
+		{
+			frameQueueStats.blockedFrames++;
+			frameQueueStats.totalWaitMS += waitMS;
+			frameQueueStats.maxWaitMS = std::max(frameQueueStats.maxWaitMS, waitMS);
+		}
+	}
+	
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+//Sleeps for most of the duration and spins for the rest, since sleeps can overshoot by more than a millisecond.
+static void PreciseSleepUntil(PacingClock::time_point deadline)
+{
+	const PacingClock::duration SPIN_DURATION = std::chrono::milliseconds(2);
+	
+	if (deadline - PacingClock::now() > SPIN_DURATION)
+		std::this_thread::sleep_until(deadline - SPIN_DURATION);
+	while (PacingClock::now() < deadline)
+		std::this_thread::yield();
+}
+
+static PacingClock::duration ApplyFramePacing(SDL_Window* window)
+{
+	int swapInterval = 0;
+	switch (framePacing)
+	{
+	case FramePacing::Uncapped: swapInterval = 0; break;
+	case FramePacing::VSync: swapInterval = 1; break;
+	case FramePacing::AdaptiveVSync: swapInterval = -1; break;
+	case FramePacing::FrameCap: swapInterval = 0; break;
+	case FramePacing::JustInTime: swapInterval = 1; break;
+	}
+	
+	if (SDL_GL_SetSwapInterval(swapInterval) != 0 && swapInterval == -1)
+		SDL_GL_SetSwapInterval(1);
+	
+	//Returns the refresh period, which just in time pacing predicts the next frame's start from.
+	SDL_DisplayMode displayMode;
+	int refreshRate = 60;
+	if (SDL_GetWindowDisplayMode(window, &displayMode) == 0 && displayMode.refresh_rate > 0)
+		refreshRate = displayMode.refresh_rate;
+	return std::chrono::duration_cast<PacingClock::duration>(std::chrono::duration<double>(1.0 / refreshRate));
+}
+
 CS_VISIBLE void RunGame(InitCallback initCallback, CloseCallback closeCallback,
-                        FrameCallback frameCallback, ResizeCallback resizeCallback,
-                        TextInputCallback textInputCallback, KeyPressCallback keyPressCallback)
+                        FrameCallback frameCallback, ResizeCallback resizeCallback)
 {
 	if (SDL_Init(SDL_INIT_VIDEO))
 		return;
@@ -117,36 +298,87 @@ CS_VISIBLE void RunGame(InitCallback initCallback, CloseCallback closeCallback,
 	
 	stbi_set_unpremultiply_on_load(true);
 	
+	//Replays resize the window to the recorded size, so the size is read back before the game is initialized.
+	BeginInputLog(window);
+	int initialWidth, initialHeight;
+	SDL_GetWindowSize(window, &initialWidth, &initialHeight);
+	
 	initCallback();
-	resizeCallback(winWidth, winHeight);
-	DisplayWidth = winWidth;
-	DisplayHeight = winHeight;
+	resizeCallback(initialWidth, initialHeight);
+	glViewport(0, 0, initialWidth, initialHeight);
+	DisplayWidth = initialWidth;
+	DisplayHeight = initialHeight;
 	
 	using Clock = std::chrono::high_resolution_clock;
 	Clock::duration lastFrameTime(0);
 	
 	GLsync fences[MAX_QUEUED_FRAMES] = { };
 	
+	//The swap interval is left at the driver's default until a pacing mode is selected.
+	PacingClock::duration refreshPeriod(0);
+	PacingClock::time_point lastSwapTime = PacingClock::now();
+	PacingClock::duration predictedFrameWork(0);
+	PacingClock::time_point nextFrameDeadline = lastSwapTime;
+	
+	std::atomic<bool> stopSimulation(false);
+	std::thread simulationThread;
+	if (simulationCallback != nullptr)
+		simulationThread = std::thread(RunSimulation, simulationCallback, simulationRate, std::cref(stopSimulation));
+	
 	shouldExit = false;
 	while (!shouldExit)
 	{
 		Clock::time_point frameStartTime = Clock::now();
 		float dt = lastFrameTime.count() * 1E-9f;
 		
-		SDL_Event event;
-		while (SDL_PollEvent(&event))
+		if (framePacingChanged)
+		{
+			refreshPeriod = ApplyFramePacing(window);
+			framePacingChanged = false;
+		}
+		
+		//Changing the depth changes which page each frame uses, so all queued frames must have finished first.
+		if (requestedQueuedFrames != 0 && requestedQueuedFrames != QueuedFrames)
 		{
+			for (GLsync& fence : fences)
+				WaitForFence(fence, false);
+			QueuedFrames = requestedQueuedFrames;
+			FrameQueueIndex = FrameIndex % QueuedFrames;
+		}
+		requestedQueuedFrames = 0;
+		
+		//Waits for the GPU before input is sampled, so that the wait does not add to input latency.
+		WaitForFence(fences[FrameQueueIndex], true);
+		
+		if (framePacing == FramePacing::JustInTime)
+		{
+			const PacingClock::duration SAFETY_MARGIN = std::chrono::milliseconds(1);
+			PreciseSleepUntil(lastSwapTime + refreshPeriod - predictedFrameWork - SAFETY_MARGIN);
+		}
+		
+		const PacingClock::time_point workStartTime = PacingClock::now();
+		
+		static std::vector<SDL_Event> events;
+		events.clear();
+		SDL_Event polledEvent;
+		while (SDL_PollEvent(&polledEvent))
+			events.push_back(polledEvent);
+		
+		if (!ProcessFrameInput(dt, events))
+			break;
+		
+		for (const SDL_Event& event : events)
+		{
+			redrawRequired = true;
+			
+			//Input events are queued and drained by managed code once per frame, see DrainInputEvents.
+			RecordInputEvent(event);
+			
 			switch (event.type)
 			{
 			case SDL_QUIT:
 				shouldExit = true;
 				break;
-			case SDL_TEXTINPUT:
-				textInputCallback(event.text.text, std::strlen(event.text.text));
-				break;
-			case SDL_KEYDOWN:
-				keyPressCallback(event.key.keysym.scancode);
-				break;
 			case SDL_MOUSEWHEEL:
 				MouseWheelX += event.wheel.x;
 				MouseWheelY += event.wheel.y;
@@ -160,29 +392,94 @@ CS_VISIBLE void RunGame(InitCallback initCallback, CloseCallback closeCallback,
 					DisplayWidth = event.window.data1;
 					DisplayHeight = event.window.data2;
 					break;
+				case SDL_WINDOWEVENT_MINIMIZED:
+				case SDL_WINDOWEVENT_HIDDEN:
+					windowOccluded = true;
+					break;
+				case SDL_WINDOWEVENT_SHOWN:
+				case SDL_WINDOWEVENT_RESTORED:
+				case SDL_WINDOWEVENT_MAXIMIZED:
+				case SDL_WINDOWEVENT_EXPOSED:
+					windowOccluded = false;
+					break;
+				case SDL_WINDOWEVENT_FOCUS_GAINED:
+					windowFocused = true;
+					break;
+				case SDL_WINDOWEVENT_FOCUS_LOST:
+					windowFocused = false;
+					break;
 				}
 				break;
 			}
 		}
 		
-		if (fences[FrameQueueIndex])
+		presentSkipped = false;
+		frameCallback(dt);
+		
+		if (presentSkipped)
 		{
-			glClientWaitSync(fences[FrameQueueIndex], GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
-			glDeleteSync(fences[FrameQueueIndex]);
+			LatencyFrameSkipped();
+			FrameCaptureSkipped();
+			
+			//Keeps updating at a low rate, so that network activity can still change the game state.
+			const int IDLE_WAIT_MS = 100;
+			SDL_WaitEventTimeout(nullptr, IDLE_WAIT_MS);
+			
+			lastFrameTime = Clock::now() - frameStartTime;
+			continue;
 		}
 		
-		frameCallback(dt);
+		//The prediction follows increases in work immediately and decays slowly, so one fast frame does not
+		// cause the next slow one to miss the refresh.
+		const PacingClock::duration frameWork = PacingClock::now() - workStartTime;
+		predictedFrameWork = std::max(frameWork, predictedFrameWork * 15 / 16);
 		
 		SDL_GL_SwapWindow(window);
+		lastSwapTime = PacingClock::now();
+		redrawRequired = false;
+		
+		LatencyFrameSubmitted();
 		
 		fences[FrameQueueIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 		
+		UpdateFrameCapture();
+		InputFramePresented();
+		
 		FrameIndex++;
-		FrameQueueIndex = FrameIndex % MAX_QUEUED_FRAMES;
+		FrameQueueIndex = FrameIndex % QueuedFrames;
+		frameQueueStats.frames++;
+		
+		if (framePacing == FramePacing::FrameCap && framePacingTargetFPS > 0)
+		{
+			//Deadlines advance by whole periods to keep a steady cadence, but are not allowed to fall behind.
+			nextFrameDeadline = std::max(nextFrameDeadline + std::chrono::duration_cast<PacingClock::duration>(
+				std::chrono::duration<double>(1.0 / framePacingTargetFPS)), PacingClock::now());
+			PreciseSleepUntil(nextFrameDeadline);
+		}
+		
+		//Windows in the background keep presenting, but at a reduced rate. Events still wake the loop immediately.
+		if (!windowFocused && !IsReplayingInput())
+		{
+			const float UNFOCUSED_FPS = 15;
+			const auto remaining = std::chrono::duration<float>(1.0f / UNFOCUSED_FPS) - (Clock::now() - frameStartTime);
+			const int remainingMS = static_cast<int>(remaining.count() * 1000);
+			if (remainingMS > 0)
+				SDL_WaitEventTimeout(nullptr, remainingMS);
+		}
 		
 		lastFrameTime = Clock::now() - frameStartTime;
 	}
 	
+	if (simulationThread.joinable())
+	{
+		stopSimulation = true;
+		simulationThread.join();
+	}
+	
+	EndInputLog();
+	ShutdownFrameCapture();
+	ShutdownLatencyTracking();
+	
 	closeCallback();
 	
 	SDL_GL_DeleteContext(glContext);
@@ -0,0 +1,308 @@
+#include "../Src/Montgomery.h"
+#include "../Src/DeckCrypto.h"
+#include "../Src/Random.h"
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+//Cross-checks the Montgomery arithmetic of the deck encryption against plain 128 bit arithmetic, for the game's
+// prime and for moduli at the edges of the range. Then checks modular inverses and generated keys, and that every
+// encoded card survives encryption by several players and decryption with their inverse keys, also when the
+// players replace their global keys with a key per card.
+// Usage: CryptoCheck
+
+static const uint32_t CHECKS_PER_MODULUS = 20000;
+static const uint32_t DECK_CHECKS = 200;
+static const uint32_t INVERSE_CHECKS = 100000;
+static const uint32_t NUM_PLAYERS = 8;
+
+//Cards are encoded as (id + MIN_CARD_ROOT)^2, like DeckEncrypter.EncodeCard does.
+static const uint64_t MIN_CARD_ROOT = 2;
+
+static const uint64_t PRIME = 18446744073709550147ull;
+
+typedef unsigned __int128 uint128_t;
+
+static uint64_t ReferenceMultiply(uint64_t a, uint64_t b, uint64_t modulus)
+{
+	return static_cast<uint64_t>(static_cast<uint128_t>(a) * b % modulus);
+}
+
+static uint64_t ReferencePow(uint64_t base, uint64_t exponent, uint64_t modulus)
+{
+	uint64_t result = 1 % modulus;
+	base %= modulus;
+	for (; exponent != 0; exponent >>= 1)
+	{
+		if (exponent & 1)
+			result = ReferenceMultiply(result, base, modulus);
+		base = ReferenceMultiply(base, base, modulus);
+	}
+	return result;
+}
+
+//Operands are mostly random, with the values next to 0 and the modulus mixed in.
+static uint64_t NextOperand(Xoshiro256& random, uint64_t modulus)
+{
+	switch (random.NextBelow(8))
+	{
+	case 0: return random.NextBelow(3);
+	case 1: return modulus - 1 - random.NextBelow(3) % modulus;
+	default: return random.Next() % modulus;
+	}
+}
+
+static uint64_t CheckModulus(Xoshiro256& random, uint64_t modulus)
+{
+	const Montgomery montgomery(modulus);
+	uint64_t numErrors = 0;
+	
+	for (uint32_t check = 0; check < CHECKS_PER_MODULUS; check++)
+	{
+		const uint64_t a = NextOperand(random, modulus);
+		const uint64_t b = NextOperand(random, modulus);
+		
+		//Values may be converted from any 64 bit value, not only from those below the modulus.
+		const uint64_t unreduced = random.Next();
+		bool valid = montgomery.FromMontgomery(montgomery.ToMontgomery(unreduced)) == unreduced % modulus;
+		
+		const uint64_t product = montgomery.Multiply(montgomery.ToMontgomery(a), montgomery.ToMontgomery(b));
+		valid &= montgomery.FromMontgomery(product) == ReferenceMultiply(a, b, modulus);
+		
+		const uint64_t exponent = check % 16 == 0 ? random.NextBelow(4) : random.Next();
+		valid &= montgomery.Pow(a, exponent) == ReferencePow(a, exponent, modulus);
+		
+		if (!valid)
+		{
+			if (numErrors < 10)
+			{
+				std::cerr << "Mismatch modulo " << modulus << ": a " << a << ", b " << b << ", exponent " << exponent
+				          << std::endl;
+			}
+			numErrors++;
+		}
+	}
+	
+	std::cout << "Modulus " << modulus << ": " << CHECKS_PER_MODULUS << " checked, " << numErrors << " mismatches"
+	          << std::endl;
+	return numErrors;
+}
+
+//DC_ExpMod52 raises cards in interleaved groups on the thread pool, which must agree with raising them one by one.
+static uint64_t CheckDeck(Xoshiro256& random)
+{
+	uint64_t numErrors = 0;
+	for (uint32_t check = 0; check < DECK_CHECKS; check++)
+	{
+		const uint32_t numKeys = check % 2 == 0 ? 1 : 52;
+		uint64_t cards[52];
+		uint64_t keys[52];
+		for (uint32_t i = 0; i < 52; i++)
+		{
+			cards[i] = random.Next() % PRIME;
+			keys[i] = random.Next();
+		}
+		
+		uint64_t expected[52];
+		for (uint32_t i = 0; i < 52; i++)
+			expected[i] = ReferencePow(cards[i], keys[numKeys == 1 ? 0 : i], PRIME);
+		
+		DC_ExpMod52(cards, keys, numKeys, PRIME);
+		for (uint32_t i = 0; i < 52; i++)
+			numErrors += cards[i] != expected[i];
+	}
+	
+	std::cout << "Decks: " << DECK_CHECKS << " checked, " << numErrors << " mismatches" << std::endl;
+	return numErrors;
+}
+
+static uint64_t ReferenceGCD(uint64_t a, uint64_t b)
+{
+	while (b != 0)
+	{
+		const uint64_t remainder = a % b;
+		a = b;
+		b = remainder;
+	}
+	return a;
+}
+
+//DC_InverseMod must return the inverse whenever there is one and 0 otherwise. Even moduli are included, since keys
+// are inverted modulo prime - 1.
+static uint64_t CheckInverses(Xoshiro256& random)
+{
+	uint64_t numErrors = 0;
+	for (uint32_t check = 0; check < INVERSE_CHECKS; check++)
+	{
+		const uint64_t modulus = check % 4 == 0 ? PRIME - 1 : 2 + random.Next() % (UINT64_MAX - 1);
+		const uint64_t value = NextOperand(random, modulus);
+		const uint64_t inverse = DC_InverseMod(value, modulus);
+		
+		const bool invertible = ReferenceGCD(value, modulus) == 1;
+		const bool valid = invertible ? inverse < modulus && ReferenceMultiply(value, inverse, modulus) == 1 % modulus :
+		                                inverse == 0;
+		if (!valid)
+		{
+			if (numErrors < 10)
+				std::cerr << "Wrong inverse of " << value << " modulo " << modulus << ": " << inverse << std::endl;
+			numErrors++;
+		}
+	}
+	
+	std::cout << "Inverses: " << INVERSE_CHECKS << " checked, " << numErrors << " mismatches" << std::endl;
+	return numErrors;
+}
+
+//Every player encrypts the whole deck with a key, after which each card must decrypt to itself with the inverse
+// keys in any order. Keys must be coprime with prime - 1 and must not be 1.
+static uint64_t CheckRoundTrips(Xoshiro256& random)
+{
+	uint64_t numErrors = 0;
+	for (uint32_t check = 0; check < DECK_CHECKS; check++)
+	{
+		uint64_t randomWords[NUM_PLAYERS];
+		for (uint64_t& word : randomWords)
+			word = check == 0 ? 0 : random.Next();
+		
+		uint64_t keys[NUM_PLAYERS];
+		uint64_t inverseKeys[NUM_PLAYERS];
+		DC_GenerateKeys(randomWords, NUM_PLAYERS, PRIME, keys, inverseKeys);
+		for (uint32_t p = 0; p < NUM_PLAYERS; p++)
+		{
+			if (keys[p] < 2 || ReferenceGCD(keys[p], PRIME - 1) != 1 ||
+			    ReferenceMultiply(keys[p], inverseKeys[p], PRIME - 1) != 1)
+			{
+				if (numErrors < 10)
+					std::cerr << "Invalid key " << keys[p] << " with inverse " << inverseKeys[p] << std::endl;
+				numErrors++;
+			}
+		}
+		
+		uint64_t encoded[52];
+		uint64_t cards[52];
+		for (uint32_t i = 0; i < 52; i++)
+		{
+			encoded[i] = (i + MIN_CARD_ROOT) * (i + MIN_CARD_ROOT);
+			cards[i] = encoded[i];
+		}
+		for (uint32_t p = 0; p < NUM_PLAYERS; p++)
+			DC_ExpMod52(cards, &keys[p], 1, PRIME);
+		
+		//Players decrypt in reverse order of encryption, which commutative encryption does not depend on.
+		std::vector<uint64_t> decryptKeys(inverseKeys, inverseKeys + NUM_PLAYERS);
+		if (check % 2 == 1)
+			std::reverse(decryptKeys.begin(), decryptKeys.end());
+		
+		for (uint32_t i = 0; i < 52; i++)
+		{
+			bool valid = cards[i] != encoded[i] || check == 0;
+			valid &= DC_DecryptCard(cards[i], decryptKeys.data(), NUM_PLAYERS, PRIME) == encoded[i];
+			if (!valid)
+			{
+				if (numErrors < 10)
+					std::cerr << "Card " << i << " did not survive encryption, encrypted to " << cards[i] << std::endl;
+				numErrors++;
+			}
+		}
+	}
+	
+	std::cout << "Round trips: " << DECK_CHECKS << " decks checked, " << numErrors << " mismatches" << std::endl;
+	return numErrors;
+}
+
+//Players encrypt the deck with a global key and then replace it with a key per card. Replacing the key must give
+// the same cards as decrypting with the global inverse key and encrypting again, and the cards must decrypt with
+// the inverse keys of each card.
+static uint64_t CheckKeyReplacement(Xoshiro256& random)
+{
+	uint64_t numErrors = 0;
+	for (uint32_t check = 0; check < DECK_CHECKS; check++)
+	{
+		uint64_t randomWords[NUM_PLAYERS * 53];
+		for (uint64_t& word : randomWords)
+			word = random.Next();
+		
+		uint64_t globalKeys[NUM_PLAYERS];
+		uint64_t globalInverseKeys[NUM_PLAYERS];
+		DC_GenerateKeys(randomWords, NUM_PLAYERS, PRIME, globalKeys, globalInverseKeys);
+		
+		uint64_t individualKeys[NUM_PLAYERS][52];
+		uint64_t individualInverseKeys[NUM_PLAYERS][52];
+		for (uint32_t p = 0; p < NUM_PLAYERS; p++)
+		{
+			DC_GenerateKeys(randomWords + NUM_PLAYERS + p * 52, 52, PRIME, individualKeys[p],
+			                individualInverseKeys[p]);
+		}
+		
+		uint64_t encoded[52];
+		uint64_t cards[52];
+		for (uint32_t i = 0; i < 52; i++)
+		{
+			encoded[i] = (i + MIN_CARD_ROOT) * (i + MIN_CARD_ROOT);
+			cards[i] = encoded[i];
+		}
+		for (uint32_t p = 0; p < NUM_PLAYERS; p++)
+			DC_ExpMod52(cards, &globalKeys[p], 1, PRIME);
+		
+		for (uint32_t p = 0; p < NUM_PLAYERS; p++)
+		{
+			uint64_t expected[52];
+			for (uint32_t i = 0; i < 52; i++)
+			{
+				expected[i] = ReferencePow(ReferencePow(cards[i], globalInverseKeys[p], PRIME), individualKeys[p][i],
+				                           PRIME);
+			}
+			
+			DC_ReplaceGlobalKey(cards, globalInverseKeys[p], individualKeys[p], PRIME);
+			for (uint32_t i = 0; i < 52; i++)
+			{
+				if (cards[i] != expected[i])
+				{
+					if (numErrors < 10)
+					{
+						std::cerr << "Replacing the key of player " << p << " gave " << cards[i] << " for card " << i
+						          << " instead of " << expected[i] << std::endl;
+					}
+					numErrors++;
+				}
+			}
+		}
+		
+		for (uint32_t i = 0; i < 52; i++)
+		{
+			uint64_t decryptKeys[NUM_PLAYERS];
+			for (uint32_t p = 0; p < NUM_PLAYERS; p++)
+				decryptKeys[p] = individualInverseKeys[p][i];
+			
+			if (DC_DecryptCard(cards[i], decryptKeys, NUM_PLAYERS, PRIME) != encoded[i])
+			{
+				if (numErrors < 10)
+					std::cerr << "Card " << i << " did not survive replacing the global keys" << std::endl;
+				numErrors++;
+			}
+		}
+	}
+	
+	std::cout << "Key replacements: " << DECK_CHECKS << " decks checked, " << numErrors << " mismatches" << std::endl;
+	return numErrors;
+}
+
+int main()
+{
+	Xoshiro256 random(1);
+	uint64_t numErrors = 0;
+	
+	//The game's prime, small moduli, the largest prime below 2^64, the largest odd value and random odd values.
+	const uint64_t moduli[] = { PRIME, 3, 66797, 18446744073709551557ull, UINT64_MAX, (random.Next() | 1),
+	                            (random.Next() >> 20 | 1), (random.Next() | 1ull << 63 | 1) };
+	for (uint64_t modulus : moduli)
+		numErrors += CheckModulus(random, modulus);
+	
+	numErrors += CheckDeck(random);
+	numErrors += CheckInverses(random);
+	numErrors += CheckRoundTrips(random);
+	numErrors += CheckKeyReplacement(random);
+	
+	return numErrors == 0 ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#include "../Src/Equity.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+//Compares exhaustive enumeration with Monte Carlo sampling on heads up all in spots, reporting the time each takes
+// and how far the sampled equities are from the exact ones.
+// Usage: EquityBenchmark
+
+struct Spot
+{
+	const char* name;
+	const char* holeCards;
+	const char* board;
+};
+
+static const Spot spots[] =
+{
+	{ "AA vs KK preflop",           "AsAh KdKc", "" },
+	{ "AKs vs QQ preflop",          "AhKh QsQd", "" },
+	{ "72o vs AKo preflop",         "7c2d AsKh", "" },
+	{ "Set vs flush draw on flop",  "QsQd AhKh", "Qh7h2c" },
+	{ "Overpair vs combo draw",     "AcAd JsTs", "9s8d2s" },
+	{ "Top pair vs open ender",     "AsQc 9h8h", "QdTc7s" },
+	{ "Two pair vs flush draw",     "KsQs AhTh", "KdQh4h5c" },
+	{ "Chopped river",              "AsKd AcKh", "QsJhTd3c2s" },
+};
+
+static const uint64_t SAMPLE_COUNTS[] = { 100000, 1000000 };
+
+//Cards are written as rank then suit, as in "Ah" or "Tc".
+static std::vector<uint8_t> ParseCards(const std::string& text)
+{
+	const std::string RANKS = "23456789TJQKA";
+	const std::string SUITS = "shdc";
+	
+	std::vector<uint8_t> cards;
+	for (size_t i = 0; i + 1 < text.size(); i++)
+	{
+		const size_t rank = RANKS.find(text[i]);
+		const size_t suit = SUITS.find(text[i + 1]);
+		if (rank == std::string::npos || suit == std::string::npos)
+			continue;
+		cards.push_back(static_cast<uint8_t>(suit + rank * 4));
+		i++;
+	}
+	return cards;
+}
+
+template <typename CallbackTp>
+static double MeasureMS(CallbackTp callback)
+{
+	const auto start = std::chrono::steady_clock::now();
+	callback();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double GetEquity(const EquityTally& tally, uint32_t player)
+{
+	return tally.shares[player] / static_cast<double>(tally.deals * EQUITY_SHARE_UNIT);
+}
+
+int main()
+{
+	std::cout << std::fixed << std::setprecision(3);
+	
+	for (const Spot& spot : spots)
+	{
+		const std::vector<uint8_t> holeCards = ParseCards(spot.holeCards);
+		const std::vector<uint8_t> board = ParseCards(spot.board);
+		const EquitySpot equitySpot = MakeEquitySpot(holeCards.data(), 2, board.data(),
+		                                             static_cast<uint32_t>(board.size()), nullptr, 0);
+		
+		ClearEquityCache();
+		EquityTally exact;
+		const double enumerateMS = MeasureMS([&] { exact = EnumerateEquity(equitySpot); });
+		const double cachedMS = MeasureMS([&] { EnumerateEquity(equitySpot); });
+		
+		std::cout << spot.name << ": " << (GetEquity(exact, 0) * 100) << "% vs " << (GetEquity(exact, 1) * 100) << "%"
+		          << std::endl;
+		std::cout << "  enumeration   " << std::setw(9) << enumerateMS << " ms, " << exact.deals << " boards, "
+		          << cachedMS << " ms cached" << std::endl;
+		
+		for (uint64_t numDeals : SAMPLE_COUNTS)
+		{
+			EquityTally sampled;
+			const double sampleMS = MeasureMS([&] { sampled = SampleEquity(equitySpot, numDeals, 1); });
+			const double error = std::abs(GetEquity(sampled, 0) - GetEquity(exact, 0));
+			
+			std::cout << "  monte carlo   " << std::setw(9) << sampleMS << " ms, " << numDeals << " deals, "
+			          << (error * 100) << "% off" << std::endl;
+		}
+	}
+	
+	return 0;
+}
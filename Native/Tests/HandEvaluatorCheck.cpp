@@ -0,0 +1,247 @@
+#include "../Src/HandEvaluator.h"
+#include "../Src/Random.h"
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+//Cross-checks the hand evaluator against a brute force evaluator which scores every five card subset on its own.
+// Hands are sorted by the brute force score, after which the evaluated strengths must be sorted too, must tie
+// exactly where the scores tie and must have the same category.
+// Usage: HandEvaluatorCheck
+
+static const uint32_t HANDS_PER_SIZE = 300000;
+static const uint32_t RIVER_CHECKS = 20000;
+
+static const uint32_t RANK_5 = 3;
+static const uint32_t RANK_ACE = 12;
+
+enum Category : uint32_t
+{
+	HighCard, Pair, TwoPair, ThreeOfAKind, Straight, Flush, FullHouse, FourOfAKind, StraightFlush
+};
+
+//Category in the top bits followed by up to five ranks in order of importance.
+static uint32_t ScoreFive(const uint8_t* cards)
+{
+	uint32_t rankCounts[13] = { };
+	bool flush = true;
+	for (uint32_t i = 0; i < 5; i++)
+	{
+		rankCounts[cards[i] / 4]++;
+		flush &= cards[i] % 4 == cards[0] % 4;
+	}
+	
+	//Ranks ordered by how many times they appear, then by rank.
+	std::vector<uint32_t> ranks;
+	for (uint32_t count = 4; count > 0; count--)
+	{
+		for (int32_t rank = RANK_ACE; rank >= 0; rank--)
+		{
+			if (rankCounts[rank] == count)
+				ranks.push_back(static_cast<uint32_t>(rank));
+		}
+	}
+	
+	bool straight = false;
+	if (ranks.size() == 5)
+	{
+		if (ranks[0] - ranks[4] == 4)
+		{
+			straight = true;
+		}
+		else if (ranks[0] == RANK_ACE && ranks[1] == RANK_5)
+		{
+			//The wheel, where the ace plays low.
+			straight = true;
+			ranks = { RANK_5 };
+		}
+	}
+	
+	Category category;
+	if (straight && flush)
+		category = StraightFlush;
+	else if (rankCounts[ranks[0]] == 4)
+		category = FourOfAKind;
+	else if (rankCounts[ranks[0]] == 3 && rankCounts[ranks[1]] == 2)
+		category = FullHouse;
+	else if (flush)
+		category = Flush;
+	else if (straight)
+		category = Straight;
+	else if (rankCounts[ranks[0]] == 3)
+		category = ThreeOfAKind;
+	else if (rankCounts[ranks[0]] == 2 && rankCounts[ranks[1]] == 2)
+		category = TwoPair;
+	else if (rankCounts[ranks[0]] == 2)
+		category = Pair;
+	else
+		category = HighCard;
+	
+	uint32_t score = category;
+	for (uint32_t i = 0; i < 5; i++)
+		score = score * 16 + (i < ranks.size() ? ranks[i] + 1 : 0);
+	return score;
+}
+
+static uint32_t ScoreBest(const uint8_t* cards, uint32_t numCards)
+{
+	uint32_t best = 0;
+	for (uint32_t mask = 0; mask < (1u << numCards); mask++)
+	{
+		if (__builtin_popcount(mask) != 5)
+			continue;
+		
+		uint8_t subset[5];
+		uint32_t subsetSize = 0;
+		for (uint32_t i = 0; i < numCards; i++)
+		{
+			if (mask & (1u << i))
+				subset[subsetSize++] = cards[i];
+		}
+		best = std::max(best, ScoreFive(subset));
+	}
+	return best;
+}
+
+static uint32_t GetScoreCategory(uint32_t score)
+{
+	return score >> 20;
+}
+
+struct CheckedHand
+{
+	uint8_t cards[7];
+	uint32_t score;
+	uint16_t strength;
+};
+
+//Deals the cards after the first numFixed, which are already set.
+static void DealHand(Xoshiro256& random, uint8_t* cards, uint32_t numFixed, uint32_t numCards)
+{
+	uint8_t deck[52];
+	uint32_t deckSize = 0;
+	for (uint8_t card = 0; card < 52; card++)
+	{
+		if (std::find(cards, cards + numFixed, card) == cards + numFixed)
+			deck[deckSize++] = card;
+	}
+	
+	for (uint32_t i = numFixed; i < numCards; i++)
+	{
+		const uint32_t index = random.NextBelow(deckSize);
+		cards[i] = deck[index];
+		deck[index] = deck[--deckSize];
+	}
+}
+
+static void PrintHand(const CheckedHand& hand, uint32_t numCards)
+{
+	const char* RANKS = "23456789TJQKA";
+	const char* SUITS = "cdhs";
+	for (uint32_t i = 0; i < numCards; i++)
+		std::cerr << RANKS[hand.cards[i] / 4] << SUITS[hand.cards[i] % 4];
+	std::cerr << " (strength " << hand.strength << ", category " << GetHandCategory(hand.strength) << ")";
+}
+
+static uint64_t CheckHands(std::vector<CheckedHand>& hands, uint32_t numCards)
+{
+	for (CheckedHand& hand : hands)
+	{
+		hand.score = ScoreBest(hand.cards, numCards);
+		hand.strength = EvaluateHand(hand.cards, numCards);
+	}
+	
+	std::sort(hands.begin(), hands.end(), [] (const CheckedHand& a, const CheckedHand& b)
+	{
+		return a.score < b.score;
+	});
+	
+	uint64_t numErrors = 0;
+	for (size_t i = 0; i < hands.size(); i++)
+	{
+		bool valid = GetHandCategory(hands[i].strength) == GetScoreCategory(hands[i].score);
+		if (i > 0)
+		{
+			const bool sameScore = hands[i - 1].score == hands[i].score;
+			valid &= sameScore ? hands[i - 1].strength == hands[i].strength :
+			                     hands[i - 1].strength < hands[i].strength;
+		}
+		
+		if (!valid)
+		{
+			if (numErrors < 10)
+			{
+				std::cerr << "Mismatch: ";
+				if (i > 0)
+				{
+					PrintHand(hands[i - 1], numCards);
+					std::cerr << " then ";
+				}
+				PrintHand(hands[i], numCards);
+				std::cerr << std::endl;
+			}
+			numErrors++;
+		}
+	}
+	return numErrors;
+}
+
+int main()
+{
+	Xoshiro256 random(1);
+	uint64_t numErrors = 0;
+	
+	for (uint32_t numCards = 5; numCards <= 7; numCards++)
+	{
+		std::vector<CheckedHand> hands(HANDS_PER_SIZE);
+		for (CheckedHand& hand : hands)
+			DealHand(random, hand.cards, 0, numCards);
+		
+		//Every straight and straight flush, including the wheels, regardless of how rare they are when dealt.
+		for (uint32_t highRank = RANK_5; highRank <= RANK_ACE; highRank++)
+		{
+			for (uint32_t suit = 0; suit < 4; suit++)
+			{
+				CheckedHand hand;
+				for (uint32_t i = 0; i < 5; i++)
+				{
+					const uint32_t rank = highRank + i < 4 ? RANK_ACE : highRank + i - 4;
+					const uint32_t cardSuit = i == 0 && suit % 2 == 1 ? (suit + 1) % 4 : suit;
+					hand.cards[i] = static_cast<uint8_t>(cardSuit + rank * 4);
+				}
+				DealHand(random, hand.cards, 5, numCards);
+				hands.push_back(hand);
+			}
+		}
+		
+		const uint64_t sizeErrors = CheckHands(hands, numCards);
+		std::cout << numCards << " card hands: " << hands.size() << " checked, " << sizeErrors << " mismatches"
+		          << std::endl;
+		numErrors += sizeErrors;
+	}
+	
+	//EvaluateRivers must agree with evaluating each seven card hand.
+	uint64_t riverErrors = 0;
+	for (uint32_t check = 0; check < RIVER_CHECKS; check++)
+	{
+		uint8_t cards[7];
+		DealHand(random, cards, 0, 6);
+		
+		uint16_t strengths[52];
+		EvaluateRivers(cards, strengths);
+		for (uint8_t river = 0; river < 52; river++)
+		{
+			if (std::find(cards, cards + 6, river) != cards + 6)
+				continue;
+			cards[6] = river;
+			if (strengths[river] != EvaluateHand(cards, 7))
+				riverErrors++;
+		}
+	}
+	std::cout << "Rivers: " << RIVER_CHECKS << " six card hands checked, " << riverErrors << " mismatches"
+	          << std::endl;
+	numErrors += riverErrors;
+	
+	return numErrors == 0 ? 0 : 1;
+}
@@ -0,0 +1,383 @@
+#include "../Src/API.h"
+#include "../Src/MessageCodec.h"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+//Drives the native server over loopback: many clients sending fragmented messages, echoes through NS_Send, a flood
+// that backs up into the outbox, one that overflows it, a message too large to receive, disconnects, and running out
+// of file descriptors. Build with
+// -DCMAKE_CXX_FLAGS=-fsanitize=thread to run it under ThreadSanitizer.
+// Usage: NetServerTest
+
+static const uint16_t PORT = 19908;
+static const uint32_t NUM_WORKERS = 4;
+static const uint32_t NUM_CLIENTS = 300;
+static const uint32_t NUM_FLOOD_MESSAGES = 3000;
+
+//Well past the server's outbox limit and the socket buffers.
+static const uint32_t MAX_OVERFLOW_MESSAGES = 20000;
+
+static const uint16_t ECHO_REQUEST_ID = 7;
+static const uint16_t ECHO_RESPONSE_ID = 8;
+static const uint16_t FLOOD_ID = 9;
+
+static const auto TIMEOUT = std::chrono::seconds(10);
+
+//Bindings, declared as the game declares them.
+enum class NetEventType : uint32_t
+{
+	Connected = 0,
+	Message = 1,
+	Disconnected = 2
+};
+
+#pragma pack(push, 1)
+struct NetEventInfo
+{
+	NetEventType type;
+	uint32_t connection;
+	uint32_t messageId;
+	uint32_t size;
+};
+#pragma pack(pop)
+
+class NetServer;
+CS_VISIBLE NetServer* NS_Create(uint16_t port, uint32_t numWorkers);
+CS_VISIBLE void NS_Destroy(NetServer* server);
+CS_VISIBLE bool NS_Send(NetServer* server, uint32_t connection, uint16_t messageId, const uint8_t* data, uint32_t size);
+CS_VISIBLE void NS_Close(NetServer* server, uint32_t connection);
+CS_VISIBLE bool NS_WaitForEvent(NetServer* server, uint32_t timeoutMS);
+CS_VISIBLE bool NS_Poll(NetServer* server, NetEventInfo* info);
+CS_VISIBLE void NS_GetEventData(NetServer* server, uint8_t* data);
+CS_VISIBLE uint32_t NS_GetNumConnections(NetServer* server);
+
+struct Event
+{
+	NetEventInfo info;
+	std::vector<uint8_t> data;
+};
+
+static bool NextEvent(NetServer* server, Event& event)
+{
+	const auto deadline = std::chrono::steady_clock::now() + TIMEOUT;
+	while (!NS_Poll(server, &event.info))
+	{
+		if (std::chrono::steady_clock::now() >= deadline)
+			return false;
+		NS_WaitForEvent(server, 100);
+	}
+	
+	event.data.resize(event.info.size);
+	NS_GetEventData(server, event.data.data());
+	return true;
+}
+
+//Polls until an event of the given type arrives, dropping others. Returns false on timeout.
+static bool NextEvent(NetServer* server, NetEventType type, Event& event)
+{
+	while (NextEvent(server, event))
+	{
+		if (event.info.type == type)
+			return true;
+	}
+	return false;
+}
+
+static std::vector<uint8_t> FrameMessage(uint16_t id, const std::vector<uint8_t>& data)
+{
+	const uint32_t numPackets = GetNumPackets(static_cast<uint32_t>(data.size()));
+	std::vector<uint8_t> headers(GetFrameHeadersSize(numPackets));
+	std::vector<FrameSlice> slices(numPackets * 2);
+	const uint32_t numSlices = EncodeFrames(id, static_cast<uint32_t>(data.size()), headers.data(), slices.data());
+	
+	std::vector<uint8_t> wire;
+	for (uint32_t i = 0; i < numSlices; i++)
+	{
+		const uint8_t* source = slices[i].source == FS_Headers ? headers.data() : data.data();
+		wire.insert(wire.end(), source + slices[i].offset, source + slices[i].offset + slices[i].size);
+	}
+	return wire;
+}
+
+static int ConnectClient()
+{
+	const int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+	if (socket == -1)
+		return -1;
+	
+	sockaddr_in address = { };
+	address.sin_family = AF_INET;
+	address.sin_port = htons(PORT);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+	{
+		close(socket);
+		return -1;
+	}
+	return socket;
+}
+
+static bool ReceiveExactly(int socket, std::vector<uint8_t>& data, size_t size)
+{
+	data.resize(size);
+	for (size_t offset = 0; offset < size;)
+	{
+		const ssize_t received = recv(socket, data.data() + offset, size - offset, 0);
+		if (received <= 0)
+			return false;
+		offset += received;
+	}
+	return true;
+}
+
+//Every client sends one message in random fragments, which must arrive whole and be echoed back.
+static bool TestEcho(NetServer* server, std::vector<int>& clients, std::mt19937& random)
+{
+	std::vector<std::vector<uint8_t>> payloads(NUM_CLIENTS);
+	for (uint32_t i = 0; i < NUM_CLIENTS; i++)
+	{
+		clients.push_back(ConnectClient());
+		if (clients.back() == -1)
+		{
+			std::cerr << "Could not connect client " << i << "." << std::endl;
+			return false;
+		}
+		
+		//The first two bytes say which client sent the message.
+		payloads[i].resize(2 + random() % 5000);
+		for (uint8_t& byte : payloads[i])
+			byte = static_cast<uint8_t>(random());
+		payloads[i][0] = static_cast<uint8_t>(i);
+		payloads[i][1] = static_cast<uint8_t>(i >> 8);
+		
+		const std::vector<uint8_t> wire = FrameMessage(ECHO_REQUEST_ID, payloads[i]);
+		for (size_t offset = 0; offset < wire.size();)
+		{
+			const size_t fragment = std::min<size_t>(wire.size() - offset, 1 + random() % 700);
+			send(clients[i], wire.data() + offset, fragment, 0);
+			offset += fragment;
+		}
+	}
+	
+	uint32_t numConnected = 0;
+	uint32_t numMessages = 0;
+	uint32_t numCorrupt = 0;
+	Event event;
+	while (numMessages < NUM_CLIENTS && NextEvent(server, event))
+	{
+		if (event.info.type == NetEventType::Connected)
+			numConnected++;
+		if (event.info.type != NetEventType::Message)
+			continue;
+		
+		const uint32_t client = event.data.size() < 2 ? UINT32_MAX : event.data[0] | (event.data[1] << 8);
+		if (event.info.messageId != ECHO_REQUEST_ID || client >= NUM_CLIENTS || event.data != payloads[client])
+			numCorrupt++;
+		numMessages++;
+		NS_Send(server, event.info.connection, ECHO_RESPONSE_ID, event.data.data(), event.info.size);
+	}
+	
+	for (uint32_t i = 0; i < NUM_CLIENTS; i++)
+	{
+		const std::vector<uint8_t> expected = FrameMessage(ECHO_RESPONSE_ID, payloads[i]);
+		std::vector<uint8_t> echo;
+		if (!ReceiveExactly(clients[i], echo, expected.size()) || echo != expected)
+			numCorrupt++;
+	}
+	
+	std::cout << "Echo: " << numConnected << " connected, " << numMessages << " messages, " << numCorrupt << " corrupt"
+	          << std::endl;
+	return numConnected == NUM_CLIENTS && numMessages == NUM_CLIENTS && numCorrupt == 0 &&
+	       NS_GetNumConnections(server) == NUM_CLIENTS;
+}
+
+//Sends to a client which does not read until everything was sent, so most of it waits in the outbox, which holds
+// all of it.
+static bool TestFlood(NetServer* server, int client, std::mt19937& random)
+{
+	std::vector<uint8_t> message(4000);
+	for (uint8_t& byte : message)
+		byte = static_cast<uint8_t>(random());
+	
+	const std::vector<uint8_t> wire = FrameMessage(FLOOD_ID, message);
+	send(client, wire.data(), wire.size(), 0);
+	Event event;
+	if (!NextEvent(server, NetEventType::Message, event))
+		return false;
+	
+	uint32_t numSent = 0;
+	for (uint32_t i = 0; i < NUM_FLOOD_MESSAGES; i++)
+	{
+		message[0] = static_cast<uint8_t>(i);
+		message[1] = static_cast<uint8_t>(i >> 8);
+		numSent += NS_Send(server, event.info.connection, FLOOD_ID, message.data(),
+		                   static_cast<uint32_t>(message.size()));
+	}
+	
+	uint32_t numCorrupt = 0;
+	for (uint32_t i = 0; i < NUM_FLOOD_MESSAGES; i++)
+	{
+		message[0] = static_cast<uint8_t>(i);
+		message[1] = static_cast<uint8_t>(i >> 8);
+		const std::vector<uint8_t> expected = FrameMessage(FLOOD_ID, message);
+		std::vector<uint8_t> received;
+		if (!ReceiveExactly(client, received, expected.size()) || received != expected)
+			numCorrupt++;
+	}
+	
+	std::cout << "Flood: " << numSent << " sent, " << numCorrupt << " corrupt" << std::endl;
+	return numSent == NUM_FLOOD_MESSAGES && numCorrupt == 0;
+}
+
+//Sends to a client which never reads, until the outbox overflows and the connection is closed.
+static bool TestOverflow(NetServer* server, std::vector<int>& clients)
+{
+	clients.push_back(ConnectClient());
+	Event event;
+	if (clients.back() == -1 || !NextEvent(server, NetEventType::Connected, event))
+		return false;
+	const uint32_t connection = event.info.connection;
+	
+	const std::vector<uint8_t> message(4000);
+	uint32_t numSent = 0;
+	while (numSent < MAX_OVERFLOW_MESSAGES &&
+	       NS_Send(server, connection, FLOOD_ID, message.data(), static_cast<uint32_t>(message.size())))
+	{
+		numSent++;
+	}
+	
+	bool disconnected = false;
+	while (!disconnected && NextEvent(server, event))
+	{
+		if (event.info.connection == connection)
+			disconnected = event.info.type == NetEventType::Disconnected;
+	}
+	
+	close(clients.back());
+	clients.pop_back();
+	std::cout << "Overflow: " << numSent << " sent, " << (disconnected ? "disconnected" : "not disconnected")
+	          << std::endl;
+	return numSent < MAX_OVERFLOW_MESSAGES && disconnected;
+}
+
+//A message larger than the receive ring must close its connection rather than be skipped.
+static bool TestTooLarge(NetServer* server, std::vector<int>& clients)
+{
+	clients.push_back(ConnectClient());
+	Event event;
+	if (clients.back() == -1 || !NextEvent(server, NetEventType::Connected, event))
+		return false;
+	const uint32_t connection = event.info.connection;
+	
+	const std::vector<uint8_t> wire = FrameMessage(FLOOD_ID, std::vector<uint8_t>(RECEIVE_RING_SIZE));
+	send(clients.back(), wire.data(), wire.size(), MSG_NOSIGNAL);
+	
+	bool disconnected = false;
+	while (!disconnected && NextEvent(server, event))
+	{
+		if (event.info.connection == connection)
+			disconnected = event.info.type == NetEventType::Disconnected;
+	}
+	
+	close(clients.back());
+	clients.pop_back();
+	std::cout << "Too large: " << (disconnected ? "disconnected" : "not disconnected") << std::endl;
+	return disconnected;
+}
+
+static bool TestDisconnect(NetServer* server, std::vector<int>& clients)
+{
+	const uint32_t numClosed = static_cast<uint32_t>(clients.size() / 2);
+	for (uint32_t i = 0; i < numClosed; i++)
+		close(clients[i]);
+	clients.erase(clients.begin(), clients.begin() + numClosed);
+	
+	uint32_t numDisconnected = 0;
+	Event event;
+	while (numDisconnected < numClosed && NextEvent(server, NetEventType::Disconnected, event))
+		numDisconnected++;
+	
+	std::cout << "Disconnect: " << numDisconnected << " of " << numClosed << " reported, "
+	          << NS_GetNumConnections(server) << " connections left" << std::endl;
+	return numDisconnected == numClosed && NS_GetNumConnections(server) == clients.size();
+}
+
+//Connects clients until the process runs out of descriptors, which must not stop the server from accepting once
+// some have been freed.
+static bool TestDescriptorExhaustion(NetServer* server, std::vector<int>& clients)
+{
+	rlimit limit;
+	getrlimit(RLIMIT_NOFILE, &limit);
+	const rlimit lowLimit = { 64 + 2 * clients.size(), limit.rlim_max };
+	if (setrlimit(RLIMIT_NOFILE, &lowLimit) != 0)
+		return false;
+	
+	uint32_t numRefused = 0;
+	while (numRefused < 8)
+	{
+		const int client = ConnectClient();
+		if (client == -1)
+		{
+			numRefused++;
+			continue;
+		}
+		clients.push_back(client);
+	}
+	
+	//Lets the server go through the pending connections.
+	Event event;
+	while (NS_Poll(server, &event.info) || NS_WaitForEvent(server, 500))
+	{
+	}
+	
+	for (int client : clients)
+		close(client);
+	clients.clear();
+	setrlimit(RLIMIT_NOFILE, &limit);
+	
+	while (NS_GetNumConnections(server) != 0 && NextEvent(server, NetEventType::Disconnected, event))
+	{
+	}
+	
+	clients.push_back(ConnectClient());
+	const bool accepted = clients.back() != -1 && NextEvent(server, NetEventType::Connected, event);
+	std::cout << "Descriptor exhaustion: " << (accepted ? "still accepting" : "stopped accepting") << std::endl;
+	return accepted;
+}
+
+int main()
+{
+	NetServer* server = NS_Create(PORT, NUM_WORKERS);
+	if (server == nullptr)
+	{
+		std::cerr << "Could not start the server on port " << PORT << "." << std::endl;
+		return 1;
+	}
+	
+	std::mt19937 random(1);
+	std::vector<int> clients;
+	
+	bool passed = TestEcho(server, clients, random);
+	passed = passed && TestFlood(server, clients.back(), random);
+	passed = passed && TestOverflow(server, clients);
+	passed = passed && TestTooLarge(server, clients);
+	passed = passed && TestDisconnect(server, clients);
+	passed = passed && TestDescriptorExhaustion(server, clients);
+	
+	NS_Destroy(server);
+	for (int client : clients)
+		close(client);
+	
+	std::cout << (passed ? "Passed" : "Failed") << std::endl;
+	return passed ? 0 : 1;
+}
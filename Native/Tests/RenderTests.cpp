@@ -0,0 +1,1371 @@
+#include "../Src/API.h"
+#include "../Src/Utils.h"
+#include "../Src/Graphics.h"
+#include "../Src/Shader.h"
+#include "../Src/Mesh.h"
+#include "../Src/Texture2D.h"
+#include "../Src/FrameCapture.h"
+#include "../Src/SpriteBatch.h"
+#include "../Src/ChipsBuffer.h"
+#include "../Src/ChipCuller.h"
+#include "../Src/DrawList.h"
+#include "../Src/UniformBuffer.h"
+#include "../Src/ShadowMap.h"
+#include "../Src/ShadowMatrixBuffer.h"
+#include "../Src/BlurFB.h"
+#include "stb_image.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+#include <SDL2/SDL.h>
+#include <GL/glew.h>
+
+//Renders canonical scenes offscreen through the native rendering classes, compares them against golden images and
+// checks frame times and draw call counts against per scene budgets. The scenes are built from the game's own
+// assets and shaders: the board and chip models, the card textures and the bitmap font.
+// Usage: RenderTests <Poker/Res directory> <golden image directory> [--update-golden | --budget-only]
+// Exits with 0 if every scene passed, 1 if any failed and SKIPPED_EXIT_CODE if none failed but some had no
+// golden image to compare with. With --budget-only only the budgets are checked, which works without golden images.
+
+static const uint32_t WIDTH = 1280;
+static const uint32_t HEIGHT = 720;
+
+static const uint32_t WARMUP_FRAMES = 10;
+static const uint32_t MEASURED_FRAMES = 100;
+
+static const int SKIPPED_EXIT_CODE = 77;
+
+//Protocol.MAX_CLIENTS, the most players a game can have.
+static const uint32_t NUM_PLAYERS = 8;
+
+//A pixel differs if any channel differs by more than CHANNEL_TOLERANCE. A scene fails if more than
+// MAX_DIFFERING_PIXELS of its pixels differ, which leaves room for rasterization differences between drivers.
+static const int CHANNEL_TOLERANCE = 8;
+static const double MAX_DIFFERING_PIXELS = 0.001;
+
+static std::string resDirectory;
+
+static std::string ReadFile(const std::string& path, bool binary = false)
+{
+	std::ifstream stream(path, binary ? std::ios::binary : std::ios::in);
+	if (!stream)
+		Panic(("Error opening '" + path + "'.").c_str());
+	std::stringstream contents;
+	contents << stream.rdbuf();
+	return contents.str();
+}
+
+//Resolves includes from the shader directory the way Build.sh does when it builds the shader archive.
+static std::string PreprocessShader(const std::string& source)
+{
+	std::istringstream lines(source);
+	std::string result;
+	std::string line;
+	while (std::getline(lines, line))
+	{
+		if (line.compare(0, 9, "#include ") == 0)
+		{
+			const size_t nameBegin = line.find('"') + 1;
+			const std::string name = line.substr(nameBegin, line.rfind('"') - nameBegin);
+			result += PreprocessShader(ReadFile(resDirectory + "/Shaders/" + name));
+		}
+		else
+		{
+			result += line;
+		}
+		result += '\n';
+	}
+	return result;
+}
+
+static std::unique_ptr<Shader> LoadShader(const char* vertexStage, const char* fragmentStage)
+{
+	std::unique_ptr<Shader> shader(new Shader());
+	const Shader::StageType types[] = { Shader::StageType::Vertex, Shader::StageType::Fragment };
+	const char* names[] = { vertexStage, fragmentStage };
+	for (int i = 0; i < 2; i++)
+	{
+		if (names[i] == nullptr)
+			continue;
+		const std::string code = "#version 440 core\n" + PreprocessShader(ReadFile(resDirectory + "/Shaders/" + names[i]));
+		shader->AttachStage(types[i], code.c_str());
+	}
+	shader->Link();
+	return shader;
+}
+
+// ** glTF models **
+
+//Just enough JSON to read the glTF files exported for the game.
+struct JsonValue
+{
+	std::string string;
+	double number = 0;
+	std::vector<JsonValue> items;
+	std::vector<std::pair<std::string, JsonValue>> members;
+	
+	const JsonValue* Find(const char* name) const
+	{
+		for (const auto& member : members)
+		{
+			if (member.first == name)
+				return &member.second;
+		}
+		return nullptr;
+	}
+	
+	const JsonValue& operator[](const char* name) const
+	{
+		const JsonValue* value = Find(name);
+		if (value == nullptr)
+			Panic((std::string("Missing glTF property '") + name + "'.").c_str());
+		return *value;
+	}
+	
+	uint32_t GetU32(const char* name, uint32_t defaultValue) const
+	{
+		const JsonValue* value = Find(name);
+		return value == nullptr ? defaultValue : static_cast<uint32_t>(value->number);
+	}
+};
+
+class JsonParser
+{
+public:
+	explicit JsonParser(const std::string& text)
+		: m_text(text) { }
+	
+	JsonValue Parse()
+	{
+		JsonValue value;
+		SkipSpace();
+		if (Peek() == '{')
+		{
+			m_position++;
+			while (SkipSpace(), Peek() != '}')
+			{
+				std::string name = ParseString();
+				SkipSpace();
+				Expect(':');
+				value.members.emplace_back(std::move(name), Parse());
+				SkipSpace();
+				if (Peek() == ',')
+					m_position++;
+			}
+			m_position++;
+		}
+		else if (Peek() == '[')
+		{
+			m_position++;
+			while (SkipSpace(), Peek() != ']')
+			{
+				value.items.push_back(Parse());
+				SkipSpace();
+				if (Peek() == ',')
+					m_position++;
+			}
+			m_position++;
+		}
+		else if (Peek() == '"')
+		{
+			value.string = ParseString();
+		}
+		else
+		{
+			const char* begin = m_text.c_str() + m_position;
+			char* end;
+			value.number = std::strtod(begin, &end);
+			if (end == begin)
+			{
+				//true, false and null are not used by the importer.
+				while (m_position < m_text.size() && std::isalpha(static_cast<unsigned char>(m_text[m_position])))
+					m_position++;
+			}
+			else
+			{
+				m_position += end - begin;
+			}
+		}
+		return value;
+	}
+	
+private:
+	char Peek() const
+	{
+		if (m_position >= m_text.size())
+			Panic("Unexpected end of glTF JSON.");
+		return m_text[m_position];
+	}
+	
+	void SkipSpace()
+	{
+		while (m_position < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_position])))
+			m_position++;
+	}
+	
+	void Expect(char c)
+	{
+		if (Peek() != c)
+			Panic("Invalid glTF JSON.");
+		m_position++;
+	}
+	
+	std::string ParseString()
+	{
+		Expect('"');
+		std::string result;
+		while (Peek() != '"')
+		{
+			if (m_text[m_position] == '\\')
+				m_position++;
+			result += m_text[m_position++];
+		}
+		m_position++;
+		return result;
+	}
+	
+	const std::string& m_text;
+	size_t m_position = 0;
+};
+
+struct Model
+{
+	std::unique_ptr<Mesh> mesh;
+	std::vector<std::string> partNames;
+	std::vector<uint32_t> partFirstIndices;
+	std::vector<uint32_t> partNumIndices;
+	
+	uint32_t FindPart(const char* name) const
+	{
+		const auto it = std::find(partNames.begin(), partNames.end(), name);
+		if (it == partNames.end())
+			Panic((std::string("Part not found '") + name + "'.").c_str());
+		return static_cast<uint32_t>(it - partNames.begin());
+	}
+};
+
+//Imports a model like GLTFImporter does, into one packed and optimized mesh with one part per primitive.
+static Model LoadModel(const char* name)
+{
+	const std::string directory = resDirectory + "/Models/";
+	const std::string jsonText = ReadFile(directory + name + ".gltf");
+	const JsonValue json = JsonParser(jsonText).Parse();
+	
+	std::vector<std::string> buffers;
+	for (const JsonValue& buffer : json["buffers"].items)
+		buffers.push_back(ReadFile(directory + buffer["uri"].string, true));
+	
+	struct Accessor
+	{
+		const uint8_t* data;
+		uint32_t stride;
+		uint32_t count;
+		uint32_t componentType;
+	};
+	
+	std::vector<Accessor> accessors;
+	for (const JsonValue& accessorEl : json["accessors"].items)
+	{
+		const JsonValue& view = json["bufferViews"].items.at(static_cast<size_t>(accessorEl["bufferView"].number));
+		const std::string& buffer = buffers.at(view.GetU32("buffer", 0));
+		
+		const std::string& type = accessorEl["type"].string;
+		const uint32_t components = type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3 : 4;
+		const uint32_t componentType = accessorEl.GetU32("componentType", 0);
+		const uint32_t componentSize = componentType == 5121 ? 1 : componentType == 5123 ? 2 : 4;
+		
+		Accessor accessor;
+		accessor.data = reinterpret_cast<const uint8_t*>(buffer.data()) + view.GetU32("byteOffset", 0) +
+			accessorEl.GetU32("byteOffset", 0);
+		accessor.stride = view.GetU32("byteStride", components * componentSize);
+		accessor.count = accessorEl.GetU32("count", 0);
+		accessor.componentType = componentType;
+		accessors.push_back(accessor);
+	}
+	
+	auto readFloats = [&] (const Accessor& accessor, uint32_t element, float* out, uint32_t count)
+	{
+		std::memcpy(out, accessor.data + static_cast<size_t>(accessor.stride) * element, sizeof(float) * count);
+	};
+	
+	std::vector<StandardVertex> vertices;
+	std::vector<uint32_t> indices;
+	Model model;
+	
+	for (const JsonValue& meshEl : json["meshes"].items)
+	{
+		const std::vector<JsonValue>& primitives = meshEl["primitives"].items;
+		for (size_t p = 0; p < primitives.size(); p++)
+		{
+			const JsonValue& attributes = primitives[p]["attributes"];
+			const Accessor& indexAccessor = accessors.at(static_cast<size_t>(primitives[p]["indices"].number));
+			const Accessor& positionAccessor = accessors.at(static_cast<size_t>(attributes["POSITION"].number));
+			const Accessor& normalAccessor = accessors.at(static_cast<size_t>(attributes["NORMAL"].number));
+			const JsonValue* texCoordEl = attributes.Find("TEXCOORD_0");
+			
+			const uint32_t baseVertex = static_cast<uint32_t>(vertices.size());
+			const uint32_t firstIndex = static_cast<uint32_t>(indices.size());
+			
+			for (uint32_t i = 0; i < indexAccessor.count; i++)
+			{
+				const uint8_t* index = indexAccessor.data + static_cast<size_t>(indexAccessor.stride) * i;
+				uint32_t value;
+				if (indexAccessor.componentType == 5121)
+					value = *index;
+				else if (indexAccessor.componentType == 5123)
+					value = index[0] | (index[1] << 8);
+				else
+					std::memcpy(&value, index, sizeof(value));
+				indices.push_back(baseVertex + value);
+			}
+			
+			vertices.resize(baseVertex + positionAccessor.count);
+			for (uint32_t v = 0; v < positionAccessor.count; v++)
+			{
+				StandardVertex& vertex = vertices[baseVertex + v];
+				readFloats(positionAccessor, v, vertex.position, 3);
+				readFloats(normalAccessor, v, vertex.normal, 3);
+				const float length = std::sqrt(vertex.normal[0] * vertex.normal[0] + vertex.normal[1] * vertex.normal[1] +
+				                               vertex.normal[2] * vertex.normal[2]);
+				for (float& n : vertex.normal)
+					n /= length;
+				
+				if (texCoordEl != nullptr)
+					readFloats(accessors.at(static_cast<size_t>(texCoordEl->number)), v, vertex.texCoord, 2);
+				else
+					vertex.texCoord[0] = vertex.texCoord[1] = 0;
+				
+				vertex.tangent[0] = vertex.tangent[1] = vertex.tangent[2] = 0;
+			}
+			
+			//Tangents are derived by the same code as GLTFImporter uses, so that the lighting matches the game's.
+			Mesh_GenerateTangents(vertices.data(), static_cast<uint32_t>(vertices.size()), indices.data() + firstIndex,
+			                      static_cast<uint32_t>(indices.size()) - firstIndex);
+			
+			const std::string& baseName = meshEl["name"].string;
+			model.partNames.push_back(primitives.size() == 1 ? baseName : baseName + "_" + std::to_string(p));
+			model.partFirstIndices.push_back(firstIndex);
+			model.partNumIndices.push_back(static_cast<uint32_t>(indices.size()) - firstIndex);
+		}
+	}
+	
+	model.mesh.reset(new Mesh(VertexType::StandardPacked, static_cast<uint32_t>(vertices.size()), vertices.data(),
+	                          static_cast<uint32_t>(indices.size()), indices.data(), true, nullptr,
+	                          static_cast<uint32_t>(model.partNumIndices.size()), model.partNumIndices.data()));
+	return model;
+}
+
+// ** Bitmap font **
+
+struct FontChar
+{
+	int x, y, width, height, xOffset, yOffset, xAdvance;
+};
+
+//A BMFont text file, read and drawn the way SpriteFont and SpriteBatch.DrawString do.
+struct Font
+{
+	std::unique_ptr<Texture2D> texture;
+	std::unordered_map<uint32_t, FontChar> chars;
+	std::map<std::pair<uint32_t, uint32_t>, int> kerning;
+	int lineHeight = 0;
+};
+
+static Font LoadFont(const char* name)
+{
+	std::istringstream lines(ReadFile(resDirectory + "/UI/" + name + ".fnt"));
+	Font font;
+	std::string pageFile;
+	
+	std::string line;
+	while (std::getline(lines, line))
+	{
+		std::istringstream parts(line);
+		std::string tag;
+		parts >> tag;
+		
+		std::map<std::string, std::string> values;
+		std::string part;
+		while (parts >> part)
+		{
+			const size_t equals = part.find('=');
+			if (equals != std::string::npos)
+				values[part.substr(0, equals)] = part.substr(equals + 1);
+		}
+		
+		auto getInt = [&] (const char* key) { return std::atoi(values[key].c_str()); };
+		
+		if (tag == "common")
+		{
+			font.lineHeight = getInt("lineHeight");
+		}
+		else if (tag == "page")
+		{
+			pageFile = values["file"];
+			if (pageFile.size() >= 2 && pageFile.front() == '"' && pageFile.back() == '"')
+				pageFile = pageFile.substr(1, pageFile.size() - 2);
+		}
+		else if (tag == "char")
+		{
+			font.chars[getInt("id")] = { getInt("x"), getInt("y"), getInt("width"), getInt("height"), getInt("xoffset"),
+			                             getInt("yoffset"), getInt("xadvance") };
+		}
+		else if (tag == "kerning")
+		{
+			font.kerning[std::make_pair(getInt("first"), getInt("second"))] = getInt("amount");
+		}
+	}
+	
+	font.texture.reset(new Texture2D((resDirectory + "/UI/" + pageFile).c_str(), TextureType::sRGB32));
+	font.texture->SetSwizzle(SwizzleMode::One, SwizzleMode::One, SwizzleMode::One, SwizzleMode::R);
+	return font;
+}
+
+// ** Matrices **
+
+//Column major matrices, matching what the game uploads.
+struct Matrix4
+{
+	float m[16];
+};
+
+static Matrix4 Identity()
+{
+	Matrix4 result = { };
+	result.m[0] = result.m[5] = result.m[10] = result.m[15] = 1;
+	return result;
+}
+
+static Matrix4 Multiply(const Matrix4& a, const Matrix4& b)
+{
+	Matrix4 result = { };
+	for (int c = 0; c < 4; c++)
+	{
+		for (int r = 0; r < 4; r++)
+		{
+			for (int k = 0; k < 4; k++)
+				result.m[c * 4 + r] += a.m[k * 4 + r] * b.m[c * 4 + k];
+		}
+	}
+	return result;
+}
+
+static Matrix4 Perspective(float fovY, float aspect, float near, float far)
+{
+	const float f = 1.0f / std::tan(fovY / 2);
+	Matrix4 result = { };
+	result.m[0] = f / aspect;
+	result.m[5] = f;
+	result.m[10] = (far + near) / (near - far);
+	result.m[11] = -1;
+	result.m[14] = 2 * far * near / (near - far);
+	return result;
+}
+
+//Matches Matrix4x4.CreateOrthographic, which maps depth to [0, 1].
+static Matrix4 Orthographic(float width, float height, float near, float far)
+{
+	Matrix4 result = Identity();
+	result.m[0] = 2 / width;
+	result.m[5] = 2 / height;
+	result.m[10] = 1 / (near - far);
+	result.m[14] = near / (near - far);
+	return result;
+}
+
+static void Normalize(float v[3])
+{
+	const float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+	for (int i = 0; i < 3; i++)
+		v[i] /= length;
+}
+
+static void Cross(const float a[3], const float b[3], float out[3])
+{
+	out[0] = a[1] * b[2] - a[2] * b[1];
+	out[1] = a[2] * b[0] - a[0] * b[2];
+	out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static Matrix4 LookAt(const float eye[3], const float target[3], const float upHint[3])
+{
+	float forward[3] = { target[0] - eye[0], target[1] - eye[1], target[2] - eye[2] };
+	Normalize(forward);
+	
+	float right[3];
+	Cross(forward, upHint, right);
+	Normalize(right);
+	
+	float up[3];
+	Cross(right, forward, up);
+	
+	Matrix4 result = { };
+	for (int i = 0; i < 3; i++)
+	{
+		result.m[i * 4 + 0] = right[i];
+		result.m[i * 4 + 1] = up[i];
+		result.m[i * 4 + 2] = -forward[i];
+	}
+	result.m[12] = -(right[0] * eye[0] + right[1] * eye[1] + right[2] * eye[2]);
+	result.m[13] = -(up[0] * eye[0] + up[1] * eye[1] + up[2] * eye[2]);
+	result.m[14] = forward[0] * eye[0] + forward[1] * eye[1] + forward[2] * eye[2];
+	result.m[15] = 1;
+	return result;
+}
+
+//Scale, then a flip around the Z axis, then a rotation around the Y axis, then translation.
+static Matrix4 Transform(float x, float y, float z, float yaw, bool flip, float scaleX, float scaleY, float scaleZ)
+{
+	const float c = std::cos(yaw), s = std::sin(yaw);
+	const float f = flip ? -1.0f : 1.0f;
+	Matrix4 result = { };
+	result.m[0] = c * f * scaleX;
+	result.m[2] = -s * f * scaleX;
+	result.m[5] = f * scaleY;
+	result.m[8] = s * scaleZ;
+	result.m[10] = c * scaleZ;
+	result.m[12] = x;
+	result.m[13] = y;
+	result.m[14] = z;
+	result.m[15] = 1;
+	return result;
+}
+
+// ** Resources **
+
+//Constants shared with the game's renderers.
+static const float PI = 3.14159265f;
+static const float FOV = PI * 0.45f;
+static const float Z_NEAR = 0.1f;
+static const float Z_FAR = 1000.0f;
+static const float CAMERA_DIST = 3.5f;
+static const float BOARD_Y = 0.1f;
+
+static const float CHIP_SCALE = 0.05f;
+static const float CHIP_HEIGHT = 0.1f * CHIP_SCALE;
+static const float CHIP_BOUNDING_RADIUS = 1.01f * CHIP_SCALE;
+
+static const float CARD_SIZE = 0.2f;
+static const uint32_t CARD_BORDER_SIZE = 30;
+static const uint32_t MAX_CARDS = 128;
+
+static const uint32_t PARAMS_UNIT = 4;
+static const uint32_t SHADOW_MAP_UNIT = 3;
+static const uint32_t SHADOW_MAP_RESOLUTION = 1024;
+
+#pragma pack(push, 1)
+struct PartParams
+{
+	float specularIntensity;
+	float specularExponent;
+	float textureScale;
+	uint32_t textureSet;
+};
+
+struct CardParams
+{
+	Matrix4 worldTransform;
+	float texSourceRegion[4];
+};
+#pragma pack(pop)
+
+struct Card
+{
+	float x;
+	float z;
+	float yaw;
+	bool faceUp;
+	
+	//0 is the ace, 1 to 12 are two to king.
+	uint32_t rank;
+	uint32_t suit;
+};
+
+//Resources shared by the scenes, created once the context exists.
+struct Resources
+{
+	GLuint framebuffer;
+	GLuint renderbuffers[2];
+	
+	SpriteBatch* spriteBatch;
+	std::unique_ptr<Texture2D> buttonTexture;
+	std::unique_ptr<Texture2D> pixelTexture;
+	Font font;
+	Font boldFont;
+	
+	BlurFB* blurFB;
+	std::unique_ptr<Shader> blurShader;
+	int blurVectorLocation;
+	
+	UniformBuffer* viewProjBuffer;
+	ShadowMap* shadowMap;
+	ShadowMatrixBuffer* shadowMatrixBuffer;
+	Matrix4 shadowMatrix;
+	
+	Model boardModel;
+	DrawList* boardDrawList;
+	std::unique_ptr<Shader> boardShader;
+	std::unique_ptr<Shader> boardShadowShader;
+	std::unique_ptr<Texture2D> boardTextures[6];
+	
+	Model chipModel;
+	ChipsBuffer* chipStacks;
+	ChipCuller* chipCuller;
+	std::unique_ptr<Shader> cullShader;
+	std::unique_ptr<Shader> chipShader;
+	std::unique_ptr<Shader> chipShadowShader;
+	std::vector<ChipStack> showdownStacks;
+	uint32_t showdownChips;
+	
+	std::unique_ptr<Mesh> cardMesh;
+	DrawList* cardDrawList;
+	DrawList* cardShadowDrawList;
+	std::unique_ptr<Shader> cardShader;
+	std::unique_ptr<Shader> cardShadowShader;
+	std::unique_ptr<Texture2D> cardsTexture;
+	std::unique_ptr<Texture2D> cardBackTexture;
+	uint32_t cardWidth;
+	uint32_t cardHeight;
+	std::vector<Card> showdownCards;
+	std::vector<Card> menuCards;
+};
+
+static Resources res;
+
+//A full table of players with a few stacks and two cards each, the pot and the community cards in the middle.
+static void CreateShowdown()
+{
+	const uint32_t colors[] = { 0xFF2020C0, 0xFFC02020, 0xFF20A020, 0xFF202020, 0xFFE0E0E0 };
+	
+	uint32_t firstChip = 0;
+	auto addStack = [&] (float x, float z, uint32_t count, uint32_t seed, uint32_t color)
+	{
+		ChipStack stack = { x, BOARD_Y, z, seed * 0.37f, firstChip, count, seed, color };
+		res.showdownStacks.push_back(stack);
+		firstChip += count;
+	};
+	
+	for (uint32_t player = 0; player < NUM_PLAYERS; player++)
+	{
+		const float angle = player * 2 * PI / NUM_PLAYERS;
+		const float sinA = std::sin(angle), cosA = std::cos(angle);
+		for (uint32_t s = 0; s < 4; s++)
+		{
+			const float x = sinA * 1.2f + (s % 2) * 0.11f;
+			const float z = cosA * 2.1f + (s / 2) * 0.11f;
+			addStack(x, z, 8 + (player * 7 + s * 5) % 13, player * 4 + s + 1, colors[(player + s) % 5]);
+		}
+		
+		for (uint32_t c = 0; c < 2; c++)
+		{
+			const float offset = (c == 0 ? -0.1f : 0.1f);
+			res.showdownCards.push_back({ sinA * 0.85f + cosA * offset, cosA * 1.5f - sinA * offset, angle, true,
+			                              (player * 5 + c * 3) % 13, (player + c) % 4 });
+		}
+	}
+	
+	for (uint32_t s = 0; s < 12; s++)
+		addStack(0.4f + (s % 3) * 0.11f, (s / 3) * 0.11f - 0.165f, 15 + s, 100 + s, colors[s % 5]);
+	
+	res.showdownChips = firstChip;
+	
+	const uint32_t communityRanks[] = { 0, 12, 9, 4, 7 };
+	for (uint32_t i = 0; i < 5; i++)
+		res.showdownCards.push_back({ 0, 0.8f - i * 0.4f, PI / 2, true, communityRanks[i], (i * 3) % 4 });
+}
+
+//The community cards of the menu background, three of them revealed.
+static void CreateMenuCards()
+{
+	for (uint32_t i = 0; i < 5; i++)
+		res.menuCards.push_back({ 0, 0.8f - i * 0.4f, PI / 2, i < 3, (i * 4 + 1) % 13, i % 4 });
+}
+
+static void CreateResources()
+{
+	glGenFramebuffers(1, &res.framebuffer);
+	glGenRenderbuffers(2, res.renderbuffers);
+	glBindRenderbuffer(GL_RENDERBUFFER, res.renderbuffers[0]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, WIDTH, HEIGHT);
+	glBindRenderbuffer(GL_RENDERBUFFER, res.renderbuffers[1]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, WIDTH, HEIGHT);
+	glBindFramebuffer(GL_FRAMEBUFFER, res.framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, res.renderbuffers[0]);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, res.renderbuffers[1]);
+	
+	res.spriteBatch = SB_Create();
+	SB_SetDisplaySize(res.spriteBatch, WIDTH, HEIGHT);
+	res.buttonTexture.reset(new Texture2D((resDirectory + "/UI/Button.png").c_str(), TextureType::sRGB32));
+	res.pixelTexture.reset(new Texture2D((resDirectory + "/UI/Pixel.png").c_str(), TextureType::sRGB32));
+	res.font = LoadFont("Font");
+	res.boldFont = LoadFont("FontBold");
+	
+	res.blurFB = BlurFB_Create(WIDTH, HEIGHT);
+	res.blurShader = LoadShader("Blur.vs.glsl", "Blur.fs.glsl");
+	res.blurVectorLocation = res.blurShader->GetUniformLocation("blurVector");
+	
+	//The same light as the game states, with the volume of ShadowMapper.
+	float lightDirection[] = { 0.5f, -0.75f, 1.0f };
+	Normalize(lightDirection);
+	const float zero[] = { 0, 0, 0 };
+	const float unitY[] = { 0, 1, 0 };
+	float shadowUp[3];
+	Cross(lightDirection, unitY, shadowUp);
+	Normalize(shadowUp);
+	res.shadowMatrix = Multiply(Orthographic(10, 10, -100, 100), LookAt(zero, lightDirection, shadowUp));
+	res.shadowMatrixBuffer = SMB_Create(res.shadowMatrix.m);
+	res.shadowMap = SM_Create(SHADOW_MAP_RESOLUTION);
+	res.viewProjBuffer = UB_Create(sizeof(float) * (4 * 4 * 2 + 4));
+	
+	//The board with the materials of BoardModel.
+	res.boardModel = LoadModel("Board");
+	res.boardShader = LoadShader("Board.vs.glsl", "Board.fs.glsl");
+	res.boardShadowShader = LoadShader("BoardShadow.vs.glsl", nullptr);
+	
+	const char* boardTextureNames[] = { "RubberD", "RubberN", "RubberS", "WoodD", "WoodN", "WoodS" };
+	const TextureType boardTextureTypes[] = { TextureType::sRGB32, TextureType::Linear32, TextureType::Linear8 };
+	for (int i = 0; i < 6; i++)
+	{
+		const std::string path = resDirectory + "/Textures/" + boardTextureNames[i] + ".png";
+		res.boardTextures[i].reset(new Texture2D(path.c_str(), boardTextureTypes[i % 3]));
+		res.boardTextures[i]->SetRepeat(true);
+	}
+	
+	const PartParams rubberParams = { 0.4f, 10.0f, 4, 0 };
+	const PartParams woodParams = { 0.9f, 10.0f, 2, 1 };
+	res.boardDrawList = DL_Create(res.boardModel.mesh.get(), 2, sizeof(PartParams));
+	const uint32_t rubberPart = res.boardModel.FindPart("Board_0");
+	const uint32_t woodPart = res.boardModel.FindPart("Board_1");
+	const DrawDesc rubberDraw = { res.boardModel.partFirstIndices[rubberPart], res.boardModel.partNumIndices[rubberPart], 0, 1 };
+	const DrawDesc woodDraw = { res.boardModel.partFirstIndices[woodPart], res.boardModel.partNumIndices[woodPart], 0, 1 };
+	DL_Add(res.boardDrawList, &rubberDraw, &rubberParams);
+	DL_Add(res.boardDrawList, &woodDraw, &woodParams);
+	
+	//Chips as ChipsRenderer draws them.
+	res.chipModel = LoadModel("Chip");
+	const uint32_t numChipParts = static_cast<uint32_t>(res.chipModel.partNumIndices.size());
+	res.chipCuller = CC_Create(res.chipModel.mesh.get(), res.chipModel.partFirstIndices.data(),
+	                           res.chipModel.partNumIndices.data(), numChipParts);
+	
+	res.cullShader.reset(new Shader());
+	const std::string cullCode = "#version 440 core\n" + PreprocessShader(ReadFile(resDirectory + "/Shaders/ChipCull.cs.glsl"));
+	res.cullShader->AttachStage(Shader::StageType::Compute, cullCode.c_str());
+	res.cullShader->Link();
+	res.cullShader->SetUniform(res.cullShader->GetUniformLocation("numMeshes"), static_cast<int32_t>(numChipParts));
+	res.cullShader->SetUniform(res.cullShader->GetUniformLocation("chipHeight"), CHIP_HEIGHT);
+	res.cullShader->SetUniform(res.cullShader->GetUniformLocation("boundingRadius"), CHIP_BOUNDING_RADIUS);
+	
+	res.chipShader = LoadShader("Chip.vs.glsl", "Chip.fs.glsl");
+	res.chipShader->SetUniform(res.chipShader->GetUniformLocation("scale"), CHIP_SCALE);
+	res.chipShader->SetUniform(res.chipShader->GetUniformLocation("albedo"), 1.0f, 1.0f, 1.0f);
+	res.chipShader->SetUniform(res.chipShader->GetUniformLocation("specularIntensity"), 1.0f);
+	res.chipShader->SetUniform(res.chipShader->GetUniformLocation("specularExponent"), 5.0f);
+	res.chipShadowShader = LoadShader("ChipShadow.vs.glsl", nullptr);
+	res.chipShadowShader->SetUniform(res.chipShadowShader->GetUniformLocation("scale"), CHIP_SCALE);
+	
+	//Cards as CardRenderer draws them.
+	float cardVertices[] = { -1, -1, 1, -1, -1, 1, 1, 1 };
+	uint32_t cardIndices[] = { 0, 1, 2, 2, 1, 3 };
+	res.cardMesh.reset(new Mesh(VertexType::Card, 4, cardVertices, 6, cardIndices));
+	res.cardDrawList = DL_Create(res.cardMesh.get(), MAX_CARDS, sizeof(CardParams));
+	res.cardShadowDrawList = DL_Create(res.cardMesh.get(), MAX_CARDS, sizeof(Matrix4));
+	res.cardShader = LoadShader("Card.vs.glsl", "Card.fs.glsl");
+	res.cardShadowShader = LoadShader("CardShadow.vs.glsl", "CardShadow.fs.glsl");
+	
+	res.cardsTexture.reset(new Texture2D((resDirectory + "/Textures/Cards.png").c_str(), TextureType::sRGB32));
+	res.cardsTexture->SetLodBias(-1);
+	res.cardBackTexture.reset(new Texture2D((resDirectory + "/Textures/CardBack.png").c_str(), TextureType::sRGB32));
+	res.cardWidth = (res.cardsTexture->GetWidth() - CARD_BORDER_SIZE * 14) / 13;
+	res.cardHeight = (res.cardsTexture->GetHeight() - CARD_BORDER_SIZE * 5) / 4;
+	
+	CreateShowdown();
+	CreateMenuCards();
+	res.chipStacks = CB_CreateStacks(res.showdownStacks.size());
+}
+
+static void DestroyResources()
+{
+	DL_Destroy(res.cardDrawList);
+	DL_Destroy(res.cardShadowDrawList);
+	CB_Destroy(res.chipStacks);
+	CC_Destroy(res.chipCuller);
+	DL_Destroy(res.boardDrawList);
+	UB_Destroy(res.viewProjBuffer);
+	SM_Destroy(res.shadowMap);
+	SMB_Destroy(res.shadowMatrixBuffer);
+	BlurFB_Destroy(res.blurFB);
+	SB_Destroy(res.spriteBatch);
+	glDeleteRenderbuffers(2, res.renderbuffers);
+	glDeleteFramebuffers(1, &res.framebuffer);
+	res = Resources();
+}
+
+// ** Drawing **
+
+static void BindTarget()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, res.framebuffer);
+	glViewport(0, 0, WIDTH, HEIGHT);
+}
+
+static void ClearTarget(float r, float g, float b)
+{
+	const float color[] = { r, g, b, 1 };
+	glClearBufferfv(GL_COLOR, 0, color);
+	FB_ClearDepth();
+}
+
+static void DrawSprite(const Texture2D& texture, float x, float y, float width, float height, const uint8_t color[4])
+{
+	Sprite sprite = { x, y, width, height, 0, 0, static_cast<float>(texture.GetWidth()),
+	                  static_cast<float>(texture.GetHeight()), { color[0], color[1], color[2], color[3] } };
+	SB_Draw(res.spriteBatch, &texture, &sprite);
+}
+
+static void DrawString(const Font& font, const char* text, float x, float y, const uint8_t color[4])
+{
+	int advance = 0;
+	for (size_t i = 0; text[i] != '\0'; i++)
+	{
+		const auto character = font.chars.find(static_cast<uint8_t>(text[i]));
+		if (character == font.chars.end())
+			continue;
+		
+		int kerning = 0;
+		if (i > 0)
+		{
+			const auto pair = font.kerning.find(std::make_pair(static_cast<uint8_t>(text[i - 1]), static_cast<uint8_t>(text[i])));
+			if (pair != font.kerning.end())
+				kerning = pair->second;
+		}
+		
+		const FontChar& c = character->second;
+		Sprite sprite = { x + advance + c.xOffset + kerning, y + c.yOffset, static_cast<float>(c.width),
+		                  static_cast<float>(c.height), static_cast<float>(c.x), static_cast<float>(c.y),
+		                  static_cast<float>(c.width), static_cast<float>(c.height),
+		                  { color[0], color[1], color[2], color[3] } };
+		SB_Draw(res.spriteBatch, font.texture.get(), &sprite);
+		
+		advance += c.xAdvance + kerning;
+	}
+}
+
+static int MeasureString(const Font& font, const char* text)
+{
+	int width = 0;
+	for (size_t i = 0; text[i] != '\0'; i++)
+	{
+		const auto character = font.chars.find(static_cast<uint8_t>(text[i]));
+		if (character != font.chars.end())
+			width += character->second.xAdvance;
+	}
+	return width;
+}
+
+//Camera around the center of the board, pitched down towards it as in the game states.
+static Matrix4 UpdateCamera(float pitch, float yaw)
+{
+	const float eye[] = { CAMERA_DIST * std::cos(pitch) * std::sin(yaw), CAMERA_DIST * std::sin(pitch),
+	                      CAMERA_DIST * std::cos(pitch) * std::cos(yaw) };
+	const float target[] = { 0, 0, 0 };
+	const float up[] = { 0, 1, 0 };
+	const Matrix4 viewProj = Multiply(Perspective(FOV, WIDTH / static_cast<float>(HEIGHT), Z_NEAR, Z_FAR),
+	                                  LookAt(eye, target, up));
+	
+	//ViewProjUB: the view projection matrix, its inverse, which only the sky uses, and the camera position.
+	float* mapping = static_cast<float*>(UB_GetMapping(res.viewProjBuffer));
+	std::memcpy(mapping, viewProj.m, sizeof(viewProj.m));
+	std::memset(mapping + 16, 0, sizeof(float) * 16);
+	std::memcpy(mapping + 32, eye, sizeof(eye));
+	UB_Flush(res.viewProjBuffer);
+	
+	return viewProj;
+}
+
+static void AddCards(const std::vector<Card>& cards)
+{
+	const float xScale = res.cardWidth / static_cast<float>(res.cardHeight);
+	const float xSrcScale = 1.0f / res.cardsTexture->GetWidth();
+	const float ySrcScale = 1.0f / res.cardsTexture->GetHeight();
+	const DrawDesc cardDraw = { 0, 6, 0, 1 };
+	
+	DL_Clear(res.cardDrawList);
+	DL_Clear(res.cardShadowDrawList);
+	for (const Card& card : cards)
+	{
+		const float srcX = static_cast<float>(card.rank * (res.cardWidth + CARD_BORDER_SIZE) + CARD_BORDER_SIZE);
+		const float srcY = static_cast<float>(card.suit * (res.cardHeight + CARD_BORDER_SIZE) + CARD_BORDER_SIZE);
+		
+		CardParams params;
+		params.worldTransform = Transform(card.x, BOARD_Y + 0.005f, card.z, card.yaw, card.faceUp,
+		                                  xScale * CARD_SIZE, CARD_SIZE, CARD_SIZE);
+		params.texSourceRegion[0] = srcX * xSrcScale;
+		params.texSourceRegion[1] = srcY * ySrcScale;
+		params.texSourceRegion[2] = (srcX + res.cardWidth) * xSrcScale;
+		params.texSourceRegion[3] = (srcY + res.cardHeight) * ySrcScale;
+		
+		DL_Add(res.cardDrawList, &cardDraw, &params);
+		DL_Add(res.cardShadowDrawList, &cardDraw, &params.worldTransform);
+	}
+}
+
+static void DrawBoard()
+{
+	res.boardShader->Bind();
+	for (int i = 0; i < 6; i++)
+		res.boardTextures[i]->Bind(i < 3 ? i : i + 1);
+	DL_Submit(res.boardDrawList, PARAMS_UNIT);
+}
+
+static void DrawCards()
+{
+	SetFixedFunctionState(FF_AlphaBlend | FF_DepthTest);
+	res.cardShader->Bind();
+	res.cardsTexture->Bind(0);
+	res.cardBackTexture->Bind(1);
+	DL_Submit(res.cardDrawList, PARAMS_UNIT);
+}
+
+static void CullChips(const Matrix4& viewProj)
+{
+	CB_UploadStacks(res.chipStacks, res.showdownStacks.data(), res.showdownStacks.size());
+	CB_Bind(res.chipStacks, 0);
+	
+	Shader& cull = *res.cullShader;
+	cull.Bind();
+	cull.SetUniformMat4(cull.GetUniformLocation("viewProj"), viewProj.m);
+	cull.SetUniformMat4(cull.GetUniformLocation("shadowMatrix"), res.shadowMatrix.m);
+	cull.SetUniform(cull.GetUniformLocation("numChips"), static_cast<int32_t>(res.showdownChips));
+	cull.SetUniform(cull.GetUniformLocation("numStacks"), static_cast<int32_t>(res.showdownStacks.size()));
+	CC_Cull(res.chipCuller, res.showdownChips);
+}
+
+//The table is drawn like MainGameState and MenuBackground draw it: a shadow pass, then the opaque geometry and the
+// cards. Chips must have been culled before.
+static void DrawTableShadows(bool withChips)
+{
+	SetFixedFunctionState(FF_DepthTest | FF_DepthWrite);
+	SM_BindFramebuffer(res.shadowMap);
+	FB_ClearDepth();
+	SMB_Bind(res.shadowMatrixBuffer, 0);
+	
+	if (withChips)
+	{
+		res.chipShadowShader->Bind();
+		CC_Draw(res.chipCuller, ChipCullPass::Shadow);
+	}
+	res.cardShadowShader->Bind();
+	res.cardBackTexture->Bind(0);
+	DL_Submit(res.cardShadowDrawList, PARAMS_UNIT);
+	res.boardShadowShader->Bind();
+	res.boardModel.mesh->Draw();
+}
+
+static void DrawTableMain(bool withChips)
+{
+	SetFixedFunctionState(FF_DepthTest | FF_DepthWrite);
+	UB_Bind(res.viewProjBuffer, 0);
+	SM_BindTexture(res.shadowMap, SHADOW_MAP_UNIT);
+	SMB_Bind(res.shadowMatrixBuffer, 1);
+	
+	DrawBoard();
+	if (withChips)
+	{
+		res.chipShader->Bind();
+		CC_Draw(res.chipCuller, ChipCullPass::Main);
+	}
+	DrawCards();
+}
+
+// ** Scenes **
+
+static void DrawEmptyTable()
+{
+	UpdateCamera(PI * 0.4f, PI / 2);
+	AddCards({ });
+	
+	DrawTableShadows(false);
+	BindTarget();
+	ClearTarget(0.02f, 0.02f, 0.02f);
+	DrawTableMain(false);
+}
+
+static void DrawShowdown()
+{
+	const Matrix4 viewProj = UpdateCamera(PI * 0.4f, PI / 2);
+	AddCards(res.showdownCards);
+	
+	CullChips(viewProj);
+	DrawTableShadows(true);
+	BindTarget();
+	ClearTarget(0.02f, 0.02f, 0.02f);
+	DrawTableMain(true);
+	
+	//Player name plates.
+	const char* names[NUM_PLAYERS] = { "Alice", "Bob", "Carol", "Dave", "Erin", "Frank", "Grace", "Heidi" };
+	const uint8_t plate[] = { 0, 0, 0, 160 };
+	const uint8_t white[] = { 255, 255, 255, 255 };
+	SetFixedFunctionState(FF_AlphaBlend);
+	SB_Begin(res.spriteBatch);
+	for (uint32_t player = 0; player < NUM_PLAYERS; player++)
+		DrawSprite(*res.pixelTexture, 90 + (player % 4) * 290, player < 4 ? 30 : 620, 230, 70, plate);
+	for (uint32_t player = 0; player < NUM_PLAYERS; player++)
+		DrawString(res.font, names[player], 105 + (player % 4) * 290, player < 4 ? 30 : 620, white);
+	SB_End(res.spriteBatch);
+}
+
+static void DrawMenuBlur()
+{
+	//The menu background, blurred by the same passes as BlurEffect.RenderBlur into the test's framebuffer.
+	UpdateCamera(PI * 0.3f, 0.7f);
+	AddCards(res.menuCards);
+	
+	DrawTableShadows(false);
+	BlurFB_BindFramebuffer(res.blurFB, 0);
+	glViewport(0, 0, WIDTH, HEIGHT);
+	ClearTarget(1, 1, 1);
+	SetFixedFunctionState(FF_Multisample | FF_DepthTest | FF_DepthWrite);
+	DrawTableMain(false);
+	
+	SetFixedFunctionState(0);
+	BlurFB_Resolve(res.blurFB, false);
+	res.blurShader->Bind();
+	
+	const float INTENSITY = 1.0f;
+	const int NUM_PASSES = 2;
+	for (int i = 0; i < NUM_PASSES; i++)
+	{
+		BlurFB_BindFramebuffer(res.blurFB, 2);
+		BlurFB_BindTexture(res.blurFB, 1);
+		res.blurShader->SetUniform(res.blurVectorLocation, INTENSITY / WIDTH, 0.0f);
+		Blur_DrawFST();
+		
+		if (i == NUM_PASSES - 1)
+			BindTarget();
+		else
+			BlurFB_BindFramebuffer(res.blurFB, 1);
+		BlurFB_BindTexture(res.blurFB, 2);
+		res.blurShader->SetUniform(res.blurVectorLocation, 0.0f, INTENSITY / HEIGHT);
+		Blur_DrawFST();
+	}
+	
+	const char* labels[] = { "Connect", "Host", "Settings", "Quit" };
+	const uint8_t white[] = { 255, 255, 255, 255 };
+	SetFixedFunctionState(FF_AlphaBlend);
+	SB_Begin(res.spriteBatch);
+	for (int i = 0; i < 4; i++)
+		DrawSprite(*res.buttonTexture, WIDTH / 2 - 150, 220 + i * 90, 300, 70, white);
+	for (int i = 0; i < 4; i++)
+	{
+		const float x = WIDTH / 2.0f - MeasureString(res.boldFont, labels[i]) / 2.0f;
+		DrawString(res.boldFont, labels[i], x, 220 + i * 90, white);
+	}
+	SB_End(res.spriteBatch);
+}
+
+static void DrawTextSummary()
+{
+	BindTarget();
+	ClearTarget(0.02f, 0.02f, 0.02f);
+	
+	//Laid out like the end of game summary.
+	const uint8_t panel[] = { 0, 0, 0, 200 };
+	const uint8_t white[] = { 255, 255, 255, 255 };
+	const uint8_t gold[] = { 255, 215, 80, 255 };
+	const char* hands[NUM_PLAYERS] = { "Straight Flush", "Four of a Kind", "Full House", "Flush", "Straight",
+	                                   "Three of a Kind", "Two Pair", "Pair" };
+	
+	SetFixedFunctionState(FF_AlphaBlend);
+	SB_Begin(res.spriteBatch);
+	DrawSprite(*res.pixelTexture, 40, 20, WIDTH - 80, HEIGHT - 40, panel);
+	SB_End(res.spriteBatch);
+	
+	SB_Begin(res.spriteBatch);
+	DrawString(res.boldFont, "Game Summary", 60, 30, gold);
+	for (uint32_t line = 0; line < NUM_PLAYERS; line++)
+	{
+		const std::string player = "Player " + std::to_string(line + 1) + ": " + hands[line];
+		const std::string chips = std::to_string(1000 + line * 250) + " chips, won " + std::to_string(line * 3) + " hands";
+		const float y = 40.0f + (line + 1) * res.font.lineHeight * 0.85f;
+		DrawString(res.font, player.c_str(), 60, y, white);
+		DrawString(res.font, chips.c_str(), 700, y, white);
+	}
+	SB_End(res.spriteBatch);
+}
+
+struct Scene
+{
+	const char* name;
+	void (*draw)();
+	
+	//Budgets for the median frame and for the number of draw calls per frame.
+	float maxGPUMS;
+	float maxCPUMS;
+	uint32_t maxDrawCalls;
+};
+
+//Draw calls: the shadow pass and the main pass draw the board, cards and chips with one (multi) draw each, and
+// sprite batches draw once per texture.
+static const Scene scenes[] =
+{
+	{ "EmptyTable", DrawEmptyTable, 2.0f, 1.0f, 4 },
+	{ "Showdown", DrawShowdown, 4.0f, 2.0f, 8 },
+	{ "MenuBlur", DrawMenuBlur, 4.0f, 2.0f, 10 },
+	{ "TextSummary", DrawTextSummary, 2.0f, 2.0f, 3 }
+};
+
+enum class GoldenMode
+{
+	Compare,
+	Update,
+	
+	//Only the budgets are checked.
+	Ignore
+};
+
+enum class SceneResult
+{
+	Passed,
+	Failed,
+	
+	//The budgets were met, but there is no golden image to compare with.
+	Skipped
+};
+
+static std::vector<uint8_t> ReadTarget()
+{
+	std::vector<uint8_t> pixels(WIDTH * HEIGHT * 4);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, res.framebuffer);
+	glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	return pixels;
+}
+
+static bool WritePNG(const std::string& path, const std::vector<uint8_t>& pixels)
+{
+	const std::vector<uint8_t> png = EncodePNG(pixels.data(), WIDTH, HEIGHT);
+	std::ofstream stream(path, std::ios::binary);
+	stream.write(reinterpret_cast<const char*>(png.data()), png.size());
+	return static_cast<bool>(stream);
+}
+
+//Returns the fraction of differing pixels, 1 if the golden image has the wrong size, or a negative value if there is
+// no golden image.
+static double CompareWithGolden(const std::string& goldenPath, const std::vector<uint8_t>& pixels)
+{
+	int width, height;
+	stbi_uc* golden = stbi_load(goldenPath.c_str(), &width, &height, nullptr, 4);
+	if (golden == nullptr)
+		return -1;
+	if (width != static_cast<int>(WIDTH) || height != static_cast<int>(HEIGHT))
+	{
+		stbi_image_free(golden);
+		return 1;
+	}
+	
+	//Read back rows are bottom up, image rows top down.
+	uint64_t differing = 0;
+	for (uint32_t y = 0; y < HEIGHT; y++)
+	{
+		const uint8_t* actualRow = pixels.data() + (HEIGHT - 1 - y) * WIDTH * 4;
+		const uint8_t* goldenRow = golden + y * WIDTH * 4;
+		for (uint32_t x = 0; x < WIDTH * 4; x += 4)
+		{
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				if (std::abs(actualRow[x + c] - goldenRow[x + c]) > CHANNEL_TOLERANCE)
+				{
+					differing++;
+					break;
+				}
+			}
+		}
+	}
+	
+	stbi_image_free(golden);
+	return differing / static_cast<double>(WIDTH * HEIGHT);
+}
+
+static float Median(std::vector<float> values)
+{
+	std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+	return values[values.size() / 2];
+}
+
+static SceneResult RunScene(const Scene& scene, const std::string& goldenDirectory, GoldenMode goldenMode)
+{
+	GLuint query;
+	glGenQueries(1, &query);
+	
+	std::vector<float> gpuTimes;
+	std::vector<float> cpuTimes;
+	uint32_t drawCalls = 0;
+	
+	for (uint32_t frame = 0; frame < WARMUP_FRAMES + MEASURED_FRAMES; frame++)
+	{
+		const uint32_t drawCallsBefore = DrawCallCount;
+		const auto cpuStart = std::chrono::steady_clock::now();
+		
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		scene.draw();
+		glEndQuery(GL_TIME_ELAPSED);
+		
+		const auto cpuEnd = std::chrono::steady_clock::now();
+		drawCalls = DrawCallCount - drawCallsBefore;
+		
+		//Frames are not overlapped, so that the GPU time of one scene is not hidden behind another.
+		GLuint64 gpuTime;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &gpuTime);
+		
+		if (frame >= WARMUP_FRAMES)
+		{
+			gpuTimes.push_back(gpuTime * 1E-6f);
+			cpuTimes.push_back(std::chrono::duration<float, std::milli>(cpuEnd - cpuStart).count());
+		}
+		
+		FrameIndex++;
+		FrameQueueIndex = FrameIndex % QueuedFrames;
+	}
+	
+	glDeleteQueries(1, &query);
+	
+	const float gpuMS = Median(gpuTimes);
+	const float cpuMS = Median(cpuTimes);
+	SceneResult result = SceneResult::Passed;
+	
+	std::cout << scene.name << ": " << gpuMS << " ms GPU, " << cpuMS << " ms CPU, " << drawCalls << " draw calls";
+	
+	const std::vector<uint8_t> pixels = ReadTarget();
+	const std::string goldenPath = goldenDirectory + "/" + scene.name + ".png";
+	if (goldenMode == GoldenMode::Ignore)
+	{
+		std::cout << std::endl;
+	}
+	else if (goldenMode == GoldenMode::Update)
+	{
+		if (!WritePNG(goldenPath, pixels))
+			Panic(("Error writing '" + goldenPath + "'.").c_str());
+		std::cout << ", golden image updated" << std::endl;
+	}
+	else
+	{
+		const double differing = CompareWithGolden(goldenPath, pixels);
+		const std::string actualPath = std::string(scene.name) + ".actual.png";
+		if (differing < 0)
+		{
+			WritePNG(actualPath, pixels);
+			std::cout << ", no golden image" << std::endl;
+			std::cout << "  SKIPPED: output written to " << actualPath << ", run with --update-golden to accept it" << std::endl;
+			result = SceneResult::Skipped;
+		}
+		else
+		{
+			std::cout << ", " << differing * 100 << "% of pixels differ" << std::endl;
+			if (differing > MAX_DIFFERING_PIXELS)
+			{
+				WritePNG(actualPath, pixels);
+				std::cout << "  FAILED: output does not match the golden image, written to " << actualPath << std::endl;
+				result = SceneResult::Failed;
+			}
+		}
+	}
+	
+	if (gpuMS > scene.maxGPUMS)
+	{
+		std::cout << "  FAILED: GPU time over budget of " << scene.maxGPUMS << " ms" << std::endl;
+		result = SceneResult::Failed;
+	}
+	if (cpuMS > scene.maxCPUMS)
+	{
+		std::cout << "  FAILED: CPU time over budget of " << scene.maxCPUMS << " ms" << std::endl;
+		result = SceneResult::Failed;
+	}
+	if (drawCalls > scene.maxDrawCalls)
+	{
+		std::cout << "  FAILED: draw calls over budget of " << scene.maxDrawCalls << std::endl;
+		result = SceneResult::Failed;
+	}
+	
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		std::cerr << "Usage: RenderTests <resource directory> <golden image directory> [--update-golden | --budget-only]"
+		          << std::endl;
+		return 2;
+	}
+	
+	resDirectory = argv[1];
+	const std::string goldenDirectory = argv[2];
+	GoldenMode goldenMode = GoldenMode::Compare;
+	if (argc > 3 && std::strcmp(argv[3], "--update-golden") == 0)
+		goldenMode = GoldenMode::Update;
+	else if (argc > 3 && std::strcmp(argv[3], "--budget-only") == 0)
+		goldenMode = GoldenMode::Ignore;
+	
+	if (SDL_Init(SDL_INIT_VIDEO) != 0)
+		Panic(SDL_GetError());
+	
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 4);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+	
+	//The window is only needed for the context, everything is rendered to an offscreen framebuffer.
+	SDL_Window* window = SDL_CreateWindow("RenderTests", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 64, 64,
+	                                      SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+	if (window == nullptr)
+		Panic(SDL_GetError());
+	
+	SDL_GLContext glContext = SDL_GL_CreateContext(window);
+	if (glContext == nullptr)
+		Panic(SDL_GetError());
+	
+	glewExperimental = GL_TRUE;
+	if (glewInit() != GLEW_OK)
+		Panic("Error initializing GLEW.");
+	
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &UniformBufferOffsetAlignment);
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &SSBOOffsetAlignment);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	DisplayWidth = WIDTH;
+	DisplayHeight = HEIGHT;
+	
+	CreateResources();
+	
+	uint32_t failed = 0;
+	uint32_t skipped = 0;
+	for (const Scene& scene : scenes)
+	{
+		const SceneResult result = RunScene(scene, goldenDirectory, goldenMode);
+		if (result == SceneResult::Failed)
+			failed++;
+		else if (result == SceneResult::Skipped)
+			skipped++;
+	}
+	
+	DestroyResources();
+	
+	SDL_GL_DeleteContext(glContext);
+	SDL_DestroyWindow(window);
+	SDL_Quit();
+	
+	const uint32_t numScenes = sizeof(scenes) / sizeof(Scene);
+	std::cout << failed << " of " << numScenes << " scenes failed, " << skipped << " skipped" << std::endl;
+	if (failed != 0)
+		return 1;
+	return skipped != 0 ? SKIPPED_EXIT_CODE : 0;
+}
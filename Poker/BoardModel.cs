@@ -77,6 +77,7 @@ namespace Poker
 		
 		public void Dispose()
 		{
+			m_boardModel.Dispose();
 			m_boardShader.Dispose();
 			m_greenRubberDiffuseTexture.Dispose();
 			m_greenRubberNormalMap.Dispose();
@@ -15,6 +15,9 @@ namespace Poker
 			public Hands.Hand hand;
 			public int winnings;
 			
+			//Equity on the flop against the other players at the showdown holding any hands.
+			public Hands.EquityCalculator flopEquity;
+			
 			public PlayerEntry(Player player, Net.Connection connection)
 			{
 				this.player = player;
@@ -96,56 +99,57 @@ namespace Poker
 		{
 			Visible = true;
 			
+			DisposeFlopEquities();
 			m_players = connection.Players.Select(player => new PlayerEntry(player, connection))
 			            .OrderByDescending(i => i).ToArray();
 			
 			m_connection = connection;
 			
 			//Calculates winnings
-			for (int pot = 0;; pot++)
+			GameDriver driver = connection.GameDriver;
+			Card[][] holeCards = new Card[driver.Players.Length][];
+			for (int i = 0; i < driver.Players.Length; i++)
+				holeCards[i] = connection.GetClientById(driver.Players[i].ClientId).RevealedPocketCards;
+			
+			ushort[] strengths = new ushort[driver.Players.Length];
+			int[] winnings = new int[driver.Players.Length];
+			driver.ResolveShowdown(connection.CommunityCards, holeCards, strengths, winnings);
+			
+			for (int i = 0; i < m_players.Length; i++)
+				m_players[i].winnings = winnings[Array.IndexOf(driver.Players, m_players[i].player)];
+			
+			StartFlopEquities(connection);
+		}
+		
+		private const ulong FLOP_EQUITY_DEALS = 100000;
+		
+		private void StartFlopEquities(Net.Connection connection)
+		{
+			PlayerEntry[] shownPlayers = m_players.Where(p => p.hand != null).ToArray();
+			if (shownPlayers.Length < 2 || connection.CommunityCardsRevealed < 3)
+				return;
+			
+			Card[] flop = connection.CommunityCards.Take(3).ToArray();
+			foreach (PlayerEntry entry in shownPlayers)
 			{
-				int size = 0;
-				int contributors = 0;
-				int firstContributor = -1;
-				
-				for (int i = 0; i < m_players.Length; i++)
-				{
-					if (pot < m_players[i].player.ContributionAmounts.Count)
-					{
-						int contribution = m_players[i].player.ContributionAmounts[pot];
-						if (contribution > 0)
-						{
-							if (!m_players[i].player.HasFolded)
-							{
-								if (firstContributor == -1)
-									firstContributor = i;
-								contributors++;
-							}
-							size += contribution;
-						}
-					}
-				}
-				
-				if (size == 0)
-					break;
+				Hands.HandRange[] ranges = new Hands.HandRange[shownPlayers.Length];
+				ranges[0] = Hands.HandRange.Single(entry.client.RevealedPocketCards[0], entry.client.RevealedPocketCards[1]);
+				for (int i = 1; i < ranges.Length; i++)
+					ranges[i] = Hands.HandRange.Any();
 				
-				int numWinners = 1;
-				for (int i = firstContributor + 1; i < m_players.Length; i++)
-				{
-					if (m_players[i].CompareTo(m_players[i - 1]) != 0)
-						break;
-					numWinners++;
-				}
-				
-				int winnings = size / numWinners;
-				int rem = size % numWinners;
-				
-				for (int i = 0; i < numWinners; i++)
-				{
-					m_players[firstContributor + i].winnings += winnings;
-					if (i < rem)
-						m_players[firstContributor + i].winnings++;
-				}
+				entry.flopEquity = Hands.EquityCalculator.FromRanges(ranges, flop, null, FLOP_EQUITY_DEALS);
+			}
+		}
+		
+		private void DisposeFlopEquities()
+		{
+			if (m_players == null)
+				return;
+			
+			foreach (PlayerEntry entry in m_players)
+			{
+				entry.flopEquity?.Dispose();
+				entry.flopEquity = null;
 			}
 		}
 		
@@ -315,6 +319,16 @@ namespace Poker
 					statusColor = new Color(217, 49, 37);
 				}
 				
+				Hands.EquityCalculator flopEquity = m_players[i].flopEquity;
+				flopEquity?.Update();
+				if (flopEquity != null && flopEquity.Finished && flopEquity.Deals > 0)
+				{
+					string equityText = string.Format("Flop equity {0:0}% vs any hands", flopEquity.GetEquity(0) * 100);
+					statusText = statusText == null ? equityText : statusText + ", " + equityText.ToLower();
+					if (m_players[i].winnings <= 0 && m_players[i].player.Chips != 0)
+						statusColor = new Color(200, 200, 200);
+				}
+				
 				if (statusText != null)
 				{
 					y += SPACING_Y * 0.3f;
@@ -349,6 +363,7 @@ namespace Poker
 		
 		public void Dispose()
 		{
+			DisposeFlopEquities();
 			m_spriteBatch.Dispose();
 		}
 	}
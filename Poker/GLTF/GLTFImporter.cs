@@ -2,12 +2,17 @@
 using System.Collections.Generic;
 using System.IO;
 using System.Numerics;
+using System.Runtime.InteropServices;
 using Newtonsoft.Json.Linq;
 
 namespace Poker.GLTF
 {
-	public static class GLTFImporter
+	public static unsafe class GLTFImporter
 	{
+		[DllImport("Native")]
+		private static extern void Mesh_GenerateTangents(Vertex* vertices, uint numVertices, uint* indices,
+		                                                 uint numIndices);
+		
 		private enum ElementType
 		{
 			SCALAR,
@@ -114,8 +119,11 @@ namespace Poker.GLTF
 				}
 			}
 			
+			//Every primitive is appended to one vertex and index array, so the whole model shares one mesh.
 			JArray meshesArray = (JArray)json["meshes"];
-			List<Mesh> meshes = new List<Mesh>();
+			List<Vertex> modelVertices = new List<Vertex>();
+			List<uint> modelIndices = new List<uint>();
+			List<Model.Part> parts = new List<Model.Part>();
 			foreach (JObject meshEl in meshesArray)
 			{
 				string baseName = meshEl["name"].ToString();
@@ -194,50 +202,24 @@ namespace Poker.GLTF
 						}
 					}
 					
-					Vector3[] tangents1 = new Vector3[numVertices];
-					Vector3[] tangents2 = new Vector3[numVertices];
-					for (int i = 0; i < numIndices; i += 3)
-					{
-						Vector3 dp0 =  vertices[indices[i + 1]].Position - vertices[indices[i]].Position;
-						Vector3 dp1 =  vertices[indices[i + 2]].Position - vertices[indices[i]].Position;
-						Vector2 dtc0 = vertices[indices[i + 1]].TexCoord - vertices[indices[i]].TexCoord;
-						Vector2 dtc1 = vertices[indices[i + 2]].TexCoord - vertices[indices[i]].TexCoord;
-						
-						float div = dtc0.X * dtc1.Y - dtc1.X * dtc0.Y;
-						if (Math.Abs(div) < 1E-6f)
-							continue;
-						
-						float r = 1.0f / div;
-						
-						Vector3 d1 = new Vector3((dtc0.Y * dp0.X - dtc0.Y * dp1.X) * r, (dtc1.Y * dp0.Y - dtc0.Y * dp1.Y) * r, (dtc1.Y * dp0.Z - dtc0.Y * dp1.Z) * r);
-						Vector3 d2 = new Vector3((dtc0.X * dp1.X - dtc1.X * dp0.X) * r, (dtc0.X * dp1.Y - dtc1.X * dp0.Y) * r, (dtc0.X * dp1.Z - dtc1.X * dp0.Z) * r);
-						
-						for (int j = 0; j < 3; j++)
-						{
-							uint index = indices[i + j];
-							tangents1[index] += d1;
-							tangents2[index] += d2;
-						}
-					}
-					
-					for (int v = 0; v < numVertices; v++)
+					fixed (Vertex* verticesPtr = vertices)
+					fixed (uint* indicesPtr = indices)
 					{
-						if (tangents1[v].LengthSquared() < 1E-6f)
-							continue;
-						
-						Vector3 normal = vertices[v].Normal;
-						vertices[v].Tangent = Vector3.Normalize(tangents1[v] - normal * Vector3.Dot(normal, tangents1[v]));
-						
-						if (Vector3.Dot(Vector3.Cross(normal, vertices[v].Tangent), tangents2[v]) < 0.0f)
-							vertices[v].Tangent = -vertices[v].Tangent;
+						Mesh_GenerateTangents(verticesPtr, (uint)numVertices, indicesPtr, (uint)numIndices);
 					}
 					
 					string name = primitivesArray.Count == 1 ? baseName : $"{baseName}_{p}";
-					meshes.Add(new Mesh(name, vertices, indices));
+					parts.Add(new Model.Part(name, (uint)modelIndices.Count, (uint)numIndices));
+					
+					uint baseVertex = (uint)modelVertices.Count;
+					foreach (uint index in indices)
+						modelIndices.Add(baseVertex + index);
+					modelVertices.AddRange(vertices);
 				}
 			}
 			
-			return new Model(meshes.ToArray());
+			return new Model(Path.GetFileNameWithoutExtension(path), modelVertices.ToArray(), modelIndices.ToArray(),
+			                 parts.ToArray());
 		}
 	}
 }
@@ -1,21 +1,51 @@
 ﻿using System;
-using System.Collections.Generic;
+using System.Linq;
 
 namespace Poker.GLTF
 {
 	public class Model : IDisposable
 	{
-		public readonly Mesh[] Meshes;
+		public struct Part
+		{
+			public readonly string Name;
+			public readonly uint FirstIndex;
+			public readonly uint NumIndices;
+			
+			public Part(string name, uint firstIndex, uint numIndices)
+			{
+				Name = name;
+				FirstIndex = firstIndex;
+				NumIndices = numIndices;
+			}
+			
+			public DrawList.DrawDesc DrawDesc => new DrawList.DrawDesc(FirstIndex, NumIndices);
+		}
+		
+		//All primitives of the model in one packed mesh, each one a part of its indices.
+		public readonly Mesh Mesh;
+		public readonly Part[] Parts;
+		
+		public Model(string name, Vertex[] vertices, uint[] indices, Part[] parts)
+		{
+			Parts = parts;
+			Mesh = new Mesh(vertices, indices, packed: true, optimize: true,
+			                partNumIndices: parts.Select(part => part.NumIndices).ToArray());
+			
+			Mesh.OptimizeStats stats = Mesh.OptimizationStats.Value;
+			Log.Write($"Optimized model {name}: ACMR {stats.ACMRBefore:F3} -> {stats.ACMRAfter:F3}, {stats.IndexSize * 8}-bit indices");
+		}
 		
-		public Model(Mesh[] meshes)
+		public int FindPart(string name)
 		{
-			Meshes = meshes;
+			int partIndex = Array.FindIndex(Parts, part => part.Name == name);
+			if (partIndex == -1)
+				throw new ArgumentException("Part not found '" + name + "'.", nameof(name));
+			return partIndex;
 		}
 		
 		public void Dispose()
 		{
-			foreach (Mesh mesh in Meshes)
-				mesh.Dispose();
+			Mesh.Dispose();
 		}
 	}
 }
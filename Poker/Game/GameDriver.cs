@@ -30,10 +30,16 @@ namespace Poker
 		
 		private readonly List<int> m_targetPotSizes = new List<int>();
 		
+		//Buffers passed to the native showdown evaluation, reused between hands.
+		private readonly byte[] m_showdownBoard = new byte[5];
+		private readonly byte[] m_showdownHoleCards;
+		private int[] m_showdownContributions = new int[0];
+		
 		public GameDriver(IEnumerable<ushort> clientIds, int startChips, int bigBlind)
 		{
 			BigBlind = bigBlind;
 			Players = clientIds.Select(id => new Player(id, startChips)).ToArray();
+			m_showdownHoleCards = new byte[Players.Length * 2];
 		}
 		
 		public Player GetPlayer(ushort id)
@@ -52,6 +58,36 @@ namespace Poker
 			return size;
 		}
 		
+		//Scores the hands of the players still in the hand and computes how many chips each player wins from the pots.
+		// holeCards is indexed like Players, entries may be null for players who are not in the showdown.
+		public void ResolveShowdown(Card[] board, Card[][] holeCards, ushort[] strengths, int[] winnings)
+		{
+			int numPots = 0;
+			for (int i = 0; i < Players.Length; i++)
+				numPots = Math.Max(numPots, Players[i].ContributionAmounts.Count);
+			
+			if (m_showdownContributions.Length < numPots * Players.Length)
+				m_showdownContributions = new int[numPots * Players.Length];
+			
+			for (int i = 0; i < board.Length; i++)
+				m_showdownBoard[i] = board[i].PackedValue;
+			
+			for (int i = 0; i < Players.Length; i++)
+			{
+				bool inShowdown = Players[i].InGame && holeCards[i] != null;
+				m_showdownHoleCards[i * 2] = inShowdown ? holeCards[i][0].PackedValue : Hands.HandEvaluator.NO_CARD;
+				m_showdownHoleCards[i * 2 + 1] = inShowdown ? holeCards[i][1].PackedValue : Hands.HandEvaluator.NO_CARD;
+				
+				//Folded players may have fewer entries, since side pots are only inserted for players still in the hand.
+				List<int> contributions = Players[i].ContributionAmounts;
+				for (int pot = 0; pot < numPots; pot++)
+					m_showdownContributions[pot * Players.Length + i] = pot < contributions.Count ? contributions[pot] : 0;
+			}
+			
+			Hands.HandEvaluator.EvaluateShowdown(m_showdownBoard, m_showdownHoleCards, m_showdownContributions, numPots,
+			                                     strengths, winnings);
+		}
+		
 		private void IncPlayerIndex()
 		{
 			CurrentPlayerIndex = (CurrentPlayerIndex + 1) % Players.Length;
@@ -10,6 +10,8 @@ namespace Poker
 		
 		private Vector2 m_connectingTextPos;
 		
+		public override bool NeedsRedraw => false;
+		
 		public override void Update(float dt)
 		{
 			if (Connection.CState == ServerConnection.State.Connected)
@@ -8,6 +8,9 @@
 		public virtual void OnKeyPress(Keys key) { }
 		public virtual void OnResize(int newWidth, int newHeight) { }
 		public virtual void Activated() { }
+		
+		//States which are not animating return false, which lets the main loop skip frames until input arrives.
+		public virtual bool NeedsRedraw => true;
 	}
 	
 	public struct DrawArgs
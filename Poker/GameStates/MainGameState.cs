@@ -34,6 +34,9 @@ namespace Poker
 		
 		private Connection m_connection;
 		
+		//What the table looked like at the latest update, see TableSimulation.
+		private TableSnapshot m_table;
+		
 		private int m_communityCardsRevealed;
 		
 		private float m_initialDealProgress;
@@ -82,7 +85,7 @@ namespace Poker
 		private float m_pocketCardWidth;
 		private float m_pocketCardHeight;
 		
-		private volatile bool m_waitingForHandStart = true;
+		private bool m_waitingForHandStart = true;
 		
 		private float m_pocketCardRevealProgress;
 		
@@ -93,14 +96,13 @@ namespace Poker
 		
 		private class PlayerEntry
 		{
-			public Player Player;
 			public IClient Client;
 			
 			public float HighlightIntensity;
 			public float FoldIntensity;
 			
-			public readonly List<float> OutStackRotations = new List<float>();
-			public readonly List<float> InStackRotations = new List<float>();
+			public int NumOutStackChips;
+			public int NumInStackChips;
 			
 			public int NumMovingChips;
 			public float ChipsMoveProgress;
@@ -168,22 +170,25 @@ namespace Poker
 		private static readonly Vector3 CARD_DECK_POSITION = new Vector3(0.0f, 0.2f, -1.0f);
 		private const float CARD_DECK_HEIGHT = 0.05f;
 		
-		private readonly float[] m_chipEntropy = new float[1024];
-		
 		private const int STACK_SIZE = 100;
 		
 		private bool m_waitingForPlayers = false;
 		
+		//Values which change while the table animates or when network events arrive, captured after every update.
+		// Drawing is skipped while they stay the same, unless a pane which updates on its own is open.
+		private List<float> m_animationState = new List<float>();
+		private List<float> m_prevAnimationState = new List<float>();
+		private bool m_animating = true;
+		
+		public override bool NeedsRedraw => m_animating || m_endSummary.Visible || m_totalsPane.Visible;
+		
 		public MainGameState()
 		{
 			m_keyboardGuideTexture = Texture2D.Load("UI/KeyboardGuide.png");
-			
-			Random random = new Random();
-			for (int i = 0; i < m_chipEntropy.Length; i++)
-				m_chipEntropy[i] = (float)random.NextDouble();
 		}
 		
-		private void StartHand()
+		//chips holds each player's chips when the cards were dealt, before the blinds were paid.
+		private void StartHand(int[] chips)
 		{
 			if (!m_waitingForHandStart)
 				return;
@@ -209,24 +214,11 @@ namespace Poker
 				
 				m_players[i].CardRotations[0] = rotation1 + MathF.PI / 2;
 				m_players[i].CardRotations[1] = rotation2 + MathF.PI / 2;
-				m_players[i].Player = m_connection.GetPlayer(m_players[i].Client.ClientId);
 				m_players[i].FoldIntensity = 0;
 				m_players[i].ChipsMoveProgress = 0;
 				
-				int inStackSize = m_players[i].Player.Chips;
-				
-				m_players[i].InStackRotations.Clear();
-				m_players[i].OutStackRotations.Clear();
-				
-				if (m_players[i].InStackRotations.Capacity < inStackSize)
-				{
-					m_players[i].InStackRotations.Capacity = inStackSize;
-				}
-				
-				for (int j = 0; j < inStackSize; j++)
-				{
-					m_players[i].InStackRotations.Add((float)(random.NextDouble() * Math.PI * 2));
-				}
+				m_players[i].NumInStackChips = chips[i];
+				m_players[i].NumOutStackChips = 0;
 				
 				if (m_players[i].Client.ClientId == m_connection.SelfClientId)
 					m_selfPlayerIndex = i;
@@ -245,41 +237,51 @@ namespace Poker
 		public void SetConnection(Connection connection)
 		{
 			m_connection = connection;
+			m_table = default(TableSnapshot);
 			m_log.Clear();
 			
 			m_winner = null;
 			
+			TableSimulation.SetConnection(connection);
+			
+			//Events are raised on network threads. Values are read when they are raised and used once the table has caught
+			// up on the frame thread.
 			m_connection.OnTurnChanged += client =>
 			{
-				if (client != null && client.ClientId == m_connection.SelfClientId)
+				if (client != null && client.ClientId == connection.SelfClientId)
 				{
-					m_callAmount = m_connection.CallAmount;
-					m_raiseAmount = 0;
+					int callAmount = connection.CallAmount;
+					TableSimulation.Post(() =>
+					{
+						m_callAmount = callAmount;
+						m_raiseAmount = 0;
+					});
 				}
 			};
 			
 			connection.OnPlayerAction += (clientId, action, raiseAmount) =>
 			{
-				PlayerEntry playerEntry = m_players.First(player => player.Client.ClientId == clientId);
 				StringBuilder statusTextBuilder = new StringBuilder();
 				
 				switch (action)
 				{
 				case TurnEndAction.AllIn:
-					statusTextBuilder.AppendFormat(" went all in ({0})", playerEntry.Player.Chips);
+					statusTextBuilder.AppendFormat(" went all in ({0})", connection.GetPlayer(clientId).Chips);
 					break;
 				case TurnEndAction.Raise:
 					statusTextBuilder.AppendFormat(" raised by {0}", raiseAmount);
 					break;
 				case TurnEndAction.Call:
-					statusTextBuilder.Append(m_connection.CallAmount == 0 ? " checked" : " called");
+					statusTextBuilder.Append(connection.CallAmount == 0 ? " checked" : " called");
 					break;
 				case TurnEndAction.Fold:
 					statusTextBuilder.Append(" folded");
 					break;
 				}
 				
-				WriteLogMessage(playerEntry.Client.Name, statusTextBuilder.ToString());
+				string name = connection.TurnOrderClients.First(client => client.ClientId == clientId).Name;
+				string status = statusTextBuilder.ToString();
+				TableSimulation.Post(() => WriteLogMessage(name, status));
 			};
 			
 			const float TEXT_HEIGHT = 0.25f;
@@ -330,12 +332,75 @@ namespace Poker
 			
 			m_waitingForHandStart = true;
 			
-			m_connection.OnDeal += (card1, card2) => StartHand();
+			int[] GetChips() => connection.Players.Select(player => player.Chips).ToArray();
+			
+			m_connection.OnDeal += (card1, card2) =>
+			{
+				int[] chips = GetChips();
+				TableSimulation.Post(() => StartHand(chips));
+			};
 			if (!m_connection.WaitingForNetwork)
-				StartHand();
+				StartHand(GetChips());
 		}
 		
 		public override void Update(float dt)
+		{
+			TableSimulation.Update(m_connection, ref m_table);
+			UpdateTable(dt);
+			
+			List<float> prevAnimationState = m_prevAnimationState;
+			m_prevAnimationState = m_animationState;
+			m_animationState = prevAnimationState;
+			CaptureAnimationState(m_animationState);
+			
+			m_animating = m_animationState.Count != m_prevAnimationState.Count;
+			for (int i = 0; i < m_animationState.Count && !m_animating; i++)
+				m_animating = m_animationState[i] != m_prevAnimationState[i];
+		}
+		
+		private void CaptureAnimationState(List<float> state)
+		{
+			state.Clear();
+			state.Add(m_waitingForHandStart ? 1 : 0);
+			state.Add(m_winner == null ? 0 : 1);
+			state.Add(m_log.Count);
+			state.Add(m_logFadeInProgress);
+			state.Add(m_logScrollY);
+			state.Add(m_cameraYaw);
+			state.Add(m_cameraPitch);
+			state.Add(m_communityCardsRevealed);
+			state.Add(m_initialDealProgress);
+			state.Add(m_communityCardRevealProgress);
+			state.Add(m_communityCardFocusProgress);
+			state.Add(m_pocketCardRevealProgress);
+			state.Add(m_pocketCardsY[0]);
+			state.Add(m_pocketCardsY[1]);
+			state.Add(m_handSummaryRevealProgress);
+			state.Add(m_blurIntensity);
+			state.Add(m_actionButtonsAlpha);
+			state.Add(m_callButtonHighlight);
+			state.Add(m_foldButtonHighlight);
+			state.Add(m_betUpButtonHighlight);
+			state.Add(m_betDownButtonHighlight);
+			state.Add(m_betUpButtonDisProgress);
+			state.Add(m_betDownButtonDisProgress);
+			state.Add(m_returnToMenuButtonHighlight);
+			state.Add(m_callAmount);
+			state.Add(m_raiseAmount);
+			
+			if (m_players == null)
+				return;
+			foreach (PlayerEntry player in m_players)
+			{
+				state.Add(player.HighlightIntensity);
+				state.Add(player.FoldIntensity);
+				state.Add(player.ChipsMoveProgress);
+				state.Add(player.NumMovingChips);
+				state.Add(player.NumInStackChips);
+			}
+		}
+		
+		private void UpdateTable(float dt)
 		{
 			if (m_waitingForHandStart)
 				return;
@@ -346,7 +411,7 @@ namespace Poker
 			m_endSummary.Update(dt, ms, m_prevMS, out bool continuePressed);
 			if (continuePressed)
 			{
-				PlayerEntry[] playersNotBust = m_players.Where(p => p.Player.Chips != 0).ToArray();
+				PlayerEntry[] playersNotBust = m_players.Where((p, i) => m_table.GetChips(i) != 0).ToArray();
 				if (playersNotBust.Length == 1)
 				{
 					m_winner = playersNotBust[0].Client;
@@ -365,6 +430,7 @@ namespace Poker
 				{
 					if (ms.LeftButton == ButtonState.Pressed && m_prevMS.LeftButton == ButtonState.Released)
 					{
+						TableSimulation.SetConnection(null);
 						m_connection.Disconnect();
 						GameStateManager.SetGameState<MainMenuGameState>();
 					}
@@ -377,7 +443,7 @@ namespace Poker
 				}
 			}
 			
-			m_totalsPane.Update(!m_endSummary.Visible && ks.IsKeyDown(Keys.F1), dt);
+			m_totalsPane.Update(!m_endSummary.Visible && ks.IsKeyDown(Keys.F1), dt, m_connection, ref m_table);
 			
 			if (ms.RightButton == ButtonState.Pressed && m_communityCardFocusProgress < 1E-3f)
 			{
@@ -419,19 +485,19 @@ namespace Poker
 			bool revealPocketCards = false;
 			
 			// ** Updates player highlight **
-			IClient currentClient = m_connection.CurrentClient;
-			foreach (PlayerEntry player in m_players)
+			for (int i = 0; i < m_players.Length; i++)
 			{
-				if (player.Player.HasFolded)
+				PlayerEntry player = m_players[i];
+				if (m_table.HasFolded(i))
 				{
 					UI.AnimateInc(ref player.FoldIntensity, dt);
 				}
 				else
 				{
-					if (player.Client.RevealedPocketCards != null)
+					if (m_table.HasRevealedPocketCards(i))
 						revealPocketCards = true;
 					
-					if (player.Client == currentClient && dealAnimationComplete)
+					if (i == m_table.CurrentPlayer && dealAnimationComplete)
 						UI.AnimateInc(ref player.HighlightIntensity, dt);
 					else
 						UI.AnimateDec(ref player.HighlightIntensity, dt);
@@ -447,24 +513,22 @@ namespace Poker
 							
 							if (player.ChipsMoveProgress >= 1)
 							{
-								int inStackBegin = player.InStackRotations.Count - player.NumMovingChips;
-								player.OutStackRotations.AddRange(
-									player.InStackRotations.Skip(player.InStackRotations.Count - player.NumMovingChips));
-								player.InStackRotations.RemoveRange(inStackBegin, player.NumMovingChips);
+								player.NumInStackChips -= player.NumMovingChips;
+								player.NumOutStackChips += player.NumMovingChips;
 								player.NumMovingChips = 0;
 							}
 						}
-						else if (player.InStackRotations.Count > player.Player.Chips)
+						else if (player.NumInStackChips > m_table.GetChips(i))
 						{
-							int lastInStackSize = player.InStackRotations.Count % STACK_SIZE;
+							int lastInStackSize = player.NumInStackChips % STACK_SIZE;
 							if (lastInStackSize == 0)
 								lastInStackSize += STACK_SIZE;
 							
-							int lastOutStackSpace = STACK_SIZE - player.OutStackRotations.Count % STACK_SIZE;
+							int lastOutStackSpace = STACK_SIZE - player.NumOutStackChips % STACK_SIZE;
 							
 							player.ChipsMoveProgress = 0;
 							player.NumMovingChips = Math.Min(Math.Min(lastInStackSize, lastOutStackSpace),
-								player.InStackRotations.Count - player.Player.Chips);
+								player.NumInStackChips - m_table.GetChips(i));
 							
 							playerChipsMoving = true;
 						}
@@ -472,9 +536,9 @@ namespace Poker
 				}
 			}
 			
-			bool selfFolded = m_players[m_selfPlayerIndex].Player.HasFolded;
+			bool selfFolded = m_table.HasFolded(m_selfPlayerIndex);
 			
-			if (m_connection.HasDealtPocketCards)
+			if (m_table.HasDealtPocketCards)
 			{
 				if (!dealAnimationComplete)
 				{
@@ -526,7 +590,7 @@ namespace Poker
 					// ** Updates the reveal animation for community cards **
 					if (!playerChipsMoving)
 					{
-						if (m_communityCardsRevealed < m_connection.CommunityCardsRevealed)
+						if (m_communityCardsRevealed < m_table.CommunityCardsRevealed)
 						{
 							m_communityCardRevealProgress += dt * DEAL_ANIMATION_SPEED * 0.5f;
 							if (m_communityCardRevealProgress >= 1.0f)
@@ -537,7 +601,7 @@ namespace Poker
 						}
 						else
 						{
-							showActionsUI = currentClient != null && m_connection.SelfClientId == currentClient.ClientId;
+							showActionsUI = m_table.CurrentPlayer == m_selfPlayerIndex;
 						}
 					}
 				}
@@ -546,7 +610,7 @@ namespace Poker
 			bool showHandSummary = false;
 			
 			if (revealPocketCards && !playerChipsMoving &&
-			    m_communityCardsRevealed == m_connection.CommunityCardsRevealed)
+			    m_communityCardsRevealed == m_table.CommunityCardsRevealed)
 			{
 				const float REVEAL_SPEED = DEAL_ANIMATION_SPEED * 0.4f;
 				m_pocketCardRevealProgress += dt * REVEAL_SPEED;
@@ -595,7 +659,7 @@ namespace Poker
 			if ((callButtonHovered && ms.LeftButton == ButtonState.Pressed && m_prevMS.LeftButton == ButtonState.Released) ||
 				(showActionsUI && ks.IsKeyDown(Keys.Return) && !m_prevKS.IsKeyDown(Keys.Return)))
 			{
-				if (m_callAmount + m_raiseAmount >= m_players[m_selfPlayerIndex].Player.Chips)
+				if (m_callAmount + m_raiseAmount >= m_table.GetChips(m_selfPlayerIndex))
 					m_connection.AllIn();
 				else if (m_raiseAmount > 0)
 					m_connection.Raise(m_raiseAmount);
@@ -624,7 +688,7 @@ namespace Poker
 					m_betButtonCooldown = 0;
 			}
 			
-			int selfChips = m_players[m_selfPlayerIndex].Player.Chips;
+			int selfChips = m_table.GetChips(m_selfPlayerIndex);
 			const float BET_BUTTON_COOLDOWN = 0.1f;
 			
 			// ** Bet up button **
@@ -650,7 +714,7 @@ namespace Poker
 				if (ks.IsKeyDown(Keys.LeftShift))
 					m_raiseAmount = Math.Max(selfChips - m_callAmount, 0);
 				else
-					m_raiseAmount = m_raiseAmount == 0 ? m_connection.MinimumRaise : m_raiseAmount + 1;
+					m_raiseAmount = m_raiseAmount == 0 ? m_table.MinimumRaise : m_raiseAmount + 1;
 				
 				m_betButtonCooldown = BET_BUTTON_COOLDOWN;
 				if (ms.LeftButton == ButtonState.Pressed && m_prevMS.LeftButton == ButtonState.Released ||
@@ -683,7 +747,7 @@ namespace Poker
 				if (ks.IsKeyDown(Keys.LeftShift))
 					m_raiseAmount = 0;
 				else
-					m_raiseAmount = m_raiseAmount == m_connection.MinimumRaise ? 0 : m_raiseAmount - 1;
+					m_raiseAmount = m_raiseAmount == m_table.MinimumRaise ? 0 : m_raiseAmount - 1;
 				
 				m_betButtonCooldown = BET_BUTTON_COOLDOWN;
 				if (ms.LeftButton == ButtonState.Pressed && m_prevMS.LeftButton == ButtonState.Released ||
@@ -784,6 +848,12 @@ namespace Poker
 			return Vector3.Lerp(pos1, pos2, t) + new Vector3(0, yOffset, 0);
 		}
 		
+		private static float InterpolateChipRotation(float rotation1, float rotation2, float t)
+		{
+			//Turns the short way around.
+			return rotation1 + (float)Math.IEEERemainder(rotation2 - rotation1, Math.PI * 2) * Utils.SmoothStep(t);
+		}
+		
 		private void PrepareChipsRenderer(ChipsRenderer chipsRenderer)
 		{
 			chipsRenderer.Begin();
@@ -792,41 +862,48 @@ namespace Poker
 			
 			foreach (PlayerEntry player in m_players)
 			{
-				Random rand = new Random(player.Client.ClientId);
-				
-				Vector3 GetChipOffset(int index, int yDir)
+				Vector3 GetStackOffset(int stackIndex, int yDir)
 				{
 					const int STACK_ROW_SIZE = 4;
 					
-					int stackIndex = index / STACK_SIZE;
 					int stackX = stackIndex % STACK_ROW_SIZE;
 					int stackY = stackIndex / STACK_ROW_SIZE;
 					
-					int entropyIndex = (index * 2) % m_chipEntropy.Length;
-					
-					return new Vector3(
-						   (m_chipEntropy[entropyIndex] - 0.5f) * 0.01f,
-						   ChipsRenderer.CHIP_HEIGHT * (index % STACK_SIZE),
-						   (m_chipEntropy[entropyIndex + 1] - 0.5f) * 0.01f) +
-						   player.BoardAreaLeft * -(stackX * STACK_ROW_STRIDE) +
-						   player.BoardAreaUp * (stackY * yDir * STACK_ROW_STRIDE);
+					return player.BoardAreaLeft * -(stackX * STACK_ROW_STRIDE) +
+					       player.BoardAreaUp * (stackY * yDir * STACK_ROW_STRIDE);
 				}
 				
-				Vector3 stackBasePos = player.BoardAreaCenter - player.BoardAreaUp * 0.15f;
-				Vector3 potBasePos = stackBasePos + player.BoardAreaUp * 0.75f;
+				Vector3 GetChipOffset(int index, int yDir)
+				{
+					return GetStackOffset(index / STACK_SIZE, yDir) +
+					       new Vector3(0, ChipsRenderer.CHIP_HEIGHT * (index % STACK_SIZE), 0);
+				}
 				
-				//Flipped loop gives better early Z rejection
-				int inStackSize = player.InStackRotations.Count - player.NumMovingChips;
-				for (int j = inStackSize - 1; j >= 0; j--)
+				uint GetStackSeed(int stackIndex, uint firstSeed)
 				{
-					chipsRenderer.Add(stackBasePos + GetChipOffset(j, 1), player.InStackRotations[j]);
+					return firstSeed + (uint)stackIndex * 2;
 				}
 				
-				for (int j = player.OutStackRotations.Count - 1; j >= 0; j--)
+				void AddStacks(Vector3 basePos, int numChips, int yDir, uint firstSeed)
 				{
-					chipsRenderer.Add(potBasePos + GetChipOffset(j, -1), player.OutStackRotations[j]);
+					for (int s = 0; s * STACK_SIZE < numChips; s++)
+					{
+						int count = Math.Min(STACK_SIZE, numChips - s * STACK_SIZE);
+						chipsRenderer.AddStack(basePos + GetStackOffset(s, yDir), 0, count, GetStackSeed(s, firstSeed),
+						                       ChipsRenderer.DEFAULT_COLOR);
+					}
 				}
 				
+				Vector3 stackBasePos = player.BoardAreaCenter - player.BoardAreaUp * 0.15f;
+				Vector3 potBasePos = stackBasePos + player.BoardAreaUp * 0.75f;
+				
+				//Stack seeds must be non-zero and differ between players, stacks and the in/out rows.
+				uint seedBase = (uint)player.Client.ClientId * 1024 + 1;
+				
+				int inStackSize = player.NumInStackChips - player.NumMovingChips;
+				AddStacks(stackBasePos, inStackSize, 1, seedBase);
+				AddStacks(potBasePos, player.NumOutStackChips, -1, seedBase + 1);
+				
 				//If a chip is not being moved to the pot, skip the last section, which draws the chip at it's current position.
 				if (player.ChipsMoveProgress < 1E-6f)
 					continue;
@@ -834,12 +911,19 @@ namespace Poker
 				for (int i = 0; i < player.NumMovingChips; i++)
 				{
 					int sourceIndex = inStackSize + i;
-					int dstIndex = player.OutStackRotations.Count + i;
+					int dstIndex = player.NumOutStackChips + i;
 					
-					Vector3 sourcePos = stackBasePos + GetChipOffset(sourceIndex, 1);
-					Vector3 destPos = potBasePos + GetChipOffset(dstIndex, -1);
+					//Starts and ends with the jitter the chip has in the stacks, so it does not jump when it is handed over.
+					ChipsRenderer.GetChipJitter(GetStackSeed(sourceIndex / STACK_SIZE, seedBase), sourceIndex % STACK_SIZE,
+					                            out Vector3 sourceJitter, out float sourceRotation);
+					ChipsRenderer.GetChipJitter(GetStackSeed(dstIndex / STACK_SIZE, seedBase + 1), dstIndex % STACK_SIZE,
+					                            out Vector3 destJitter, out float destRotation);
+					
+					Vector3 sourcePos = stackBasePos + GetChipOffset(sourceIndex, 1) + sourceJitter;
+					Vector3 destPos = potBasePos + GetChipOffset(dstIndex, -1) + destJitter;
 					Vector3 pos = InterpolateChipPosition(sourcePos, destPos, player.ChipsMoveProgress);
-					chipsRenderer.Add(pos, player.InStackRotations[sourceIndex]);
+					float rotation = InterpolateChipRotation(sourceRotation, destRotation, player.ChipsMoveProgress);
+					chipsRenderer.Add(pos, rotation);
 				}
 			}
 			
@@ -878,7 +962,7 @@ namespace Poker
 					
 					const float REV_DELTA_ROT = 0.1f;
 					
-					if (m_players[i].Client.RevealedPocketCards != null)
+					if (m_table.HasRevealedPocketCards(i))
 					{
 						Quaternion revRotation = cardRotation * 
 							Quaternion.CreateFromAxisAngle(Vector3.UnitX, MathF.PI) * 
@@ -890,7 +974,7 @@ namespace Poker
 						//Only cast shadows if the card is playing the flip animation
 						bool castShadows = m_pocketCardRevealProgress < 0.99f;
 						
-						Card card = m_players[i].Client.RevealedPocketCards[c];
+						Card card = m_table.GetRevealedPocketCard(i, c);
 						cardRenderer.Add(destinationPos, rotation, card, castShadows);
 					}
 					else
@@ -943,7 +1027,7 @@ namespace Poker
 					}
 				}
 				
-				cardRenderer.Add(position, cardRotation, m_connection.CommunityCards[i], castShadows);
+				cardRenderer.Add(position, cardRotation, m_table.GetCommunityCard(i), castShadows);
 			}
 		}
 		
@@ -971,9 +1055,13 @@ namespace Poker
 			               Matrix4x4.CreateTranslation(0, 0, -cameraDist);
 			
 			
+			Matrix4x4 viewProj = m_viewMatrix * m_projectionMatrix;
+			
 			PrepareChipsRenderer(ChipsRenderer.Instance);
 			PrepareCardsRenderer(CardRenderer.Instance);
 			
+			ChipsRenderer.Instance.Cull(viewProj, m_shadowMapper.ShadowMatrix);
+			
 			Graphics.SetFixedFunctionState(FFState.DepthTest | FFState.DepthWrite);
 			m_shadowMapper.RenderShadows(() =>
 			{
@@ -990,7 +1078,6 @@ namespace Poker
 			Graphics.ClearDepth();
 			Graphics.SetFixedFunctionState(FFState.Multisample | FFState.DepthWrite | FFState.DepthTest);
 			
-			Matrix4x4 viewProj = m_viewMatrix * m_projectionMatrix;
 			m_viewProjUniformBuffer.Update(ref viewProj, cameraPos);
 			m_viewProjUniformBuffer.Bind(0);
 			
@@ -1017,13 +1104,13 @@ namespace Poker
 			drawArgs.SpriteBatch.Begin();
 			
 			//Draws the pocket cards UI
-			if (m_connection.HasDealtPocketCards)
+			if (m_table.HasDealtPocketCards)
 			{
 				for (int i = 0; i < 2; i++)
 				{
 					RectangleF rect = new RectangleF(m_pocketCardsX[i], m_displayHeight - m_pocketCardsY[i],
 													 m_pocketCardWidth, m_pocketCardHeight);
-					RectangleF srcRect = Assets.CardsTexture.GetSourceRectangle(m_connection.PocketCards[i]);
+					RectangleF srcRect = Assets.CardsTexture.GetSourceRectangle(m_table.GetPocketCard(i));
 					drawArgs.SpriteBatch.Draw(Assets.CardsTexture.Texture, rect, srcRect, Color.White);
 				}
 			}
@@ -1046,9 +1133,9 @@ namespace Poker
 				const float TEXT_HEIGHT_PERCENTAGE = 0.6f;
 				
 				int callAmount = m_callAmount + m_raiseAmount;
-				bool allIn = callAmount >= m_players[m_selfPlayerIndex].Player.Chips;
+				bool allIn = callAmount >= m_table.GetChips(m_selfPlayerIndex);
 				if (allIn)
-					callAmount = m_players[m_selfPlayerIndex].Player.Chips;
+					callAmount = m_table.GetChips(m_selfPlayerIndex);
 				
 				//Draws the call button label
 				string callText = allIn ? "ALL IN" : (m_raiseAmount > 0 ? "RAISE" : (m_callAmount > 0 ? "CALL" : "CHECK"));
@@ -1107,7 +1194,7 @@ namespace Poker
 			                                new Color(255, 255, 255, 150), 0.2f);
 #endif
 			
-			m_totalsPane.Draw(drawArgs.SpriteBatch, m_connection);
+			m_totalsPane.Draw(drawArgs.SpriteBatch, m_connection, ref m_table);
 			
 			if (m_waitingForPlayers)
 			{
@@ -1206,6 +1293,7 @@ namespace Poker
 			m_viewProjUniformBuffer.Dispose();
 			m_keyboardGuideTexture.Dispose();
 			m_endSummary.Dispose();
+			m_totalsPane.Dispose();
 		}
 	}
 }
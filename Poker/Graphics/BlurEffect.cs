@@ -26,6 +26,9 @@ namespace Poker
 		[DllImport("Native")]
 		private static extern void BlurFB_BindTexture(IntPtr blurFB, Buffers buffer);
 		[DllImport("Native")]
+		[return: MarshalAs(UnmanagedType.I1)]
+		private static extern bool BlurFB_Capture(IntPtr blurFB, Buffers buffer, string path, CaptureFormat format);
+		[DllImport("Native")]
 		private static extern void Blur_DrawFST();
 		
 		private readonly Shader m_shader;
@@ -36,6 +39,9 @@ namespace Poker
 		
 		private IntPtr m_framebuffer;
 		
+		private string m_capturePath;
+		private CaptureFormat m_captureFormat;
+		
 		public BlurEffect()
 		{
 			m_shader = new Shader();
@@ -63,6 +69,12 @@ namespace Poker
 			
 			BlurFB_Resolve(m_framebuffer, false);
 			
+			if (m_capturePath != null)
+			{
+				BlurFB_Capture(m_framebuffer, Buffers.Inter1, m_capturePath, m_captureFormat);
+				m_capturePath = null;
+			}
+			
 			m_shader.Bind();
 			
 			const int NUM_PASSES = 2;
@@ -90,6 +102,13 @@ namespace Poker
 			}
 		}
 		
+		//Captures the scene without blur the next time a blur is rendered.
+		public void RequestCapture(string path, CaptureFormat format)
+		{
+			m_capturePath = path;
+			m_captureFormat = format;
+		}
+		
 		public void SetResolution(uint width, uint height)
 		{
 			DestroyFramebuffer();
@@ -8,9 +8,13 @@ namespace Poker
 		private readonly Shader m_shader;
 		private readonly Shader m_shadowShader;
 		
-		private readonly int m_specularExponentLocation;
-		private readonly int m_specularIntensityLocation;
-		private readonly int m_textureScaleLocation;
+		//Binding point of the per part material parameters in Board.vs.glsl.
+		public const uint PARAMS_UNIT = 4;
+		
+		//Texture units of the diffuse texture of each texture set in Board.fs.glsl, followed by the normal and
+		// specular maps. Unit 3 holds the shadow map.
+		private static readonly int[] TEXTURE_SET_UNITS = { 0, 4 };
+		public static int MAX_TEXTURE_SETS => TEXTURE_SET_UNITS.Length;
 		
 		public BoardShader()
 		{
@@ -22,10 +26,6 @@ namespace Poker
 			m_shadowShader = new Shader();
 			m_shadowShader.AttachStage(Shader.StageType.Vertex, "BoardShadow.vs.glsl");
 			m_shadowShader.Link();
-			
-			m_specularExponentLocation = m_shader.GetUniformLocation("specularExponent");
-			m_specularIntensityLocation = m_shader.GetUniformLocation("specularIntensity");
-			m_textureScaleLocation = m_shader.GetUniformLocation("textureScale");
 		}
 		
 		public void Bind()
@@ -38,15 +38,12 @@ namespace Poker
 			m_shadowShader.Bind();
 		}
 		
-		public void BindSettings(MaterialSettings settings)
+		public void BindTextures(MaterialSettings settings, int textureSet)
 		{
-			settings.DiffuseTexture.Bind(0);
-			settings.NormalMap.Bind(1);
-			settings.SpecularMap.Bind(2);
-			
-			m_shader.SetUniform(m_textureScaleLocation, settings.TextureScale);
-			m_shader.SetUniform(m_specularExponentLocation, settings.SpecularExponent);
-			m_shader.SetUniform(m_specularIntensityLocation, settings.SpecularIntensity);
+			int firstUnit = TEXTURE_SET_UNITS[textureSet];
+			settings.DiffuseTexture.Bind(firstUnit);
+			settings.NormalMap.Bind(firstUnit + 1);
+			settings.SpecularMap.Bind(firstUnit + 2);
 		}
 		
 		public void Dispose()
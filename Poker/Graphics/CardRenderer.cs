@@ -2,13 +2,23 @@
 using System.Collections.Generic;
 using System.Drawing;
 using System.Numerics;
+using System.Runtime.InteropServices;
 
 namespace Poker
 {
-	public class CardRenderer : IDisposable
+	//Draws all cards of a pass with one multi draw. Each card reads its transform and source region from the draw
+	// list's parameter buffer.
+	public unsafe class CardRenderer : IDisposable
 	{
 		public static CardRenderer Instance;
 		
+		[StructLayout(LayoutKind.Sequential, Pack=1)]
+		private struct CardParameters
+		{
+			public Matrix4x4 WorldTransform;
+			public Vector4 TexSourceRegion;
+		}
+		
 		private struct CardEntry : IComparable<CardEntry>
 		{
 			public RectangleF SrcRectangle;
@@ -25,13 +35,18 @@ namespace Poker
 		private readonly List<CardEntry> m_cards = new List<CardEntry>();
 		
 		private readonly Shader m_shader;
-		private readonly int m_worldTransformLocation;
-		private readonly int m_texSourceRegionLocation;
-		
 		private readonly Shader m_shadowShader;
-		private readonly int m_worldTransformLocationShadow;
 		
 		private readonly Mesh m_mesh;
+		private readonly DrawList m_drawList;
+		private readonly DrawList m_shadowDrawList;
+		
+		//Binding point of the card parameters in Card.vs.glsl and CardShadow.vs.glsl.
+		private const uint PARAMS_UNIT = 4;
+		
+		private const uint MAX_CARDS = 128;
+		
+		private static readonly DrawList.DrawDesc CARD_DRAW = new DrawList.DrawDesc(0, 6);
 		
 		private readonly float m_xScale;
 		
@@ -49,16 +64,15 @@ namespace Poker
 			m_shadowShader.AttachStage(Shader.StageType.Fragment, "CardShadow.fs.glsl");
 			m_shadowShader.Link();
 			
-			m_worldTransformLocation = m_shader.GetUniformLocation("worldTransform");
-			m_texSourceRegionLocation = m_shader.GetUniformLocation("texSourceRegion");
-			
-			m_worldTransformLocationShadow = m_shadowShader.GetUniformLocation("worldTransform");
-			
 			m_xScale = (float)Assets.CardsTexture.CardWidth / Assets.CardsTexture.CardHeight;
 			
 			Vector2[] vertices = { new Vector2(-1, -1), new Vector2(1, -1), new Vector2(-1,  1), new Vector2(1,  1) };
 			uint[] indices = { 0, 1, 2, 2, 1, 3 };
 			m_mesh = new Mesh(vertices, indices);
+			
+			//The shadow pass only needs the transforms.
+			m_drawList = new DrawList(m_mesh, MAX_CARDS, (uint)sizeof(CardParameters));
+			m_shadowDrawList = new DrawList(m_mesh, MAX_CARDS, (uint)sizeof(Matrix4x4));
 		}
 		
 		public void Reset()
@@ -105,19 +119,24 @@ namespace Poker
 			
 			m_cards.Sort();
 			
+			//The list is rebuilt in sorted order, since the draws of a multi draw are blended in order.
+			m_drawList.Clear();
 			for (int i = 0; i < m_cards.Count; i++)
 			{
-				Matrix4x4 worldTransform = GetCardTransform(i);
-				m_shader.SetUniform(m_worldTransformLocation, ref worldTransform);
-				
 				float minSrcX = m_cards[i].SrcRectangle.Left * xSrcScale;
 				float minSrcY = m_cards[i].SrcRectangle.Top * ySrcScale;
 				float maxSrcX = m_cards[i].SrcRectangle.Right * xSrcScale;
 				float maxSrcY = m_cards[i].SrcRectangle.Bottom * ySrcScale;
-				m_shader.SetUniform(m_texSourceRegionLocation, new Vector4(minSrcX, minSrcY, maxSrcX, maxSrcY));
 				
-				m_mesh.Draw();
+				CardParameters parameters = new CardParameters
+				{
+					WorldTransform = GetCardTransform(i),
+					TexSourceRegion = new Vector4(minSrcX, minSrcY, maxSrcX, maxSrcY)
+				};
+				m_drawList.Add(CARD_DRAW, &parameters);
 			}
+			
+			m_drawList.Submit(PARAMS_UNIT);
 		}
 		
 		public void DrawShadow()
@@ -126,22 +145,25 @@ namespace Poker
 			
 			Assets.CardBackTexture.Bind(0);
 			
+			m_shadowDrawList.Clear();
 			for (int i = 0; i < m_cards.Count; i++)
 			{
 				if (!m_cards[i].CastShadows)
 					continue;
 				
 				Matrix4x4 worldTransform = GetCardTransform(i);
-				m_shadowShader.SetUniform(m_worldTransformLocationShadow, ref worldTransform);
-				
-				m_mesh.Draw();
+				m_shadowDrawList.Add(CARD_DRAW, &worldTransform);
 			}
+			
+			m_shadowDrawList.Submit(PARAMS_UNIT);
 		}
 		
 		public void Dispose()
 		{
 			m_shader.Dispose();
 			m_shadowShader.Dispose();
+			m_drawList.Dispose();
+			m_shadowDrawList.Dispose();
 			m_mesh.Dispose();
 		}
 	}
@@ -11,49 +11,100 @@ namespace Poker
 		public static ChipsRenderer Instance;
 		
 		[StructLayout(LayoutKind.Sequential, Pack=1)]
-		private struct Chip
+		private struct ChipStack
 		{
 			public readonly float X;
 			public readonly float Y;
 			public readonly float Z;
 			public readonly float Rotation;
+			public readonly uint FirstChip;
+			public readonly uint Count;
+			public readonly uint Seed;
+			public readonly Color Color;
 			
-			public Chip(Vector3 pos, float rotation)
+			public ChipStack(Vector3 pos, float rotation, uint firstChip, uint count, uint seed, Color color)
 			{
 				X = pos.X;
 				Y = pos.Y;
 				Z = pos.Z;
 				Rotation = rotation;
+				FirstChip = firstChip;
+				Count = count;
+				Seed = seed;
+				Color = color;
 			}
 		}
 		
 		[DllImport("Native")]
-		private static extern IntPtr CB_Create(ulong maxChips);
+		private static extern IntPtr CB_CreateStacks(ulong maxStacks);
 		[DllImport("Native")]
 		private static extern void CB_Destroy(IntPtr handle);
 		[DllImport("Native")]
-		private static extern void CB_Upload(IntPtr handle, Chip* chips, ulong chipsCount);
+		private static extern void CB_UploadStacks(IntPtr handle, ChipStack* stacks, ulong stacksCount);
 		[DllImport("Native")]
 		private static extern void CB_Bind(IntPtr handle, uint unit);
+		[DllImport("Native")]
+		private static extern void CB_SetDeltaUploads(IntPtr handle, [MarshalAs(UnmanagedType.I1)] bool enabled);
+		
+		[StructLayout(LayoutKind.Sequential, Pack=1)]
+		public struct UploadStats
+		{
+			public ulong BytesUploaded;
+			public ulong BytesSkipped;
+			public ulong IdleUploads;
+		}
+		
+		[DllImport("Native")]
+		private static extern UploadStats CB_GetStats(IntPtr handle);
+		
+		private enum CullPass
+		{
+			Main = 0,
+			Shadow = 1
+		}
+		
+		[DllImport("Native")]
+		private static extern IntPtr CC_Create(IntPtr mesh, uint* partFirstIndices, uint* partNumIndices, uint numParts);
+		[DllImport("Native")]
+		private static extern void CC_Destroy(IntPtr handle);
+		[DllImport("Native")]
+		private static extern void CC_Cull(IntPtr handle, uint numChips);
+		[DllImport("Native")]
+		private static extern void CC_Draw(IntPtr handle, CullPass pass);
 		
 		private readonly IntPtr m_chipsBufferHandle;
+		private readonly IntPtr m_cullerHandle;
 		private readonly Shader m_shader;
 		private readonly Shader m_shadowShader;
+		private readonly Shader m_cullShader;
 		private readonly GLTF.Model m_chipModel;
 		
 		private readonly int m_albedoLocation;
+		private readonly int m_cullViewProjLocation;
+		private readonly int m_cullShadowMatrixLocation;
+		private readonly int m_cullNumStacksLocation;
+		private readonly int m_cullNumChipsLocation;
 		
 		public const float CHIP_SCALE = 0.05f;
 		public const float CHIP_HEIGHT = 0.1f * CHIP_SCALE;
 		
-		private const ulong MAX_CHIPS = 1024 * Net.Protocol.MAX_CLIENTS;
+		//Radius of a sphere around the chip's center which contains the chip model.
+		private const float CHIP_BOUNDING_RADIUS = 1.01f * CHIP_SCALE;
+		
+		private const ulong MAX_STACKS = 256 * Net.Protocol.MAX_CLIENTS;
+		
+		public static readonly Color DEFAULT_COLOR = new Color(255, 0, 0);
 		
 		private int m_numChips;
-		private readonly Chip[] m_chips = new Chip[MAX_CHIPS];
+		private int m_numStacks;
+		private readonly ChipStack[] m_stacks = new ChipStack[MAX_STACKS];
 		
 		public ChipsRenderer()
 		{
-			m_chipsBufferHandle = CB_Create(MAX_CHIPS);
+			m_chipsBufferHandle = CB_CreateStacks(MAX_STACKS);
+			
+			//Stacks rarely change between frames, so only the changed ones are written to the buffer.
+			CB_SetDeltaUploads(m_chipsBufferHandle, true);
 			
 			m_shader = new Shader();
 			m_shader.AttachStage(Shader.StageType.Vertex, "Chip.vs.glsl");
@@ -64,75 +115,148 @@ namespace Poker
 			m_shadowShader.AttachStage(Shader.StageType.Vertex, "ChipShadow.vs.glsl");
 			m_shadowShader.Link();
 			
+			m_cullShader = new Shader();
+			m_cullShader.AttachStage(Shader.StageType.Compute, "ChipCull.cs.glsl");
+			m_cullShader.Link();
+			
 			m_albedoLocation = m_shader.GetUniformLocation("albedo");
+			m_cullViewProjLocation = m_cullShader.GetUniformLocation("viewProj");
+			m_cullShadowMatrixLocation = m_cullShader.GetUniformLocation("shadowMatrix");
+			m_cullNumStacksLocation = m_cullShader.GetUniformLocation("numStacks");
+			m_cullNumChipsLocation = m_cullShader.GetUniformLocation("numChips");
 			
 			m_shader.SetUniform("specularIntensity", SPECULAR_INTENSITY);
 			m_shader.SetUniform("specularExponent", SPECULAR_EXPONENT);
 			m_shader.SetUniform("scale", CHIP_SCALE);
 			m_shadowShader.SetUniform("scale", CHIP_SCALE);
+			m_cullShader.SetUniform("chipHeight", CHIP_HEIGHT);
+			m_cullShader.SetUniform("boundingRadius", CHIP_BOUNDING_RADIUS);
 			
 			m_chipModel = GLTF.GLTFImporter.Import(Program.EXEDirectory + "/Res/Models/Chip.gltf");
+			
+			int numParts = m_chipModel.Parts.Length;
+			uint* partFirstIndices = stackalloc uint[numParts];
+			uint* partNumIndices = stackalloc uint[numParts];
+			for (int i = 0; i < numParts; i++)
+			{
+				partFirstIndices[i] = m_chipModel.Parts[i].FirstIndex;
+				partNumIndices[i] = m_chipModel.Parts[i].NumIndices;
+			}
+			m_cullerHandle = CC_Create(m_chipModel.Mesh.Handle, partFirstIndices, partNumIndices, (uint)numParts);
+			m_cullShader.SetUniform(m_cullShader.GetUniformLocation("numMeshes"), numParts);
 		}
 		
 		~ChipsRenderer()
 		{
 			CB_Destroy(m_chipsBufferHandle);
+			CC_Destroy(m_cullerHandle);
 		}
 		
 		public void Dispose()
 		{
 			m_shader.Dispose();
 			m_shadowShader.Dispose();
+			m_cullShader.Dispose();
 			m_chipModel.Dispose();
 			
 			CB_Destroy(m_chipsBufferHandle);
+			CC_Destroy(m_cullerHandle);
 			GC.SuppressFinalize(this);
 		}
 		
+		//Totals of the delta uploads of the chip stacks since the renderer was created.
+		public UploadStats StackUploadStats => CB_GetStats(m_chipsBufferHandle);
+		
 		public void Begin()
 		{
 			m_numChips = 0;
+			m_numStacks = 0;
 		}
 		
 		public void End()
 		{
-			fixed (Chip* chip = m_chips)
+			fixed (ChipStack* stacks = m_stacks)
 			{
-				CB_Upload(m_chipsBufferHandle, chip, (ulong)m_numChips);
+				CB_UploadStacks(m_chipsBufferHandle, stacks, (ulong)m_numStacks);
 			}
 		}
 		
+		//Adds a single chip at an exact position.
 		public void Add(Vector3 position, float rotation)
 		{
-			m_chips[m_numChips++] = new Chip(position, rotation);
+			AddStack(position, rotation, 1, 0, DEFAULT_COLOR);
+		}
+		
+		//Adds a stack of chips growing upwards from position. Chips in stacks with a non-zero seed get a
+		// random rotation and a small random offset, which are stable for a given seed.
+		public void AddStack(Vector3 position, float rotation, int count, uint seed, Color color)
+		{
+			if (count <= 0)
+				return;
+			m_stacks[m_numStacks++] = new ChipStack(position, rotation, (uint)m_numChips, (uint)count, seed, color);
+			m_numChips += count;
+		}
+		
+		//Same as chipHash in ChipStack.glh.
+		private static float ChipHash(uint seed, uint index)
+		{
+			unchecked
+			{
+				uint h = seed * 747796405u + index * 2891336453u;
+				h ^= h >> 16;
+				h *= 0x7feb352du;
+				h ^= h >> 15;
+				h *= 0x846ca68bu;
+				h ^= h >> 16;
+				return h * (1.0f / 4294967295.0f);
+			}
+		}
+		
+		//Gets the offset and rotation which the shader gives the chip at index in a stack with the given seed.
+		public static void GetChipJitter(uint seed, int index, out Vector3 offset, out float rotation)
+		{
+			uint i = (uint)index;
+			offset = new Vector3((ChipHash(seed, i * 3 + 0) - 0.5f) * 0.01f, 0, (ChipHash(seed, i * 3 + 1) - 0.5f) * 0.01f);
+			rotation = ChipHash(seed, i * 3 + 2) * MathF.PI * 2;
+		}
+		
+		//Tests every chip against the camera frustum and the shadow volume. Must be called after End and before
+		// DrawShadows and Draw, which then only draw the chips visible to their pass.
+		public void Cull(Matrix4x4 viewProj, Matrix4x4 shadowMatrix)
+		{
+			m_cullShader.Bind();
+			m_cullShader.SetUniform(m_cullViewProjLocation, ref viewProj);
+			m_cullShader.SetUniform(m_cullShadowMatrixLocation, ref shadowMatrix);
+			m_cullShader.SetUniform(m_cullNumStacksLocation, m_numStacks);
+			m_cullShader.SetUniform(m_cullNumChipsLocation, m_numChips);
+			
+			CB_Bind(m_chipsBufferHandle, 0);
+			
+			CC_Cull(m_cullerHandle, (uint)m_numChips);
 		}
 		
-		private readonly Vector3 RED_ALBEDO = new Vector3(1, 0, 0);
 		private readonly Vector3 WHITE_ALBEDO = new Vector3(1, 1, 1);
 		private const float SPECULAR_INTENSITY = 1;
 		private const float SPECULAR_EXPONENT = 5;
 		
 		public void DrawShadows()
 		{
-			m_shadowShader.Bind();
-			
-			CB_Bind(m_chipsBufferHandle, 0);
+			if (m_numStacks == 0)
+				return;
 			
-			foreach (GLTF.Mesh mesh in m_chipModel.Meshes)
-				mesh.DrawInstanced((uint)m_numChips);
+			m_shadowShader.Bind();
+			CC_Draw(m_cullerHandle, CullPass.Shadow);
 		}
 		
 		public void Draw()
 		{
-			m_shader.Bind();
-			
-			CB_Bind(m_chipsBufferHandle, 0);
-			
-			m_shader.SetUniform(m_albedoLocation, RED_ALBEDO);
-			m_chipModel.Meshes[0].DrawInstanced((uint)m_numChips);
+			if (m_numStacks == 0)
+				return;
 			
+			//The first part takes the color of the stack and the others are drawn white.
+			m_shader.Bind();
 			m_shader.SetUniform(m_albedoLocation, WHITE_ALBEDO);
-			m_chipModel.Meshes[1].DrawInstanced((uint)m_numChips);
+			CC_Draw(m_cullerHandle, CullPass.Main);
 		}
 	}
 }
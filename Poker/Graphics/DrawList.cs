@@ -0,0 +1,99 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace Poker
+{
+	//Draws sharing one mesh, submitted with a single multi draw indirect call. Shaders read each draw's
+	// parameter block from an SSBO, indexed by the draw id attribute at location 7.
+	public unsafe class DrawList : IDisposable
+	{
+		[StructLayout(LayoutKind.Sequential, Pack=1)]
+		public struct DrawDesc
+		{
+			public uint FirstIndex;
+			public uint NumIndices;
+			public int BaseVertex;
+			public uint NumInstances;
+			
+			public DrawDesc(uint firstIndex, uint numIndices, int baseVertex = 0, uint numInstances = 1)
+			{
+				FirstIndex = firstIndex;
+				NumIndices = numIndices;
+				BaseVertex = baseVertex;
+				NumInstances = numInstances;
+			}
+		}
+		
+		[DllImport("Native")]
+		private static extern IntPtr DL_Create(IntPtr mesh, uint maxDraws, uint paramsStride);
+		[DllImport("Native")]
+		private static extern void DL_Destroy(IntPtr drawList);
+		[DllImport("Native")]
+		private static extern uint DL_Add(IntPtr drawList, DrawDesc* desc, void* parameters);
+		[DllImport("Native")]
+		private static extern void DL_Remove(IntPtr drawList, uint handle);
+		[DllImport("Native")]
+		private static extern void DL_Update(IntPtr drawList, uint handle, DrawDesc* desc, void* parameters);
+		[DllImport("Native")]
+		private static extern void DL_Clear(IntPtr drawList);
+		[DllImport("Native")]
+		private static extern uint DL_GetCount(IntPtr drawList);
+		[DllImport("Native")]
+		private static extern void DL_Submit(IntPtr drawList, uint paramsUnit);
+		
+		private readonly IntPtr m_handle;
+		
+		//The mesh is referenced by the native draw list, so it must stay alive as long as the list does.
+		private readonly Mesh m_mesh;
+		
+		public DrawList(Mesh mesh, uint maxDraws, uint paramsStride)
+		{
+			m_mesh = mesh;
+			m_handle = DL_Create(mesh.Handle, maxDraws, paramsStride);
+		}
+		
+		~DrawList()
+		{
+			DL_Destroy(m_handle);
+		}
+		
+		public void Dispose()
+		{
+			DL_Destroy(m_handle);
+			GC.SuppressFinalize(this);
+		}
+		
+		public uint Count => DL_GetCount(m_handle);
+		
+		public uint Add(DrawDesc desc, void* parameters)
+		{
+			return DL_Add(m_handle, &desc, parameters);
+		}
+		
+		public void Remove(uint drawHandle)
+		{
+			DL_Remove(m_handle, drawHandle);
+		}
+		
+		public void Update(uint drawHandle, DrawDesc desc, void* parameters)
+		{
+			DL_Update(m_handle, drawHandle, &desc, parameters);
+		}
+		
+		public void UpdateParameters(uint drawHandle, void* parameters)
+		{
+			DL_Update(m_handle, drawHandle, null, parameters);
+		}
+		
+		//Removes all draws. Lists which are rebuilt every frame use this to keep their draws in the order added.
+		public void Clear()
+		{
+			DL_Clear(m_handle);
+		}
+		
+		public void Submit(uint paramsUnit)
+		{
+			DL_Submit(m_handle, paramsUnit);
+		}
+	}
+}
@@ -0,0 +1,46 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace Poker
+{
+	public enum CaptureFormat : uint
+	{
+		PNG = 0,
+		Raw = 1
+	}
+	
+	//Reads frames back asynchronously. Pixels are copied on the GPU and written to disk by a native worker thread,
+	// so captures never stall the frame. When too many captures are in flight, new ones are dropped.
+	public static class FrameCapture
+	{
+		[StructLayout(LayoutKind.Sequential, Pack=1)]
+		public struct Stats
+		{
+			public uint Written;
+			public uint Dropped;
+			public uint InFlight;
+		}
+		
+		[DllImport("Native")]
+		[return: MarshalAs(UnmanagedType.I1)]
+		private static extern bool CaptureFrame(uint width, uint height, string path, CaptureFormat format);
+		[DllImport("Native")]
+		public static extern Stats GetFrameCaptureStats();
+		
+		public static int DisplayWidth;
+		public static int DisplayHeight;
+		
+		//Captures the back buffer, must be called after the frame is drawn. Raw frames are appended to path.
+		public static bool Capture(string path, CaptureFormat format)
+		{
+			return CaptureFrame((uint)DisplayWidth, (uint)DisplayHeight, path, format);
+		}
+		
+		public static string GetScreenshotPath()
+		{
+			string directory = System.IO.Path.Combine(Program.EXEDirectory, "Screenshots");
+			System.IO.Directory.CreateDirectory(directory);
+			return System.IO.Path.Combine(directory, DateTime.Now.ToString("yyyyMMdd-HHmmss-fff") + ".png");
+		}
+	}
+}
@@ -8,15 +8,28 @@ namespace Poker
 	{
 		private enum VertexType
 		{
-			Standard = 0,
-			Card     = 1,
-			Text     = 2
+			Standard       = 0,
+			Card           = 1,
+			Text           = 2,
+			StandardPacked = 3
+		}
+		
+		[StructLayout(LayoutKind.Sequential, Pack=1)]
+		public struct OptimizeStats
+		{
+			public float ACMRBefore;
+			public float ACMRAfter;
+			public uint IndexSize;
 		}
 		
 		[DllImport("Native")]
 		private static extern IntPtr Mesh_Create(VertexType vertexType, uint numVertices, void* vertices,
 		                                         uint numIndices, uint* indices);
 		[DllImport("Native")]
+		private static extern IntPtr Mesh_CreateOptimized(VertexType vertexType, uint numVertices, void* vertices,
+		                                                  uint numIndices, uint* indices, out OptimizeStats stats,
+		                                                  uint numParts, uint* partNumIndices);
+		[DllImport("Native")]
 		private static extern void Mesh_Destroy(IntPtr mesh);
 		[DllImport("Native")]
 		private static extern void Mesh_Draw(IntPtr mesh);
@@ -25,18 +38,38 @@ namespace Poker
 		
 		private readonly IntPtr m_handle;
 		
-		public Mesh(Vertex[] vertices, uint[] indices, uint numVertices = 0, uint numIndices = 0)
+		public IntPtr Handle => m_handle;
+		
+		//Set for meshes created with optimize, which have their triangles and vertices reordered for the vertex cache.
+		public readonly OptimizeStats? OptimizationStats;
+		
+		//Packed meshes are quantized by the native side to half the vertex size, and must be drawn with shaders
+		// which decode vertices using PackedVertex.glh. Optimization keeps triangles within the consecutive index ranges
+		// given by partNumIndices, so that the parts can still be drawn separately.
+		public Mesh(Vertex[] vertices, uint[] indices, uint numVertices = 0, uint numIndices = 0, bool packed = false,
+		            bool optimize = false, uint[] partNumIndices = null)
 		{
 			if (numVertices == 0)
 				numVertices = (uint)vertices.Length;
 			if (numIndices == 0)
 				numIndices = (uint)indices.Length;
 			
-			fixed (uint* indicesPtr = indices)
+			fixed (uint* indicesPtr = indices, partNumIndicesPtr = partNumIndices)
 			{
 				fixed (Vertex* verticesPtr = vertices)
 				{
-					m_handle = Mesh_Create(VertexType.Standard, numVertices, verticesPtr, numIndices, indicesPtr);
+					VertexType vertexType = packed ? VertexType.StandardPacked : VertexType.Standard;
+					if (optimize)
+					{
+						m_handle = Mesh_CreateOptimized(vertexType, numVertices, verticesPtr, numIndices, indicesPtr,
+						                                out OptimizeStats stats, (uint)(partNumIndices?.Length ?? 0),
+						                                partNumIndicesPtr);
+						OptimizationStats = stats;
+					}
+					else
+					{
+						m_handle = Mesh_Create(vertexType, numVertices, verticesPtr, numIndices, indicesPtr);
+					}
 				}
 			}
 		}
@@ -1,16 +1,39 @@
 ﻿using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
 
 namespace Poker
 {
-	public class ModelInstance
+	//Draws all parts of a model with one multi draw. Materials are passed per part, and their textures are bound
+	// side by side as texture sets of the board shader.
+	public unsafe class ModelInstance : IDisposable
 	{
+		[StructLayout(LayoutKind.Sequential, Pack=1)]
+		private struct PartParameters
+		{
+			public float SpecularIntensity;
+			public float SpecularExponent;
+			public float TextureScale;
+			public uint TextureSet;
+		}
+		
 		private readonly GLTF.Model m_model;
 		private readonly MaterialSettings[] m_materialSettings;
+		private readonly List<MaterialSettings> m_textureSets = new List<MaterialSettings>();
+		
+		private readonly DrawList m_drawList;
+		private readonly uint[] m_drawHandles;
 		
 		public ModelInstance(GLTF.Model model, MaterialSettings material = null)
 		{
 			m_model = model;
-			m_materialSettings = new MaterialSettings[m_model.Meshes.Length];
+			m_materialSettings = new MaterialSettings[m_model.Parts.Length];
+			
+			m_drawList = new DrawList(m_model.Mesh, (uint)m_model.Parts.Length, (uint)sizeof(PartParameters));
+			m_drawHandles = new uint[m_model.Parts.Length];
+			for (int i = 0; i < m_model.Parts.Length; i++)
+				m_drawHandles[i] = m_drawList.Add(m_model.Parts[i].DrawDesc, null);
+			
 			SetMaterial(material);
 		}
 		
@@ -18,23 +41,61 @@ namespace Poker
 		{
 			for (int i = 0; i < m_materialSettings.Length; i++)
 				m_materialSettings[i] = materialSettings;
+			UpdateParameters();
 		}
 		
 		public void SetMaterial(string meshName, MaterialSettings materialSettings)
 		{
-			int meshIndex = Array.FindIndex(m_model.Meshes, mesh => mesh.Name == meshName);
-			if (meshIndex == -1)
-				throw new ArgumentException("Mesh not found '" + meshName + "'.", nameof(meshName));
-			m_materialSettings[meshIndex] = materialSettings;
+			m_materialSettings[m_model.FindPart(meshName)] = materialSettings;
+			UpdateParameters();
 		}
 		
+		private void UpdateParameters()
+		{
+			m_textureSets.Clear();
+			for (int i = 0; i < m_materialSettings.Length; i++)
+			{
+				MaterialSettings settings = m_materialSettings[i];
+				if (settings == null)
+					continue;
+				
+				int textureSet = m_textureSets.IndexOf(settings);
+				if (textureSet == -1)
+				{
+					if (m_textureSets.Count == BoardShader.MAX_TEXTURE_SETS)
+						throw new InvalidOperationException("Too many materials for one model.");
+					textureSet = m_textureSets.Count;
+					m_textureSets.Add(settings);
+				}
+				
+				PartParameters parameters = new PartParameters
+				{
+					SpecularIntensity = settings.SpecularIntensity,
+					SpecularExponent = settings.SpecularExponent,
+					TextureScale = settings.TextureScale,
+					TextureSet = (uint)textureSet
+				};
+				m_drawList.UpdateParameters(m_drawHandles[i], &parameters);
+			}
+		}
+		
+		//Shadow passes draw the mesh as a whole, since they need no materials.
 		public void Draw(BoardShader boardShader)
 		{
-			for (int i = 0; i < m_model.Meshes.Length; i++)
+			if (boardShader == null)
 			{
-				boardShader?.BindSettings(m_materialSettings[i]);
-				m_model.Meshes[i].Draw();
+				m_model.Mesh.Draw();
+				return;
 			}
+			
+			for (int i = 0; i < m_textureSets.Count; i++)
+				boardShader.BindTextures(m_textureSets[i], i);
+			m_drawList.Submit(BoardShader.PARAMS_UNIT);
+		}
+		
+		public void Dispose()
+		{
+			m_drawList.Dispose();
 		}
 	}
 }
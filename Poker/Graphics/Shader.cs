@@ -12,7 +12,8 @@ namespace Poker
 		public enum StageType
 		{
 			Vertex = 0,
-			Fragment = 1
+			Fragment = 1,
+			Compute = 2
 		}
 		
 		[DllImport("Native")]
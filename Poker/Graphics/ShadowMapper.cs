@@ -25,6 +25,8 @@ namespace Poker
 		private IntPtr m_shadowMapHandle = IntPtr.Zero;
 		private readonly IntPtr m_shadowMatrixBuffer;
 		
+		public readonly Matrix4x4 ShadowMatrix;
+		
 		private uint m_resolution = 1024;
 		private bool m_resolutionChanged = true;
 		
@@ -35,6 +37,7 @@ namespace Poker
 			Matrix4x4 shadowMatrix = Matrix4x4.CreateLookAt(Vector3.Zero, lightDirection, shadowUp) *
 			                         Matrix4x4.CreateOrthographic(VOLUME_SIZE, VOLUME_SIZE, -100, 100);
 			
+			ShadowMatrix = shadowMatrix;
 			m_shadowMatrixBuffer = SMB_Create(&shadowMatrix.M11);
 		}
 		
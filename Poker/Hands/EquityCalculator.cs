@@ -0,0 +1,157 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace Poker.Hands
+{
+	//Computes the equity of each player in a spot on native worker threads, so that it can run while frames are being
+	// drawn. Players whose hole cards are null hold unknown hands, which only Monte Carlo sampling supports.
+	public class EquityCalculator : IDisposable
+	{
+		[DllImport("Native")]
+		private static extern IntPtr EQ_StartMonteCarlo(byte[] holeCards, uint numPlayers, byte[] board,
+		                                                uint numBoardCards, byte[] deadCards, uint numDeadCards,
+		                                                ulong numDeals, uint timeBudgetMS, ulong seed);
+		[DllImport("Native")]
+		private static extern IntPtr EQ_StartEnumeration(byte[] holeCards, uint numPlayers, byte[] board,
+		                                                 uint numBoardCards, byte[] deadCards, uint numDeadCards);
+		[DllImport("Native")]
+		private static extern IntPtr EQ_StartRangeSampling(float[] weights, uint numPlayers, byte[] board,
+		                                                   uint numBoardCards, byte[] deadCards, uint numDeadCards,
+		                                                   ulong numDeals, uint timeBudgetMS, ulong seed);
+		[DllImport("Native")]
+		private static extern void EQ_Destroy(IntPtr job);
+		[DllImport("Native")]
+		[return: MarshalAs(UnmanagedType.I1)]
+		private static extern bool EQ_GetResult(IntPtr job, out ulong deals, double[] win, double[] tie,
+		                                        double[] equity);
+		
+		public const int MAX_PLAYERS = 8;
+		
+		private IntPtr m_job;
+		
+		public readonly int NumPlayers;
+		
+		//Exact results are only meaningful once finished, sampled results get more accurate over time.
+		public readonly bool Exact;
+		
+		public ulong Deals { get; private set; }
+		public bool Finished { get; private set; }
+		
+		private readonly double[] m_win = new double[MAX_PLAYERS];
+		private readonly double[] m_tie = new double[MAX_PLAYERS];
+		private readonly double[] m_equity = new double[MAX_PLAYERS];
+		
+		private enum Method
+		{
+			Sample,
+			Enumerate
+		}
+		
+		private EquityCalculator(HandRange[] ranges, Card[] board, Card[] deadCards, ulong numDeals, int timeBudgetMS)
+		{
+			NumPlayers = ranges.Length;
+			
+			float[] weights = new float[ranges.Length * HandRange.NUM_COMBOS];
+			for (int i = 0; i < ranges.Length; i++)
+				Array.Copy(ranges[i].Weights, 0, weights, i * HandRange.NUM_COMBOS, HandRange.NUM_COMBOS);
+			
+			byte[] packedBoard = Array.ConvertAll(board, card => card.PackedValue);
+			byte[] packedDeadCards = Array.ConvertAll(deadCards ?? new Card[0], card => card.PackedValue);
+			
+			//The seed is fixed, so that the cached result of a spot does not depend on which run filled the cache.
+			m_job = EQ_StartRangeSampling(weights, (uint)ranges.Length, packedBoard, (uint)packedBoard.Length,
+			                              packedDeadCards, (uint)packedDeadCards.Length, numDeals, (uint)timeBudgetMS, 1);
+		}
+		
+		private EquityCalculator(Method method, Card[][] holeCards, Card[] board, Card[] deadCards, ulong numDeals,
+		                         int timeBudgetMS)
+		{
+			NumPlayers = holeCards.Length;
+			Exact = method == Method.Enumerate;
+			
+			byte[] packedHoleCards = new byte[holeCards.Length * 2];
+			for (int i = 0; i < holeCards.Length; i++)
+			{
+				packedHoleCards[i * 2] = holeCards[i]?[0].PackedValue ?? HandEvaluator.NO_CARD;
+				packedHoleCards[i * 2 + 1] = holeCards[i]?[1].PackedValue ?? HandEvaluator.NO_CARD;
+			}
+			
+			byte[] packedBoard = Array.ConvertAll(board, card => card.PackedValue);
+			byte[] packedDeadCards = Array.ConvertAll(deadCards ?? new Card[0], card => card.PackedValue);
+			
+			if (method == Method.Enumerate)
+			{
+				m_job = EQ_StartEnumeration(packedHoleCards, (uint)holeCards.Length, packedBoard,
+				                            (uint)packedBoard.Length, packedDeadCards, (uint)packedDeadCards.Length);
+			}
+			else
+			{
+				m_job = EQ_StartMonteCarlo(packedHoleCards, (uint)holeCards.Length, packedBoard,
+				                           (uint)packedBoard.Length, packedDeadCards, (uint)packedDeadCards.Length,
+				                           numDeals, (uint)timeBudgetMS, (ulong)DateTime.Now.Ticks);
+			}
+		}
+		
+		//Deals a fixed number of boards.
+		public static EquityCalculator WithDeals(Card[][] holeCards, Card[] board, Card[] deadCards, ulong numDeals)
+		{
+			return new EquityCalculator(Method.Sample, holeCards, board, deadCards, numDeals, 0);
+		}
+		
+		//Deals as many boards as fit in the time budget.
+		public static EquityCalculator WithTimeBudget(Card[][] holeCards, Card[] board, Card[] deadCards,
+		                                              int timeBudgetMS)
+		{
+			return new EquityCalculator(Method.Sample, holeCards, board, deadCards, 0, timeBudgetMS);
+		}
+		
+		//Samples deals from weighted ranges, for 2 to 8 players. Results of a fixed number of deals are cached by
+		// native code, so asking again for a spot is immediate. Ranges which clash too much to deal give no deals.
+		// Returns null if the board and dead cards leave a range without any combos.
+		public static EquityCalculator FromRanges(HandRange[] ranges, Card[] board, Card[] deadCards, ulong numDeals)
+		{
+			EquityCalculator calculator = new EquityCalculator(ranges, board, deadCards, numDeals, 0);
+			if (calculator.m_job == IntPtr.Zero)
+			{
+				GC.SuppressFinalize(calculator);
+				return null;
+			}
+			return calculator;
+		}
+		
+		//Deals every possible board for exact equities. All hole cards must be known. Preflop spots with more than a
+		// few players take much longer than sampling.
+		public static EquityCalculator Enumerate(Card[][] holeCards, Card[] board, Card[] deadCards)
+		{
+			return new EquityCalculator(Method.Enumerate, holeCards, board, deadCards, 0, 0);
+		}
+		
+		~EquityCalculator()
+		{
+			EQ_Destroy(m_job);
+		}
+		
+		//Does not block, so a running job can be dropped from the render thread.
+		public void Dispose()
+		{
+			EQ_Destroy(m_job);
+			GC.SuppressFinalize(this);
+		}
+		
+		//Fetches the latest results. Does not block, the results become more accurate until the job has finished.
+		public void Update()
+		{
+			if (Finished)
+				return;
+			
+			Finished = EQ_GetResult(m_job, out ulong deals, m_win, m_tie, m_equity);
+			Deals = deals;
+		}
+		
+		public double GetWinProbability(int player) => m_win[player];
+		public double GetTieProbability(int player) => m_tie[player];
+		
+		//The player's expected share of the pot, counting split pots.
+		public double GetEquity(int player) => m_equity[player];
+	}
+}
@@ -29,16 +29,5 @@ namespace Poker.Hands
 			
 			return null;
 		}
-		
-		public int CompareSame(Flush other)
-		{
-			for (int i = m_cards.Length - 1; i >= 0; i--)
-			{
-				int comp = m_cards[i].Rank.CompareTo(other.m_cards[i].Rank);
-				if (comp != 0)
-					return comp;
-			}
-			return 0;
-		}
 	}
 }
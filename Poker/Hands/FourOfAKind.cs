@@ -37,13 +37,5 @@ namespace Poker.Hands
 			Card kicker = SelectKickers(cards, new[] {index}, 4).First();
 			return new FourOfAKind(cards[index].Rank, kicker);
 		}
-		
-		public int CompareSame(FourOfAKind other)
-		{
-			int result = m_rank.CompareTo(other.m_rank);
-			if (result == 0)
-				result = m_kicker.Rank.CompareTo(other.m_kicker.Rank);
-			return result;
-		}
 	}
 }
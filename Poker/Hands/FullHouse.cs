@@ -51,13 +51,5 @@ namespace Poker.Hands
 			
 			return new FullHouse(cards, set3[0], set2Begin);
 		}
-		
-		public int CompareSame(FullHouse other)
-		{
-			int result = m_set30.Rank.CompareTo(other.m_set30.Rank);
-			if (result == 0)
-				result = m_set20.Rank.CompareTo(other.m_set20.Rank);
-			return result;
-		}
 	}
 }
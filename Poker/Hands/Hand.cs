@@ -11,28 +11,39 @@ namespace Poker.Hands
 		public abstract IEnumerable<Card> Cards { get; }
 		public virtual Color Color => Color.White;
 		
-		private static readonly Type[] HAND_TYPES = 
+		//Strength from the native evaluator, which decides how hands compare.
+		public ushort Strength { get; private set; }
+		
+		//Ordered from the strongest hand type to the weakest.
+		private static readonly Func<Card[], Hand>[] HAND_CREATORS = 
 		{
-			typeof(StraightFlush),
-			typeof(FourOfAKind),
-			typeof(FullHouse),
-			typeof(Flush),
-			typeof(Straight),
-			typeof(ThreeOfAKind),
-			typeof(TwoPair),
-			typeof(Pair),
-			typeof(HighCard)
+			StraightFlush.Create,
+			FourOfAKind.Create,
+			FullHouse.Create,
+			Flush.Create,
+			Straight.Create,
+			ThreeOfAKind.Create,
+			TwoPair.Create,
+			Pair.Create,
+			HighCard.Create
 		};
 		
 		public static Hand CreateBest(Card[] cards)
 		{
+			ushort strength = HandEvaluator.Evaluate(cards);
+			
 			Array.Sort(cards);
 			
-			foreach (Type type in HAND_TYPES)
+			//Only the evaluated hand type and weaker ones are tried, to find the cards to display.
+			int firstCreator = HAND_CREATORS.Length - 1 - HandEvaluator.GetCategory(strength);
+			for (int i = firstCreator; i < HAND_CREATORS.Length; i++)
 			{
-				Hand hand = (Hand)type.GetMethod("Create").Invoke(null, new object[] {cards});
+				Hand hand = HAND_CREATORS[i](cards);
 				if (hand != null)
+				{
+					hand.Strength = strength;
 					return hand;
+				}
 			}
 			
 			return null;
@@ -40,10 +51,7 @@ namespace Poker.Hands
 		
 		public int CompareTo(Hand other)
 		{
-			int result = Rank.CompareTo(other.Rank);
-			if (result == 0)
-				result = (int)GetType().GetMethod("CompareSame").Invoke(this, new object[] {other});
-			return result;
+			return Strength.CompareTo(other.Strength);
 		}
 		
 		public override string ToString()
@@ -61,17 +69,34 @@ namespace Poker.Hands
 			}
 		}
 		
-		protected static IEnumerable<Card> IterateStraight(Card[] cards, int startOffset)
+		//Returns the five cards of the highest straight from lowest to highest, or null. The ace also counts as the low
+		// card of the wheel (A-2-3-4-5).
+		protected static Card[] FindStraight(IEnumerable<Card> cards)
 		{
-			yield return cards[startOffset];
-			for (int i = startOffset + 1; i < cards.Length; i++)
+			Card?[] cardsByRank = new Card?[Card.RANK_ACE + 1];
+			foreach (Card card in cards)
 			{
-				int rankDiff = cards[i].Rank - cards[i - 1].Rank;
-				if (rankDiff > 1)
-					break;
-				if (rankDiff == 1)
-					yield return cards[i];
+				cardsByRank[card.Rank] = card;
 			}
+			
+			for (int highRank = Card.RANK_ACE; highRank >= Card.RANK_5; highRank--)
+			{
+				Card[] straight = new Card[5];
+				int i;
+				for (i = 0; i < 5; i++)
+				{
+					int rank = highRank - 4 + i;
+					Card? card = cardsByRank[rank < 0 ? Card.RANK_ACE : rank];
+					if (!card.HasValue)
+						break;
+					straight[i] = card.Value;
+				}
+				
+				if (i == 5)
+					return straight;
+			}
+			
+			return null;
 		}
 		
 		protected static IEnumerable<int> IterateSets(Card[] cards, int size)
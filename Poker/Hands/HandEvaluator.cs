@@ -0,0 +1,55 @@
+﻿using System.Runtime.InteropServices;
+
+namespace Poker.Hands
+{
+	//Table driven evaluator in the native library. Strengths compare like the best hands they stand for, and
+	// store the hand's category, which matches Hand.Rank, in the top four bits.
+	public static class HandEvaluator
+	{
+		[DllImport("Native")]
+		private static extern ushort HE_Evaluate(byte[] cards, uint numCards);
+		[DllImport("Native")]
+		private static extern void HE_EvaluateBatch(byte[] cards, uint cardsPerHand, uint numHands, ushort[] strengths);
+		[DllImport("Native")]
+		private static extern void HE_EvaluateShowdown(byte[] board, byte[] holeCards, uint numPlayers,
+		                                               int[] contributions, uint numPots, ushort[] strengths,
+		                                               int[] potAwards);
+		
+		//Stands in for the hole cards of players who are not in the showdown.
+		public const byte NO_CARD = 0xFF;
+		
+		[System.ThreadStatic]
+		private static byte[] s_packedCards;
+		
+		//Evaluates the best five card hand among 5 to 7 cards.
+		public static ushort Evaluate(Card[] cards)
+		{
+			if (s_packedCards == null)
+				s_packedCards = new byte[7];
+			
+			for (int i = 0; i < cards.Length; i++)
+				s_packedCards[i] = cards[i].PackedValue;
+			return HE_Evaluate(s_packedCards, (uint)cards.Length);
+		}
+		
+		//Evaluates hands of cardsPerHand packed cards each, stored one after another.
+		public static void EvaluateBatch(byte[] packedCards, int cardsPerHand, ushort[] strengths)
+		{
+			HE_EvaluateBatch(packedCards, (uint)cardsPerHand, (uint)(packedCards.Length / cardsPerHand), strengths);
+		}
+		
+		//Scores every player's hand and splits the pots among the strongest hands of the players who contributed to
+		// them. holeCards holds two packed cards per player, contributions holds one amount per player for each pot.
+		public static void EvaluateShowdown(byte[] board, byte[] holeCards, int[] contributions, int numPots,
+		                                    ushort[] strengths, int[] potAwards)
+		{
+			HE_EvaluateShowdown(board, holeCards, (uint)(holeCards.Length / 2), contributions, (uint)numPots,
+			                    strengths, potAwards);
+		}
+		
+		public static int GetCategory(ushort strength)
+		{
+			return strength >> 12;
+		}
+	}
+}
@@ -0,0 +1,75 @@
+﻿using System;
+
+namespace Poker.Hands
+{
+	//A weighted range of starting hands, with one weight for each of the 1326 pairs of hole cards.
+	public class HandRange
+	{
+		public const int NUM_COMBOS = 1326;
+		
+		//Number of starting hands when suits are ignored: 13 pairs, 78 suited and 78 offsuit hands.
+		public const int NUM_CANONICAL_HANDS = 169;
+		
+		public readonly float[] Weights = new float[NUM_COMBOS];
+		
+		//Matches GetComboIndex in native code.
+		public static int GetComboIndex(Card card1, Card card2)
+		{
+			int high = Math.Max(card1.PackedValue, card2.PackedValue);
+			int low = Math.Min(card1.PackedValue, card2.PackedValue);
+			return high * (high - 1) / 2 + low;
+		}
+		
+		public static HandRange Any()
+		{
+			HandRange range = new HandRange();
+			for (int i = 0; i < NUM_COMBOS; i++)
+				range.Weights[i] = 1;
+			return range;
+		}
+		
+		public static HandRange Single(Card card1, Card card2)
+		{
+			HandRange range = new HandRange();
+			range.SetCombo(card1, card2, 1);
+			return range;
+		}
+		
+		//Weights are laid out as a 13 by 13 grid indexed by rank1 * 13 + rank2. Pairs are on the diagonal, suited
+		// hands have rank1 above rank2 and offsuit hands have rank1 below rank2.
+		public static HandRange FromCanonical(float[] weights)
+		{
+			HandRange range = new HandRange();
+			for (int rank1 = 0; rank1 < 13; rank1++)
+			{
+				for (int rank2 = 0; rank2 < 13; rank2++)
+				{
+					float weight = weights[rank1 * 13 + rank2];
+					if (weight > 0)
+						range.SetCanonical(Math.Max(rank1, rank2), Math.Min(rank1, rank2), rank1 > rank2, weight);
+				}
+			}
+			return range;
+		}
+		
+		public void SetCombo(Card card1, Card card2, float weight)
+		{
+			Weights[GetComboIndex(card1, card2)] = weight;
+		}
+		
+		//Sets the weight of every combo of a starting hand. suited is ignored for pairs.
+		public void SetCanonical(int highRank, int lowRank, bool suited, float weight)
+		{
+			for (int suit1 = 0; suit1 < 4; suit1++)
+			{
+				for (int suit2 = 0; suit2 < 4; suit2++)
+				{
+					bool isSuited = suit1 == suit2;
+					if (highRank == lowRank ? suit1 >= suit2 : isSuited != suited)
+						continue;
+					SetCombo(new Card((Suits)suit1, highRank), new Card((Suits)suit2, lowRank), weight);
+				}
+			}
+		}
+	}
+}
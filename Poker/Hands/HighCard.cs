@@ -23,16 +23,5 @@ namespace Poker.Hands
 				outCards[i] = cards[cards.Length - i - 1];
 			return new HighCard(outCards);
 		}
-		
-		public int CompareSame(HighCard other)
-		{
-			for (int i = 0; i < m_cards.Length; i++)
-			{
-				int result = m_cards[i].Rank.CompareTo(other.m_cards[i].Rank);
-				if (result != 0)
-					return result;
-			}
-			return 0;
-		}
 	}
 }
@@ -27,16 +27,5 @@ namespace Poker.Hands
 			
 			return new Pair(new[] { cards[index], cards[index + 1], kickers[0], kickers[1], kickers[2] });
 		}
-		
-		public int CompareSame(Pair other)
-		{
-			for (int i = 1; i < 5; i++)
-			{
-				int result = m_cards[i].Rank.CompareTo(other.m_cards[i].Rank);
-				if (result != 0)
-					return result;
-			}
-			return 0;
-		}
 	}
 }
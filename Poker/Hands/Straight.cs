@@ -19,21 +19,8 @@ namespace Poker.Hands
 		
 		public static Straight Create(Card[] cards)
 		{
-			for (int o = 2; o >= 0; o--)
-			{
-				Card[] straight = IterateStraight(cards, o).Take(5).ToArray();
-				if (straight.Length == 5)
-				{
-					return new Straight(straight);
-				}
-			}
-			
-			return null;
-		}
-		
-		public int CompareSame(Straight other)
-		{
-			return m_cards[0].Rank.CompareTo(other.m_cards[0].Rank);
+			Card[] straight = FindStraight(cards);
+			return straight == null ? null : new Straight(straight);
 		}
 	}
 }
@@ -11,41 +11,27 @@ namespace Poker.Hands
 		public override string Name => "Straight Flush";
 		public override Color Color => new Color(255, 233, 166);
 		
-		public override IEnumerable<Card> Cards
-		{
-			get
-			{
-				for (int i = 0; i < 5; i++)
-				{
-					yield return new Card(m_startingCard.Suit, m_startingCard.Rank + i);
-				}
-			}
-		}
+		public override IEnumerable<Card> Cards => m_cards;
 		
-		private Card m_startingCard;
+		private readonly Card[] m_cards;
 		
-		private StraightFlush(Card startingCard)
+		private StraightFlush(Card[] cards)
 		{
-			m_startingCard = startingCard;
+			m_cards = cards;
 		}
 		
 		public static StraightFlush Create(Card[] cards)
 		{
-			for (int o = 2; o >= 0; o--)
+			foreach (Suits suit in Enum.GetValues(typeof(Suits)))
 			{
-				Card[] straight = IterateStraight(cards, o).Take(5).ToArray();
-				if (straight.Length == 5 && straight.Skip(1).All(card => card.Suit == straight[0].Suit))
+				Card[] straight = FindStraight(cards.Where(card => card.Suit == suit));
+				if (straight != null)
 				{
-					return new StraightFlush(straight[0]);
+					return new StraightFlush(straight);
 				}
 			}
 			
 			return null;
 		}
-		
-		public int CompareSame(StraightFlush other)
-		{
-			return m_startingCard.Rank.CompareTo(other.m_startingCard.Rank);
-		}
 	}
 }
@@ -44,13 +44,5 @@ namespace Poker.Hands
 			
 			return new ThreeOfAKind(cards[index].Rank, suits, kickers);
 		}
-		
-		public int CompareSame(ThreeOfAKind other)
-		{
-			int result = m_rank.CompareTo(other.m_rank);
-			for (int i = 0; i < m_kickers.Length && result == 0; i++)
-				result = m_kickers[i].Rank.CompareTo(other.m_kickers[i].Rank);
-			return result;
-		}
 	}
 }
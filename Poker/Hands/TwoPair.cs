@@ -29,16 +29,5 @@ namespace Poker.Hands
 		}
 		
 		private static readonly int[] COMPARE_INDICES = { 0, 2, 4 };
-		
-		public int CompareSame(TwoPair other)
-		{
-			foreach (int index in COMPARE_INDICES)
-			{
-				int result = m_cards[index].Rank.CompareTo(other.m_cards[index].Rank);
-				if (result != 0)
-					return result;
-			}
-			return 0;
-		}
 	}
 }
@@ -0,0 +1,63 @@
+﻿using System.Runtime.InteropServices;
+using System.Text;
+
+namespace Poker
+{
+	public enum InputEventType : uint
+	{
+		TextInput       = 0,
+		KeyDown         = 1,
+		KeyUp           = 2,
+		MouseButtonDown = 3,
+		MouseButtonUp   = 4,
+		MouseWheel      = 5
+	}
+	
+	[StructLayout(LayoutKind.Sequential, Pack=1)]
+	public unsafe struct InputEvent
+	{
+		public InputEventType Type;
+		public uint SDLTimestamp;
+		public ulong ArrivalTime;
+		public int X;
+		public int Y;
+		public int Button;
+		public uint TextLength;
+		public fixed byte Text[32];
+		
+		public Keys Key => (Keys)X;
+		public bool IsRepeat => Y != 0;
+		
+		public string GetText()
+		{
+			fixed (byte* text = Text)
+			{
+				return Encoding.UTF8.GetString(text, (int)TextLength);
+			}
+		}
+	}
+	
+	//Input events are queued natively with their arrival time and drained once per frame.
+	public static unsafe class InputQueue
+	{
+		[DllImport("Native")]
+		private static extern uint DrainInputEvents(InputEvent* events, uint maxEvents);
+		[DllImport("Native")]
+		public static extern ulong GetInputClock();
+		
+		private static readonly InputEvent[] s_events = new InputEvent[256];
+		
+		public static int Count { get; private set; }
+		
+		public static InputEvent[] Events => s_events;
+		
+		//Replaces Events with the events which arrived since the last call.
+		public static void Drain()
+		{
+			fixed (InputEvent* events = s_events)
+			{
+				Count = (int)DrainInputEvents(events, (uint)s_events.Length);
+			}
+		}
+	}
+}
@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Diagnostics.Contracts;
 using System.IO;
@@ -38,6 +39,9 @@ namespace Poker.Net.Client
 		
 		private volatile bool m_shouldDisconnect;
 		
+		private volatile bool m_deferMessages;
+		private readonly ConcurrentQueue<Message> m_deferredMessages = new ConcurrentQueue<Message>();
+		
 		public event Action OnStateChanged;
 		
 		private ushort m_selfClientId;
@@ -108,6 +112,26 @@ namespace Poker.Net.Client
 			m_receiver.ShouldStop = true;
 			m_socket.Close();
 			m_thread.Join();
+			m_receiver.Dispose();
+		}
+		
+		//Makes the receive thread queue messages instead of handling them, so that another thread can handle them in
+		// HandleDeferredMessages. Messages received before this call have been handled when the first one is queued.
+		public void DeferMessages()
+		{
+			m_deferMessages = true;
+		}
+		
+		public void HandleDeferredMessages()
+		{
+			while (m_deferredMessages.TryDequeue(out Message message))
+			{
+				if (!HandleMessage(message))
+				{
+					m_socket.Close();
+					break;
+				}
+			}
 		}
 		
 		public override void NextHand()
@@ -188,8 +212,7 @@ namespace Poker.Net.Client
 					return;
 				}
 				
-				ulong cardId = DeckEncrypter.DecryptCard(m_encryptedDeck[cardIndex], keys);
-				CommunityCards[cardOffset + i] = new Card((byte)cardId);
+				CommunityCards[cardOffset + i] = DeckEncrypter.DecryptCard(m_encryptedDeck[cardIndex], keys);
 			}
 			
 			CommunityCardsRevealed += numCards;
@@ -267,6 +290,7 @@ namespace Poker.Net.Client
 				var waitResult = m_receiver.WaitForMessage(m_socket, out Message message);
 				
 				if (waitResult == Receiver.WaitResult.SocketClosed ||
+				    waitResult == Receiver.WaitResult.MessageTooLarge ||
 				    waitResult == Receiver.WaitResult.ShouldStop && m_shouldDisconnect)
 				{
 					Console.WriteLine("Disconnected by server");
@@ -279,418 +303,431 @@ namespace Poker.Net.Client
 				if (waitResult != Receiver.WaitResult.Received)
 					continue;
 				
-				BinaryReader messageReader = new BinaryReader(new MemoryStream(message.Data));
+				//Once deferred, messages wait for HandleDeferredMessages, which handles them in the order they arrived.
+				if (m_deferMessages)
+				{
+					m_deferredMessages.Enqueue(message);
+					continue;
+				}
 				
-				if (CState == State.Connecting)
+				if (!HandleMessage(message))
+					break;
+			}
+			
+			m_socket.Close();
+		}
+		
+		//Returns false if the connection should be closed.
+		private bool HandleMessage(Message message)
+		{
+			BinaryReader messageReader = new BinaryReader(new MemoryStream(message.Data));
+			
+			if (CState == State.Connecting)
+			{
+				if (message.Id != MessageId.ConnectionResponse)
+					return true;
+				
+				ConnectionResponseStatus = (ConnectionResponseStatus)messageReader.ReadByte();
+				if (ConnectionResponseStatus != ConnectionResponseStatus.OK)
 				{
-					if (message.Id != MessageId.ConnectionResponse)
-						continue;
+					CState = State.Rejected;
+					return false;
+				}
+				
+				m_selfClientId = messageReader.ReadUInt16();
+				
+				ushort numOtherClients = messageReader.ReadUInt16();
+				m_clients = new List<Client>(numOtherClients + 1);
+				
+				//Reads information about other clients
+				for (ushort i = 0; i < numOtherClients; i++)
+				{
+					ushort clientId = messageReader.ReadUInt16();
+					byte nameLen = messageReader.ReadByte();
+					byte[] nameUtf8 = messageReader.ReadBytes(nameLen);
 					
-					ConnectionResponseStatus = (ConnectionResponseStatus)messageReader.ReadByte();
-					if (ConnectionResponseStatus != ConnectionResponseStatus.OK)
+					m_clients.Add(new Client(clientId, Encoding.UTF8.GetString(nameUtf8)));
+				}
+				
+				m_clients.Add(new Client(SelfClientId, m_name));
+				
+				Console.WriteLine("Connected to server");
+				
+				CState = State.Connected;
+				OnStateChanged?.Invoke();
+			}
+			else if (CState == State.Connected)
+			{
+				// ReSharper disable once SwitchStatementMissingSomeCases
+				switch (message.Id)
+				{
+				case MessageId.ClientConnected:
+				{
+					ushort newClientId = messageReader.ReadUInt16();
+					byte nameLen = messageReader.ReadByte();
+					byte[] nameUtf8 = messageReader.ReadBytes(nameLen);
+					
+					m_clients.Add(new Client(newClientId, Encoding.UTF8.GetString(nameUtf8)));
+					break;
+				}
+				case MessageId.ClientDisconnected:
+				{
+					ushort clientId = messageReader.ReadUInt16();
+					int index = m_clients.FindIndex(client => client.ClientId == clientId);
+					if (index != -1)
 					{
-						CState = State.Rejected;
-						break;
+						m_clients[index].IsConnected = false;
+						m_clients.RemoveAt(index);
 					}
+					break;
+				}
+				case MessageId.StartGame:
+				{
+					int startChips = (int)messageReader.ReadUInt32();
+					BigBlind = (int)messageReader.ReadUInt32();
 					
-					m_selfClientId = messageReader.ReadUInt16();
+					InGame = true;
 					
-					ushort numOtherClients = messageReader.ReadUInt16();
-					m_clients = new List<Client>(numOtherClients + 1);
+					byte numClients = messageReader.ReadByte();
+					Contract.Assert(numClients == m_clients.Count);
 					
-					//Reads information about other clients
-					for (ushort i = 0; i < numOtherClients; i++)
+					m_turnOrderClients = new Client[numClients];
+					for (int i = 0; i < numClients; i++)
 					{
-						ushort clientId = messageReader.ReadUInt16();
-						byte nameLen = messageReader.ReadByte();
-						byte[] nameUtf8 = messageReader.ReadBytes(nameLen);
-						
-						m_clients.Add(new Client(clientId, Encoding.UTF8.GetString(nameUtf8)));
+						ushort id = messageReader.ReadUInt16();
+						m_turnOrderClients[i] = m_clients.Find(client => client.ClientId == id);
 					}
 					
-					m_clients.Add(new Client(SelfClientId, m_name));
+					GameDriver = new GameDriver(m_turnOrderClients.Select(client => client.ClientId), startChips, BigBlind);
+					GameDriver.OnStageChanged += GameStageChanged;
+					m_waitingForP1Encrypt = true;
+					m_waitingForNetwork = true;
 					
-					Console.WriteLine("Connected to server");
+					RaiseOnGameStart();
 					
-					CState = State.Connected;
-					OnStateChanged?.Invoke();
+					break;
 				}
-				else if (CState == State.Connected)
+				case MessageId.P1EncryptRequest:
 				{
-					// ReSharper disable once SwitchStatementMissingSomeCases
-					switch (message.Id)
-					{
-					case MessageId.ClientConnected:
-					{
-						ushort newClientId = messageReader.ReadUInt16();
-						byte nameLen = messageReader.ReadByte();
-						byte[] nameUtf8 = messageReader.ReadBytes(nameLen);
-						
-						m_clients.Add(new Client(newClientId, Encoding.UTF8.GetString(nameUtf8)));
-						break;
-					}
-					case MessageId.ClientDisconnected:
-					{
-						ushort clientId = messageReader.ReadUInt16();
-						int index = m_clients.FindIndex(client => client.ClientId == clientId);
-						if (index != -1)
-						{
-							m_clients[index].IsConnected = false;
-							m_clients.RemoveAt(index);
-						}
-						break;
-					}
-					case MessageId.StartGame:
-					{
-						int startChips = (int)messageReader.ReadUInt32();
-						BigBlind = (int)messageReader.ReadUInt32();
-						
-						InGame = true;
-						
-						byte numClients = messageReader.ReadByte();
-						Contract.Assert(numClients == m_clients.Count);
-						
-						m_turnOrderClients = new Client[numClients];
-						for (int i = 0; i < numClients; i++)
-						{
-							ushort id = messageReader.ReadUInt16();
-							m_turnOrderClients[i] = m_clients.Find(client => client.ClientId == id);
-						}
-						
-						GameDriver = new GameDriver(m_turnOrderClients.Select(client => client.ClientId), startChips, BigBlind);
-						GameDriver.OnStageChanged += GameStageChanged;
-						m_waitingForP1Encrypt = true;
-						m_waitingForNetwork = true;
-						
-						RaiseOnGameStart();
-						
+					if (!m_waitingForP1Encrypt)
 						break;
-					}
-					case MessageId.P1EncryptRequest:
-					{
-						if (!m_waitingForP1Encrypt)
-							break;
-						m_waitingForP1Encrypt = false;
-						m_waitingForP2Encrypt = true;
-						
-						HasDealtPocketCards = false;
-						CommunityCardsRevealed = 0;
-						
-						m_deckEncrypter = new DeckEncrypter();
-						
-						ulong[] cards = DeckEncrypter.ReadCardsFromMessage(message.Data, 0);
-						Utils.Shuffle(cards, m_random);
-						m_deckEncrypter.ApplyGlobal(cards);
-						
-						MemoryStream responseStream = new MemoryStream(sizeof(ulong) * 52);
-						BinaryWriter responseWriter = new BinaryWriter(responseStream);
-						foreach (ulong card in cards)
-							responseWriter.Write(card);
-						Send(new Message(MessageId.P1EncryptResponse, responseStream.GetBuffer()));
-						
+					m_waitingForP1Encrypt = false;
+					m_waitingForP2Encrypt = true;
+					
+					HasDealtPocketCards = false;
+					CommunityCardsRevealed = 0;
+					
+					m_deckEncrypter = new DeckEncrypter();
+					
+					ulong[] cards = DeckEncrypter.ReadCardsFromMessage(message.Data, 0);
+					Utils.Shuffle(cards, m_random);
+					m_deckEncrypter.ApplyGlobal(cards);
+					
+					MemoryStream responseStream = new MemoryStream(sizeof(ulong) * 52);
+					BinaryWriter responseWriter = new BinaryWriter(responseStream);
+					foreach (ulong card in cards)
+						responseWriter.Write(card);
+					Send(new Message(MessageId.P1EncryptResponse, responseStream.GetBuffer()));
+					
+					break;
+				}
+				case MessageId.P2EncryptRequest:
+				{
+					if (!m_waitingForP2Encrypt)
 						break;
-					}
-					case MessageId.P2EncryptRequest:
+					m_waitingForP2Encrypt = false;
+					
+					ulong[] cards = DeckEncrypter.ReadCardsFromMessage(message.Data, 0);
+					
+					m_deckEncrypter.ReplaceGlobalWithIndividual(cards);
+					
+					MemoryStream responseStream = new MemoryStream(sizeof(ulong) * 52);
+					BinaryWriter responseWriter = new BinaryWriter(responseStream);
+					foreach (ulong card in cards)
+						responseWriter.Write(card);
+					Send(new Message(MessageId.P2EncryptResponse, responseStream.GetBuffer()));
+					
+					break;
+				}
+				case MessageId.DealDecryptRequest:
+				{
+					if (m_encryptedDeck == null)
+						m_encryptedDeck = new ulong[52];
+					for (int i = 0; i < 52; i++)
+						m_encryptedDeck[i] = messageReader.ReadUInt64();
+					
+					int numClients = messageReader.ReadByte();
+					
+					MemoryStream responseStream = new MemoryStream();
+					BinaryWriter responseWriter = new BinaryWriter(responseStream);
+					
+					responseWriter.Write((byte)(numClients - 1));
+					
+					bool RangeOverlap(int min1, int len1, int min2, int len2)
 					{
-						if (!m_waitingForP2Encrypt)
-							break;
-						m_waitingForP2Encrypt = false;
-						
-						ulong[] cards = DeckEncrypter.ReadCardsFromMessage(message.Data, 0);
-						
-						m_deckEncrypter.RemoveGlobal(cards);
-						m_deckEncrypter.ApplyIndividual(cards);
-						
-						MemoryStream responseStream = new MemoryStream(sizeof(ulong) * 52);
-						BinaryWriter responseWriter = new BinaryWriter(responseStream);
-						foreach (ulong card in cards)
-							responseWriter.Write(card);
-						Send(new Message(MessageId.P2EncryptResponse, responseStream.GetBuffer()));
-						
-						break;
+						if (min2 > min1)
+							return min2 < min1 + len1;
+						if (min2 < min1)
+							return min2 + len2 > min1;
+						return true;
 					}
-					case MessageId.DealDecryptRequest:
+					
+					//Reads client card positions. The list maps client ids to their card positions.
+					List<Tuple<ushort, int>> clientCardPositions = new List<Tuple<ushort, int>>(numClients);
+					for (int i = 0; i < numClients; i++)
 					{
-						if (m_encryptedDeck == null)
-							m_encryptedDeck = new ulong[52];
-						for (int i = 0; i < 52; i++)
-							m_encryptedDeck[i] = messageReader.ReadUInt64();
-						
-						int numClients = messageReader.ReadByte();
-						
-						MemoryStream responseStream = new MemoryStream();
-						BinaryWriter responseWriter = new BinaryWriter(responseStream);
-						
-						responseWriter.Write((byte)(numClients - 1));
-						
-						bool RangeOverlap(int min1, int len1, int min2, int len2)
-						{
-							if (min2 > min1)
-								return min2 < min1 + len1;
-							if (min2 < min1)
-								return min2 + len2 > min1;
-							return true;
-						}
-						
-						//Reads client card positions. The list maps client ids to their card positions.
-						List<Tuple<ushort, int>> clientCardPositions = new List<Tuple<ushort, int>>(numClients);
-						for (int i = 0; i < numClients; i++)
-						{
-							ushort id = messageReader.ReadUInt16();
-							int cardPosition = messageReader.ReadByte();
-							
-							//Checks that the range doesn't overlap any previous range
-							if (clientCardPositions.Any(p => RangeOverlap(cardPosition, 2, p.Item2, 2)))
-							{
-								Log.Error("Client card position overlap!");
-								break;
-							}
-							
-							if (id == SelfClientId)
-							{
-								m_pocketCardsPosition = cardPosition;
-							}
-							else
-							{
-								responseWriter.Write(id);
-								for (int j = 0; j < 2; j++)
-								{
-									responseWriter.Write(m_deckEncrypter.GetIndividualInverseKey(cardPosition + j));
-								}
-							}
-							
-							((Client)GetClientById(id)).PocketCardsPosition = cardPosition;
-							
-							clientCardPositions.Add(new Tuple<ushort, int>(id, cardPosition));
-						}
+						ushort id = messageReader.ReadUInt16();
+						int cardPosition = messageReader.ReadByte();
 						
-						m_communityCardsDeckPosition = messageReader.ReadByte();
-						if (clientCardPositions.Any(p => RangeOverlap(m_communityCardsDeckPosition, 5, p.Item2, 2)))
+						//Checks that the range doesn't overlap any previous range
+						if (clientCardPositions.Any(p => RangeOverlap(cardPosition, 2, p.Item2, 2)))
 						{
 							Log.Error("Client card position overlap!");
 							break;
 						}
 						
-						Send(new Message(MessageId.DealDecryptResponse, responseStream.GetBuffer()));
-						
-						break;
-					}
-					case MessageId.DealDecryptInfo:
-					{
-						int numKeys = messageReader.ReadByte();
-						ulong[][] keys = { new ulong[numKeys + 1], new ulong[numKeys + 1] };
-						
-						for (int i = 0; i < numKeys; i++)
+						if (id == SelfClientId)
 						{
+							m_pocketCardsPosition = cardPosition;
+						}
+						else
+						{
+							responseWriter.Write(id);
 							for (int j = 0; j < 2; j++)
 							{
-								keys[j][i] = messageReader.ReadUInt64();
+								responseWriter.Write(m_deckEncrypter.GetIndividualInverseKey(cardPosition + j));
 							}
 						}
 						
-						keys[0][numKeys] = m_deckEncrypter.GetIndividualInverseKey(m_pocketCardsPosition + 0);
-						keys[1][numKeys] = m_deckEncrypter.GetIndividualInverseKey(m_pocketCardsPosition + 1);
-						
-						for (int i = 0; i < 2; i++)
-						{
-							ulong encryptedCard = m_encryptedDeck[m_pocketCardsPosition + i];
-							Card card = new Card((byte)DeckEncrypter.DecryptCard(encryptedCard, keys[i]));
-							PocketCards[i] = card;
-						}
-						
-						for (int i = 0; i < m_clients.Count; i++)
-							m_clients[i].RevealedPocketCards = null;
-						
-						RaiseDealEvent(PocketCards[0], PocketCards[1]);
-						
-						m_waitingForNetwork = false;
-						HasDealtPocketCards = true;
-						
-						StepFirstPlayerIndex();
-						GameDriver.StartHand(m_turnOrderClients[FirstPlayerIndex].ClientId);
-						
-						RaiseTurnChanged();
+						((Client)GetClientById(id)).PocketCardsPosition = cardPosition;
 						
+						clientCardPositions.Add(new Tuple<ushort, int>(id, cardPosition));
+					}
+					
+					m_communityCardsDeckPosition = messageReader.ReadByte();
+					if (clientCardPositions.Any(p => RangeOverlap(m_communityCardsDeckPosition, 5, p.Item2, 2)))
+					{
+						Log.Error("Client card position overlap!");
 						break;
 					}
-					case MessageId.EndTurn:
+					
+					Send(new Message(MessageId.DealDecryptResponse, responseStream.GetBuffer()));
+					
+					break;
+				}
+				case MessageId.DealDecryptInfo:
+				{
+					int numKeys = messageReader.ReadByte();
+					ulong[][] keys = { new ulong[numKeys + 1], new ulong[numKeys + 1] };
+					
+					for (int i = 0; i < numKeys; i++)
 					{
-						TurnEndAction action = (TurnEndAction)messageReader.ReadByte();
-						int raiseAmount = messageReader.ReadInt32();
-						
-						RaiseOnPlayerAction(GameDriver.CurrentPlayer.ClientId, action, raiseAmount);
-						
-						switch (action)
+						for (int j = 0; j < 2; j++)
 						{
-							case TurnEndAction.Fold:
-								GameDriver.Fold();
-								break;
-							case TurnEndAction.Call:
-								GameDriver.Call();
-								break;
-							case TurnEndAction.Raise:
-								GameDriver.Raise(raiseAmount);
-								break;
-							case TurnEndAction.AllIn:
-								GameDriver.AllIn();
-								break;
+							keys[j][i] = messageReader.ReadUInt64();
 						}
-						
-						if (!m_waitingForCommunityCards)
-							RaiseTurnChanged();
-						
-						break;
 					}
-					case MessageId.Flop:
+					
+					keys[0][numKeys] = m_deckEncrypter.GetIndividualInverseKey(m_pocketCardsPosition + 0);
+					keys[1][numKeys] = m_deckEncrypter.GetIndividualInverseKey(m_pocketCardsPosition + 1);
+					
+					for (int i = 0; i < 2; i++)
 					{
-						if (!m_waitingForCommunityCards)
-							break;
-						
-						DecryptCommunityCards(0, 3, messageReader);
-						RaiseFlopEvent(CommunityCards[0], CommunityCards[1], CommunityCards[2]);
-						RaiseTurnChanged();
-						
-						break;
+						ulong encryptedCard = m_encryptedDeck[m_pocketCardsPosition + i];
+						PocketCards[i] = DeckEncrypter.DecryptCard(encryptedCard, keys[i]);
 					}
-					case MessageId.Turn:
+					
+					for (int i = 0; i < m_clients.Count; i++)
+						m_clients[i].RevealedPocketCards = null;
+					
+					RaiseDealEvent(PocketCards[0], PocketCards[1]);
+					
+					m_waitingForNetwork = false;
+					HasDealtPocketCards = true;
+					
+					StepFirstPlayerIndex();
+					GameDriver.StartHand(m_turnOrderClients[FirstPlayerIndex].ClientId);
+					
+					RaiseTurnChanged();
+					
+					break;
+				}
+				case MessageId.EndTurn:
+				{
+					TurnEndAction action = (TurnEndAction)messageReader.ReadByte();
+					int raiseAmount = messageReader.ReadInt32();
+					
+					RaiseOnPlayerAction(GameDriver.CurrentPlayer.ClientId, action, raiseAmount);
+					
+					switch (action)
 					{
-						if (!m_waitingForCommunityCards)
+						case TurnEndAction.Fold:
+							GameDriver.Fold();
 							break;
-						
-						DecryptCommunityCards(3, 1, messageReader);
-						RaiseTurnEvent(CommunityCards[3]);
-						RaiseTurnChanged();
-						
-						break;
-					}
-					case MessageId.River:
-					{
-						if (!m_waitingForCommunityCards)
+						case TurnEndAction.Call:
+							GameDriver.Call();
 							break;
-						
-						DecryptCommunityCards(4, 1, messageReader);
-						RaiseTurnEvent(CommunityCards[4]);
-						RaiseTurnChanged();
-						
-						break;
-					}
-					case MessageId.AllInReveal:
-					{
-						if (!m_waitingForCommunityCards)
+						case TurnEndAction.Raise:
+							GameDriver.Raise(raiseAmount);
 							break;
-						
-						bool preFlop = CommunityCardsRevealed < 3;
-						bool preTurn = CommunityCardsRevealed < 4;
-						bool preRiver = CommunityCardsRevealed < 5;
-						
-						DecryptCommunityCards(CommunityCardsRevealed, 5 - CommunityCardsRevealed, messageReader);
-						
-						if (preFlop)
-							RaiseFlopEvent(CommunityCards[0], CommunityCards[1], CommunityCards[2]);
-						if (preTurn)
-							RaiseTurnEvent(CommunityCards[3]);
-						if (preRiver)
-							RaiseRiverEvent(CommunityCards[4]);
-						
+						case TurnEndAction.AllIn:
+							GameDriver.AllIn();
+							break;
+					}
+					
+					if (!m_waitingForCommunityCards)
 						RaiseTurnChanged();
-						
+					
+					break;
+				}
+				case MessageId.Flop:
+				{
+					if (!m_waitingForCommunityCards)
+						break;
+					
+					DecryptCommunityCards(0, 3, messageReader);
+					RaiseFlopEvent(CommunityCards[0], CommunityCards[1], CommunityCards[2]);
+					RaiseTurnChanged();
+					
+					break;
+				}
+				case MessageId.Turn:
+				{
+					if (!m_waitingForCommunityCards)
+						break;
+					
+					DecryptCommunityCards(3, 1, messageReader);
+					RaiseTurnEvent(CommunityCards[3]);
+					RaiseTurnChanged();
+					
+					break;
+				}
+				case MessageId.River:
+				{
+					if (!m_waitingForCommunityCards)
+						break;
+					
+					DecryptCommunityCards(4, 1, messageReader);
+					RaiseTurnEvent(CommunityCards[4]);
+					RaiseTurnChanged();
+					
+					break;
+				}
+				case MessageId.AllInReveal:
+				{
+					if (!m_waitingForCommunityCards)
 						break;
+					
+					bool preFlop = CommunityCardsRevealed < 3;
+					bool preTurn = CommunityCardsRevealed < 4;
+					bool preRiver = CommunityCardsRevealed < 5;
+					
+					DecryptCommunityCards(CommunityCardsRevealed, 5 - CommunityCardsRevealed, messageReader);
+					
+					if (preFlop)
+						RaiseFlopEvent(CommunityCards[0], CommunityCards[1], CommunityCards[2]);
+					if (preTurn)
+						RaiseTurnEvent(CommunityCards[3]);
+					if (preRiver)
+						RaiseRiverEvent(CommunityCards[4]);
+					
+					RaiseTurnChanged();
+					
+					break;
+				}
+				case MessageId.BeginShowdown:
+				{
+					if (!(GameDriver.Stage == HandStage.End || GameDriver.Stage == HandStage.River))
+						break;
+					
+					m_serverIndividualInvKey = new ulong[2];
+					m_serverIndividualInvKey[0] = messageReader.ReadUInt64();
+					m_serverIndividualInvKey[1] = messageReader.ReadUInt64();
+					
+					MemoryStream responseStream = new MemoryStream(sizeof(ulong) * 2);
+					BinaryWriter responseWriter = new BinaryWriter(responseStream);
+					
+					for (int i = 0; i < 2; i++)
+					{
+						responseWriter.Write(m_deckEncrypter.GetIndividualInverseKey(m_pocketCardsPosition + i));
 					}
-					case MessageId.BeginShowdown:
+					
+					Send(new Message(MessageId.ShowdownDecryptInfo, responseStream.GetBuffer()));
+					
+					break;
+				}
+				case MessageId.ShowdownEnd:
+				{
+					if (GameDriver.Stage != HandStage.End && GameDriver.Stage != HandStage.River)
+						break;
+					
+					uint numActiveClients = messageReader.ReadUInt32();
+					int numKeys = (int)messageReader.ReadUInt32();
+					
+					//Maps client ids to their set of decrypt keys
+					var decryptKeys = new Dictionary<ushort, ulong[]>();
+					
+					for (uint i = 0; i < numActiveClients; i++)
 					{
-						if (!(GameDriver.Stage == HandStage.End || GameDriver.Stage == HandStage.River))
-							break;
-						
-						m_serverIndividualInvKey = new ulong[2];
-						m_serverIndividualInvKey[0] = messageReader.ReadUInt64();
-						m_serverIndividualInvKey[1] = messageReader.ReadUInt64();
-						
-						MemoryStream responseStream = new MemoryStream(sizeof(ulong) * 2);
-						BinaryWriter responseWriter = new BinaryWriter(responseStream);
-						
-						for (int i = 0; i < 2; i++)
-						{
-							responseWriter.Write(m_deckEncrypter.GetIndividualInverseKey(m_pocketCardsPosition + i));
-						}
+						ushort clientId = messageReader.ReadUInt16();
 						
-						Send(new Message(MessageId.ShowdownDecryptInfo, responseStream.GetBuffer()));
+						var keys = new ulong[numKeys * 2];
+						for (int j = 0; j < keys.Length; j++)
+							keys[j] = messageReader.ReadUInt64();
 						
-						break;
+						decryptKeys.Add(clientId, keys);
 					}
-					case MessageId.ShowdownEnd:
+					
+					bool ok = true;
+					foreach (Client client in m_clients.Where(c => GameDriver.GetPlayer(c.ClientId).InGame))
 					{
-						if (GameDriver.Stage != HandStage.End && GameDriver.Stage != HandStage.River)
-							break;
-						
-						uint numActiveClients = messageReader.ReadUInt32();
-						int numKeys = (int)messageReader.ReadUInt32();
-						
-						//Maps client ids to their set of decrypt keys
-						var decryptKeys = new Dictionary<ushort, ulong[]>();
-						
-						for (uint i = 0; i < numActiveClients; i++)
+						if (!decryptKeys.TryGetValue(client.ClientId, out ulong[] keys))
 						{
-							ushort clientId = messageReader.ReadUInt16();
-							
-							var keys = new ulong[numKeys * 2];
-							for (int j = 0; j < keys.Length; j++)
-								keys[j] = messageReader.ReadUInt64();
-							
-							decryptKeys.Add(clientId, keys);
+							Log.Error("Server didn't send decrypt keys for active client '" + client.ClientId + "'.");
+							ok = false;
+							break;
 						}
 						
-						bool ok = true;
-						foreach (Client client in m_clients.Where(c => GameDriver.GetPlayer(c.ClientId).InGame))
+						client.RevealedPocketCards = new Card[2];
+						for (int k = 0; k < 2; k++)
 						{
-							if (!decryptKeys.TryGetValue(client.ClientId, out ulong[] keys))
+							int deckPos = client.PocketCardsPosition + k;
+							
+							ulong[] cardKeys = keys.Skip(k * numKeys).Take(numKeys).ToArray();
+							if (!cardKeys.Contains(m_deckEncrypter.GetIndividualInverseKey(deckPos)))
 							{
-								Log.Error("Server didn't send decrypt keys for active client '" + client.ClientId + "'.");
+								Log.Error("Pocket card inverse key mismatch, own key not present.");
 								ok = false;
 								break;
 							}
 							
-							client.RevealedPocketCards = new Card[2];
-							for (int k = 0; k < 2; k++)
+							//ClientId == 0 means that this client is the host
+							if (client.ClientId == 0 && !cardKeys.Contains(m_serverIndividualInvKey[k]))
 							{
-								int deckPos = client.PocketCardsPosition + k;
-								
-								ulong[] cardKeys = keys.Skip(k * numKeys).Take(numKeys).ToArray();
-								if (!cardKeys.Contains(m_deckEncrypter.GetIndividualInverseKey(deckPos)))
-								{
-									Log.Error("Pocket card inverse key mismatch, own key not present.");
-									ok = false;
-									break;
-								}
-								
-								//ClientId == 0 means that this client is the host
-								if (client.ClientId == 0 && !cardKeys.Contains(m_serverIndividualInvKey[k]))
-								{
-									Log.Error("Pocket card inverse key mismatch, server's key not present.");
-									ok = false;
-									break;
-								}
-								
-								ulong encryptedCard = m_encryptedDeck[deckPos];
-								ulong decryptedCard = DeckEncrypter.DecryptCard(encryptedCard, cardKeys);
-								client.RevealedPocketCards[k] = new Card((byte)decryptedCard);
+								Log.Error("Pocket card inverse key mismatch, server's key not present.");
+								ok = false;
+								break;
 							}
 							
-							if (!ok)
-								break;
-						}
-						
-						if (ok)
-						{
-							//TODO: Victory logic & maybe raise event
+							ulong encryptedCard = m_encryptedDeck[deckPos];
+							client.RevealedPocketCards[k] = DeckEncrypter.DecryptCard(encryptedCard, cardKeys);
 						}
 						
-						break;
+						if (!ok)
+							break;
 					}
+					
+					if (ok)
+					{
+						//TODO: Victory logic & maybe raise event
 					}
+					
+					break;
+				}
 				}
 			}
 			
-			m_socket.Close();
+			return true;
 		}
 	}
 }
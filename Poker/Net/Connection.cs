@@ -58,6 +58,12 @@ namespace Poker.Net
 		
 		public abstract void NextHand();
 		
+		//Copies the state of the table, which may be changed by network threads while it is read.
+		public virtual void CaptureTable(ref TableSnapshot table)
+		{
+			table.Capture(this);
+		}
+		
 		protected void StepFirstPlayerIndex()
 		{
 			do
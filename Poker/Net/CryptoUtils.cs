@@ -1,31 +1,63 @@
-﻿namespace Poker.Net
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace Poker.Net
 {
 	public static class CryptoUtils
 	{
+		[DllImport("Native")]
+		private static extern ulong DC_ExpMod(ulong value, ulong exponent, ulong prime);
+		[DllImport("Native")]
+		private static extern void DC_ExpMod52(ulong[] cards, ulong[] keys, uint numKeys, ulong prime);
+		[DllImport("Native")]
+		private static extern ulong DC_DecryptCard(ulong card, ulong[] keys, uint numKeys, ulong prime);
+		[DllImport("Native")]
+		private static extern void DC_ReplaceGlobalKey(ulong[] cards, ulong globalInverseKey, ulong[] individualKeys,
+		                                               ulong prime);
+		[DllImport("Native")]
+		private static extern ulong DC_InverseMod(ulong value, ulong modulus);
+		[DllImport("Native")]
+		private static extern void DC_GenerateKeys(ulong[] randomWords, uint numKeys, ulong prime, ulong[] keys,
+		                                           ulong[] inverseKeys);
+		
+		//Modular exponentiation is done natively with Montgomery multiplication, which works for any odd 64 bit
+		// modulus without overflowing.
 		public static ulong ExpMod(ulong x, ulong e, ulong mod)
 		{
-			if (e == 1)
-				return x % mod;
-			
-			ulong val = ExpMod(x, e / 2, mod);
-			val = val * val % mod;
-			
-			if (e % 2 == 1)
-				val = val * (x % mod) % mod;
-			
-			return val;
+			return DC_ExpMod(x, e, mod);
+		}
+		
+		//Raises each of the 52 cards to the power of its key, in place. keys holds one key for all cards or one per card.
+		public static void ExpMod52(ulong[] cards, ulong[] keys, ulong mod)
+		{
+			DC_ExpMod52(cards, keys, (uint)keys.Length, mod);
+		}
+		
+		//Raises each of the 52 cards to globalInvKey and then its individual key, in a single exponentiation per card.
+		public static void ReplaceGlobalKey(ulong[] cards, ulong globalInvKey, ulong[] individualKeys, ulong mod)
+		{
+			DC_ReplaceGlobalKey(cards, globalInvKey, individualKeys, mod);
 		}
 		
+		//Raises the value to the power of each key in turn.
+		public static ulong ExpModChain(ulong x, ulong[] keys, ulong mod)
+		{
+			return DC_DecryptCard(x, keys, (uint)keys.Length, mod);
+		}
+		
+		//Returns 0 if a has no inverse.
 		public static ulong MInverse(ulong a, ulong mod)
 		{
-			//TODO: Change to faster algorithm
-			
-			for (ulong i = 1; i < mod - 1; i++)
-			{
-				if ((a * i) % mod == 1)
-					return i;
-			}
-			return 0;
+			return DC_InverseMod(a, mod);
+		}
+		
+		//Fills keys with exponents invertible modulo prime - 1, one picked from each random word, and invKeys with
+		// their inverses.
+		public static void GenerateKeys(ulong[] randomWords, ulong[] keys, ulong[] invKeys, ulong prime)
+		{
+			if (keys.Length != randomWords.Length || invKeys.Length != randomWords.Length)
+				throw new ArgumentException("Need one random word per key.");
+			DC_GenerateKeys(randomWords, (uint)keys.Length, prime, keys, invKeys);
 		}
 	}
 }
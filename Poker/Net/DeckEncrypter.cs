@@ -8,38 +8,36 @@ namespace Poker.Net
 {
 	public class DeckEncrypter
 	{
-		private readonly ulong m_globalKey;
-		private readonly ulong m_globalInvKey;
+		//Single element arrays, as passed to the native batch exponentiation.
+		private readonly ulong[] m_globalKey = new ulong[1];
+		private readonly ulong[] m_globalInvKey = new ulong[1];
 		
 		private readonly ulong[] m_individualKeys = new ulong[52];
 		private readonly ulong[] m_individualInvKeys = new ulong[52];
 		
-		private const ulong PRIME = 66797;//4294967291;
+		//The largest safe prime below 2^64. Since (PRIME - 1) / 2 is prime as well, encrypted cards leak no more than
+		// their quadratic residuosity, which is the same for every card as they are encoded as squares.
+		private const ulong PRIME = 18446744073709550147;
 		
-		private static void GenerateKey(RNGCryptoServiceProvider rng, out ulong key, out ulong invKey)
+		private const int MIN_CARD_ROOT = 2;
+		
+		private static void GenerateKeys(RNGCryptoServiceProvider rng, ulong[] keys, ulong[] invKeys)
 		{
-			byte[] buffer = new byte[sizeof(ulong)];
+			byte[] buffer = new byte[keys.Length * sizeof(ulong)];
 			rng.GetBytes(buffer);
 			
-			key = BitConverter.ToUInt64(buffer, 0) % (PRIME - 3);
-			invKey = 0;
+			ulong[] randomWords = new ulong[keys.Length];
+			Buffer.BlockCopy(buffer, 0, randomWords, 0, buffer.Length);
 			
-			while (invKey == 0)
-			{
-				key++;
-				invKey = CryptoUtils.MInverse(key, PRIME - 1);
-			}
+			CryptoUtils.GenerateKeys(randomWords, keys, invKeys, PRIME);
 		}
 		
 		public DeckEncrypter()
 		{
-			RNGCryptoServiceProvider rng = new RNGCryptoServiceProvider();
-			
-			GenerateKey(rng, out m_globalKey, out m_globalInvKey);
-			
-			for (int i = 0; i < 52; i++)
+			using (RNGCryptoServiceProvider rng = new RNGCryptoServiceProvider())
 			{
-				GenerateKey(rng, out m_individualKeys[i], out m_individualInvKeys[i]);
+				GenerateKeys(rng, m_globalKey, m_globalInvKey);
+				GenerateKeys(rng, m_individualKeys, m_individualInvKeys);
 			}
 		}
 		
@@ -54,9 +52,25 @@ namespace Poker.Net
 			return cards;
 		}
 		
-		public static ulong DecryptCard(ulong card, IEnumerable<ulong> decryptKeys)
+		//Card ids are not encrypted as they are, since 0 and 1 would be left unchanged by every key. Card i is encoded as
+		// (i + 2)^2 instead, a quadratic residue other than 1, which keys can only map to other quadratic residues.
+		public static ulong EncodeCard(int cardId)
 		{
-			return decryptKeys.Aggregate(card, (current, key) => CryptoUtils.ExpMod(current, key, PRIME));
+			ulong root = (ulong)(cardId + MIN_CARD_ROOT);
+			return root * root;
+		}
+		
+		public static Card DecryptCard(ulong card, IEnumerable<ulong> decryptKeys)
+		{
+			ulong value = CryptoUtils.ExpModChain(card, decryptKeys as ulong[] ?? decryptKeys.ToArray(), PRIME);
+			
+			ulong root = (ulong)Math.Round(Math.Sqrt(value));
+			if (root < MIN_CARD_ROOT || root >= MIN_CARD_ROOT + 52 || root * root != value)
+			{
+				Log.Error("Decrypted value " + value + " is not a card, a decryption key is wrong.");
+				return new Card(0);
+			}
+			return new Card((byte)(root - MIN_CARD_ROOT));
 		}
 		
 		public ulong GetIndividualInverseKey(int index)
@@ -66,20 +80,23 @@ namespace Poker.Net
 		
 		public void ApplyGlobal(ulong[] cards)
 		{
-			for (int i = 0; i < cards.Length; i++)
-				cards[i] = CryptoUtils.ExpMod(cards[i], m_globalKey, PRIME);
+			CryptoUtils.ExpMod52(cards, m_globalKey, PRIME);
 		}
 		
 		public void RemoveGlobal(ulong[] cards)
 		{
-			for (int i = 0; i < cards.Length; i++)
-				cards[i] = CryptoUtils.ExpMod(cards[i], m_globalInvKey, PRIME);
+			CryptoUtils.ExpMod52(cards, m_globalInvKey, PRIME);
 		}
 		
 		public void ApplyIndividual(ulong[] cards)
 		{
-			for (int i = 0; i < cards.Length; i++)
-				cards[i] = CryptoUtils.ExpMod(cards[i], m_individualKeys[i], PRIME);
+			CryptoUtils.ExpMod52(cards, m_individualKeys, PRIME);
+		}
+		
+		//Same as RemoveGlobal followed by ApplyIndividual, at the cost of one of them.
+		public void ReplaceGlobalWithIndividual(ulong[] cards)
+		{
+			CryptoUtils.ReplaceGlobalKey(cards, m_globalInvKey[0], m_individualKeys, PRIME);
 		}
 	}
 }
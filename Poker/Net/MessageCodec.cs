@@ -0,0 +1,48 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace Poker.Net
+{
+	//A range of the packet headers or the message data, see MessageCodec.h.
+	[StructLayout(LayoutKind.Sequential, Pack = 1)]
+	internal struct FrameSlice
+	{
+		public const uint HEADERS = 0;
+		
+		public uint Source;
+		public uint Offset;
+		public uint Size;
+	}
+	
+	internal enum DecodeResult : uint
+	{
+		NeedMore = 0,
+		Message = 1,
+		TooLarge = 2
+	}
+	
+	internal static class MessageCodecNative
+	{
+		[DllImport("Native")]
+		public static extern uint MC_GetNumPackets(uint dataSize);
+		[DllImport("Native")]
+		public static extern uint MC_GetFrameHeadersSize(uint numPackets);
+		[DllImport("Native")]
+		public static extern uint MC_GetReceiveRingSize();
+		[DllImport("Native")]
+		public static extern uint MC_EncodeFrames(ushort id, uint dataSize, byte[] headers, [Out] FrameSlice[] slices);
+		
+		[DllImport("Native")]
+		public static extern IntPtr MC_CreateDecoder(IntPtr ring, uint capacity);
+		[DllImport("Native")]
+		public static extern void MC_DestroyDecoder(IntPtr decoder);
+		[DllImport("Native")]
+		public static extern uint MC_GetReceiveSpace(IntPtr decoder, out uint offset);
+		[DllImport("Native")]
+		public static extern void MC_CommitReceived(IntPtr decoder, uint size);
+		[DllImport("Native")]
+		public static extern DecodeResult MC_NextMessage(IntPtr decoder, out ushort id, out uint size);
+		[DllImport("Native")]
+		public static extern void MC_TakeMessage(IntPtr decoder, byte[] data);
+	}
+}
@@ -1,37 +1,81 @@
 ﻿using System;
 using System.Net.Sockets;
+using System.Runtime.InteropServices;
 
 namespace Poker.Net
 {
-	public class Receiver
+	public class Receiver : IDisposable
 	{
-		private readonly byte[] m_buffer = new byte[Protocol.BUFFER_SIZE];
+		//Shared with the native server. A message larger than this on the wire ends the connection, as the stream can not
+		// be followed past it.
+		private static readonly uint RING_SIZE = MessageCodecNative.MC_GetReceiveRingSize();
+		
+		//Bytes are received straight into the ring, where the native decoder reassembles messages.
+		private readonly byte[] m_ring = new byte[RING_SIZE];
+		private GCHandle m_ringHandle;
+		private readonly IntPtr m_decoder;
+		private bool m_disposed;
 		
 		public enum WaitResult
 		{
 			Received,
 			ShouldStop,
-			SocketClosed
+			SocketClosed,
+			MessageTooLarge
 		}
 		
 		public bool ShouldStop { get; set; }
 		
-		public WaitResult WaitForMessage(Socket socket, out Message message)
+		public Receiver()
+		{
+			m_ringHandle = GCHandle.Alloc(m_ring, GCHandleType.Pinned);
+			m_decoder = MessageCodecNative.MC_CreateDecoder(m_ringHandle.AddrOfPinnedObject(), RING_SIZE);
+		}
+		
+		~Receiver()
+		{
+			Destroy();
+		}
+		
+		public void Dispose()
+		{
+			Destroy();
+			GC.SuppressFinalize(this);
+		}
+		
+		private void Destroy()
 		{
-			MessageId pendingMessageId = default(MessageId);
-			byte[] pendingMessageData = null;
-			int pendingDataReceived = 0;
+			if (m_disposed)
+				return;
+			m_disposed = true;
 			
+			MessageCodecNative.MC_DestroyDecoder(m_decoder);
+			m_ringHandle.Free();
+		}
+		
+		public WaitResult WaitForMessage(Socket socket, out Message message)
+		{
 			message.Data = null;
 			message.Id = default(MessageId);
 			
-			while (true)
+			ushort id;
+			uint size;
+			DecodeResult result;
+			while ((result = MessageCodecNative.MC_NextMessage(m_decoder, out id, out size)) != DecodeResult.Message)
 			{
+				if (result == DecodeResult.TooLarge)
+				{
+					Console.WriteLine("Received a message larger than " + RING_SIZE + " bytes, disconnecting");
+					return WaitResult.MessageTooLarge;
+				}
+				
+				uint receiveSize = MessageCodecNative.MC_GetReceiveSpace(m_decoder, out uint receiveOffset);
+				
 				int bytesReceived;
 				
 				try
 				{
-					bytesReceived = socket.Receive(m_buffer);
+					bytesReceived = socket.Receive(m_ring, (int)receiveOffset, (int)receiveSize, SocketFlags.None);
 				}
 				catch (SocketException ex)
 				{
@@ -54,69 +98,16 @@ namespace Poker.Net
 				
 				if (bytesReceived == 0)
 					return WaitResult.SocketClosed;
-				if (bytesReceived < 4)
-					continue;
-				
-				ushort magic = BitConverter.ToUInt16(m_buffer, 0);
-				if (magic != Protocol.MAGIC)
-					continue;
-				
-				MessageId id = (MessageId)BitConverter.ToUInt16(m_buffer, 2);
 				
-				if (pendingMessageData == null)
-				{
-					//We have not received anything yet, so this should be an initial packet.
-					if (id == MessageId.Continuation || bytesReceived < 8)
-						continue;
-					
-					//Reads the remander of the initial packet header
-					pendingMessageId = id;
-					ushort packetCount = BitConverter.ToUInt16(m_buffer, 4);
-					ushort lastPacketData = BitConverter.ToUInt16(m_buffer, 6);
-					
-					int firstPacketBytes = packetCount == 1 ? lastPacketData : Protocol.MAX_DATA_INITIAL_PACKET;
-					
-					//If we didn't receive enough data, drop the packet
-					if (bytesReceived < firstPacketBytes + 8)
-						continue;
-					
-					int dataBytes = Math.Max(packetCount - 2, 0) * Protocol.MAX_DATA_CONTINUATION_PACKET + lastPacketData;
-					if (packetCount > 1)
-						dataBytes += Protocol.MAX_DATA_INITIAL_PACKET;
-					
-					pendingMessageData = new byte[dataBytes];
-					Array.Copy(m_buffer, 8, pendingMessageData, 0, firstPacketBytes);
-					
-					if (packetCount == 1)
-						break;
-					
-					pendingDataReceived = Protocol.MAX_DATA_INITIAL_PACKET;
-				}
-				else
-				{
-					if (id != MessageId.Continuation)
-						continue;
-					
-					int expectedDataBytes = Math.Min(pendingMessageData.Length - pendingDataReceived,
-					                                 Protocol.MAX_DATA_CONTINUATION_PACKET);
-					if (bytesReceived < expectedDataBytes + 4)
-					{
-						pendingMessageData = null;
-						continue;
-					}
-					
-					Array.Copy(m_buffer, 4, pendingMessageData, pendingDataReceived, expectedDataBytes);
-					pendingDataReceived += expectedDataBytes;
-					
-					if (pendingDataReceived >= pendingMessageData.Length)
-						break;
-				}
+				MessageCodecNative.MC_CommitReceived(m_decoder, (uint)bytesReceived);
 			}
 			
-			Console.WriteLine("Got message " + pendingMessageId);
+			message.Id = (MessageId)id;
+			message.Data = new byte[size];
+			MessageCodecNative.MC_TakeMessage(m_decoder, message.Data);
+			
+			Console.WriteLine("Got message " + message.Id);
 			
-			message.Data = pendingMessageData;
-			message.Id = pendingMessageId;
 			return WaitResult.Received;
 		}
 	}
@@ -1,69 +1,43 @@
 ﻿using System;
-using System.IO;
+using System.Collections.Generic;
 using System.Net.Sockets;
 
 namespace Poker.Net
 {
 	public class Sender
 	{
-		private readonly byte[] m_buffer = new byte[Protocol.BUFFER_SIZE];
-		
-		public Sender()
-		{
-			//Initializes the first two bytes of the buffer to the protocol magic
-			byte[] magicBytes = BitConverter.GetBytes(Protocol.MAGIC);
-			Array.Copy(magicBytes, m_buffer, magicBytes.Length);
-		}
+		private byte[] m_headers = new byte[0];
+		private FrameSlice[] m_slices = new FrameSlice[0];
+		private readonly List<ArraySegment<byte>> m_segments = new List<ArraySegment<byte>>();
 		
 		public void Send(Socket socket, Message message)
 		{
 			if (message.Data.Length == 0)
 				throw new InvalidOperationException("Attempted to send empty message.");
 			
-			//Calculates how many packets will be needed
-			int packetCount = 1;
-			int lastPacketSize = message.Data.Length;
-			if (lastPacketSize > Protocol.MAX_DATA_INITIAL_PACKET)
-			{
-				packetCount++;
-				lastPacketSize -= Protocol.MAX_DATA_INITIAL_PACKET;
-				
-				packetCount += (ushort)(lastPacketSize / Protocol.MAX_DATA_CONTINUATION_PACKET);
-				lastPacketSize %= Protocol.MAX_DATA_CONTINUATION_PACKET;
-				
-				if (lastPacketSize == 0)
-					lastPacketSize = Protocol.MAX_DATA_CONTINUATION_PACKET;
-				else
-					packetCount++;
-			}
+			uint numPackets = MessageCodecNative.MC_GetNumPackets((uint)message.Data.Length);
+			if (numPackets == 0)
+				throw new InvalidOperationException("Attempted to send message too large for the protocol.");
 			
-			//Writes the first packet's header
-			using (BinaryWriter headerWriter = new BinaryWriter(new MemoryStream(m_buffer, 2, 6)))
+			if (m_slices.Length < numPackets * 2)
 			{
-				headerWriter.Write((ushort)message.Id);
-				headerWriter.Write((ushort)packetCount);
-				headerWriter.Write((ushort)lastPacketSize);
+				m_slices = new FrameSlice[numPackets * 2];
+				m_headers = new byte[MessageCodecNative.MC_GetFrameHeadersSize(numPackets)];
 			}
 			
-			//Copies message data to the first packet
-			int firstPacketDataSize = Math.Min(Protocol.MAX_DATA_INITIAL_PACKET, message.Data.Length);
-			Array.Copy(message.Data, 0, m_buffer, 8, firstPacketDataSize);
-			
-			//Sends the first packet
-			socket.Send(m_buffer, 0, firstPacketDataSize + 8, SocketFlags.None);
+			//The packets are sent straight from the header buffer and the message data in a single gathering send
+			uint numSlices = MessageCodecNative.MC_EncodeFrames((ushort)message.Id, (uint)message.Data.Length,
+			                                                    m_headers, m_slices);
 			
-			//Sends continuation packets
-			m_buffer[2] = m_buffer[3] = 0;
-			for (int i = 0; i < packetCount - 1; i++)
+			m_segments.Clear();
+			for (int i = 0; i < numSlices; i++)
 			{
-				int offset = Protocol.MAX_DATA_INITIAL_PACKET + Protocol.MAX_DATA_CONTINUATION_PACKET * i;
-				int dataSize = Math.Min(message.Data.Length - offset, Protocol.MAX_DATA_CONTINUATION_PACKET);
-				
-				Array.Copy(message.Data, offset, m_buffer, 4, dataSize);
-				
-				socket.Send(m_buffer, 0, dataSize + 4, SocketFlags.None);
+				byte[] source = m_slices[i].Source == FrameSlice.HEADERS ? m_headers : message.Data;
+				m_segments.Add(new ArraySegment<byte>(source, (int)m_slices[i].Offset, (int)m_slices[i].Size));
 			}
 			
+			socket.Send(m_segments);
+			
 			Log.Write("Sent message " + message.Id + " to " + socket.RemoteEndPoint);
 		}
 	}
@@ -0,0 +1,120 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace Poker.Net.Server
+{
+	public enum NetEventType : uint
+	{
+		Connected,
+		Message,
+		Disconnected
+	}
+	
+	public struct NetEvent
+	{
+		public NetEventType Type;
+		public uint Connection;
+		
+		//Only set for message events.
+		public Message Message;
+	}
+	
+	//Multiplexes many connections over a few native epoll worker threads, so one process can host many tables.
+	// Only available on Linux. Events must be polled from a single thread, while Send may be called from any.
+	public class NetServerCore : IDisposable
+	{
+		[StructLayout(LayoutKind.Sequential, Pack = 1)]
+		private struct NetEventInfo
+		{
+			public NetEventType Type;
+			public uint Connection;
+			public uint MessageId;
+			public uint Size;
+		}
+		
+		[DllImport("Native")]
+		private static extern IntPtr NS_Create(ushort port, uint numWorkers);
+		[DllImport("Native")]
+		private static extern void NS_Destroy(IntPtr server);
+		[DllImport("Native")]
+		[return: MarshalAs(UnmanagedType.I1)]
+		private static extern bool NS_Send(IntPtr server, uint connection, ushort messageId, byte[] data, uint size);
+		[DllImport("Native")]
+		private static extern void NS_Close(IntPtr server, uint connection);
+		[DllImport("Native")]
+		[return: MarshalAs(UnmanagedType.I1)]
+		private static extern bool NS_WaitForEvent(IntPtr server, uint timeoutMS);
+		[DllImport("Native")]
+		[return: MarshalAs(UnmanagedType.I1)]
+		private static extern bool NS_Poll(IntPtr server, out NetEventInfo info);
+		[DllImport("Native")]
+		private static extern void NS_GetEventData(IntPtr server, byte[] data);
+		[DllImport("Native")]
+		private static extern uint NS_GetNumConnections(IntPtr server);
+		
+		private readonly IntPtr m_handle;
+		
+		private NetServerCore(IntPtr handle)
+		{
+			m_handle = handle;
+		}
+		
+		//Returns null if the port could not be listened on, or on platforms without epoll.
+		public static NetServerCore TryCreate(int port, int numWorkers)
+		{
+			IntPtr handle = NS_Create((ushort)port, (uint)numWorkers);
+			return handle == IntPtr.Zero ? null : new NetServerCore(handle);
+		}
+		
+		~NetServerCore()
+		{
+			NS_Destroy(m_handle);
+		}
+		
+		public void Dispose()
+		{
+			NS_Destroy(m_handle);
+			GC.SuppressFinalize(this);
+		}
+		
+		public int NumConnections
+		{
+			get { return (int)NS_GetNumConnections(m_handle); }
+		}
+		
+		//Blocks until an event can be polled or the timeout passes. Returns false on timeout.
+		public bool WaitForEvent(int timeoutMS)
+		{
+			return NS_WaitForEvent(m_handle, (uint)timeoutMS);
+		}
+		
+		public bool TryPoll(out NetEvent netEvent)
+		{
+			netEvent = default(NetEvent);
+			if (!NS_Poll(m_handle, out NetEventInfo info))
+				return false;
+			
+			netEvent.Type = info.Type;
+			netEvent.Connection = info.Connection;
+			if (info.Type == NetEventType.Message)
+			{
+				byte[] data = new byte[info.Size];
+				NS_GetEventData(m_handle, data);
+				netEvent.Message = new Message((MessageId)info.MessageId, data);
+			}
+			return true;
+		}
+		
+		//Returns false if the connection is gone, or if the client has fallen so far behind that it is disconnected.
+		public bool Send(uint connection, Message message)
+		{
+			return NS_Send(m_handle, connection, (ushort)message.Id, message.Data, (uint)message.Data.Length);
+		}
+		
+		//A disconnected event follows once the connection has been closed.
+		public void Close(uint connection)
+		{
+			NS_Close(m_handle, connection);
+		}
+	}
+}
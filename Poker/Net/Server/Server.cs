@@ -4,6 +4,7 @@ using System.IO;
 using System.Linq;
 using System.Net;
 using System.Net.Sockets;
+using System.Threading;
 
 namespace Poker.Net.Server
 {
@@ -22,8 +23,16 @@ namespace Poker.Net.Server
 			ShowdownDecryptInfo
 		};
 		
+		//Connections are accepted by the native core where it is available, and by the listening socket otherwise.
+		private readonly NetServerCore m_core;
+		private readonly Thread m_coreThread;
+		private readonly Dictionary<uint, RemoteClient> m_coreClients = new Dictionary<uint, RemoteClient>();
 		private readonly Socket m_socket;
 		
+		//A table needs no more than one worker.
+		private const int CORE_WORKERS = 1;
+		private const int CORE_POLL_TIMEOUT_MS = 500;
+		
 		private readonly List<RemoteClient> m_clients = new List<RemoteClient>();
 		
 		private readonly SelfClient m_selfClient;
@@ -96,6 +105,16 @@ namespace Poker.Net.Server
 			BigBlind = 2;
 			
 			m_selfClient = new SelfClient(nickname);
+			
+			m_core = NetServerCore.TryCreate(Protocol.SERVER_PORT, CORE_WORKERS);
+			if (m_core != null)
+			{
+				m_coreThread = new Thread(CoreThreadTarget);
+				m_coreThread.IsBackground = true;
+				m_coreThread.Start();
+				return;
+			}
+			
 			m_socket = new Socket(AddressFamily.InterNetwork, SocketType.Stream, ProtocolType.Tcp);
 			m_socket.SetSocketOption(SocketOptionLevel.Socket, SocketOptionName.ReuseAddress, true);
 			
@@ -113,6 +132,40 @@ namespace Poker.Net.Server
 			m_socket.BeginAccept(AcceptCallback, null);
 		}
 		
+		//Handles the events of every connection on one thread, in the order they arrived.
+		private void CoreThreadTarget()
+		{
+			while (!m_closed)
+			{
+				if (!m_core.TryPoll(out NetEvent netEvent))
+				{
+					m_core.WaitForEvent(CORE_POLL_TIMEOUT_MS);
+					continue;
+				}
+				
+				RemoteClient client;
+				switch (netEvent.Type)
+				{
+				case NetEventType.Connected:
+					client = new RemoteClient(this, m_core, netEvent.Connection, m_nextClientId++);
+					m_coreClients.Add(netEvent.Connection, client);
+					m_clients.Add(client);
+					break;
+				case NetEventType.Message:
+					if (m_coreClients.TryGetValue(netEvent.Connection, out client))
+						client.HandleMessage(netEvent.Message);
+					break;
+				case NetEventType.Disconnected:
+					if (m_coreClients.TryGetValue(netEvent.Connection, out client))
+					{
+						m_coreClients.Remove(netEvent.Connection);
+						client.HandleDisconnected();
+					}
+					break;
+				}
+			}
+		}
+		
 		public void SendToAll(Message message)
 		{
 			foreach (RemoteClient client in RemoteClients)
@@ -174,6 +227,14 @@ namespace Poker.Net.Server
 			TurnEnded(TurnEndAction.AllIn, 0);
 		}
 		
+		public override void CaptureTable(ref TableSnapshot table)
+		{
+			lock (m_mutex)
+			{
+				base.CaptureTable(ref table);
+			}
+		}
+		
 		private void TurnEnded(TurnEndAction action, int raiseAmount)
 		{
 			RaiseOnPlayerAction(GameDriver.CurrentPlayer.ClientId, action, raiseAmount);
@@ -277,8 +338,8 @@ namespace Poker.Net.Server
 					for (int k = 0; k < 2; k++)
 					{
 						ulong encryptedCard = m_encryptedDeck[activeClients[i].PocketCardsPosition + k];
-						ulong card = DeckEncrypter.DecryptCard(encryptedCard, activeClients[i].PocketCardDecryptKeys[k]);
-						activeClients[i].RevealedPocketCards[k] = new Card((byte)card);
+						activeClients[i].RevealedPocketCards[k] =
+							DeckEncrypter.DecryptCard(encryptedCard, activeClients[i].PocketCardDecryptKeys[k]);
 					}
 				}
 				
@@ -394,8 +455,8 @@ namespace Poker.Net.Server
 					messageWriter.Write(key);
 				
 				ulong encryptedCard = m_encryptedDeck[deckPosition + i];
-				ulong cardId = DeckEncrypter.DecryptCard(encryptedCard, m_communityCardDecryptKeys[i]);
-				CommunityCards[firstCommunityCardIndex + i] = new Card((byte)cardId);
+				CommunityCards[firstCommunityCardIndex + i] =
+					DeckEncrypter.DecryptCard(encryptedCard, m_communityCardDecryptKeys[i]);
 			}
 			
 			CommunityCardsRevealed += m_communityCardDecryptKeys.Length;
@@ -566,7 +627,7 @@ namespace Poker.Net.Server
 			//Generates an initial encrypted card deck and shuffles it
 			ulong[] cards = new ulong[52];
 			for (int i = 0; i < cards.Length; i++)
-				cards[i] = (ulong)i;
+				cards[i] = DeckEncrypter.EncodeCard(i);
 			m_deckEncrypter.ApplyGlobal(cards);
 			Utils.Shuffle(cards, m_rand);
 			
@@ -612,8 +673,7 @@ namespace Poker.Net.Server
 					m_encryptionClientIndex = 0;
 					m_pendingNetOperation = PendingNetOperation.DealEncryptP2;
 					
-					m_deckEncrypter.RemoveGlobal(cards);
-					m_deckEncrypter.ApplyIndividual(cards);
+					m_deckEncrypter.ReplaceGlobalWithIndividual(cards);
 					
 					SendEncryptRequest(m_clients[m_encryptionClientIndex], cards);
 				}
@@ -736,10 +796,7 @@ namespace Poker.Net.Server
 				for (int i = 0; i < 2; i++)
 				{
 					ulong encryptedCard = m_encryptedDeck[m_selfClient.PocketCardsPosition + i];
-					ulong cardId = DeckEncrypter.DecryptCard(encryptedCard, m_selfClient.PocketCardDecryptKeys[i]);
-					
-					Card card = new Card((byte)cardId);
-					PocketCards[i] = card;
+					PocketCards[i] = DeckEncrypter.DecryptCard(encryptedCard, m_selfClient.PocketCardDecryptKeys[i]);
 				}
 				
 				m_pendingNetOperation = PendingNetOperation.None;
@@ -755,6 +812,7 @@ namespace Poker.Net.Server
 		public override void Disconnect()
 		{
 			m_closed = true;
+			m_coreThread?.Join();
 			
 			RemoteClient[] clients = m_clients.ToArray();
 			m_clients.Clear();
@@ -763,7 +821,8 @@ namespace Poker.Net.Server
 			
 			m_clients.Sort();
 			
-			m_socket.Close();
+			m_socket?.Close();
+			m_core?.Dispose();
 		}
 	}
 }
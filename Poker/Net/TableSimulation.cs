@@ -0,0 +1,127 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Runtime.InteropServices;
+using Poker.Net.Client;
+
+namespace Poker.Net
+{
+	//When the game runs with --sim-thread, a joined game's messages are handled on the native simulation thread at a
+	// fixed rate, instead of on the connection's receive thread, and the table is captured there after every step.
+	// The frame thread draws the latest published TableSnapshot, so slow message handlers never hold up a frame.
+	public static class TableSimulation
+	{
+		private delegate void SimulationCallback(float dt);
+		
+		[DllImport("Native")]
+		private static extern void SetSimulationThread(SimulationCallback callback, float rate);
+		
+		private const float RATE = 60;
+		
+		//Kept alive here, since native code calls it for as long as the game runs.
+		private static SimulationCallback s_callback;
+		
+		private static SnapshotBuffer<TableSnapshot> s_snapshots;
+		
+		//Held for a whole step, so the connection can't be disconnected while the simulation thread uses it.
+		private static readonly object s_mutex = new object();
+		private static Connection s_connection;
+		private static uint s_generation;
+		
+		private static volatile uint s_step;
+		[ThreadStatic] private static bool s_onSimulationThread;
+		
+		private struct PostedAction
+		{
+			public uint Step;
+			public Action Action;
+		}
+		
+		private static readonly ConcurrentQueue<PostedAction> s_postedActions = new ConcurrentQueue<PostedAction>();
+		
+		public static bool Enabled => s_callback != null;
+		
+		//Must be called before RunGame.
+		public static void Enable()
+		{
+			s_snapshots = new SnapshotBuffer<TableSnapshot>();
+			s_callback = Step;
+			SetSimulationThread(s_callback, RATE);
+		}
+		
+		//Called from the frame thread when a game starts, and with null before its connection is disconnected. Actions
+		// posted for the previous connection are dropped.
+		public static void SetConnection(Connection connection)
+		{
+			if (Enabled)
+			{
+				lock (s_mutex)
+				{
+					s_connection = connection;
+					s_generation++;
+				}
+				
+				(connection as ServerConnection)?.DeferMessages();
+			}
+			
+			while (s_postedActions.TryDequeue(out PostedAction _))
+			{
+			}
+		}
+		
+		private static void Step(float dt)
+		{
+			s_onSimulationThread = true;
+			
+			lock (s_mutex)
+			{
+				if (s_connection == null)
+					return;
+				
+				s_step++;
+				
+				//A hosted game handles messages on the server's threads, so there is only its table to capture.
+				(s_connection as ServerConnection)?.HandleDeferredMessages();
+				
+				TableSnapshot table = default(TableSnapshot);
+				s_connection.CaptureTable(ref table);
+				table.Generation = s_generation;
+				table.Step = s_step;
+				s_snapshots.Publish(table);
+			}
+		}
+		
+		//Queues an action for the frame thread, which runs it in Update once the table it draws includes everything
+		// that happened before the call. Handlers of connection events use this, since the events are raised on
+		// network threads.
+		public static void Post(Action action)
+		{
+			//Snapshots of other threads' changes are only certain to include them from the next step.
+			uint step = s_onSimulationThread ? s_step : s_step + 1;
+			s_postedActions.Enqueue(new PostedAction { Step = step, Action = action });
+		}
+		
+		//Called from the frame thread before it reads the table. Without the simulation thread the table is captured
+		// directly, otherwise it is left as it is until a snapshot of the current connection has been published.
+		public static void Update(Connection connection, ref TableSnapshot table)
+		{
+			if (!Enabled)
+			{
+				while (s_postedActions.TryDequeue(out PostedAction posted))
+					posted.Action();
+				connection.CaptureTable(ref table);
+				return;
+			}
+			
+			if (s_snapshots.TryGetLatest(out TableSnapshot latest) && latest.Generation == s_generation)
+				table = latest;
+			if (table.Generation != s_generation)
+				return;
+			
+			while (s_postedActions.TryPeek(out PostedAction posted) && posted.Step <= table.Step)
+			{
+				s_postedActions.TryDequeue(out posted);
+				posted.Action();
+			}
+		}
+	}
+}
@@ -0,0 +1,164 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace Poker.Net
+{
+	//The table state which the game draws, copied out of a Connection. It only holds values, so it can be handed from
+	// the simulation thread to the frame thread through a SnapshotBuffer. Players are indexed in turn order.
+	[StructLayout(LayoutKind.Sequential)]
+	public unsafe struct TableSnapshot
+	{
+		public const int MAX_PLAYERS = Protocol.MAX_CLIENTS;
+		
+		private const byte FOLDED = 1;
+		private const byte ALL_IN = 2;
+		private const byte NO_CARD = 0xFF;
+		
+		//Set by TableSimulation, which uses them to ignore snapshots of an earlier connection and to tell which posted
+		// actions a snapshot has caught up with.
+		public uint Generation;
+		public uint Step;
+		
+		public int NumPlayers;
+		public int CurrentPlayer;
+		public int CommunityCardsRevealed;
+		public int MinimumRaise;
+		public int NumPots;
+		
+		private byte m_hasDealtPocketCards;
+		private fixed byte m_pocketCards[2];
+		private fixed byte m_communityCards[5];
+		private fixed byte m_revealedPocketCards[MAX_PLAYERS * 2];
+		private fixed byte m_playerFlags[MAX_PLAYERS];
+		private fixed int m_chips[MAX_PLAYERS];
+		private fixed int m_potSizes[MAX_PLAYERS];
+		
+		public bool HasDealtPocketCards => m_hasDealtPocketCards != 0;
+		
+		public void Capture(Connection connection)
+		{
+			GameDriver driver = connection.GameDriver;
+			if (driver == null)
+			{
+				NumPlayers = 0;
+				return;
+			}
+			
+			NumPlayers = Math.Min(driver.Players.Length, MAX_PLAYERS);
+			
+			//Players who have left the game can not act.
+			IClient currentClient = connection.CurrentClient;
+			CurrentPlayer = currentClient == null ? -1 :
+				Array.FindIndex(driver.Players, player => player.ClientId == currentClient.ClientId);
+			
+			CommunityCardsRevealed = connection.CommunityCardsRevealed;
+			MinimumRaise = driver.MinimumRaise;
+			m_hasDealtPocketCards = (byte)(connection.HasDealtPocketCards ? 1 : 0);
+			
+			fixed (byte* pocketCards = m_pocketCards)
+			{
+				for (int i = 0; i < 2; i++)
+					pocketCards[i] = connection.PocketCards[i].PackedValue;
+			}
+			
+			fixed (byte* communityCards = m_communityCards)
+			{
+				for (int i = 0; i < 5; i++)
+					communityCards[i] = connection.CommunityCards[i].PackedValue;
+			}
+			
+			fixed (byte* revealedPocketCards = m_revealedPocketCards)
+			fixed (byte* playerFlags = m_playerFlags)
+			fixed (int* chips = m_chips)
+			fixed (int* potSizes = m_potSizes)
+			{
+				NumPots = 0;
+				for (int i = 0; i < NumPlayers; i++)
+				{
+					Player player = driver.Players[i];
+					chips[i] = player.Chips;
+					playerFlags[i] = (byte)((player.HasFolded ? FOLDED : 0) | (player.AllIn ? ALL_IN : 0));
+					NumPots = Math.Max(NumPots, Math.Min(player.ContributionAmounts.Count, MAX_PLAYERS));
+					
+					Card[] revealed = connection.TurnOrderClients[i].RevealedPocketCards;
+					revealedPocketCards[i * 2 + 0] = revealed == null ? NO_CARD : revealed[0].PackedValue;
+					revealedPocketCards[i * 2 + 1] = revealed == null ? NO_CARD : revealed[1].PackedValue;
+				}
+				
+				for (int pot = 0; pot < NumPots; pot++)
+					potSizes[pot] = driver.GetPotSize(pot);
+			}
+		}
+		
+		public Card GetPocketCard(int index)
+		{
+			fixed (byte* pocketCards = m_pocketCards)
+			{
+				return new Card(pocketCards[index]);
+			}
+		}
+		
+		public Card GetCommunityCard(int index)
+		{
+			fixed (byte* communityCards = m_communityCards)
+			{
+				return new Card(communityCards[index]);
+			}
+		}
+		
+		public int GetChips(int player)
+		{
+			fixed (int* chips = m_chips)
+			{
+				return chips[player];
+			}
+		}
+		
+		public bool HasFolded(int player)
+		{
+			fixed (byte* playerFlags = m_playerFlags)
+			{
+				return (playerFlags[player] & FOLDED) != 0;
+			}
+		}
+		
+		public bool IsAllIn(int player)
+		{
+			fixed (byte* playerFlags = m_playerFlags)
+			{
+				return (playerFlags[player] & ALL_IN) != 0;
+			}
+		}
+		
+		public bool IsBust(int player) => GetChips(player) == 0 && !IsAllIn(player);
+		public bool IsInGame(int player) => !IsBust(player) && !HasFolded(player);
+		
+		//Cards are only revealed at showdowns.
+		public bool HasRevealedPocketCards(int player)
+		{
+			fixed (byte* revealedPocketCards = m_revealedPocketCards)
+			{
+				return revealedPocketCards[player * 2] != NO_CARD;
+			}
+		}
+		
+		public Card GetRevealedPocketCard(int player, int index)
+		{
+			fixed (byte* revealedPocketCards = m_revealedPocketCards)
+			{
+				return new Card(revealedPocketCards[player * 2 + index]);
+			}
+		}
+		
+		//Zero for pots which do not exist.
+		public int GetPotSize(int pot)
+		{
+			if (pot >= NumPots)
+				return 0;
+			fixed (int* potSizes = m_potSizes)
+			{
+				return potSizes[pot];
+			}
+		}
+	}
+}
@@ -5,7 +5,6 @@ using System.Linq;
 using System.Net;
 using System.Numerics;
 using System.Runtime.InteropServices;
-using System.Text;
 using System.Threading;
 using Poker.Net;
 using Poker.Net.Client;
@@ -19,36 +18,144 @@ namespace Poker
 		private delegate void CloseCallback();
 		private delegate void FrameCallback(float dt);
 		private delegate void ResizeCallback(int width, int height);
-		private delegate void TextInputCallback(byte* utf8String, int byteLength);
-		private delegate void KeyPressCallback(Keys key);
+		
+		public enum FramePacing
+		{
+			Uncapped      = 0,
+			VSync         = 1,
+			AdaptiveVSync = 2,
+			FrameCap      = 3,
+			JustInTime    = 4
+		}
 		
 		[DllImport("Native")]
 		private static extern bool RunGame(InitCallback initCallback, CloseCallback closeCallback,
-		                                   FrameCallback frameCallback, ResizeCallback resizeCallback,
-		                                   TextInputCallback textInputCallback, KeyPressCallback keyPressCallback);
+		                                   FrameCallback frameCallback, ResizeCallback resizeCallback);
 		
 		[DllImport("Native")]
 		public static extern bool ExitGame();
 		
+		//targetFPS is only used by FramePacing.FrameCap.
+		[DllImport("Native")]
+		public static extern void SetFramePacing(FramePacing pacing, float targetFPS);
+		
+		[StructLayout(LayoutKind.Sequential, Pack=1)]
+		private struct FrameQueueStats
+		{
+			public ulong Frames;
+			public ulong BlockedFrames;
+			public float TotalWaitMS;
+			public float MaxWaitMS;
+			public uint QueueDepth;
+		}
+		
+		//Depth is clamped to 1-4. Lower depths reduce latency, higher depths let the CPU run further ahead of the GPU.
+		[DllImport("Native")]
+		public static extern void SetFrameQueueDepth(uint depth);
+		[DllImport("Native")]
+		private static extern FrameQueueStats GetFrameQueueStats();
+		
+		[StructLayout(LayoutKind.Sequential, Pack=1)]
+		public struct LatencyStats
+		{
+			public uint Samples;
+			public float P50;
+			public float P95;
+			public float P99;
+			public float Max;
+		}
+		
+		//Input to photon latency, from an input event's arrival until the GPU has finished the first frame
+		// which reacted to it. Percentiles are in milliseconds over the most recent 1024 samples.
+		[DllImport("Native")]
+		public static extern void SetLatencyTracking([MarshalAs(UnmanagedType.I1)] bool enabled);
+		[DllImport("Native")]
+		public static extern LatencyStats GetLatencyStats();
+		[DllImport("Native")]
+		public static extern void ResetLatencyStats();
+		
+		//Records the input events and frame times of a session, or plays a recording back instead of live input.
+		// A fixed dt above zero replaces the recorded frame times.
+		[DllImport("Native")]
+		private static extern void StartInputRecording(string path);
+		[DllImport("Native")]
+		private static extern void StartInputReplay(string path, float fixedDT);
+		
+		[DllImport("Native")]
+		[return: MarshalAs(UnmanagedType.I1)]
+		private static extern bool IsWindowOccluded();
+		[DllImport("Native")]
+		[return: MarshalAs(UnmanagedType.I1)]
+		private static extern bool IsRedrawRequired();
+		[DllImport("Native")]
+		private static extern void SkipPresent();
+		
 		public static string EXEDirectory { get; private set; }
 		
 		private static SpriteBatch s_spriteBatch;
 		
+		private static bool s_screenshotRequested;
+		private static string s_captureStreamPath;
+		
 		private static bool s_host;
 		private static bool s_join;
 		private static string s_nickname;
 		
 		public static void Main(string[] args)
 		{
-			if (args.Length == 2)
+			if (args.Length >= 2)
 			{
 				s_host = args[0] == "host";
 				s_join = args[0] == "join";
 				s_nickname = args[1];
 			}
 			
+			//Adaptive vsync by default, so that menus do not render thousands of frames per second.
+			SetFramePacing(FramePacing.AdaptiveVSync, 0);
+			
+			switch (GetArgValue(args, "--pacing"))
+			{
+			case "uncapped": SetFramePacing(FramePacing.Uncapped, 0); break;
+			case "vsync": SetFramePacing(FramePacing.VSync, 0); break;
+			case "adaptive": SetFramePacing(FramePacing.AdaptiveVSync, 0); break;
+			case "jit": SetFramePacing(FramePacing.JustInTime, 0); break;
+			}
+			
+			if (float.TryParse(GetArgValue(args, "--fps-cap"), out float fpsCap))
+				SetFramePacing(FramePacing.FrameCap, fpsCap);
+			
+			if (uint.TryParse(GetArgValue(args, "--queue-depth"), out uint queueDepth))
+				SetFrameQueueDepth(queueDepth);
+			
+			if (args.Contains("--latency"))
+				SetLatencyTracking(true);
+			
+			if (args.Contains("--sim-thread"))
+				TableSimulation.Enable();
+			
+			string recordPath = GetArgValue(args, "--record");
+			string replayPath = GetArgValue(args, "--replay");
+			if (replayPath != null)
+			{
+				float.TryParse(GetArgValue(args, "--fixed-dt"), out float fixedDT);
+				StartInputReplay(replayPath, fixedDT);
+			}
+			else if (recordPath != null)
+			{
+				StartInputRecording(recordPath);
+			}
+			
+			s_captureStreamPath = GetArgValue(args, "--capture-stream");
+			
 			EXEDirectory = AppDomain.CurrentDomain.BaseDirectory;
-			RunGame(Initialize, Close, RunFrame, Resized, TextInput, KeyPress);
+			RunGame(Initialize, Close, RunFrame, Resized);
+		}
+		
+		//Returns the argument following name, or null if there is none.
+		private static string GetArgValue(string[] args, string name)
+		{
+			int index = Array.IndexOf(args, name);
+			return index != -1 && index + 1 < args.Length ? args[index + 1] : null;
 		}
 		
 		private static void Initialize()
@@ -109,6 +216,31 @@ namespace Poker
 		
 		private static void Close()
 		{
+			FrameQueueStats queueStats = GetFrameQueueStats();
+			if (queueStats.Frames != 0)
+			{
+				Log.Write($"Frame queue depth {queueStats.QueueDepth}: CPU blocked on {queueStats.BlockedFrames} of " +
+				          $"{queueStats.Frames} frames, {queueStats.TotalWaitMS:F0} ms total, {queueStats.MaxWaitMS:F1} ms max");
+			}
+			
+			FrameCapture.Stats captureStats = FrameCapture.GetFrameCaptureStats();
+			if (captureStats.Written != 0 || captureStats.Dropped != 0)
+				Log.Write($"Frame capture: {captureStats.Written} frames written, {captureStats.Dropped} dropped");
+			
+			LatencyStats latencyStats = GetLatencyStats();
+			if (latencyStats.Samples != 0)
+			{
+				Log.Write($"Input latency over {latencyStats.Samples} frames: p50 {latencyStats.P50:F1} ms, " +
+				          $"p95 {latencyStats.P95:F1} ms, p99 {latencyStats.P99:F1} ms, max {latencyStats.Max:F1} ms");
+			}
+			
+			ChipsRenderer.UploadStats chipStats = ChipsRenderer.Instance.StackUploadStats;
+			if (chipStats.BytesUploaded + chipStats.BytesSkipped != 0)
+			{
+				Log.Write($"Chip stacks: {chipStats.BytesUploaded} bytes uploaded, {chipStats.BytesSkipped} bytes " +
+				          $"unchanged, {chipStats.IdleUploads} uploads without changes");
+			}
+			
 			Utils.DisposeAndNull(ref s_spriteBatch);
 			GameStateManager.Dispose();
 			SkyRenderer.Dispose();
@@ -124,32 +256,61 @@ namespace Poker
 		{
 			MenuBackground.Instance.OnResize(width, height);
 			BlurEffect.Instance.SetResolution((uint)width, (uint)height);
+			FrameCapture.DisplayWidth = width;
+			FrameCapture.DisplayHeight = height;
 			s_spriteBatch.SetDisplaySize(width, height);
 			GameStateManager.OnResize(width, height);
 		}
 		
-		private static void TextInput(byte* utf8String, int byteLength)
-		{
-			string text = Encoding.UTF8.GetString(utf8String, byteLength);
-			GameStateManager.CurrentGameState.OnTextInput(text);
-		}
-		
-		private static void KeyPress(Keys key)
+		private static void DispatchInput()
 		{
-			GameStateManager.CurrentGameState.OnKeyPress(key);
+			InputQueue.Drain();
+			for (int i = 0; i < InputQueue.Count; i++)
+			{
+				switch (InputQueue.Events[i].Type)
+				{
+				case InputEventType.TextInput:
+					GameStateManager.CurrentGameState.OnTextInput(InputQueue.Events[i].GetText());
+					break;
+				case InputEventType.KeyDown:
+					if (InputQueue.Events[i].Key == Keys.F12 && !InputQueue.Events[i].IsRepeat)
+						s_screenshotRequested = true;
+					GameStateManager.CurrentGameState.OnKeyPress(InputQueue.Events[i].Key);
+					break;
+				}
+			}
 		}
 		
 		private static void RunFrame(float dt)
 		{
+			DispatchInput();
+			
 			GameState drawGS = GameStateManager.CurrentGameState;
 			GameStateManager.Update(dt);
 			
+			//Nothing is drawn while the window can't be seen, or while the screen would not change.
+			if (IsWindowOccluded() ||
+			    (!drawGS.NeedsRedraw && !IsRedrawRequired() && drawGS == GameStateManager.CurrentGameState))
+			{
+				SkipPresent();
+				return;
+			}
+			
 			DrawArgs drawArgs = new DrawArgs
 			{
 				DeltaTime = dt,
 				SpriteBatch = s_spriteBatch
 			};
 			drawGS.Draw(drawArgs);
+			
+			if (s_screenshotRequested)
+			{
+				FrameCapture.Capture(FrameCapture.GetScreenshotPath(), CaptureFormat.PNG);
+				s_screenshotRequested = false;
+			}
+			
+			if (s_captureStreamPath != null)
+				FrameCapture.Capture(s_captureStreamPath, CaptureFormat.Raw);
 		}
 	}
 }
@@ -2,32 +2,49 @@ layout(location=0) in vec3 normal_in;
 layout(location=1) in vec3 tangent_in;
 layout(location=2) in vec2 texCoord_in;
 layout(location=3) in vec3 worldPos_in;
+layout(location=4) flat in uint textureSet_in;
+layout(location=5) flat in vec2 specular_in;
 
 layout(location=0) out vec4 color_out;
 
-layout(binding=0) uniform sampler2D diffuseSampler;
-layout(binding=1) uniform sampler2D normalMapSampler;
-layout(binding=2) uniform sampler2D specularMapSampler;
+//Two texture sets of diffuse, normal and specular maps, one per material. Unit 3 holds the shadow map.
+layout(binding=0) uniform sampler2D diffuseSampler0;
+layout(binding=1) uniform sampler2D normalMapSampler0;
+layout(binding=2) uniform sampler2D specularMapSampler0;
+layout(binding=4) uniform sampler2D diffuseSampler1;
+layout(binding=5) uniform sampler2D normalMapSampler1;
+layout(binding=6) uniform sampler2D specularMapSampler1;
 
 #include "Lighting.glh"
 
-uniform float specularExponent;
-uniform float specularIntensity;
-
 void main()
 {
+	//The texture set is the same for a whole triangle, so derivatives are still valid within the branches.
+	vec3 nmSample, color;
+	float specSample;
+	if (textureSet_in == 0u)
+	{
+		nmSample = texture(normalMapSampler0, texCoord_in).rgb;
+		color = texture(diffuseSampler0, texCoord_in).rgb;
+		specSample = texture(specularMapSampler0, texCoord_in).r;
+	}
+	else
+	{
+		nmSample = texture(normalMapSampler1, texCoord_in).rgb;
+		color = texture(diffuseSampler1, texCoord_in).rgb;
+		specSample = texture(specularMapSampler1, texCoord_in).r;
+	}
+	
 	vec3 normal = normalize(normal_in);
 	vec3 tangent = normalize(tangent_in - dot(normal, tangent_in) * normal);
 	
 	mat3 tbnMatrix = mat3(tangent, cross(tangent, normal), normal);
 	
-	vec3 nmNormal = (texture(normalMapSampler, texCoord_in).rgb * (255.0 / 128.0)) - vec3(1.0);
+	vec3 nmNormal = (nmSample * (255.0 / 128.0)) - vec3(1.0);
 	normal = normalize(tbnMatrix * nmNormal);
 	
-	vec3 color = texture(diffuseSampler, texCoord_in).rgb;
-	
-	float specIntensity = texture(specularMapSampler, texCoord_in).r * specularIntensity;
-	vec3 lighting = calcLighting(color, normal, worldPos_in, specIntensity, specularExponent);
+	float specIntensity = specSample * specular_in.x;
+	vec3 lighting = calcLighting(color, normal, worldPos_in, specIntensity, specular_in.y);
 	
 	color_out = vec4(pow(lighting, vec3(1.0 / 2.2)), 1.0);
 }
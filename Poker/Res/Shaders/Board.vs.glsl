@@ -1,23 +1,42 @@
 layout(location=0) in vec3 position_in;
-layout(location=1) in vec3 normal_in;
-layout(location=2) in vec3 tangent_in;
+layout(location=1) in vec2 normal_in;
+layout(location=2) in vec2 tangent_in;
 layout(location=3) in vec2 texCoord_in;
+layout(location=7) in uint drawId_in;
 
 layout(location=0) out vec3 normal_out;
 layout(location=1) out vec3 tangent_out;
 layout(location=2) out vec2 texCoord_out;
 layout(location=3) out vec3 worldPos_out;
+layout(location=4) flat out uint textureSet_out;
+layout(location=5) flat out vec2 specular_out;
 
-uniform float textureScale;
+struct PartParams
+{
+	float specularIntensity;
+	float specularExponent;
+	float textureScale;
+	uint textureSet;
+};
+
+layout(binding=4, std430) readonly buffer PartParamsBuffer
+{
+	PartParams parts[];
+};
 
 #include "ViewProj.glh"
+#include "PackedVertex.glh"
 
 void main()
 {
-	normal_out = normal_in;
-	tangent_out = tangent_in;
-	texCoord_out = texCoord_in * textureScale;
-	worldPos_out = position_in;
+	PartParams part = parts[drawId_in];
+	textureSet_out = part.textureSet;
+	specular_out = vec2(part.specularIntensity, part.specularExponent);
+	
+	normal_out = unpackOctahedral(normal_in);
+	tangent_out = unpackOctahedral(tangent_in);
+	texCoord_out = texCoord_in * part.textureScale;
+	worldPos_out = unpackPosition(position_in);
 	
-	gl_Position = viewProjTransform * vec4(position_in, 1.0);
+	gl_Position = viewProjTransform * vec4(worldPos_out, 1.0);
 }
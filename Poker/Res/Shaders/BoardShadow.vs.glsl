@@ -1,3 +1,5 @@
+#include "PackedVertex.glh"
+
 layout(location=0) in vec3 position_in;
 
 layout(binding=0, std140) uniform ShadowMatrixUB
@@ -7,5 +9,5 @@ layout(binding=0, std140) uniform ShadowMatrixUB
 
 void main()
 {
-	gl_Position = shadowMatrix * vec4(position_in, 1.0);
+	gl_Position = shadowMatrix * vec4(unpackPosition(position_in), 1.0);
 }
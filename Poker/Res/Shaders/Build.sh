@@ -3,6 +3,7 @@ mkdir -p .build
 
 vs=(Card.vs.glsl Board.vs.glsl PlayerName.vs.glsl Sky.vs.glsl Chip.vs.glsl ChipShadow.vs.glsl BoardShadow.vs.glsl CardShadow.vs.glsl Blur.vs.glsl)
 fs=(Card.fs.glsl Board.fs.glsl PlayerName.fs.glsl Sky.fs.glsl Chip.fs.glsl CardShadow.fs.glsl Blur.fs.glsl)
+cs=(ChipCull.cs.glsl)
 
 preamble=$'#version 440 core\n#extension GL_GOOGLE_include_directive:enable\n#line 1\n'
 
@@ -16,4 +17,9 @@ for shader in ${fs[@]}; do
 	glslangValidator -S frag .build/${shader}
 done
 
+for shader in ${cs[@]}; do
+	echo -e "$preamble" "$(cat ${shader})" | glslangValidator --stdin -E -S comp > .build/${shader}
+	glslangValidator -S comp .build/${shader}
+done
+
 7z a -tzip Shaders. ./.build/* > /dev/null
@@ -1,14 +1,13 @@
 layout(location=0) in vec2 texCoord_in;
 layout(location=1) in vec3 worldPos_in;
 layout(location=2) in vec3 normal_in;
+layout(location=3) flat in vec4 texSourceRegion_in;
 
 layout(location=0) out vec4 color_out;
 
 layout(binding=0) uniform sampler2D frontTexSampler;
 layout(binding=1) uniform sampler2D backTexSampler;
 
-uniform vec4 texSourceRegion;
-
 #include "Lighting.glh"
 
 void main()
@@ -18,7 +17,7 @@ void main()
 	vec4 color;
 	if (gl_FrontFacing)
 	{
-		color = texture(frontTexSampler, mix(texSourceRegion.xy, texSourceRegion.zw, texCoord_in));
+		color = texture(frontTexSampler, mix(texSourceRegion_in.xy, texSourceRegion_in.zw, texCoord_in));
 		normal = -normal;
 	}
 	else
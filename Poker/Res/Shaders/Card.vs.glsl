@@ -1,15 +1,29 @@
 layout(location=0) in vec2 position_in;
+layout(location=7) in uint drawId_in;
 
 layout(location=0) out vec2 texCoord_out;
 layout(location=1) out vec3 worldPos_out;
 layout(location=2) out vec3 normal_out;
+layout(location=3) flat out vec4 texSourceRegion_out;
 
-uniform mat4 worldTransform;
+struct CardParams
+{
+	mat4 worldTransform;
+	vec4 texSourceRegion;
+};
+
+layout(binding=4, std430) readonly buffer CardParamsBuffer
+{
+	CardParams cards[];
+};
 
 #include "ViewProj.glh"
 
 void main()
 {
+	mat4 worldTransform = cards[drawId_in].worldTransform;
+	texSourceRegion_out = cards[drawId_in].texSourceRegion;
+	
 	normal_out = (worldTransform * vec4(0, 1, 0, 0)).xyz;
 	
 	texCoord_out = (position_in + 1.0) / 2.0;
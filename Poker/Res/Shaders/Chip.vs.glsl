@@ -1,14 +1,20 @@
 #include "ViewProj.glh"
+#include "PackedVertex.glh"
+#include "CulledChip.glh"
 
 layout(location=0) in vec3 position_in;
-layout(location=1) in vec3 normal_in;
+layout(location=1) in vec2 normal_in;
+
+//Index of the chip mesh part. Part 0 takes the color of the stack, the others use albedo.
+layout(location=7) in uint drawId_in;
 
 layout(location=0) out vec3 normal_out;
 layout(location=1) out vec3 worldPos_out;
+layout(location=2) flat out vec3 albedo_out;
 
-layout(binding=0, std140) readonly buffer PositionBuffer
+layout(binding=1, std430) readonly buffer CulledChipBuffer
 {
-	vec4 transforms[];
+	CulledChip culledChips[];
 };
 
 vec3 rotateXZ(vec3 v, float sinR, float cosR)
@@ -21,15 +27,20 @@ vec3 rotateXZ(vec3 v, float sinR, float cosR)
 }
 
 uniform float scale;
+uniform vec3 albedo;
 
 void main()
 {
-	float sinR = sin(transforms[gl_InstanceID].w);
-	float cosR = cos(transforms[gl_InstanceID].w);
+	CulledChip chip = culledChips[gl_InstanceID];
+	
+	float sinR = sin(chip.positionAndRotation.w);
+	float cosR = cos(chip.positionAndRotation.w);
+	
+	worldPos_out = rotateXZ(unpackPosition(position_in), sinR, cosR) * scale + chip.positionAndRotation.xyz;
 	
-	worldPos_out = rotateXZ(position_in, sinR, cosR) * scale + transforms[gl_InstanceID].xyz;
+	normal_out = rotateXZ(unpackOctahedral(normal_in), sinR, cosR);
 	
-	normal_out = rotateXZ(normal_in, sinR, cosR);
+	albedo_out = drawId_in == 0u ? unpackUnorm4x8(chip.color).rgb : albedo;
 	
 	gl_Position = viewProjTransform * vec4(worldPos_out, 1.0);
 }
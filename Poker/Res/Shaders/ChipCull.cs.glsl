@@ -0,0 +1,87 @@
+#include "ChipStack.glh"
+#include "CulledChip.glh"
+
+layout(local_size_x=64) in;
+
+layout(binding=1, std430) writeonly buffer CulledChipBuffer
+{
+	CulledChip culledChips[];
+};
+
+layout(binding=2, std430) writeonly buffer ShadowCulledChipBuffer
+{
+	CulledChip shadowCulledChips[];
+};
+
+struct DrawCommand
+{
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+//Commands for the main pass followed by commands for the shadow pass, MAX_MESHES each.
+const int MAX_MESHES = 4;
+
+layout(binding=3, std430) buffer DrawCommandBuffer
+{
+	DrawCommand commands[];
+};
+
+uniform mat4 viewProj;
+uniform mat4 shadowMatrix;
+uniform int numChips;
+uniform int numMeshes;
+uniform float boundingRadius;
+
+//Tests a bounding sphere against the clip planes of a view projection matrix. The near plane is taken
+// as -w <= z, which is conservative for projections mapping depth to [0, w].
+bool isSphereVisible(mat4 m, vec3 center, float radius)
+{
+	vec4 rowX = vec4(m[0].x, m[1].x, m[2].x, m[3].x);
+	vec4 rowY = vec4(m[0].y, m[1].y, m[2].y, m[3].y);
+	vec4 rowZ = vec4(m[0].z, m[1].z, m[2].z, m[3].z);
+	vec4 rowW = vec4(m[0].w, m[1].w, m[2].w, m[3].w);
+	
+	vec4 planes[6] = vec4[](rowW + rowX, rowW - rowX, rowW + rowY, rowW - rowY, rowW + rowZ, rowW - rowZ);
+	for (int i = 0; i < 6; i++)
+	{
+		if (dot(planes[i].xyz, center) + planes[i].w < -radius * length(planes[i].xyz))
+			return false;
+	}
+	return true;
+}
+
+void appendChip(int pass, CulledChip chip)
+{
+	uint index = atomicAdd(commands[pass * MAX_MESHES].instanceCount, 1u);
+	for (int i = 1; i < numMeshes; i++)
+		atomicAdd(commands[pass * MAX_MESHES + i].instanceCount, 1u);
+	
+	if (pass == 0)
+		culledChips[index] = chip;
+	else
+		shadowCulledChips[index] = chip;
+}
+
+void main()
+{
+	int instance = int(gl_GlobalInvocationID.x);
+	if (instance >= numChips)
+		return;
+	
+	ChipInstance chip = getChipInstance(instance);
+	
+	CulledChip culledChip;
+	culledChip.positionAndRotation = vec4(chip.position, chip.rotation);
+	culledChip.color = packUnorm4x8(vec4(chip.color, 1.0));
+	
+	vec3 center = chip.position + vec3(0.0, chipHeight * 0.5, 0.0);
+	
+	if (isSphereVisible(viewProj, center, boundingRadius))
+		appendChip(0, culledChip);
+	if (isSphereVisible(shadowMatrix, center, boundingRadius))
+		appendChip(1, culledChip);
+}
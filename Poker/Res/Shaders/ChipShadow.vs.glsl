@@ -1,8 +1,11 @@
+#include "PackedVertex.glh"
+#include "CulledChip.glh"
+
 layout(location=0) in vec3 position_in;
 
-layout(binding=0, std140) readonly buffer PositionBuffer
+layout(binding=1, std430) readonly buffer CulledChipBuffer
 {
-	vec4 transforms[];
+	CulledChip culledChips[];
 };
 
 layout(binding=0, std140) uniform ShadowMatrixUB
@@ -14,7 +17,7 @@ uniform float scale;
 
 void main()
 {
-	vec3 worldPos = position_in * scale + transforms[gl_InstanceID].xyz;
+	vec3 worldPos = unpackPosition(position_in) * scale + culledChips[gl_InstanceID].positionAndRotation.xyz;
 	
 	gl_Position = shadowMatrix * vec4(worldPos, 1.0);
 }
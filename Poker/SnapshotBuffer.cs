@@ -0,0 +1,63 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace Poker
+{
+	internal static class TripleBufferNative
+	{
+		[DllImport("Native")]
+		public static extern IntPtr TB_Create(ulong snapshotSize);
+		[DllImport("Native")]
+		public static extern void TB_Destroy(IntPtr buffer);
+		[DllImport("Native")]
+		public static extern IntPtr TB_GetWriteSlot(IntPtr buffer);
+		[DllImport("Native")]
+		public static extern void TB_Publish(IntPtr buffer);
+		[DllImport("Native")]
+		public static extern IntPtr TB_AcquireLatest(IntPtr buffer);
+	}
+	
+	//Hands immutable snapshots of type T from the simulation thread to the frame thread through a lock free
+	// triple buffer. T must be a blittable struct.
+	public class SnapshotBuffer<T> : IDisposable where T : struct
+	{
+		private readonly IntPtr m_handle;
+		
+		public SnapshotBuffer()
+		{
+			m_handle = TripleBufferNative.TB_Create((ulong)Marshal.SizeOf<T>());
+		}
+		
+		~SnapshotBuffer()
+		{
+			TripleBufferNative.TB_Destroy(m_handle);
+		}
+		
+		public void Dispose()
+		{
+			TripleBufferNative.TB_Destroy(m_handle);
+			GC.SuppressFinalize(this);
+		}
+		
+		//Called from the simulation thread.
+		public void Publish(T snapshot)
+		{
+			Marshal.StructureToPtr(snapshot, TripleBufferNative.TB_GetWriteSlot(m_handle), false);
+			TripleBufferNative.TB_Publish(m_handle);
+		}
+		
+		//Called from the frame thread. Returns false until the first snapshot has been published.
+		public bool TryGetLatest(out T snapshot)
+		{
+			IntPtr latest = TripleBufferNative.TB_AcquireLatest(m_handle);
+			if (latest == IntPtr.Zero)
+			{
+				snapshot = default(T);
+				return false;
+			}
+			
+			snapshot = Marshal.PtrToStructure<T>(latest);
+			return true;
+		}
+	}
+}
@@ -5,7 +5,7 @@ using System.Numerics;
 
 namespace Poker
 {
-	class TotalsPane
+	class TotalsPane : IDisposable
 	{
 		private float m_width;
 		private float m_height;
@@ -24,6 +24,18 @@ namespace Poker
 		private float m_itemPadding;
 		private float m_textScale;
 		
+		//Live equities of the players still in the hand. Hands this client has not seen count as unknown hands.
+		private Hands.EquityCalculator m_equityCalculator;
+		private readonly List<int> m_equityPlayers = new List<int>();
+		private readonly List<Card[]> m_equityHoleCards = new List<Card[]>();
+		private Card[] m_equityBoard = new Card[0];
+		
+		//The inputs of the current update, copied to the ones above when they differ.
+		private readonly List<int> m_newEquityPlayers = new List<int>();
+		private readonly List<Card[]> m_newEquityHoleCards = new List<Card[]>();
+		
+		private const int EQUITY_TIME_BUDGET_MS = 500;
+		
 		public TotalsPane()
 		{
 			m_titleSize = Assets.RegularFont.MeasureString(TITLE);
@@ -50,16 +62,121 @@ namespace Poker
 			m_textScale = targetTextHeight / Assets.RegularFont.LineHeight;
 		}
 		
-		public void Update(bool visible, float dt)
+		public void Dispose()
+		{
+			m_equityCalculator?.Dispose();
+		}
+		
+		private static Card[] GetKnownHoleCards(Net.Connection connection, ref Net.TableSnapshot table, int player)
+		{
+			if (connection.TurnOrderClients[player].ClientId == connection.SelfClientId)
+				return table.HasDealtPocketCards ? new[] { table.GetPocketCard(0), table.GetPocketCard(1) } : null;
+			if (!table.HasRevealedPocketCards(player))
+				return null;
+			return new[] { table.GetRevealedPocketCard(player, 0), table.GetRevealedPocketCard(player, 1) };
+		}
+		
+		private static bool SameHoleCards(Card[] a, Card[] b)
+		{
+			if (a == null || b == null)
+				return a == b;
+			return a[0].PackedValue == b[0].PackedValue && a[1].PackedValue == b[1].PackedValue;
+		}
+		
+		private bool EquityInputsChanged(ref Net.TableSnapshot table)
+		{
+			if (m_newEquityPlayers.Count != m_equityPlayers.Count || table.CommunityCardsRevealed != m_equityBoard.Length)
+				return true;
+			
+			for (int i = 0; i < m_equityPlayers.Count; i++)
+			{
+				if (m_newEquityPlayers[i] != m_equityPlayers[i] || !SameHoleCards(m_newEquityHoleCards[i], m_equityHoleCards[i]))
+					return true;
+			}
+			
+			for (int i = 0; i < m_equityBoard.Length; i++)
+			{
+				if (table.GetCommunityCard(i).PackedValue != m_equityBoard[i].PackedValue)
+					return true;
+			}
+			
+			return false;
+		}
+		
+		//Restarts the equity calculation when a card is revealed or a player leaves the hand.
+		private void UpdateEquity(Net.Connection connection, ref Net.TableSnapshot table)
+		{
+			m_newEquityPlayers.Clear();
+			m_newEquityHoleCards.Clear();
+			
+			bool anyKnown = false;
+			bool allKnown = true;
+			for (int player = 0; player < table.NumPlayers; player++)
+			{
+				if (!table.IsInGame(player))
+					continue;
+				
+				Card[] holeCards = GetKnownHoleCards(connection, ref table, player);
+				m_newEquityPlayers.Add(player);
+				m_newEquityHoleCards.Add(holeCards);
+				anyKnown |= holeCards != null;
+				allKnown &= holeCards != null;
+			}
+			
+			if (!anyKnown || m_newEquityPlayers.Count < 2 ||
+			    m_newEquityPlayers.Count > Hands.EquityCalculator.MAX_PLAYERS)
+			{
+				m_equityCalculator?.Dispose();
+				m_equityCalculator = null;
+				return;
+			}
+			
+			if (m_equityCalculator == null || EquityInputsChanged(ref table))
+			{
+				m_equityPlayers.Clear();
+				m_equityPlayers.AddRange(m_newEquityPlayers);
+				m_equityHoleCards.Clear();
+				m_equityHoleCards.AddRange(m_newEquityHoleCards);
+				
+				m_equityBoard = new Card[table.CommunityCardsRevealed];
+				for (int i = 0; i < m_equityBoard.Length; i++)
+					m_equityBoard[i] = table.GetCommunityCard(i);
+				
+				//Exact equities are cheap once the flop is out, or preflop heads up.
+				bool enumerate = allKnown && (m_equityBoard.Length >= 3 || m_equityPlayers.Count == 2);
+				
+				m_equityCalculator?.Dispose();
+				if (enumerate)
+				{
+					m_equityCalculator = Hands.EquityCalculator.Enumerate(m_equityHoleCards.ToArray(), m_equityBoard,
+					                                                      null);
+				}
+				else
+				{
+					m_equityCalculator = Hands.EquityCalculator.WithTimeBudget(m_equityHoleCards.ToArray(),
+					                                                           m_equityBoard, null,
+					                                                           EQUITY_TIME_BUDGET_MS);
+				}
+			}
+			
+			m_equityCalculator.Update();
+		}
+		
+		public bool Visible => m_enterProgress > 0;
+		
+		public void Update(bool visible, float dt, Net.Connection connection, ref Net.TableSnapshot table)
 		{
 			const float ANIMATION_SPEED = 0.75f;
 			if (visible)
 				UI.AnimateInc(ref m_enterProgress, dt, ANIMATION_SPEED);
 			else
 				UI.AnimateDec(ref m_enterProgress, dt, ANIMATION_SPEED);
+			
+			if (m_enterProgress > 0)
+				UpdateEquity(connection, ref table);
 		}
 		
-		public void Draw(SpriteBatch spriteBatch, Net.Connection connection)
+		public void Draw(SpriteBatch spriteBatch, Net.Connection connection, ref Net.TableSnapshot table)
 		{
 			if (m_enterProgress <= 0)
 				return;
@@ -100,7 +217,7 @@ namespace Poker
 			//Draws pot sizes
 			for (int pot = 0;; pot++)
 			{
-				int size = connection.GameDriver.GetPotSize(pot);
+				int size = table.GetPotSize(pot);
 				if (size == 0 && pot != 0)
 					break;
 				
@@ -111,10 +228,23 @@ namespace Poker
 			y += m_itemPadding;
 			
 			//Draws player chip counts
-			foreach (Player player in connection.GameDriver.Players)
+			for (int player = 0; player < table.NumPlayers; player++)
 			{
-				DrawTotalsEntry(connection.GetClientById(player.ClientId).Name + ":",
-				                player.Chips.ToString(), player.Bust ? 0.5f : 1.0f);
+				DrawTotalsEntry(connection.TurnOrderClients[player].Name + ":",
+				                table.GetChips(player).ToString(), table.IsBust(player) ? 0.5f : 1.0f);
+			}
+			
+			//Draws equities once enough boards have been dealt for them to settle
+			if (m_equityCalculator != null && (m_equityCalculator.Finished ||
+			    (!m_equityCalculator.Exact && m_equityCalculator.Deals >= 10000)))
+			{
+				y += m_itemPadding;
+				
+				for (int i = 0; i < m_equityPlayers.Count; i++)
+				{
+					string equity = (m_equityCalculator.GetEquity(i) * 100).ToString("0.0") + "%";
+					DrawTotalsEntry(connection.TurnOrderClients[m_equityPlayers[i]].Name + " Equity:", equity);
+				}
 			}
 		}
 	}